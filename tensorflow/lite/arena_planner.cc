@@ -84,6 +84,7 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  plan_cache_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
@@ -159,11 +160,16 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
 
+    // Nodes that may run at the same time as this one need their tensors at
+    // once, so lifetimes are stretched over the whole group of such nodes.
+    const int first_concurrent_node = graph_info_->first_concurrent_node(i);
+    const int last_concurrent_node = graph_info_->last_concurrent_node(i);
+
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(allocate(first_concurrent_node, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -175,7 +181,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
         if (tensor_index != kTfLiteOptionalTensor) {
           refcounts[tensor_index]--;
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(
+                deallocate(last_concurrent_node, tensor_index));
           }
         }
       }
@@ -202,14 +209,31 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = graph_info_->first_concurrent_node(i);
       if (!preserve_intermediates_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // Where tensors go in a plan made from scratch only depends on their sizes
+  // and lifetimes, so earlier plans for the same ones can be used as is.
+  bool restored = false;
+  std::vector<TensorUsage> usages;
+  const bool plan_from_scratch = first_node == 0 && IsPlanEmpty();
+  if (plan_from_scratch) {
+    usages = GetTensorUsages();
+    TF_LITE_ENSURE_STATUS(RestoreCachedPlan(last_node, usages, &restored));
+  }
+  if (!restored) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+    if (plan_from_scratch) {
+      CachePlan(last_node, std::move(usages));
+      ++plan_cache_misses_;
+    }
+  } else {
+    ++plan_cache_hits_;
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
@@ -336,6 +360,78 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::TensorUsage::operator==(const TensorUsage& other) const {
+  return bytes == other.bytes && alloc_node == other.alloc_node &&
+         dealloc_node == other.dealloc_node &&
+         allocation_type == other.allocation_type;
+}
+
+bool ArenaPlanner::IsPlanEmpty() const {
+  for (const auto& alloc : allocs_) {
+    if (alloc.size != 0) return false;
+  }
+  return true;
+}
+
+std::vector<ArenaPlanner::TensorUsage> ArenaPlanner::GetTensorUsages() const {
+  std::vector<TensorUsage> usages(graph_info_->num_tensors());
+  for (int i = 0; i < static_cast<int>(usages.size()); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    // Only tensors in the arenas matter, whatever the size of others.
+    if (tensor.allocation_type == kTfLiteArenaRw ||
+        tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      usages[i] = {tensor.bytes, alloc_node_[i], dealloc_node_[i],
+                   tensor.allocation_type};
+    } else {
+      usages[i] = {0, kNodeNotAssigned, kNodeNotAssigned,
+                   tensor.allocation_type};
+    }
+  }
+  return usages;
+}
+
+TfLiteStatus ArenaPlanner::RestoreCachedPlan(
+    int last_node, const std::vector<TensorUsage>& usages, bool* restored) {
+  *restored = false;
+  auto plan = std::find_if(plan_cache_.begin(), plan_cache_.end(),
+                           [&](const CachedPlan& plan) {
+                             return plan.last_node == last_node &&
+                                    plan.usages == usages;
+                           });
+  if (plan == plan_cache_.end()) return kTfLiteOk;
+  std::rotate(plan_cache_.begin(), plan, plan + 1);
+  allocs_ = plan_cache_.front().allocs;
+
+  // Scheduling the allocations in order of offset keeps the arenas sorted
+  // without moving anything around.
+  std::vector<int32_t> tensor_order;
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    if (allocs_[i].size != 0) tensor_order.push_back(i);
+  }
+  std::sort(tensor_order.begin(), tensor_order.end(), [this](int a, int b) {
+    return allocs_[a].offset < allocs_[b].offset;
+  });
+  for (int tensor_index : tensor_order) {
+    if (usages[tensor_index].allocation_type == kTfLiteArenaRw) {
+      TF_LITE_ENSURE_STATUS(
+          arena_.AllocateAt(context_, allocs_[tensor_index]));
+    } else {
+      TF_LITE_ENSURE_STATUS(
+          persistent_arena_.AllocateAt(context_, allocs_[tensor_index]));
+    }
+  }
+  *restored = true;
+  return kTfLiteOk;
+}
+
+void ArenaPlanner::CachePlan(int last_node, std::vector<TensorUsage> usages) {
+  if (plan_cache_.size() == kMaxCachedArenaPlans) {
+    plan_cache_.pop_back();
+  }
+  plan_cache_.insert(plan_cache_.begin(),
+                     CachedPlan{last_node, std::move(usages), allocs_});
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -28,6 +28,8 @@ limitations under the License.
 namespace tflite {
 
 constexpr const int kDefaultArenaAlignment = 64;
+// The number of plans an ArenaPlanner keeps for input sizes it has seen.
+constexpr const int kMaxCachedArenaPlans = 8;
 struct AllocationInfo;
 
 // A memory planner that makes all the allocations using arenas.
@@ -43,6 +45,15 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// Nodes that GraphInfo reports as running at the same time are treated as a
+// single step: the tensors any of them use are alive for the whole group, so
+// they never share memory with each other.
+//
+// Plans made from scratch, which is what happens each time the inputs are
+// resized, are cached by the sizes and lifetimes of the tensors. Going back to
+// tensor sizes that were planned for recently reuses the earlier offsets
+// instead of searching the arenas for gaps again.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -67,6 +78,11 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Returns how many plans made from scratch were restored from the cache,
+  // and how many had to be calculated.
+  int plan_cache_hits() const { return plan_cache_hits_; }
+  int plan_cache_misses() const { return plan_cache_misses_; }
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -98,6 +114,38 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
 
+  // What a plan made from scratch depends on for one tensor.
+  struct TensorUsage {
+    size_t bytes;
+    int32_t alloc_node;
+    int32_t dealloc_node;
+    TfLiteAllocationType allocation_type;
+    bool operator==(const TensorUsage& other) const;
+  };
+
+  struct CachedPlan {
+    int last_node;
+    std::vector<TensorUsage> usages;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+  };
+
+  // Returns true if no tensor has been given memory since the last reset.
+  bool IsPlanEmpty() const;
+
+  // Returns the usage of all tensors, which identifies a plan made from
+  // scratch.
+  std::vector<TensorUsage> GetTensorUsages() const;
+
+  // Schedules the allocations of a plan cached for the same usages and
+  // `last_node`, if any, and returns whether it did.
+  TfLiteStatus RestoreCachedPlan(int last_node,
+                                 const std::vector<TensorUsage>& usages,
+                                 bool* restored);
+
+  // Adds the current plan to the cache, evicting the least recently used one
+  // if it is full.
+  void CachePlan(int last_node, std::vector<TensorUsage> usages);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -131,6 +179,11 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Plans made from scratch, most recently used first.
+  std::vector<CachedPlan> plan_cache_;
+  int plan_cache_hits_ = 0;
+  int plan_cache_misses_ = 0;
 };
 
 }  // namespace tflite
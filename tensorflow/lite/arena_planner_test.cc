@@ -119,12 +119,22 @@ class TestGraph {
     variables_ = variables;
   }
 
+  // Sets the first and last node that may run at the same time as each node.
+  void SetConcurrentNodes(
+      const std::vector<std::pair<int, int>>& concurrent_nodes) {
+    concurrent_nodes_ = concurrent_nodes;
+  }
+  const std::vector<std::pair<int, int>>& concurrent_nodes() {
+    return concurrent_nodes_;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
     std::swap(inputs_, other->inputs_);
     std::swap(outputs_, other->outputs_);
     std::swap(variables_, other->variables_);
+    std::swap(concurrent_nodes_, other->concurrent_nodes_);
   }
 
  private:
@@ -133,6 +143,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<std::pair<int, int>> concurrent_nodes_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -155,6 +166,14 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    if (graph_->concurrent_nodes().empty()) return index;
+    return graph_->concurrent_nodes()[index].first;
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    if (graph_->concurrent_nodes().empty()) return index;
+    return graph_->concurrent_nodes()[index].second;
+  }
 
  private:
   TestGraph* graph_;
@@ -194,6 +213,25 @@ class ArenaPlannerTest : public ::testing::Test {
     CHECK(planner_->ExecuteAllocations(start, end) == kTfLiteOk);
   }
 
+  void ResetAllocations() {
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  }
+
+  int PlanCacheHits() { return planner_->plan_cache_hits(); }
+  int PlanCacheMisses() { return planner_->plan_cache_misses(); }
+
+  // Returns the offsets of the first num_tensors tensors in a plan made by a
+  // new planner, which has no cache.
+  std::vector<std::ptrdiff_t> GetNewPlannerOffsets(int num_tensors) {
+    std::unique_ptr<ArenaPlanner> planner = std::move(planner_);
+    SetGraph(graph_);
+    Execute(0, 10);
+    std::vector<std::ptrdiff_t> offsets;
+    for (int i = 0; i < num_tensors; ++i) offsets.push_back(GetOffset(i));
+    planner_ = std::move(planner);
+    return offsets;
+  }
+
   void ReleaseNonPersistentMemory() {
     CHECK(planner_->ReleaseNonPersistentMemory() == kTfLiteOk);
   }
@@ -401,6 +439,37 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentResetAllocationsAfter) {
   EXPECT_TRUE(tensor5_ptr == (*graph.tensors())[5].data.raw);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithConcurrentNodes) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {3}},    // First op, with temporary
+                      {{0}, {2}, {4}},    // Second op, with temporary
+                      {{1, 2}, {5}, {}}  // Third op
+                  },
+                  {5});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Run one after the other, the first two ops share their temporaries.
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(3), 0);
+
+  // Run at the same time, none of the tensors they use may overlap.
+  graph.SetConcurrentNodes({{0, 1}, {0, 1}, {2, 2}});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order: +0 +1 +2 +3 +4 -0 -3 -4 +5 -1 -2
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithOptionals) {
   TestGraph graph({0, -1, 1},
                   {
@@ -447,6 +516,102 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithLargeTensor) {
   EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithResizedTensors) {
+  TestGraph graph({0, -1, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4, -1}, {3}, {}}   // Third op, with optional
+                  },
+                  {3});
+  (*graph.tensors())[1].bytes = 40;
+  (*graph.tensors())[5].allocation_type = kTfLiteArenaRwPersistent;
+
+  SetGraph(&graph);
+  Execute(0, 10);
+  std::vector<std::ptrdiff_t> large_offsets;
+  for (int i = 0; i < 6; ++i) large_offsets.push_back(GetOffset(i));
+  EXPECT_EQ(PlanCacheMisses(), 1);
+
+  // With a small #1, #4 no longer fits in its vacancy.
+  (*graph.tensors())[1].bytes = 3;
+  ResetAllocations();
+  Execute(0, 10);
+  std::vector<std::ptrdiff_t> small_offsets;
+  for (int i = 0; i < 6; ++i) small_offsets.push_back(GetOffset(i));
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_NE(small_offsets, large_offsets);
+  EXPECT_EQ(PlanCacheMisses(), 2);
+  EXPECT_EQ(PlanCacheHits(), 0);
+
+  // Going back to earlier sizes gives the same plans as before.
+  (*graph.tensors())[1].bytes = 40;
+  ResetAllocations();
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), large_offsets[i]);
+  }
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(PlanCacheHits(), 1);
+
+  (*graph.tensors())[1].bytes = 3;
+  ResetAllocations();
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), small_offsets[i]);
+  }
+  EXPECT_EQ(PlanCacheHits(), 2);
+  EXPECT_EQ(PlanCacheMisses(), 2);
+
+  // The pointers of a restored plan are resolved like any other.
+  ReleaseNonPersistentMemory();
+  AcquireNonPersistentMemory();
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), small_offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, SimpleGraphWithChangedTemporaries) {
+  TestGraph graph({0, -1, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4, -1}, {3}, {6}}  // Third op, with temporary
+                  },
+                  {3});
+  auto execute_from_scratch = [&]() {
+    ResetAllocations();
+    Execute(0, 10);
+    std::vector<std::ptrdiff_t> offsets;
+    for (int i = 0; i < 7; ++i) offsets.push_back(GetOffset(i));
+    return offsets;
+  };
+
+  SetGraph(&graph);
+  execute_from_scratch();
+  execute_from_scratch();
+  EXPECT_EQ(PlanCacheMisses(), 1);
+  EXPECT_EQ(PlanCacheHits(), 1);
+
+  // A kernel asking for a larger temporary gets a new plan.
+  (*graph.tensors())[5].bytes = 100;
+  std::vector<std::ptrdiff_t> expected_offsets = GetNewPlannerOffsets(7);
+  EXPECT_EQ(execute_from_scratch(), expected_offsets);
+  EXPECT_EQ(PlanCacheMisses(), 2);
+  EXPECT_EQ(PlanCacheHits(), 1);
+
+  // So do kernels swapping their temporaries, which keeps the sizes but
+  // changes the lifetimes. #5 now overlaps #4 and #3 rather than #2 and #4.
+  graph.nodes()[1].temporaries->data[0] = 6;
+  graph.nodes()[2].temporaries->data[0] = 5;
+  expected_offsets = GetNewPlannerOffsets(7);
+  EXPECT_EQ(execute_from_scratch(), expected_offsets);
+  EXPECT_EQ(PlanCacheMisses(), 3);
+  EXPECT_EQ(PlanCacheHits(), 1);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentTensor) {
   TestGraph graph({0, -1, 1},
                   {
@@ -764,6 +764,16 @@ typedef struct TfLiteContext {
   // WARNING: This method may not be available on all platforms.
   TfLiteEvalTensor* (*GetEvalTensor)(const struct TfLiteContext* context,
                                      int tensor_idx);
+
+  // Asks for the output tensor to share the buffer of the input tensor, for
+  // ops that leave the data unchanged (e.g. RESHAPE). The request can be
+  // declined, so the kernel must still work when the buffers differ. Only
+  // available during Prepare.
+  // WARNING: This is an experimental interface that is subject to change.
+  // WARNING: This method may not be available on all platforms.
+  TfLiteStatus (*RequestInPlaceOutput)(struct TfLiteContext* context,
+                                       int input_tensor_idx,
+                                       int output_tensor_idx);
 } TfLiteContext;
 
 typedef struct TfLiteRegistration {
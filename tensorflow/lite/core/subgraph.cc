@@ -36,7 +36,9 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/worker_pool.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -166,6 +168,23 @@ TfLiteStatus ValidateCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// Returns true if a node must keep its place in the execution plan and run on
+// its own, because it may do more than read its inputs and write its outputs:
+// run other subgraphs, use shared resources, or hand work to a delegate.
+bool RunsAlone(const TfLiteNode& node, const TfLiteRegistration& registration) {
+  if (node.delegate != nullptr) return true;
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -201,6 +220,12 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    return subgraph_->concurrent_nodes(index).first;
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    return subgraph_->concurrent_nodes(index).second;
+  }
 
  public:
   Subgraph* subgraph_;
@@ -230,6 +255,7 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
   context_.profiler = nullptr;
   context_.GetTensor = nullptr;
   context_.GetEvalTensor = nullptr;
+  context_.RequestInPlaceOutput = nullptr;
 
   // Reserve some space for the tensors to avoid excessive resizing.
   tensors_.reserve(kTensorsReservedCapacity);
@@ -463,6 +489,19 @@ void Subgraph::SetExternalContext(struct TfLiteContext* context,
   return static_cast<Subgraph*>(context->impl_)->SetExternalContext(type, ctx);
 }
 
+TfLiteExternalContext* Subgraph::GetWorkerExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    const int worker = context - subgraph->worker_contexts_.data();
+    if (worker >= 0 &&
+        worker < subgraph->worker_cpu_backend_contexts_.size()) {
+      return subgraph->worker_cpu_backend_contexts_[worker].get();
+    }
+  }
+  return subgraph->GetExternalContext(type);
+}
+
 // Gets an TfLiteIntArray* representing the execution plan. The interpreter owns
 // this memory and it is only guaranteed to exist during the invocation of the
 // delegate prepare.
@@ -563,6 +602,31 @@ void Subgraph::SetCancellationFunction(void* data,
   check_cancelled_func_ = check_cancelled_func;
 }
 
+TfLiteStatus Subgraph::SetParallelExecution(bool enabled) {
+  if (parallel_execution_ == enabled) return kTfLiteOk;
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetParallelExecution is disallowed when graph is immutable.");
+    return kTfLiteApplicationError;
+  }
+  parallel_execution_ = enabled;
+  if (memory_planner_) {
+    // The execution and memory plans both change, so the tensors have to be
+    // allocated again.
+    state_ = kStateUninvokable;
+    PlanParallelExecution();
+    TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+std::pair<int, int> Subgraph::concurrent_nodes(
+    int execution_plan_index) const {
+  if (concurrent_nodes_.size() != execution_plan_.size()) {
+    return {execution_plan_index, execution_plan_index};
+  }
+  return concurrent_nodes_[execution_plan_index];
+}
+
 bool Subgraph::IsCancelled() {
   return (check_cancelled_func_ != nullptr) &&
          (*check_cancelled_func_)(cancellation_data_);
@@ -937,6 +1001,7 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
         kDefaultTensorAlignment));
+    PlanParallelExecution();
     memory_planner_->PlanAllocations();
   }
 
@@ -969,6 +1034,16 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
                            execution_plan_, &last_exec_plan_index_prepared));
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
+  // Dynamic tensors are only sized as the nodes run, one by one, so the waves
+  // are dropped and the memory is planned for a sequential run instead. This
+  // is found out while preparing for the first time, before any allocations.
+  if (has_dynamic_tensors_ && !concurrent_nodes_.empty()) {
+    concurrent_nodes_.clear();
+    parallel_execution_plan_.clear();
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    next_execution_plan_index_to_plan_allocation_ = 0;
+  }
+
   // Execute arena allocations.
   TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
       next_execution_plan_index_to_plan_allocation_,
@@ -994,6 +1069,39 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  // TODO(ycling): This is an extra loop through inputs to check if the data
+  // need to be copied from Delegate buffer to raw memory, which is often not
+  // needed. We may want to cache this in prepare to know if this needs to be
+  // done for a node or not.
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is only
+        // used for the shape, not for the data. Thus, null buffer is ok.
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   if (!consistent_) {
     ReportError("Invoke called on model that is not consistent.");
@@ -1009,6 +1117,18 @@ TfLiteStatus Subgraph::Invoke() {
     return kTfLiteError;
   }
 
+  if (CanInvokeInParallel()) {
+    if (worker_pool_ &&
+        worker_pool_num_threads_ == context_.recommended_num_threads) {
+      return InvokeInParallel();
+    }
+    // Kernels may set things up lazily the first time they run, like the
+    // thread pools of external contexts. So the first Invoke() with a new
+    // plan or thread count runs the nodes one by one, and only then are the
+    // threads started.
+    CreateWorkerPool();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1029,34 +1149,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    // TODO(ycling): This is an extra loop through inputs to check if the data
-    // need to be copied from Delegate buffer to raw memory, which is often not
-    // needed. We may want to cache this in prepare to know if this needs to be
-    // done for a node or not.
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is only
-          // used for the shape, not for the data. Thus, null buffer is ok.
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
 
     if (check_cancelled_func_ != nullptr &&
         check_cancelled_func_(cancellation_data_)) {
@@ -1095,6 +1188,174 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+void Subgraph::PlanParallelExecution() {
+  concurrent_nodes_.clear();
+  parallel_execution_plan_.clear();
+  max_concurrent_nodes_ = 1;
+  worker_pool_.reset();
+  if (!parallel_execution_) return;
+
+  // A node goes in the wave after the last one that writes its inputs, or
+  // reads or writes its outputs. Variable tensors may be updated by the nodes
+  // that read them, so those count as writes too.
+  std::vector<int> last_write(tensors_.size(), -1);
+  std::vector<int> last_read(tensors_.size(), -1);
+  std::vector<int> waves(execution_plan_.size());
+  int num_waves = 0;
+  int first_open_wave = 0;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+
+    int wave = first_open_wave;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      wave = std::max(wave, last_write[tensor_index] + 1);
+      if (tensors_[tensor_index].is_variable) {
+        wave = std::max(wave, last_read[tensor_index] + 1);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      wave = std::max(wave, last_write[tensor_index] + 1);
+      wave = std::max(wave, last_read[tensor_index] + 1);
+    }
+    if (RunsAlone(node, registration)) {
+      // Nothing before or after the node may share its wave.
+      wave = num_waves;
+      first_open_wave = wave + 1;
+    }
+
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      last_read[tensor_index] = std::max(last_read[tensor_index], wave);
+      if (tensors_[tensor_index].is_variable) {
+        last_write[tensor_index] = std::max(last_write[tensor_index], wave);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      last_write[tensor_index] = std::max(last_write[tensor_index], wave);
+    }
+    waves[i] = wave;
+    num_waves = std::max(num_waves, wave + 1);
+  }
+
+  // Sort the plan by wave, keeping the original order within each wave.
+  std::vector<int> wave_start(num_waves + 1, 0);
+  for (int wave : waves) {
+    ++wave_start[wave + 1];
+  }
+  for (int wave = 0; wave < num_waves; ++wave) {
+    wave_start[wave + 1] += wave_start[wave];
+  }
+  std::vector<int> next_in_wave(wave_start.begin(), wave_start.end() - 1);
+  std::vector<int> plan(execution_plan_.size());
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    plan[next_in_wave[waves[i]]++] = execution_plan_[i];
+  }
+
+  concurrent_nodes_.resize(plan.size());
+  for (int wave = 0; wave < num_waves; ++wave) {
+    const int first = wave_start[wave];
+    const int last = wave_start[wave + 1] - 1;
+    for (int i = first; i <= last; ++i) {
+      concurrent_nodes_[i] = {first, last};
+    }
+    max_concurrent_nodes_ = std::max(max_concurrent_nodes_, last - first + 1);
+  }
+  execution_plan_ = plan;
+  parallel_execution_plan_ = std::move(plan);
+}
+
+bool Subgraph::CanInvokeInParallel() const {
+  // The profiler and the handling of dynamic tensors both expect the nodes to
+  // run one after the other.
+  return !concurrent_nodes_.empty() && max_concurrent_nodes_ > 1 &&
+         context_.recommended_num_threads > 1 && !profiler_ &&
+         !has_dynamic_tensors_ &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size() &&
+         parallel_execution_plan_ == execution_plan_;
+}
+
+void Subgraph::CreateWorkerPool() {
+  const int num_threads =
+      std::min(context_.recommended_num_threads, max_concurrent_nodes_);
+  worker_pool_.reset(new WorkerPool(num_threads - 1));
+  worker_pool_num_threads_ = context_.recommended_num_threads;
+  worker_contexts_.resize(num_threads);
+  worker_cpu_backend_contexts_.clear();
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      GetExternalContext(kTfLiteCpuBackendContext));
+  for (int i = 0; i < num_threads; ++i) {
+    worker_cpu_backend_contexts_.emplace_back(new ExternalCpuBackendContext);
+    if (cpu_backend_context) {
+      worker_cpu_backend_contexts_.back()->set_packed_weights_cache(
+          cpu_backend_context->packed_weights_cache());
+    }
+  }
+}
+
+TfLiteStatus Subgraph::InvokeInParallel() {
+  std::vector<TfLiteStatus> statuses;
+  for (int first = 0; first < execution_plan_.size();) {
+    const int last = concurrent_nodes_[first].second;
+    for (int i = first; i <= last; ++i) {
+      const int node_index = execution_plan_[i];
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(
+          nodes_and_registration_[node_index].first,
+          nodes_and_registration_[node_index].second));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+    if (first == last) {
+      // A node on its own keeps all the threads for its kernel.
+      const int node_index = execution_plan_[first];
+      statuses.assign(1, OpInvoke(nodes_and_registration_[node_index].second,
+                                  &nodes_and_registration_[node_index].first));
+    } else {
+      // The threads are spent on the nodes of the wave instead.
+      for (TfLiteContext& worker_context : worker_contexts_) {
+        worker_context = context_;
+        worker_context.recommended_num_threads = 1;
+        worker_context.GetExternalContext = GetWorkerExternalContext;
+      }
+      statuses.assign(last - first + 1, kTfLiteOk);
+      worker_pool_->Run(
+          last - first + 1, [this, first, &statuses](int worker, int task) {
+            const int node_index = execution_plan_[first + task];
+            TfLiteNode& node = nodes_and_registration_[node_index].first;
+            const TfLiteRegistration& registration =
+                nodes_and_registration_[node_index].second;
+            statuses[task] =
+                registration.invoke == nullptr
+                    ? kTfLiteError
+                    : registration.invoke(&worker_contexts_[worker], &node);
+          });
+    }
+
+    for (int i = first; i <= last; ++i) {
+      if (statuses[i - first] != kTfLiteOk) {
+        const int node_index = execution_plan_[i];
+        return ReportOpError(
+            &context_, nodes_and_registration_[node_index].first,
+            nodes_and_registration_[node_index].second, node_index,
+            "failed to invoke");
+      }
+    }
+    first = last + 1;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1499,6 +1760,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    PlanParallelExecution();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -36,6 +36,9 @@ limitations under the License.
 
 namespace tflite {
 
+class ExternalCpuBackendContext;
+class WorkerPool;
+
 class Subgraph {
  public:
   friend class Interpreter;
@@ -263,6 +266,20 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Enables or disables running nodes that don't depend on each other at the
+  // same time, on up to `context()->recommended_num_threads` threads. The
+  // execution plan is reordered into waves of such nodes, and their tensors
+  // are kept apart in the memory plan, which can make the arena bigger.
+  // Invoke() still runs nodes one by one when a profiler is set or the graph
+  // has dynamic tensors. Takes effect at the next AllocateTensors().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetParallelExecution(bool enabled);
+
+  // Returns the execution-plan indices of the first and last nodes of the
+  // wave that the node at `execution_plan_index` runs in.
+  // WARNING: This is an experimental API and subject to change.
+  std::pair<int, int> concurrent_nodes(int execution_plan_index) const;
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -418,6 +435,26 @@ class Subgraph {
     return op_reg.invoke(&context_, node);
   }
 
+  // Makes the inputs of 'node' readable, returning an error if one of them
+  // lacks data.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Groups the execution plan into waves of nodes that don't depend on each
+  // other and reorders the plan so that each wave is contiguous. Clears the
+  // waves if parallel execution is disabled.
+  void PlanParallelExecution();
+
+  // True if Invoke() can run the waves of the execution plan in parallel.
+  bool CanInvokeInParallel() const;
+
+  // Starts `worker_pool_` for the current number of threads.
+  void CreateWorkerPool();
+
+  // Runs the execution plan wave by wave, the nodes of a wave at the same
+  // time on `worker_pool_`.
+  TfLiteStatus InvokeInParallel();
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -546,6 +583,10 @@ class Subgraph {
                                  TfLiteExternalContextType type,
                                  TfLiteExternalContext* ctx);
 
+  // Retrieve an external context for a node run from `worker_contexts_`.
+  static TfLiteExternalContext* GetWorkerExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
   // WARNING: This is an experimental API and subject to change.
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
@@ -731,6 +772,30 @@ class Subgraph {
 
   // A map of resources. Owned by interpreter and shared by multiple subgraphs.
   resource::ResourceMap* resources_ = nullptr;
+
+  // Whether nodes that don't depend on each other may run at the same time.
+  bool parallel_execution_ = false;
+
+  // The execution plan that the waves were planned for, and for each of its
+  // indices the first and last index of the wave. Empty if nodes run one
+  // after the other.
+  std::vector<int> parallel_execution_plan_;
+  std::vector<std::pair<int, int>> concurrent_nodes_;
+
+  // Number of nodes in the largest wave.
+  int max_concurrent_nodes_ = 1;
+
+  // Threads that run the nodes of a wave, and the number of threads the
+  // context recommended when they were started.
+  std::unique_ptr<WorkerPool> worker_pool_;
+  int worker_pool_num_threads_ = 0;
+
+  // Copies of `context_` that the nodes of a wave run with, one per thread.
+  // Each has its own CPU backend context, since ruy and gemmlowp contexts
+  // can't be used from several threads at once.
+  std::vector<TfLiteContext> worker_contexts_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
 };
 
 }  // namespace tflite
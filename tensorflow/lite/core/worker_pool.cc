@@ -0,0 +1,91 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/worker_pool.h"
+
+namespace tflite {
+
+WorkerPool::WorkerPool(int num_workers) {
+  threads_.reserve(num_workers);
+  for (int i = 1; i <= num_workers; ++i) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Run(int num_tasks, const std::function<void(int, int)>& task) {
+  if (num_tasks <= 0) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    pending_tasks_ = num_tasks;
+    ++generation_;
+  }
+  work_ready_.notify_all();
+
+  RunTasks(/*worker=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return pending_tasks_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop(int worker) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [this, &seen_generation] {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) return;
+      seen_generation = generation_;
+    }
+    RunTasks(worker);
+  }
+}
+
+void WorkerPool::RunTasks(int worker) {
+  while (true) {
+    int index;
+    const std::function<void(int, int)>* task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (next_task_ >= num_tasks_) return;
+      index = next_task_++;
+      task = task_;
+    }
+    (*task)(worker, index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_tasks_ == 0) {
+        work_done_.notify_all();
+      }
+    }
+  }
+}
+
+}  // namespace tflite
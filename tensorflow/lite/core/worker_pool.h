@@ -0,0 +1,65 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_WORKER_POOL_H_
+#define TENSORFLOW_LITE_CORE_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads that a Subgraph uses to run independent nodes at the
+// same time. The thread calling Run() takes part in the work, so a pool with
+// `num_workers` threads runs up to `num_workers + 1` tasks at once.
+class WorkerPool {
+ public:
+  explicit WorkerPool(int num_workers);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  int num_workers() const { return static_cast<int>(threads_.size()); }
+
+  // Calls `task(worker, index)` for every index in [0, num_tasks) and returns
+  // once all calls have finished. `worker` is 0 for the calling thread and
+  // between 1 and num_workers() for the threads of the pool, so that tasks
+  // can keep per-thread state. Run() must not be called concurrently.
+  void Run(int num_tasks, const std::function<void(int, int)>& task);
+
+ private:
+  void WorkerLoop(int worker);
+  void RunTasks(int worker);
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+
+  // The batch of tasks being run, guarded by `mutex_`.
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int pending_tasks_ = 0;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_WORKER_POOL_H_
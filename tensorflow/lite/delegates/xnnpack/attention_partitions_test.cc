@@ -0,0 +1,262 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+
+namespace {
+
+constexpr int32_t kTokens = 4;
+constexpr int32_t kHidden = 8;
+
+// Single-head self-attention block of a BERT-style encoder layer:
+//   q, k, v = FC(x)
+//   y = x + FC(BATCH_MATMUL(SOFTMAX(BATCH_MATMUL(q, k, adj_y)), v))
+std::vector<char> CreateAttentionModel() {
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto f32rng = std::bind(std::uniform_real_distribution<float>(-0.5f, 0.5f),
+                          std::ref(rng));
+
+  flatbuffers::FlatBufferBuilder builder;
+  const std::array<flatbuffers::Offset<OperatorCode>, 4> operator_codes{{
+      CreateOperatorCode(builder, BuiltinOperator_FULLY_CONNECTED),
+      CreateOperatorCode(builder, BuiltinOperator_BATCH_MATMUL),
+      CreateOperatorCode(builder, BuiltinOperator_SOFTMAX),
+      CreateOperatorCode(builder, BuiltinOperator_ADD),
+  }};
+
+  // buffer 0 is empty, buffers 1-8 are the filters and biases of the four
+  // FULLY_CONNECTED operators
+  std::vector<flatbuffers::Offset<Buffer>> buffers{
+      CreateBuffer(builder, builder.CreateVector({}))};
+  for (int i = 0; i < 4; i++) {
+    std::vector<float> filter(kHidden * kHidden);
+    std::generate(filter.begin(), filter.end(), std::ref(f32rng));
+    buffers.push_back(CreateBuffer(
+        builder, builder.CreateVector(
+                     reinterpret_cast<const uint8_t*>(filter.data()),
+                     sizeof(float) * filter.size())));
+    std::vector<float> bias(kHidden);
+    std::generate(bias.begin(), bias.end(), std::ref(f32rng));
+    buffers.push_back(CreateBuffer(
+        builder,
+        builder.CreateVector(reinterpret_cast<const uint8_t*>(bias.data()),
+                             sizeof(float) * bias.size())));
+  }
+
+  const std::array<int32_t, 3> hidden_shape{{1, kTokens, kHidden}};
+  const std::array<int32_t, 3> scores_shape{{1, kTokens, kTokens}};
+  const std::array<int32_t, 2> filter_shape{{kHidden, kHidden}};
+  const std::array<int32_t, 1> bias_shape{{kHidden}};
+  auto hidden_tensor = [&]() {
+    return CreateTensor(builder,
+                        builder.CreateVector<int32_t>(hidden_shape.data(),
+                                                      hidden_shape.size()),
+                        TensorType_FLOAT32);
+  };
+  auto scores_tensor = [&]() {
+    return CreateTensor(builder,
+                        builder.CreateVector<int32_t>(scores_shape.data(),
+                                                      scores_shape.size()),
+                        TensorType_FLOAT32);
+  };
+  std::vector<flatbuffers::Offset<Tensor>> tensors{hidden_tensor()};  // x
+  for (int i = 0; i < 4; i++) {
+    tensors.push_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_FLOAT32, /*buffer=*/1 + 2 * i));
+    tensors.push_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
+        TensorType_FLOAT32, /*buffer=*/2 + 2 * i));
+  }
+  tensors.push_back(hidden_tensor());  // 9: q
+  tensors.push_back(hidden_tensor());  // 10: k
+  tensors.push_back(hidden_tensor());  // 11: v
+  tensors.push_back(scores_tensor());  // 12: scores
+  tensors.push_back(scores_tensor());  // 13: probabilities
+  tensors.push_back(hidden_tensor());  // 14: context
+  tensors.push_back(hidden_tensor());  // 15: attention
+  tensors.push_back(hidden_tensor());  // 16: y
+
+  auto fc_options = [&]() {
+    return CreateFullyConnectedOptions(
+               builder, ActivationFunctionType_NONE,
+               FullyConnectedOptionsWeightsFormat_DEFAULT,
+               /*keep_num_dims=*/true)
+        .Union();
+  };
+  auto create_op = [&](int32_t opcode_index, std::vector<int32_t> inputs,
+                       int32_t output, BuiltinOptions options_type,
+                       flatbuffers::Offset<void> options) {
+    return CreateOperator(
+        builder, opcode_index,
+        builder.CreateVector<int32_t>(inputs.data(), inputs.size()),
+        builder.CreateVector<int32_t>(&output, 1), options_type, options);
+  };
+  const std::array<flatbuffers::Offset<Operator>, 8> operators{{
+      create_op(0, {0, 1, 2}, 9, BuiltinOptions_FullyConnectedOptions,
+                fc_options()),
+      create_op(0, {0, 3, 4}, 10, BuiltinOptions_FullyConnectedOptions,
+                fc_options()),
+      create_op(0, {0, 5, 6}, 11, BuiltinOptions_FullyConnectedOptions,
+                fc_options()),
+      create_op(1, {9, 10}, 12, BuiltinOptions_BatchMatMulOptions,
+                CreateBatchMatMulOptions(builder, /*adj_x=*/false,
+                                         /*adj_y=*/true)
+                    .Union()),
+      create_op(2, {12}, 13, BuiltinOptions_SoftmaxOptions,
+                CreateSoftmaxOptions(builder, /*beta=*/1.0f).Union()),
+      create_op(1, {13, 11}, 14, BuiltinOptions_BatchMatMulOptions,
+                CreateBatchMatMulOptions(builder).Union()),
+      create_op(0, {14, 7, 8}, 15, BuiltinOptions_FullyConnectedOptions,
+                fc_options()),
+      create_op(3, {15, 0}, 16, BuiltinOptions_AddOptions,
+                CreateAddOptions(builder).Union()),
+  }};
+
+  const std::array<int32_t, 1> subgraph_inputs{{0}};
+  const std::array<int32_t, 1> subgraph_outputs{{16}};
+  flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(subgraph_outputs.data(),
+                                    subgraph_outputs.size()),
+      builder.CreateVector(operators.data(), operators.size()));
+
+  const flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION,
+      builder.CreateVector(operator_codes.data(), operator_codes.size()),
+      builder.CreateVector(&subgraph, 1),
+      builder.CreateString("Attention model"),
+      builder.CreateVector(buffers.data(), buffers.size()));
+
+  builder.Finish(model_buffer);
+
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+}  // namespace
+
+// Without the transformer operators, the two BATCH_MATMUL operators run on the
+// default kernels and cut the block into three delegate partitions:
+// {FC q, FC k, FC v}, {SOFTMAX} and {FC, ADD}. With them, the whole block is
+// one partition.
+TEST(AttentionPartitions, BertStyleBlock) {
+#ifdef XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
+  constexpr int kDelegatePartitions = 1;
+  constexpr int kDefaultNodes = 0;
+#else
+  constexpr int kDelegatePartitions = 3;
+  constexpr int kDefaultNodes = 2;
+#endif
+
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::vector<char> buffer = CreateAttentionModel();
+  const Model* model = GetModel(buffer.data());
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &delegate_interpreter),
+      kTfLiteOk);
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &default_interpreter),
+      kTfLiteOk);
+
+  ASSERT_TRUE(delegate_interpreter);
+  ASSERT_TRUE(default_interpreter);
+
+  ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(
+                xnnpack_delegate.get()),
+            kTfLiteOk);
+
+  int delegate_partitions = 0;
+  int default_nodes = 0;
+  for (int node_index : delegate_interpreter->execution_plan()) {
+    const TfLiteRegistration& registration =
+        delegate_interpreter->node_and_registration(node_index)->second;
+    if (registration.builtin_code == kTfLiteBuiltinDelegate) {
+      delegate_partitions++;
+    } else {
+      default_nodes++;
+    }
+  }
+  EXPECT_EQ(kDelegatePartitions, delegate_partitions);
+  EXPECT_EQ(kDefaultNodes, default_nodes);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto f32rng = std::bind(std::uniform_real_distribution<float>(-1.0f, 1.0f),
+                          std::ref(rng));
+  float* default_input_data = default_interpreter->typed_tensor<float>(
+      default_interpreter->inputs()[0]);
+  std::generate(default_input_data, default_input_data + kTokens * kHidden,
+                std::ref(f32rng));
+  float* delegate_input_data = delegate_interpreter->typed_tensor<float>(
+      delegate_interpreter->inputs()[0]);
+  std::copy(default_input_data, default_input_data + kTokens * kHidden,
+            delegate_input_data);
+
+  ASSERT_EQ(default_interpreter->Invoke(), kTfLiteOk);
+  ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+
+  float* default_output_data = default_interpreter->typed_tensor<float>(
+      default_interpreter->outputs()[0]);
+  float* delegate_output_data = delegate_interpreter->typed_tensor<float>(
+      delegate_interpreter->outputs()[0]);
+  for (int32_t i = 0; i < kTokens * kHidden; i++) {
+    ASSERT_NEAR(default_output_data[i], delegate_output_data[i],
+                std::max(std::abs(default_output_data[i]) * 1.0e-4f, 1.0e-4f));
+  }
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
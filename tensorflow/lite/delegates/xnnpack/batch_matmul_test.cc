@@ -0,0 +1,90 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/xnnpack/batch_matmul_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace tflite {
+namespace xnnpack {
+
+TEST(BatchMatMul, 3D) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto matrix_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 32), std::ref(rng));
+
+  BatchMatMulTester()
+      .BatchShape({shape_rng()})
+      .M(matrix_rng())
+      .K(matrix_rng())
+      .N(matrix_rng())
+      .Test(xnnpack_delegate.get());
+}
+
+TEST(BatchMatMul, 4D) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto matrix_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 32), std::ref(rng));
+
+  BatchMatMulTester()
+      .BatchShape({shape_rng(), shape_rng()})
+      .M(matrix_rng())
+      .K(matrix_rng())
+      .N(matrix_rng())
+      .Test(xnnpack_delegate.get());
+}
+
+TEST(BatchMatMul, 4DAdjY) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto matrix_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 32), std::ref(rng));
+
+  BatchMatMulTester()
+      .BatchShape({shape_rng(), shape_rng()})
+      .M(matrix_rng())
+      .K(matrix_rng())
+      .N(matrix_rng())
+      .AdjY(true)
+      .Test(xnnpack_delegate.get());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
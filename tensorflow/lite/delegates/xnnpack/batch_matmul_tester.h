@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_BATCH_MATMUL_TESTER_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_BATCH_MATMUL_TESTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace xnnpack {
+
+class BatchMatMulTester {
+ public:
+  BatchMatMulTester() = default;
+  BatchMatMulTester(const BatchMatMulTester&) = delete;
+  BatchMatMulTester& operator=(const BatchMatMulTester&) = delete;
+
+  // Sets the batch dimensions, which are the same for both inputs.
+  inline BatchMatMulTester& BatchShape(
+      const std::vector<int32_t>& batch_shape) {
+    for (int32_t batch_dim : batch_shape) {
+      EXPECT_GT(batch_dim, 0);
+    }
+    batch_shape_ = std::vector<int32_t>(batch_shape.begin(), batch_shape.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& BatchShape() const { return batch_shape_; }
+
+  inline BatchMatMulTester& M(int32_t m) {
+    EXPECT_GT(m, 0);
+    m_ = m;
+    return *this;
+  }
+
+  inline int32_t M() const { return m_; }
+
+  inline BatchMatMulTester& K(int32_t k) {
+    EXPECT_GT(k, 0);
+    k_ = k;
+    return *this;
+  }
+
+  inline int32_t K() const { return k_; }
+
+  inline BatchMatMulTester& N(int32_t n) {
+    EXPECT_GT(n, 0);
+    n_ = n;
+    return *this;
+  }
+
+  inline int32_t N() const { return n_; }
+
+  // Transposes the second input, so that it has [N, K] matrices.
+  inline BatchMatMulTester& AdjY(bool adj_y) {
+    adj_y_ = adj_y;
+    return *this;
+  }
+
+  inline bool AdjY() const { return adj_y_; }
+
+  std::vector<int32_t> Input1Shape() const;
+  std::vector<int32_t> Input2Shape() const;
+  std::vector<int32_t> OutputShape() const;
+
+  void Test(TfLiteDelegate* delegate) const;
+
+ private:
+  std::vector<char> CreateTfLiteModel() const;
+
+  static int32_t ComputeSize(const std::vector<int32_t>& shape);
+
+  std::vector<int32_t> batch_shape_{1};
+  int32_t m_ = 1;
+  int32_t k_ = 1;
+  int32_t n_ = 1;
+  bool adj_y_ = false;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_BATCH_MATMUL_TESTER_H_
@@ -0,0 +1,72 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_CONCATENATION_TESTER_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_CONCATENATION_TESTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace xnnpack {
+
+class ConcatenationTester {
+ public:
+  ConcatenationTester() = default;
+  ConcatenationTester(const ConcatenationTester&) = delete;
+  ConcatenationTester& operator=(const ConcatenationTester&) = delete;
+
+  inline ConcatenationTester& InputShapes(
+      const std::vector<std::vector<int32_t>>& input_shapes) {
+    for (const std::vector<int32_t>& input_shape : input_shapes) {
+      for (int32_t input_dim : input_shape) {
+        EXPECT_GT(input_dim, 0);
+      }
+    }
+    input_shapes_ = input_shapes;
+    return *this;
+  }
+
+  inline const std::vector<std::vector<int32_t>>& InputShapes() const {
+    return input_shapes_;
+  }
+
+  inline ConcatenationTester& Axis(int32_t axis) {
+    axis_ = axis;
+    return *this;
+  }
+
+  inline int32_t Axis() const { return axis_; }
+
+  std::vector<int32_t> OutputShape() const;
+
+  void Test(TfLiteDelegate* delegate) const;
+
+ private:
+  std::vector<char> CreateTfLiteModel() const;
+
+  static int32_t ComputeSize(const std::vector<int32_t>& shape);
+
+  std::vector<std::vector<int32_t>> input_shapes_;
+  int32_t axis_ = 0;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_CONCATENATION_TESTER_H_
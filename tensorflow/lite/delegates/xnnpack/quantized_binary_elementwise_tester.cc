@@ -0,0 +1,308 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/quantized_binary_elementwise_tester.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_conversion_utils.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+
+std::vector<int32_t> QuantizedBinaryElementwiseTester::OutputShape() const {
+  std::vector<int32_t> output_shape;
+  if (!input1_shape_.empty()) {
+    output_shape.insert(
+        output_shape.end(), input1_shape_.cbegin(),
+        input1_shape_.cbegin() +
+            std::max(input1_shape_.size(), input2_shape_.size()) -
+            input2_shape_.size());
+  }
+  if (!input2_shape_.empty()) {
+    output_shape.insert(
+        output_shape.end(), input2_shape_.cbegin(),
+        input2_shape_.cbegin() +
+            std::max(input2_shape_.size(), input1_shape_.size()) -
+            input1_shape_.size());
+  }
+  for (size_t i = std::min(input1_shape_.size(), input2_shape_.size()); i >= 1;
+       i--) {
+    output_shape.push_back(
+        std::max(*(input1_shape_.cend() - i), *(input2_shape_.cend() - i)));
+  }
+  return output_shape;
+}
+
+template <class T>
+void QuantizedBinaryElementwiseTester::Test(
+    tflite::BuiltinOperator binary_op, Interpreter* delegate_interpreter,
+    Interpreter* default_interpreter) const {
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+
+  for (int i = 0; i < 2; i++) {
+    const int input = default_interpreter->inputs()[i];
+    // Products of the whole range would mostly saturate, so MUL inputs stay
+    // close to their zero point.
+    const int32_t zero_point =
+        default_interpreter->tensor(input)->params.zero_point;
+    int32_t input_min = std::numeric_limits<T>::min();
+    int32_t input_max = std::numeric_limits<T>::max();
+    if (binary_op == BuiltinOperator_MUL) {
+      input_min = std::max(input_min, zero_point - 12);
+      input_max = std::min(input_max, zero_point + 12);
+    }
+    auto input_rng = std::bind(
+        std::uniform_int_distribution<int32_t>(input_min, input_max),
+        std::ref(rng));
+
+    const std::vector<int32_t>& input_shape =
+        i == 0 ? Input1Shape() : Input2Shape();
+    T* default_input_data = default_interpreter->typed_tensor<T>(input);
+    std::generate(default_input_data,
+                  default_input_data + ComputeSize(input_shape),
+                  std::ref(input_rng));
+
+    T* delegate_input_data = delegate_interpreter->typed_tensor<T>(
+        delegate_interpreter->inputs()[i]);
+    std::copy(default_input_data,
+              default_input_data + ComputeSize(input_shape),
+              delegate_input_data);
+  }
+
+  ASSERT_EQ(default_interpreter->Invoke(), kTfLiteOk);
+  ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+
+  T* default_output_data =
+      default_interpreter->typed_tensor<T>(default_interpreter->outputs()[0]);
+  T* delegate_output_data =
+      delegate_interpreter->typed_tensor<T>(delegate_interpreter->outputs()[0]);
+
+  // Rounding of the requantization differs between the default kernels and
+  // XNNPACK, so outputs can be off by one.
+  for (size_t i = 0; i < ComputeSize(OutputShape()); i++) {
+    ASSERT_LE(std::abs(static_cast<int32_t>(default_output_data[i]) -
+                       static_cast<int32_t>(delegate_output_data[i])),
+              1)
+        << "element " << i << " / " << ComputeSize(OutputShape());
+  }
+}
+
+void QuantizedBinaryElementwiseTester::Test(tflite::BuiltinOperator binary_op,
+                                            TfLiteDelegate* delegate) const {
+  std::vector<char> buffer = CreateTfLiteModel(binary_op);
+  const Model* model = GetModel(buffer.data());
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &delegate_interpreter),
+      kTfLiteOk);
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &default_interpreter),
+      kTfLiteOk);
+
+  ASSERT_TRUE(delegate_interpreter);
+  ASSERT_TRUE(default_interpreter);
+
+  ASSERT_EQ(delegate_interpreter->inputs().size(), 2);
+  ASSERT_EQ(default_interpreter->inputs().size(), 2);
+
+  ASSERT_EQ(delegate_interpreter->outputs().size(), 1);
+  ASSERT_EQ(default_interpreter->outputs().size(), 1);
+
+  ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+
+  // The whole model must run in XNNPACK, or the test compares the default
+  // kernels with themselves.
+  ASSERT_EQ(delegate_interpreter->execution_plan().size(), 1);
+  const TfLiteNode* node =
+      &delegate_interpreter
+           ->node_and_registration(delegate_interpreter->execution_plan()[0])
+           ->first;
+  ASSERT_EQ(node->delegate, delegate);
+
+  if (Unsigned()) {
+    Test<uint8_t>(binary_op, delegate_interpreter.get(),
+                  default_interpreter.get());
+  } else {
+    Test<int8_t>(binary_op, delegate_interpreter.get(),
+                 default_interpreter.get());
+  }
+}
+
+void QuantizedBinaryElementwiseTester::TestRejected(
+    tflite::BuiltinOperator binary_op, TfLiteDelegate* delegate) const {
+  std::vector<char> buffer = CreateTfLiteModel(binary_op);
+  const Model* model = GetModel(buffer.data());
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &delegate_interpreter),
+      kTfLiteOk);
+
+  ASSERT_TRUE(delegate_interpreter);
+
+  ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->execution_plan().size(), 1);
+  const TfLiteNode* node =
+      &delegate_interpreter
+           ->node_and_registration(delegate_interpreter->execution_plan()[0])
+           ->first;
+  ASSERT_EQ(node->delegate, nullptr);
+
+  ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+}
+
+std::vector<char> QuantizedBinaryElementwiseTester::CreateTfLiteModel(
+    tflite::BuiltinOperator binary_op) const {
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto zero_point_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(-10, 10), std::ref(rng));
+
+  // Unsigned tensors are centered around 128.
+  const int32_t zero_point_offset = Unsigned() ? 128 : 0;
+  const int64_t input1_zero_point = zero_point_offset + zero_point_rng();
+  const int64_t input2_zero_point = zero_point_offset + zero_point_rng();
+  const int64_t output_zero_point = zero_point_offset + zero_point_rng();
+
+  flatbuffers::FlatBufferBuilder builder;
+  flatbuffers::Offset<OperatorCode> operator_code =
+      CreateOperatorCode(builder, binary_op);
+
+  const std::array<flatbuffers::Offset<Buffer>, 1> buffers{{
+      CreateBuffer(builder, builder.CreateVector({})),
+  }};
+
+  const TensorType tensor_type =
+      Unsigned() ? TensorType_UINT8 : TensorType_INT8;
+  const std::vector<int32_t> output_shape = OutputShape();
+  const std::array<flatbuffers::Offset<Tensor>, 3> tensors{{
+      CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(Input1Shape().data(),
+                                        Input1Shape().size()),
+          tensor_type, /*buffer=*/0, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0,
+              builder.CreateVector<float>({Input1Scale()}),
+              builder.CreateVector<int64_t>({input1_zero_point}))),
+      CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(Input2Shape().data(),
+                                        Input2Shape().size()),
+          tensor_type, /*buffer=*/0, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0,
+              builder.CreateVector<float>({Input2Scale()}),
+              builder.CreateVector<int64_t>({input2_zero_point}))),
+      CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(output_shape.data(),
+                                        output_shape.size()),
+          tensor_type, /*buffer=*/0, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0,
+              builder.CreateVector<float>({OutputScale()}),
+              builder.CreateVector<int64_t>({output_zero_point}))),
+  }};
+
+  tflite::BuiltinOptions builtin_options_type = tflite::BuiltinOptions_NONE;
+  flatbuffers::Offset<void> builtin_options = 0;
+  switch (binary_op) {
+    case BuiltinOperator_ADD:
+      builtin_options_type = BuiltinOptions_AddOptions;
+      builtin_options = CreateAddOptions(builder, Activation()).Union();
+      break;
+    case BuiltinOperator_MUL:
+      builtin_options_type = BuiltinOptions_MulOptions;
+      builtin_options = CreateMulOptions(builder, Activation()).Union();
+      break;
+    default:
+      EXPECT_EQ(Activation(), ActivationFunctionType_NONE);
+  }
+
+  const std::array<int32_t, 2> op_inputs{{0, 1}};
+  const std::array<int32_t, 1> op_outputs{{2}};
+  flatbuffers::Offset<Operator> op = CreateOperator(
+      builder, /*opcode_index=*/0,
+      builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      builtin_options_type, builtin_options);
+
+  const std::array<int32_t, 2> subgraph_inputs{{0, 1}};
+  const std::array<int32_t, 1> subgraph_outputs{{2}};
+  flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(subgraph_outputs.data(),
+                                    subgraph_outputs.size()),
+      builder.CreateVector(&op, 1));
+
+  flatbuffers::Offset<flatbuffers::String> description =
+      builder.CreateString("Quantized binary operator model");
+
+  flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(&operator_code, 1),
+      builder.CreateVector(&subgraph, 1), description,
+      builder.CreateVector(buffers.data(), buffers.size()));
+
+  builder.Finish(model_buffer);
+
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+int32_t QuantizedBinaryElementwiseTester::ComputeSize(
+    const std::vector<int32_t>& shape) {
+  return std::accumulate(shape.cbegin(), shape.cend(), 1,
+                         std::multiplies<int32_t>());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
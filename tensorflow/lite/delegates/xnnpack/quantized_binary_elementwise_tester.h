@@ -0,0 +1,143 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_QUANTIZED_BINARY_ELEMENTWISE_TESTER_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_QUANTIZED_BINARY_ELEMENTWISE_TESTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace xnnpack {
+
+class QuantizedBinaryElementwiseTester {
+ public:
+  QuantizedBinaryElementwiseTester() = default;
+  QuantizedBinaryElementwiseTester(const QuantizedBinaryElementwiseTester&) =
+      delete;
+  QuantizedBinaryElementwiseTester& operator=(
+      const QuantizedBinaryElementwiseTester&) = delete;
+
+  inline QuantizedBinaryElementwiseTester& Input1Shape(
+      std::initializer_list<int32_t> shape) {
+    for (auto it = shape.begin(); it != shape.end(); ++it) {
+      EXPECT_GT(*it, 0);
+    }
+    input1_shape_ = std::vector<int32_t>(shape.begin(), shape.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& Input1Shape() const {
+    return input1_shape_;
+  }
+
+  inline QuantizedBinaryElementwiseTester& Input2Shape(
+      std::initializer_list<int32_t> shape) {
+    for (auto it = shape.begin(); it != shape.end(); ++it) {
+      EXPECT_GT(*it, 0);
+    }
+    input2_shape_ = std::vector<int32_t>(shape.begin(), shape.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& Input2Shape() const {
+    return input2_shape_;
+  }
+
+  std::vector<int32_t> OutputShape() const;
+
+  inline QuantizedBinaryElementwiseTester& Input1Scale(float input1_scale) {
+    EXPECT_GT(input1_scale, 0.0f);
+    input1_scale_ = input1_scale;
+    return *this;
+  }
+
+  inline float Input1Scale() const { return input1_scale_; }
+
+  inline QuantizedBinaryElementwiseTester& Input2Scale(float input2_scale) {
+    EXPECT_GT(input2_scale, 0.0f);
+    input2_scale_ = input2_scale;
+    return *this;
+  }
+
+  inline float Input2Scale() const { return input2_scale_; }
+
+  inline QuantizedBinaryElementwiseTester& OutputScale(float output_scale) {
+    EXPECT_GT(output_scale, 0.0f);
+    output_scale_ = output_scale;
+    return *this;
+  }
+
+  inline float OutputScale() const { return output_scale_; }
+
+  inline QuantizedBinaryElementwiseTester& Unsigned(bool is_unsigned) {
+    unsigned_ = is_unsigned;
+    return *this;
+  }
+
+  inline bool Unsigned() const { return unsigned_; }
+
+  inline QuantizedBinaryElementwiseTester& ReluActivation() {
+    activation_ = ::tflite::ActivationFunctionType_RELU;
+    return *this;
+  }
+
+  inline QuantizedBinaryElementwiseTester& Relu6Activation() {
+    activation_ = ::tflite::ActivationFunctionType_RELU6;
+    return *this;
+  }
+
+  // Checks that the operator is delegated, and that its outputs match the
+  // default kernels.
+  void Test(tflite::BuiltinOperator binary_op, TfLiteDelegate* delegate) const;
+
+  // Checks that the operator stays on the default kernels, e.g. because
+  // XNNPACK can't requantize its result with the scales of its tensors.
+  void TestRejected(tflite::BuiltinOperator binary_op,
+                    TfLiteDelegate* delegate) const;
+
+ private:
+  template <class T>
+  void Test(tflite::BuiltinOperator binary_op,
+            Interpreter* delegate_interpreter,
+            Interpreter* default_interpreter) const;
+
+  std::vector<char> CreateTfLiteModel(tflite::BuiltinOperator binary_op) const;
+
+  inline ::tflite::ActivationFunctionType Activation() const {
+    return activation_;
+  }
+
+  static int32_t ComputeSize(const std::vector<int32_t>& shape);
+
+  std::vector<int32_t> input1_shape_;
+  std::vector<int32_t> input2_shape_;
+  float input1_scale_ = 0.75f;
+  float input2_scale_ = 1.25f;
+  float output_scale_ = 1.5f;
+  bool unsigned_ = false;
+  ::tflite::ActivationFunctionType activation_ =
+      ::tflite::ActivationFunctionType_NONE;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_QUANTIZED_BINARY_ELEMENTWISE_TESTER_H_
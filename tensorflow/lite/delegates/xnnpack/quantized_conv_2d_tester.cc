@@ -0,0 +1,288 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/quantized_conv_2d_tester.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_conversion_utils.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+
+template <class T>
+void QuantizedConv2DTester::Test(Interpreter* delegate_interpreter,
+                                 Interpreter* default_interpreter) const {
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto input_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(std::numeric_limits<T>::min(),
+                                             std::numeric_limits<T>::max()),
+      std::ref(rng));
+
+  T* default_input_data =
+      default_interpreter->typed_tensor<T>(default_interpreter->inputs()[0]);
+  std::generate(default_input_data,
+                default_input_data + BatchSize() * InputHeight() *
+                                         InputWidth() * InputChannels(),
+                std::ref(input_rng));
+
+  T* delegate_input_data =
+      delegate_interpreter->typed_tensor<T>(delegate_interpreter->inputs()[0]);
+  std::copy(default_input_data,
+            default_input_data +
+                BatchSize() * InputHeight() * InputWidth() * InputChannels(),
+            delegate_input_data);
+
+  ASSERT_EQ(default_interpreter->Invoke(), kTfLiteOk);
+  ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+
+  T* default_output_data =
+      default_interpreter->typed_tensor<T>(default_interpreter->outputs()[0]);
+  T* delegate_output_data =
+      delegate_interpreter->typed_tensor<T>(delegate_interpreter->outputs()[0]);
+
+  // Rounding of the requantization differs between the default kernels and
+  // XNNPACK, so outputs can be off by one.
+  for (int32_t i = 0; i < BatchSize(); i++) {
+    for (int32_t y = 0; y < OutputHeight(); y++) {
+      for (int32_t x = 0; x < OutputWidth(); x++) {
+        for (int32_t c = 0; c < OutputChannels(); c++) {
+          const int32_t index = ((i * OutputHeight() + y) * OutputWidth() + x) *
+                                    OutputChannels() +
+                                c;
+          ASSERT_LE(std::abs(static_cast<int32_t>(default_output_data[index]) -
+                             static_cast<int32_t>(delegate_output_data[index])),
+                    1)
+              << "batch " << i << " / " << BatchSize() << ", y position " << y
+              << " / " << OutputHeight() << ", x position " << x << " / "
+              << OutputWidth() << ", channel " << c << " / "
+              << OutputChannels();
+        }
+      }
+    }
+  }
+}
+
+void QuantizedConv2DTester::Test(TfLiteDelegate* delegate) const {
+  std::vector<char> buffer = CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &delegate_interpreter),
+      kTfLiteOk);
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &default_interpreter),
+      kTfLiteOk);
+
+  ASSERT_TRUE(delegate_interpreter);
+  ASSERT_TRUE(default_interpreter);
+
+  ASSERT_EQ(delegate_interpreter->inputs().size(), 1);
+  ASSERT_EQ(default_interpreter->inputs().size(), 1);
+
+  ASSERT_EQ(delegate_interpreter->outputs().size(), 1);
+  ASSERT_EQ(default_interpreter->outputs().size(), 1);
+
+  ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+
+  // The whole model must run in XNNPACK, or the test compares the default
+  // kernels with themselves.
+  ASSERT_EQ(delegate_interpreter->execution_plan().size(), 1);
+  const TfLiteNode* node =
+      &delegate_interpreter
+           ->node_and_registration(delegate_interpreter->execution_plan()[0])
+           ->first;
+  ASSERT_EQ(node->delegate, delegate);
+
+  if (Unsigned()) {
+    Test<uint8_t>(delegate_interpreter.get(), default_interpreter.get());
+  } else {
+    Test<int8_t>(delegate_interpreter.get(), default_interpreter.get());
+  }
+}
+
+std::vector<char> QuantizedConv2DTester::CreateTfLiteModel() const {
+  EXPECT_FALSE(Unsigned() && ChannelWise());
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto scale_rng = std::bind(
+      std::uniform_real_distribution<float>(0.5f, 2.0f), std::ref(rng));
+  auto zero_point_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(-10, 10), std::ref(rng));
+  auto filter_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(-127, 127), std::ref(rng));
+  auto bias_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(-10000, 10000), std::ref(rng));
+
+  // Unsigned tensors are centered around 128.
+  const int32_t zero_point_offset = Unsigned() ? 128 : 0;
+  const float input_scale = scale_rng() / 64.0f;
+  const int64_t input_zero_point = zero_point_offset + zero_point_rng();
+  const int64_t filter_zero_point = zero_point_offset;
+  std::vector<float> filter_scales(ChannelWise() ? OutputChannels() : 1);
+  std::generate(filter_scales.begin(), filter_scales.end(),
+                [&]() { return scale_rng() / 128.0f; });
+  std::vector<float> bias_scales(filter_scales.size());
+  std::transform(
+      filter_scales.begin(), filter_scales.end(), bias_scales.begin(),
+      [=](float filter_scale) { return input_scale * filter_scale; });
+  // Keeps most outputs of the accumulation in range, whatever the size of
+  // the kernel.
+  const float output_scale =
+      input_scale * filter_scales[0] * 32.0f *
+      std::sqrt(static_cast<float>(KernelHeight() * KernelWidth() *
+                                   InputChannels()));
+  const int64_t output_zero_point = zero_point_offset + zero_point_rng();
+
+  flatbuffers::FlatBufferBuilder builder;
+  const std::array<flatbuffers::Offset<OperatorCode>, 1> operator_codes{
+      {CreateOperatorCode(builder, BuiltinOperator_CONV_2D)}};
+
+  std::vector<uint8_t> filter_data(OutputChannels() * KernelHeight() *
+                                   KernelWidth() * InputChannels());
+  std::generate(filter_data.begin(), filter_data.end(), [&]() {
+    return static_cast<uint8_t>(filter_rng() + filter_zero_point);
+  });
+  std::vector<int32_t> bias_data(OutputChannels());
+  std::generate(bias_data.begin(), bias_data.end(), std::ref(bias_rng));
+
+  const std::array<flatbuffers::Offset<Buffer>, 3> buffers{{
+      CreateBuffer(builder, builder.CreateVector({})),
+      CreateBuffer(builder, builder.CreateVector(filter_data.data(),
+                                                 filter_data.size())),
+      CreateBuffer(builder,
+                   builder.CreateVector(
+                       reinterpret_cast<const uint8_t*>(bias_data.data()),
+                       sizeof(int32_t) * bias_data.size())),
+  }};
+
+  const std::array<int32_t, 4> input_shape{
+      {BatchSize(), InputHeight(), InputWidth(), InputChannels()}};
+  const std::array<int32_t, 4> output_shape{
+      {BatchSize(), OutputHeight(), OutputWidth(), OutputChannels()}};
+  const std::array<int32_t, 4> filter_shape{
+      {OutputChannels(), KernelHeight(), KernelWidth(), InputChannels()}};
+  const std::array<int32_t, 1> bias_shape{{OutputChannels()}};
+
+  const TensorType tensor_type =
+      Unsigned() ? TensorType_UINT8 : TensorType_INT8;
+  const std::vector<int64_t> filter_zero_points(filter_scales.size(),
+                                                filter_zero_point);
+  const std::vector<int64_t> bias_zero_points(bias_scales.size(), 0);
+  const std::array<flatbuffers::Offset<Tensor>, 4> tensors{{
+      CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(input_shape.data(), input_shape.size()),
+          tensor_type, /*buffer=*/0, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0,
+              builder.CreateVector<float>({input_scale}),
+              builder.CreateVector<int64_t>({input_zero_point}))),
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(filter_shape.data(),
+                                                 filter_shape.size()),
+                   tensor_type, /*buffer=*/1, /*name=*/0,
+                   CreateQuantizationParameters(
+                       builder, /*min=*/0, /*max=*/0,
+                       builder.CreateVector<float>(filter_scales),
+                       builder.CreateVector<int64_t>(filter_zero_points),
+                       QuantizationDetails_NONE, /*details=*/0,
+                       /*quantized_dimension=*/0)),
+      CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
+          TensorType_INT32, /*buffer=*/2, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0,
+              builder.CreateVector<float>(bias_scales),
+              builder.CreateVector<int64_t>(bias_zero_points),
+              QuantizationDetails_NONE, /*details=*/0,
+              /*quantized_dimension=*/0)),
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(output_shape.data(),
+                                                 output_shape.size()),
+                   tensor_type, /*buffer=*/0, /*name=*/0,
+                   CreateQuantizationParameters(
+                       builder, /*min=*/0, /*max=*/0,
+                       builder.CreateVector<float>({output_scale}),
+                       builder.CreateVector<int64_t>({output_zero_point}))),
+  }};
+
+  const std::array<int32_t, 3> op_inputs{{0, 1, 2}};
+  const std::array<int32_t, 1> op_outputs{{3}};
+
+  flatbuffers::Offset<Conv2DOptions> conv2d_options =
+      CreateConv2DOptions(builder, Padding(), StrideWidth(), StrideHeight(),
+                          Activation(), DilationWidth(), DilationHeight());
+  const flatbuffers::Offset<Operator> op = CreateOperator(
+      builder, /*opcode_index=*/0,
+      builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      BuiltinOptions_Conv2DOptions, conv2d_options.Union());
+
+  const std::array<int32_t, 1> subgraph_inputs{{0}};
+  const std::array<int32_t, 1> subgraph_outputs{{3}};
+  flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(subgraph_outputs.data(),
+                                    subgraph_outputs.size()),
+      builder.CreateVector(&op, 1));
+
+  flatbuffers::Offset<flatbuffers::String> description =
+      builder.CreateString("Quantized Conv2D model");
+
+  flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION,
+      builder.CreateVector(operator_codes.data(), operator_codes.size()),
+      builder.CreateVector(&subgraph, 1), description,
+      builder.CreateVector(buffers.data(), buffers.size()));
+
+  builder.Finish(model_buffer);
+
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
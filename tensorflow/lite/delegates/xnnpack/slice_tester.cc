@@ -0,0 +1,194 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/slice_tester.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_conversion_utils.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+
+void SliceTester::Test(tflite::BuiltinOperator slice_op,
+                       TfLiteDelegate* delegate) const {
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto f32rng =
+      std::bind(std::uniform_real_distribution<float>(), std::ref(rng));
+
+  ASSERT_EQ(InputShape().size(), Offsets().size());
+  ASSERT_EQ(InputShape().size(), Sizes().size());
+  for (size_t i = 0; i < InputShape().size(); i++) {
+    ASSERT_LE(Offsets()[i] + Sizes()[i], InputShape()[i]);
+  }
+
+  std::vector<char> buffer = CreateTfLiteModel(slice_op);
+  const Model* model = GetModel(buffer.data());
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &delegate_interpreter),
+      kTfLiteOk);
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &default_interpreter),
+      kTfLiteOk);
+
+  ASSERT_TRUE(delegate_interpreter);
+  ASSERT_TRUE(default_interpreter);
+
+  ASSERT_EQ(delegate_interpreter->inputs().size(), 1);
+  ASSERT_EQ(default_interpreter->inputs().size(), 1);
+
+  ASSERT_EQ(delegate_interpreter->outputs().size(), 1);
+  ASSERT_EQ(default_interpreter->outputs().size(), 1);
+
+  ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+
+  const int32_t input_size = ComputeSize(InputShape());
+  float* default_input_data = default_interpreter->typed_tensor<float>(
+      default_interpreter->inputs()[0]);
+  std::generate(default_input_data, default_input_data + input_size,
+                std::ref(f32rng));
+
+  float* delegate_input_data = delegate_interpreter->typed_tensor<float>(
+      delegate_interpreter->inputs()[0]);
+  std::copy(default_input_data, default_input_data + input_size,
+            delegate_input_data);
+
+  ASSERT_EQ(default_interpreter->Invoke(), kTfLiteOk);
+  ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+
+  float* default_output_data = default_interpreter->typed_tensor<float>(
+      default_interpreter->outputs()[0]);
+  float* delegate_output_data = delegate_interpreter->typed_tensor<float>(
+      delegate_interpreter->outputs()[0]);
+
+  const int32_t output_size = ComputeSize(Sizes());
+  for (int32_t i = 0; i < output_size; i++) {
+    ASSERT_EQ(delegate_output_data[i], default_output_data[i]);
+  }
+}
+
+std::vector<char> SliceTester::CreateTfLiteModel(
+    tflite::BuiltinOperator slice_op) const {
+  flatbuffers::FlatBufferBuilder builder;
+  flatbuffers::Offset<OperatorCode> operator_code =
+      CreateOperatorCode(builder, slice_op, 0);
+
+  // SLICE takes the offsets and the sizes, and STRIDED_SLICE takes the
+  // offsets, the ends, and the strides.
+  std::vector<std::vector<int32_t>> parameters{Offsets()};
+  BuiltinOptions builtin_options_type = BuiltinOptions_SliceOptions;
+  flatbuffers::Offset<void> builtin_options =
+      CreateSliceOptions(builder).Union();
+  if (slice_op == BuiltinOperator_STRIDED_SLICE) {
+    std::vector<int32_t> ends(Offsets().size());
+    for (size_t i = 0; i < ends.size(); i++) {
+      ends[i] = Offsets()[i] + Sizes()[i];
+    }
+    parameters.push_back(ends);
+    parameters.push_back(std::vector<int32_t>(Offsets().size(), 1));
+    builtin_options_type = BuiltinOptions_StridedSliceOptions;
+    builtin_options = CreateStridedSliceOptions(builder).Union();
+  } else {
+    parameters.push_back(Sizes());
+  }
+
+  std::vector<flatbuffers::Offset<Buffer>> buffers{{
+      CreateBuffer(builder, builder.CreateVector({})),
+  }};
+  std::vector<flatbuffers::Offset<Tensor>> tensors{{
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(InputShape().data(),
+                                                 InputShape().size()),
+                   TensorType_FLOAT32),
+  }};
+  const std::array<int32_t, 1> parameter_shape{
+      {static_cast<int32_t>(InputShape().size())}};
+  std::vector<int32_t> op_inputs{{0}};
+  for (const std::vector<int32_t>& parameter : parameters) {
+    op_inputs.push_back(static_cast<int32_t>(tensors.size()));
+    tensors.push_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(parameter_shape.data(),
+                                      parameter_shape.size()),
+        TensorType_INT32, /*buffer=*/buffers.size()));
+    buffers.push_back(CreateBuffer(
+        builder, builder.CreateVector(
+                     reinterpret_cast<const uint8_t*>(parameter.data()),
+                     parameter.size() * sizeof(int32_t))));
+  }
+  const std::array<int32_t, 1> op_outputs{
+      {static_cast<int32_t>(tensors.size())}};
+  tensors.push_back(CreateTensor(
+      builder, builder.CreateVector<int32_t>(Sizes().data(), Sizes().size()),
+      TensorType_FLOAT32));
+
+  const flatbuffers::Offset<Operator> op = CreateOperator(
+      builder, /*opcode_index=*/0,
+      builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      builtin_options_type, builtin_options);
+
+  const std::array<int32_t, 1> subgraph_inputs{{0}};
+  flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      builder.CreateVector(&op, 1));
+
+  const flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(&operator_code, 1),
+      builder.CreateVector(&subgraph, 1), builder.CreateString("Slice model"),
+      builder.CreateVector(buffers.data(), buffers.size()));
+
+  builder.Finish(model_buffer);
+
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+int32_t SliceTester::ComputeSize(const std::vector<int32_t>& shape) {
+  return std::accumulate(shape.cbegin(), shape.cend(), 1,
+                         std::multiplies<int32_t>());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -0,0 +1,81 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_SLICE_TESTER_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_SLICE_TESTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace xnnpack {
+
+// Tests SLICE and STRIDED_SLICE operators with unit strides.
+class SliceTester {
+ public:
+  SliceTester() = default;
+  SliceTester(const SliceTester&) = delete;
+  SliceTester& operator=(const SliceTester&) = delete;
+
+  inline SliceTester& InputShape(const std::vector<int32_t>& input_shape) {
+    for (int32_t input_dim : input_shape) {
+      EXPECT_GT(input_dim, 0);
+    }
+    input_shape_ = std::vector<int32_t>(input_shape.begin(), input_shape.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& InputShape() const { return input_shape_; }
+
+  inline SliceTester& Offsets(const std::vector<int32_t>& offsets) {
+    for (int32_t offset : offsets) {
+      EXPECT_GE(offset, 0);
+    }
+    offsets_ = std::vector<int32_t>(offsets.begin(), offsets.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& Offsets() const { return offsets_; }
+
+  inline SliceTester& Sizes(const std::vector<int32_t>& sizes) {
+    for (int32_t size : sizes) {
+      EXPECT_GT(size, 0);
+    }
+    sizes_ = std::vector<int32_t>(sizes.begin(), sizes.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& Sizes() const { return sizes_; }
+
+  void Test(tflite::BuiltinOperator slice_op, TfLiteDelegate* delegate) const;
+
+ private:
+  std::vector<char> CreateTfLiteModel(tflite::BuiltinOperator slice_op) const;
+
+  static int32_t ComputeSize(const std::vector<int32_t>& shape);
+
+  std::vector<int32_t> input_shape_;
+  std::vector<int32_t> offsets_;
+  std::vector<int32_t> sizes_;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_SLICE_TESTER_H_
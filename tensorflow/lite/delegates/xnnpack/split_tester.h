@@ -0,0 +1,76 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_SPLIT_TESTER_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_SPLIT_TESTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace xnnpack {
+
+class SplitTester {
+ public:
+  SplitTester() = default;
+  SplitTester(const SplitTester&) = delete;
+  SplitTester& operator=(const SplitTester&) = delete;
+
+  inline SplitTester& InputShape(const std::vector<int32_t>& input_shape) {
+    for (int32_t input_dim : input_shape) {
+      EXPECT_GT(input_dim, 0);
+    }
+    input_shape_ = std::vector<int32_t>(input_shape.begin(), input_shape.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& InputShape() const { return input_shape_; }
+
+  inline SplitTester& Axis(int32_t axis) {
+    axis_ = axis;
+    return *this;
+  }
+
+  inline int32_t Axis() const { return axis_; }
+
+  inline SplitTester& NumSplits(int32_t num_splits) {
+    EXPECT_GT(num_splits, 0);
+    num_splits_ = num_splits;
+    return *this;
+  }
+
+  inline int32_t NumSplits() const { return num_splits_; }
+
+  std::vector<int32_t> OutputShape() const;
+
+  void Test(TfLiteDelegate* delegate) const;
+
+ private:
+  std::vector<char> CreateTfLiteModel() const;
+
+  static int32_t ComputeSize(const std::vector<int32_t>& shape);
+
+  std::vector<int32_t> input_shape_;
+  int32_t axis_ = 0;
+  int32_t num_splits_ = 2;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_SPLIT_TESTER_H_
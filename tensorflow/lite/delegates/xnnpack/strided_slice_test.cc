@@ -0,0 +1,114 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/xnnpack/slice_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace tflite {
+namespace xnnpack {
+
+TEST(StridedSlice, 2D) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto offset_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(0, 2), std::ref(rng));
+
+  std::vector<int32_t> input_shape(2);
+  std::vector<int32_t> offsets(2);
+  std::vector<int32_t> sizes(2);
+  for (int i = 0; i < 2; i++) {
+    offsets[i] = offset_rng();
+    sizes[i] = shape_rng();
+    input_shape[i] = offsets[i] + sizes[i] + offset_rng();
+  }
+
+  SliceTester()
+      .InputShape(input_shape)
+      .Offsets(offsets)
+      .Sizes(sizes)
+      .Test(BuiltinOperator_STRIDED_SLICE, xnnpack_delegate.get());
+}
+
+TEST(StridedSlice, 3D) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto offset_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(0, 2), std::ref(rng));
+
+  std::vector<int32_t> input_shape(3);
+  std::vector<int32_t> offsets(3);
+  std::vector<int32_t> sizes(3);
+  for (int i = 0; i < 3; i++) {
+    offsets[i] = offset_rng();
+    sizes[i] = shape_rng();
+    input_shape[i] = offsets[i] + sizes[i] + offset_rng();
+  }
+
+  SliceTester()
+      .InputShape(input_shape)
+      .Offsets(offsets)
+      .Sizes(sizes)
+      .Test(BuiltinOperator_STRIDED_SLICE, xnnpack_delegate.get());
+}
+
+TEST(StridedSlice, 4D) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto shape_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 5), std::ref(rng));
+  auto offset_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(0, 2), std::ref(rng));
+
+  std::vector<int32_t> input_shape(4);
+  std::vector<int32_t> offsets(4);
+  std::vector<int32_t> sizes(4);
+  for (int i = 0; i < 4; i++) {
+    offsets[i] = offset_rng();
+    sizes[i] = shape_rng();
+    input_shape[i] = offsets[i] + sizes[i] + offset_rng();
+  }
+
+  SliceTester()
+      .InputShape(input_shape)
+      .Offsets(offsets)
+      .Sizes(sizes)
+      .Test(BuiltinOperator_STRIDED_SLICE, xnnpack_delegate.get());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -39,6 +40,13 @@ namespace tflite {
 namespace xnnpack {
 namespace {
 
+// Ranges of the scales XNNPACK supports when it requantizes the results of
+// quantized operators.
+constexpr float kMinConvolutionScaleRatio = 1.0f / 4294967296.0f;  // 2**-32
+constexpr float kMinAddScaleRatio = 1.0f / 16384.0f;                 // 2**-14
+constexpr float kMinMultiplyScaleRatio = 1.0f / 65536.0f;            // 2**-16
+constexpr float kMaxScaleRatio = 256.0f;                             // 2**8
+
 // Forward declaration.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
@@ -180,6 +188,27 @@ class Subgraph {
             tensors[t] = t;
           }
           break;
+#ifdef XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
+        case kTfLiteBuiltinSlice:
+        case kTfLiteBuiltinStridedSlice:
+        case kTfLiteBuiltinTranspose:
+          // Ignore the inputs after the first one (offsets, sizes, strides,
+          // or permutation), because they are represented as parameters of
+          // the XNNPACK operator rather than extra inputs.
+          {
+            const int t = node->inputs->data[0];
+            tensors[t] = t;
+          }
+          break;
+        case kTfLiteBuiltinSplit:
+          // Ignore the first input (split axis), because it is represented as
+          // a parameter of the XNNPACK operator rather than extra input.
+          {
+            const int t = node->inputs->data[1];
+            tensors[t] = t;
+          }
+          break;
+#endif  // XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
         default:
           // All other operators: process all inputs
           for (int k = 0; k < node->inputs->size; k++) {
@@ -201,7 +230,8 @@ class Subgraph {
     // XNNPACK Value IDs for TFLite tensors
     std::vector<uint32_t> xnnpack_tensors(tensors.back() + 1);
     for (int t : tensors) {
-      if (context->tensors[t].type != kTfLiteFloat32) {
+      const xnn_datatype datatype = GetXNNPackDatatype(context->tensors[t]);
+      if (datatype == xnn_datatype_invalid) {
         TF_LITE_KERNEL_LOG(
             context,
             "unsupported datatype (%s) of tensor %d in XNNPACK delegate",
@@ -234,9 +264,38 @@ class Subgraph {
           &context->tensors[t].dims->data[0],
           &context->tensors[t].dims->data[context->tensors[t].dims->size]);
 
-      const xnn_status status = xnn_define_tensor_value(
-          subgraph.get(), xnn_datatype_fp32, dims.size(), dims.data(), data,
-          static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+      xnn_status status = xnn_status_success;
+      switch (datatype) {
+#ifdef XNNPACK_DELEGATE_ENABLE_QUANTIZED
+        case xnn_datatype_qint8:
+        case xnn_datatype_quint8:
+        case xnn_datatype_qint32:
+          status = xnn_define_quantized_tensor_value(
+              subgraph.get(), datatype,
+              context->tensors[t].params.zero_point,
+              context->tensors[t].params.scale, dims.size(), dims.data(),
+              data, static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+          break;
+        case xnn_datatype_qcint8:
+        case xnn_datatype_qcint32: {
+          const auto* quantization_params =
+              static_cast<const TfLiteAffineQuantization*>(
+                  context->tensors[t].quantization.params);
+          status = xnn_define_channelwise_quantized_tensor_value(
+              subgraph.get(), datatype, quantization_params->scale->data,
+              dims.size(),
+              static_cast<size_t>(quantization_params->quantized_dimension),
+              dims.data(), data, static_cast<uint32_t>(t), flags,
+              &xnnpack_tensors[t]);
+          break;
+        }
+#endif  // XNNPACK_DELEGATE_ENABLE_QUANTIZED
+        default:
+          status = xnn_define_tensor_value(
+              subgraph.get(), datatype, dims.size(), dims.data(), data,
+              static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+          break;
+      }
       if (status != xnn_status_success) {
         TF_LITE_KERNEL_LOG(context,
                            "failed to create XNNPACK Value for tensor %d", t);
@@ -640,6 +699,248 @@ class Subgraph {
                            node_index);
   }
 
+  // Returns the XNNPACK datatype for a tensor, or xnn_datatype_invalid if the
+  // delegate can't represent it. Quantized datatypes are only available when
+  // the delegate is built with XNNPACK_DELEGATE_ENABLE_QUANTIZED.
+  static xnn_datatype GetXNNPackDatatype(const TfLiteTensor& tensor) {
+    switch (tensor.type) {
+      case kTfLiteFloat32:
+        return xnn_datatype_fp32;
+#ifdef XNNPACK_DELEGATE_ENABLE_QUANTIZED
+      case kTfLiteInt8:
+      case kTfLiteUInt8:
+      case kTfLiteInt32: {
+        if (tensor.quantization.type != kTfLiteAffineQuantization) {
+          return xnn_datatype_invalid;
+        }
+        const auto* quantization_params =
+            static_cast<const TfLiteAffineQuantization*>(
+                tensor.quantization.params);
+        if (quantization_params == nullptr ||
+            quantization_params->scale == nullptr ||
+            quantization_params->zero_point == nullptr ||
+            quantization_params->scale->size !=
+                quantization_params->zero_point->size) {
+          return xnn_datatype_invalid;
+        }
+        const float* scales = quantization_params->scale->data;
+        const int* zero_points = quantization_params->zero_point->data;
+        const int num_scales = quantization_params->scale->size;
+        for (int i = 0; i < num_scales; i++) {
+          if (!std::isnormal(scales[i]) || scales[i] < 0.0f) {
+            return xnn_datatype_invalid;
+          }
+        }
+
+        if (num_scales == 1) {
+          switch (tensor.type) {
+            case kTfLiteInt8:
+              return zero_points[0] >= std::numeric_limits<int8_t>::min() &&
+                             zero_points[0] <=
+                                 std::numeric_limits<int8_t>::max()
+                         ? xnn_datatype_qint8
+                         : xnn_datatype_invalid;
+            case kTfLiteUInt8:
+              return zero_points[0] >= std::numeric_limits<uint8_t>::min() &&
+                             zero_points[0] <=
+                                 std::numeric_limits<uint8_t>::max()
+                         ? xnn_datatype_quint8
+                         : xnn_datatype_invalid;
+            default:
+              return zero_points[0] == 0 ? xnn_datatype_qint32
+                                         : xnn_datatype_invalid;
+          }
+        }
+
+        // Per-channel quantization is only used for the signed filters and
+        // biases of convolutions, which are symmetric.
+        const int quantized_dimension =
+            quantization_params->quantized_dimension;
+        if (quantized_dimension < 0 ||
+            quantized_dimension >= tensor.dims->size ||
+            num_scales != tensor.dims->data[quantized_dimension]) {
+          return xnn_datatype_invalid;
+        }
+        for (int i = 0; i < num_scales; i++) {
+          if (zero_points[i] != 0) {
+            return xnn_datatype_invalid;
+          }
+        }
+        switch (tensor.type) {
+          case kTfLiteInt8:
+            return xnn_datatype_qcint8;
+          case kTfLiteInt32:
+            return xnn_datatype_qcint32;
+          default:
+            return xnn_datatype_invalid;
+        }
+      }
+#endif  // XNNPACK_DELEGATE_ENABLE_QUANTIZED
+      default:
+        return xnn_datatype_invalid;
+    }
+  }
+
+  // Checks the type of an input or output of an operator with quantized
+  // support, which takes either 32-bit floating-point or per-tensor quantized
+  // 8-bit tensors.
+  static TfLiteStatus CheckTensorFloat32OrQuantizedType(
+      TfLiteContext* context, const TfLiteTensor& tensor, int tensor_index,
+      int node_index) {
+    switch (GetXNNPackDatatype(tensor)) {
+      case xnn_datatype_fp32:
+#ifdef XNNPACK_DELEGATE_ENABLE_QUANTIZED
+      case xnn_datatype_qint8:
+      case xnn_datatype_quint8:
+#endif  // XNNPACK_DELEGATE_ENABLE_QUANTIZED
+        return kTfLiteOk;
+      default:
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context, "unsupported type %s in tensor #%d in node #%d",
+            TfLiteTypeGetName(tensor.type), tensor_index, node_index);
+        return kTfLiteError;
+    }
+  }
+
+  // Checks that a tensor has the same type as the input of its operator, and
+  // that XNNPACK can represent it.
+  static TfLiteStatus CheckTensorMatchingType(TfLiteContext* context,
+                                              const TfLiteTensor& tensor,
+                                              TfLiteType input_type,
+                                              int tensor_index,
+                                              int node_index) {
+    TF_LITE_ENSURE_STATUS(CheckTensorType(context, tensor, input_type,
+                                          tensor_index, node_index));
+    return CheckTensorFloat32OrQuantizedType(context, tensor, tensor_index,
+                                             node_index);
+  }
+
+  // Checks the type of the filter of a convolution or fully connected
+  // operator against the type of its input. Signed filters must be symmetric,
+  // and may be quantized per channel along `quantized_dimension`.
+  static TfLiteStatus CheckFilterTensorType(TfLiteContext* context,
+                                            const TfLiteTensor& tensor,
+                                            TfLiteType input_type,
+                                            int quantized_dimension,
+                                            int tensor_index, int node_index) {
+    TF_LITE_ENSURE_STATUS(CheckTensorType(context, tensor, input_type,
+                                          tensor_index, node_index));
+    switch (GetXNNPackDatatype(tensor)) {
+      case xnn_datatype_fp32:
+        return kTfLiteOk;
+#ifdef XNNPACK_DELEGATE_ENABLE_QUANTIZED
+      case xnn_datatype_quint8:
+        return kTfLiteOk;
+      case xnn_datatype_qint8:
+        if (tensor.params.zero_point != 0) {
+          TF_LITE_MAYBE_KERNEL_LOG(
+              context,
+              "unsupported zero point %d in filter tensor #%d in node #%d: "
+              "signed filters must be symmetric",
+              tensor.params.zero_point, tensor_index, node_index);
+          return kTfLiteError;
+        }
+        return kTfLiteOk;
+      case xnn_datatype_qcint8: {
+        const auto* quantization_params =
+            static_cast<const TfLiteAffineQuantization*>(
+                tensor.quantization.params);
+        if (quantization_params->quantized_dimension != quantized_dimension) {
+          TF_LITE_MAYBE_KERNEL_LOG(
+              context,
+              "unsupported quantized dimension %d in filter tensor #%d in "
+              "node #%d: %d expected",
+              quantization_params->quantized_dimension, tensor_index,
+              node_index, quantized_dimension);
+          return kTfLiteError;
+        }
+        return kTfLiteOk;
+      }
+#endif  // XNNPACK_DELEGATE_ENABLE_QUANTIZED
+      default:
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context,
+            "unsupported quantization in filter tensor #%d in node #%d",
+            tensor_index, node_index);
+        return kTfLiteError;
+    }
+  }
+
+  // Checks the type of the bias of a convolution or fully connected operator,
+  // which is 32-bit integer for quantized operators.
+  static TfLiteStatus CheckBiasTensorType(TfLiteContext* context,
+                                          const TfLiteTensor& tensor,
+                                          TfLiteType input_type,
+                                          int tensor_index, int node_index) {
+    TF_LITE_ENSURE_STATUS(CheckTensorType(
+        context, tensor,
+        input_type == kTfLiteFloat32 ? kTfLiteFloat32 : kTfLiteInt32,
+        tensor_index, node_index));
+    if (GetXNNPackDatatype(tensor) == xnn_datatype_invalid) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context, "unsupported quantization in bias tensor #%d in node #%d",
+          tensor_index, node_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Checks that the output of an operator which only moves data around, such
+  // as MAX_POOL_2D or PAD, has the same quantization as its input.
+  static TfLiteStatus CheckTensorsQuantizationMatch(
+      TfLiteContext* context, const TfLiteTensor& input_tensor,
+      const TfLiteTensor& output_tensor, int node_index) {
+    if (input_tensor.type != kTfLiteFloat32 &&
+        (input_tensor.params.scale != output_tensor.params.scale ||
+         input_tensor.params.zero_point != output_tensor.params.zero_point)) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "mismatching quantization of input and output tensors in node #%d",
+          node_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Checks the ratio of scales XNNPACK uses to requantize the result of a
+  // quantized operator.
+  static TfLiteStatus CheckQuantizedScaleRatio(TfLiteContext* context,
+                                               float scale_ratio,
+                                               float min_scale_ratio,
+                                               float max_scale_ratio,
+                                               int node_index) {
+    if (scale_ratio < min_scale_ratio || scale_ratio >= max_scale_ratio) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context, "unsupported requantization scale %g in node #%d",
+          scale_ratio, node_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Checks the scales used to requantize the accumulators of a quantized
+  // convolution or fully connected operator, one per output channel for
+  // filters quantized per channel.
+  static TfLiteStatus CheckConvolutionScales(TfLiteContext* context,
+                                             const TfLiteTensor& input_tensor,
+                                             const TfLiteTensor& filter_tensor,
+                                             const TfLiteTensor& output_tensor,
+                                             int node_index) {
+    if (input_tensor.type == kTfLiteFloat32) {
+      return kTfLiteOk;
+    }
+    const auto* filter_params = static_cast<const TfLiteAffineQuantization*>(
+        filter_tensor.quantization.params);
+    for (int i = 0; i < filter_params->scale->size; i++) {
+      TF_LITE_ENSURE_STATUS(CheckQuantizedScaleRatio(
+          context,
+          input_tensor.params.scale * filter_params->scale->data[i] /
+              output_tensor.params.scale,
+          kMinConvolutionScaleRatio, kMaxScaleRatio, node_index));
+    }
+    return kTfLiteOk;
+  }
+
   static TfLiteStatus CheckTensorShape(TfLiteContext* context,
                                        const TfLiteTensor& tensor,
                                        int min_num_dims, int max_num_dims,
@@ -1002,6 +1303,45 @@ class Subgraph {
         return VisitSubNode(subgraph, logging_context, node_index, node,
                             context->tensors, sub_params, xnnpack_tensors);
       }
+#ifdef XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
+      case kTfLiteBuiltinBatchMatmul: {
+        const TfLiteBatchMatMulParams* batch_matmul_params =
+            static_cast<const TfLiteBatchMatMulParams*>(node->builtin_data);
+
+        return VisitBatchMatMulNode(subgraph, logging_context, node_index,
+                                    node, context->tensors,
+                                    batch_matmul_params, xnnpack_tensors);
+      }
+      case kTfLiteBuiltinConcatenation: {
+        const TfLiteConcatenationParams* concat_params =
+            static_cast<const TfLiteConcatenationParams*>(node->builtin_data);
+
+        return VisitConcatenationNode(subgraph, logging_context, node_index,
+                                      node, context->tensors, concat_params,
+                                      xnnpack_tensors);
+      }
+      case kTfLiteBuiltinSlice:
+        return VisitSliceNode(subgraph, logging_context, node_index, node,
+                              context->tensors, xnnpack_tensors);
+      case kTfLiteBuiltinSplit: {
+        const TfLiteSplitParams* split_params =
+            static_cast<const TfLiteSplitParams*>(node->builtin_data);
+
+        return VisitSplitNode(subgraph, logging_context, node_index, node,
+                              context->tensors, split_params, xnnpack_tensors);
+      }
+      case kTfLiteBuiltinStridedSlice: {
+        const TfLiteStridedSliceParams* strided_slice_params =
+            static_cast<const TfLiteStridedSliceParams*>(node->builtin_data);
+
+        return VisitStridedSliceNode(subgraph, logging_context, node_index,
+                                     node, context->tensors,
+                                     strided_slice_params, xnnpack_tensors);
+      }
+      case kTfLiteBuiltinTranspose:
+        return VisitTransposeNode(subgraph, logging_context, node_index, node,
+                                  context->tensors, xnnpack_tensors);
+#endif  // XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
       case kTfLiteBuiltinCustom: {
         if (strcmp(registration->custom_name, "Convolution2DTransposeBias") ==
             0) {
@@ -1079,23 +1419,36 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
 
     const TfLiteTensor& input1_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& input2_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input2_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, input2_tensor, input1_tensor.type,
+        node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input2_tensor, node->inputs->data[1], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input1_tensor.type,
+        node->outputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
+    if (input1_tensor.type != kTfLiteFloat32) {
+      TF_LITE_ENSURE_STATUS(CheckQuantizedScaleRatio(
+          logging_context,
+          input1_tensor.params.scale / output_tensor.params.scale,
+          kMinAddScaleRatio, kMaxScaleRatio, node_index));
+      TF_LITE_ENSURE_STATUS(CheckQuantizedScaleRatio(
+          logging_context,
+          input2_tensor.params.scale / output_tensor.params.scale,
+          kMinAddScaleRatio, kMaxScaleRatio, node_index));
+    }
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     if (add_params != nullptr) {
@@ -1232,7 +1585,7 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 4,
                                            node->inputs->data[0]));
@@ -1240,8 +1593,9 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, input_tensor.type,
+        /*quantized_dimension=*/0, node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1257,8 +1611,9 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckBiasTensorType(
+        logging_context, bias_tensor, input_tensor.type, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1267,8 +1622,9 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 4,
                                            node->outputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
@@ -1289,6 +1645,10 @@ class Subgraph {
         logging_context, node_index, conv_params->activation, &output_min,
         &output_max));
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionScales(
+        logging_context, input_tensor, filter_tensor, output_tensor,
+        node_index));
+
     if (subgraph != nullptr) {
       const xnn_status status = xnn_define_convolution_2d(
           subgraph,
@@ -1327,7 +1687,7 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 4,
                                            node->inputs->data[0]));
@@ -1335,8 +1695,9 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, input_tensor.type,
+        /*quantized_dimension=*/3, node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1352,8 +1713,9 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckBiasTensorType(
+        logging_context, bias_tensor, input_tensor.type, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1362,8 +1724,9 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 4,
                                            node->outputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
@@ -1386,6 +1749,10 @@ class Subgraph {
         logging_context, node_index, dwconv_params->activation, &output_min,
         &output_max));
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionScales(
+        logging_context, input_tensor, filter_tensor, output_tensor,
+        node_index));
+
     if (subgraph != nullptr) {
       const xnn_status status = xnn_define_depthwise_convolution_2d(
           subgraph,
@@ -1562,14 +1929,15 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckFilterTensorType(
+        logging_context, filter_tensor, input_tensor.type,
+        /*quantized_dimension=*/0, node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 2,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1585,8 +1953,9 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckBiasTensorType(
+        logging_context, bias_tensor, input_tensor.type, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1595,8 +1964,9 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
@@ -1679,6 +2049,10 @@ class Subgraph {
         logging_context, node_index, fc_params->activation, &output_min,
         &output_max));
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionScales(
+        logging_context, input_tensor, filter_tensor, output_tensor,
+        node_index));
+
     if (subgraph != nullptr) {
       const xnn_status status = xnn_define_fully_connected(
           subgraph, output_min, output_max,
@@ -1844,14 +2218,17 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 1, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
@@ -2287,23 +2664,33 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
 
     const TfLiteTensor& input1_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& input2_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input2_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, input2_tensor, input1_tensor.type,
+        node->inputs->data[1], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input2_tensor, node->inputs->data[1], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input1_tensor.type,
+        node->outputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
+    if (input1_tensor.type != kTfLiteFloat32) {
+      TF_LITE_ENSURE_STATUS(CheckQuantizedScaleRatio(
+          logging_context,
+          input1_tensor.params.scale * input2_tensor.params.scale /
+              output_tensor.params.scale,
+          kMinMultiplyScaleRatio, kMaxScaleRatio, node_index));
+    }
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     if (mul_params != nullptr) {
@@ -2369,7 +2756,7 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 1,
                                            XNN_MAX_TENSOR_DIMS,
@@ -2388,8 +2775,11 @@ class Subgraph {
         logging_context, paddings_tensor, node->inputs->data[1], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 1,
                                            XNN_MAX_TENSOR_DIMS,
                                            node->outputs->data[0]));
@@ -2552,7 +2942,7 @@ class Subgraph {
     }
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
         logging_context, input_tensor, node->inputs->data[0], node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 0,
                                            XNN_MAX_TENSOR_DIMS,
@@ -2572,8 +2962,11 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 0,
                                            XNN_MAX_TENSOR_DIMS,
                                            node->outputs->data[0]));
@@ -2907,6 +3300,594 @@ class Subgraph {
     return kTfLiteOk;
   }
 
+#ifdef XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
+  // Checks a static 1D INT32 tensor with one element per dimension of a
+  // tensor of num_dims dimensions, such as the offsets of a slice.
+  static TfLiteStatus CheckIndexTensor(TfLiteContext* context,
+                                       const TfLiteTensor& tensor,
+                                       int num_dims, int tensor_index,
+                                       int node_index) {
+    TF_LITE_ENSURE_STATUS(CheckTensorType(context, tensor, kTfLiteInt32,
+                                          tensor_index, node_index));
+    TF_LITE_ENSURE_STATUS(
+        CheckShapeTensorShape(context, tensor, tensor_index, node_index));
+    if (tensor.dims->data[0] != num_dims) {
+      TF_LITE_MAYBE_KERNEL_LOG(context,
+                               "unexpected number of elements (%d) in "
+                               "tensor #%d in node #%d: %d expected",
+                               tensor.dims->data[0], tensor_index, node_index,
+                               num_dims);
+      return kTfLiteError;
+    }
+    return CheckTensorStaticAllocation(context, tensor, tensor_index,
+                                       node_index);
+  }
+
+  // Checks that a slice with the given offsets and the shape of the output
+  // tensor stays within the input tensor.
+  static TfLiteStatus CheckSliceRange(TfLiteContext* context,
+                                      const TfLiteTensor& input_tensor,
+                                      const TfLiteTensor& output_tensor,
+                                      const size_t* offsets, int node_index) {
+    if (output_tensor.dims->size != input_tensor.dims->size) {
+      TF_LITE_MAYBE_KERNEL_LOG(context,
+                               "unexpected number of output dimensions (%d) "
+                               "in node #%d: %d expected",
+                               output_tensor.dims->size, node_index,
+                               input_tensor.dims->size);
+      return kTfLiteError;
+    }
+    for (int i = 0; i < input_tensor.dims->size; i++) {
+      if (offsets[i] + static_cast<size_t>(output_tensor.dims->data[i]) >
+          static_cast<size_t>(input_tensor.dims->data[i])) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context, "slice of dimension #%d out of range in node #%d", i,
+            node_index);
+        return kTfLiteError;
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitBatchMatMulNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const TfLiteBatchMatMulParams* batch_matmul_params,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    TF_LITE_ENSURE_STATUS(
+        CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
+
+    const TfLiteTensor& input1_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+        logging_context, input1_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input1_tensor, 3,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->inputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input1_tensor, node->inputs->data[0], node_index));
+
+    const TfLiteTensor& input2_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+        logging_context, input2_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(
+        logging_context, input2_tensor, input1_tensor.dims->size,
+        node->inputs->data[1]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input2_tensor, node->inputs->data[1], node_index));
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    if (batch_matmul_params->adj_x) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported adjoint first input in BATCH_MATMUL node #%d",
+          node_index);
+      return kTfLiteError;
+    }
+
+    // XNNPACK doesn't broadcast the batch dimensions.
+    const int num_batch_dims = input1_tensor.dims->size - 2;
+    for (int i = 0; i < num_batch_dims; i++) {
+      if (input1_tensor.dims->data[i] != input2_tensor.dims->data[i]) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "mismatching batch dimension #%d (%d != %d) in BATCH_MATMUL "
+            "node #%d",
+            i, input1_tensor.dims->data[i], input2_tensor.dims->data[i],
+            node_index);
+        return kTfLiteError;
+      }
+    }
+
+    if (subgraph != nullptr) {
+      const uint32_t flags =
+          batch_matmul_params->adj_y ? XNN_FLAG_TRANSPOSE_B : 0;
+      const xnn_status status = xnn_define_batch_matrix_multiply(
+          subgraph, /*input1_id=*/xnnpack_tensors[node->inputs->data[0]],
+          /*input2_id=*/xnnpack_tensors[node->inputs->data[1]],
+          /*output_id=*/xnnpack_tensors[node->outputs->data[0]], flags);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "failed to delegate BATCH_MATMUL node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitConcatenationNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const TfLiteConcatenationParams* concat_params,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    const int num_inputs = node->inputs->size;
+    if (num_inputs < 2 || num_inputs > 4) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported number of inputs (%d) in CONCATENATION node #%d: "
+          "2 to 4 inputs expected",
+          num_inputs, node_index);
+      return kTfLiteError;
+    }
+    if (node->outputs->size != 1) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unexpected number of outputs (%d) in node #%d: one output expected",
+          node->outputs->size, node_index);
+      return kTfLiteError;
+    }
+
+    if (concat_params->activation != kTfLiteActNone) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported fused activation in CONCATENATION node #%d",
+          node_index);
+      return kTfLiteError;
+    }
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 1,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->outputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    for (int i = 0; i < num_inputs; i++) {
+      const TfLiteTensor& input_tensor = tensors[node->inputs->data[i]];
+      TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+          logging_context, input_tensor, output_tensor.type,
+          node->inputs->data[i], node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+          logging_context, input_tensor, output_tensor, node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorShape(
+          logging_context, input_tensor, output_tensor.dims->size,
+          node->inputs->data[i]));
+      TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+          logging_context, input_tensor, node->inputs->data[i], node_index));
+    }
+
+    int axis = concat_params->axis;
+    if (axis < 0) {
+      axis += output_tensor.dims->size;
+    }
+    if (axis < 0 || axis >= output_tensor.dims->size) {
+      TF_LITE_MAYBE_KERNEL_LOG(logging_context,
+                               "invalid axis %d in CONCATENATION node #%d",
+                               concat_params->axis, node_index);
+      return kTfLiteError;
+    }
+
+    if (subgraph != nullptr) {
+      const uint32_t output_id = xnnpack_tensors[node->outputs->data[0]];
+      xnn_status status = xnn_status_success;
+      switch (num_inputs) {
+        case 2:
+          status = xnn_define_concatenate2(
+              subgraph, static_cast<size_t>(axis),
+              /*input1_id=*/xnnpack_tensors[node->inputs->data[0]],
+              /*input2_id=*/xnnpack_tensors[node->inputs->data[1]], output_id,
+              /*flags=*/0);
+          break;
+        case 3:
+          status = xnn_define_concatenate3(
+              subgraph, static_cast<size_t>(axis),
+              /*input1_id=*/xnnpack_tensors[node->inputs->data[0]],
+              /*input2_id=*/xnnpack_tensors[node->inputs->data[1]],
+              /*input3_id=*/xnnpack_tensors[node->inputs->data[2]], output_id,
+              /*flags=*/0);
+          break;
+        case 4:
+          status = xnn_define_concatenate4(
+              subgraph, static_cast<size_t>(axis),
+              /*input1_id=*/xnnpack_tensors[node->inputs->data[0]],
+              /*input2_id=*/xnnpack_tensors[node->inputs->data[1]],
+              /*input3_id=*/xnnpack_tensors[node->inputs->data[2]],
+              /*input4_id=*/xnnpack_tensors[node->inputs->data[3]], output_id,
+              /*flags=*/0);
+          break;
+      }
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "failed to delegate CONCATENATION node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitSliceNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    TF_LITE_ENSURE_STATUS(
+        CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
+
+    const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 1,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->inputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+
+    const int num_dims = input_tensor.dims->size;
+    const TfLiteTensor& begin_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(
+        CheckIndexTensor(logging_context, begin_tensor, num_dims,
+                         node->inputs->data[1], node_index));
+    // The sizes, including the -1 for "up to the end", are already resolved
+    // into the shape of the output tensor.
+    const TfLiteTensor& size_tensor = tensors[node->inputs->data[2]];
+    TF_LITE_ENSURE_STATUS(
+        CheckIndexTensor(logging_context, size_tensor, num_dims,
+                         node->inputs->data[2], node_index));
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor,
+                                           num_dims, node->outputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    const int32_t* begin_data =
+        reinterpret_cast<const int32_t*>(begin_tensor.data.data);
+    std::array<size_t, XNN_MAX_TENSOR_DIMS> offsets{};
+    for (int i = 0; i < num_dims; i++) {
+      if (begin_data[i] < 0) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "invalid offset %d for dimension #%d in SLICE node #%d",
+            begin_data[i], i, node_index);
+        return kTfLiteError;
+      }
+      offsets[i] = static_cast<size_t>(begin_data[i]);
+    }
+    TF_LITE_ENSURE_STATUS(CheckSliceRange(logging_context, input_tensor,
+                                          output_tensor, offsets.data(),
+                                          node_index));
+
+    if (subgraph != nullptr) {
+      std::array<size_t, XNN_MAX_TENSOR_DIMS> sizes{};
+      std::copy(&output_tensor.dims->data[0],
+                &output_tensor.dims->data[num_dims], sizes.begin());
+      const xnn_status status = xnn_define_static_slice(
+          subgraph, static_cast<size_t>(num_dims), offsets.data(),
+          sizes.data(),
+          /*input_id=*/xnnpack_tensors[node->inputs->data[0]],
+          /*output_id=*/xnnpack_tensors[node->outputs->data[0]], /*flags=*/0);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context, "failed to delegate SLICE node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitSplitNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const TfLiteSplitParams* split_params,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    const int num_outputs = node->outputs->size;
+    if (num_outputs < 2 || num_outputs > 4) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported number of outputs (%d) in SPLIT node #%d: "
+          "2 to 4 outputs expected",
+          num_outputs, node_index);
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(CheckNumInputsAndOutputs(logging_context, node, 2,
+                                                   num_outputs, node_index));
+    if (split_params->num_splits != num_outputs) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unexpected number of splits (%d != %d) in SPLIT node #%d",
+          split_params->num_splits, num_outputs, node_index);
+      return kTfLiteError;
+    }
+
+    const TfLiteTensor& input_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
+        logging_context, input_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 1,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->inputs->data[1]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input_tensor, node->inputs->data[1], node_index));
+
+    const TfLiteTensor& axis_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, axis_tensor,
+                                          kTfLiteInt32, node->inputs->data[0],
+                                          node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
+        logging_context, axis_tensor, node->inputs->data[0], node_index));
+    if (axis_tensor.bytes != sizeof(int32_t)) {
+      TF_LITE_MAYBE_KERNEL_LOG(logging_context,
+                               "unexpected number of elements in axis tensor "
+                               "#%d in SPLIT node #%d: one element expected",
+                               node->inputs->data[0], node_index);
+      return kTfLiteError;
+    }
+
+    int axis = *reinterpret_cast<const int32_t*>(axis_tensor.data.data);
+    if (axis < 0) {
+      axis += input_tensor.dims->size;
+    }
+    if (axis < 0 || axis >= input_tensor.dims->size) {
+      TF_LITE_MAYBE_KERNEL_LOG(logging_context,
+                               "invalid axis %d in SPLIT node #%d", axis,
+                               node_index);
+      return kTfLiteError;
+    }
+    if (input_tensor.dims->data[axis] % num_outputs != 0) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "dimension #%d (%d) is not divisible into %d splits in SPLIT "
+          "node #%d",
+          axis, input_tensor.dims->data[axis], num_outputs, node_index);
+      return kTfLiteError;
+    }
+
+    for (int i = 0; i < num_outputs; i++) {
+      const TfLiteTensor& output_tensor = tensors[node->outputs->data[i]];
+      TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+          logging_context, output_tensor, input_tensor.type,
+          node->outputs->data[i], node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+          logging_context, input_tensor, output_tensor, node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorShape(
+          logging_context, output_tensor, input_tensor.dims->size,
+          node->outputs->data[i]));
+      TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+          logging_context, output_tensor, node->outputs->data[i], node_index));
+    }
+
+    if (subgraph != nullptr) {
+      const uint32_t input_id = xnnpack_tensors[node->inputs->data[1]];
+      xnn_status status = xnn_status_success;
+      switch (num_outputs) {
+        case 2:
+          status = xnn_define_even_split2(
+              subgraph, static_cast<size_t>(axis), input_id,
+              /*output1_id=*/xnnpack_tensors[node->outputs->data[0]],
+              /*output2_id=*/xnnpack_tensors[node->outputs->data[1]],
+              /*flags=*/0);
+          break;
+        case 3:
+          status = xnn_define_even_split3(
+              subgraph, static_cast<size_t>(axis), input_id,
+              /*output1_id=*/xnnpack_tensors[node->outputs->data[0]],
+              /*output2_id=*/xnnpack_tensors[node->outputs->data[1]],
+              /*output3_id=*/xnnpack_tensors[node->outputs->data[2]],
+              /*flags=*/0);
+          break;
+        case 4:
+          status = xnn_define_even_split4(
+              subgraph, static_cast<size_t>(axis), input_id,
+              /*output1_id=*/xnnpack_tensors[node->outputs->data[0]],
+              /*output2_id=*/xnnpack_tensors[node->outputs->data[1]],
+              /*output3_id=*/xnnpack_tensors[node->outputs->data[2]],
+              /*output4_id=*/xnnpack_tensors[node->outputs->data[3]],
+              /*flags=*/0);
+          break;
+      }
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context, "failed to delegate SPLIT node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitStridedSliceNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const TfLiteStridedSliceParams* strided_slice_params,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    TF_LITE_ENSURE_STATUS(
+        CheckNumInputsAndOutputs(logging_context, node, 4, 1, node_index));
+
+    // Only slices that keep all dimensions of the input are supported.
+    if (strided_slice_params->ellipsis_mask != 0 ||
+        strided_slice_params->new_axis_mask != 0 ||
+        strided_slice_params->shrink_axis_mask != 0) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported ellipsis, new axis, or shrink axis mask in "
+          "STRIDED_SLICE node #%d",
+          node_index);
+      return kTfLiteError;
+    }
+
+    const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 1,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->inputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+
+    const int num_dims = input_tensor.dims->size;
+    const TfLiteTensor& begin_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(
+        CheckIndexTensor(logging_context, begin_tensor, num_dims,
+                         node->inputs->data[1], node_index));
+    // The ends are already resolved into the shape of the output tensor.
+    const TfLiteTensor& end_tensor = tensors[node->inputs->data[2]];
+    TF_LITE_ENSURE_STATUS(
+        CheckIndexTensor(logging_context, end_tensor, num_dims,
+                         node->inputs->data[2], node_index));
+    const TfLiteTensor& strides_tensor = tensors[node->inputs->data[3]];
+    TF_LITE_ENSURE_STATUS(
+        CheckIndexTensor(logging_context, strides_tensor, num_dims,
+                         node->inputs->data[3], node_index));
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor,
+                                           num_dims, node->outputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    const int32_t* begin_data =
+        reinterpret_cast<const int32_t*>(begin_tensor.data.data);
+    const int32_t* strides_data =
+        reinterpret_cast<const int32_t*>(strides_tensor.data.data);
+    std::array<size_t, XNN_MAX_TENSOR_DIMS> offsets{};
+    for (int i = 0; i < num_dims; i++) {
+      if (strides_data[i] != 1) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported stride %d for dimension #%d in STRIDED_SLICE node #%d",
+            strides_data[i], i, node_index);
+        return kTfLiteError;
+      }
+
+      int32_t offset = 0;
+      if ((strided_slice_params->begin_mask & (1 << i)) == 0) {
+        offset = begin_data[i];
+        if (offset < 0) {
+          offset += input_tensor.dims->data[i];
+        }
+        offset = std::min(std::max(offset, 0), input_tensor.dims->data[i]);
+      }
+      offsets[i] = static_cast<size_t>(offset);
+    }
+    TF_LITE_ENSURE_STATUS(CheckSliceRange(logging_context, input_tensor,
+                                          output_tensor, offsets.data(),
+                                          node_index));
+
+    if (subgraph != nullptr) {
+      std::array<size_t, XNN_MAX_TENSOR_DIMS> sizes{};
+      std::copy(&output_tensor.dims->data[0],
+                &output_tensor.dims->data[num_dims], sizes.begin());
+      const xnn_status status = xnn_define_static_slice(
+          subgraph, static_cast<size_t>(num_dims), offsets.data(),
+          sizes.data(),
+          /*input_id=*/xnnpack_tensors[node->inputs->data[0]],
+          /*output_id=*/xnnpack_tensors[node->outputs->data[0]], /*flags=*/0);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "failed to delegate STRIDED_SLICE node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus VisitTransposeNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    TF_LITE_ENSURE_STATUS(
+        CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
+
+    const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQuantizedType(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 1,
+                                           XNN_MAX_TENSOR_DIMS,
+                                           node->inputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+
+    const int num_dims = input_tensor.dims->size;
+    const TfLiteTensor& perm_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(CheckIndexTensor(logging_context, perm_tensor,
+                                           num_dims, node->inputs->data[1],
+                                           node_index));
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorMatchingType(
+        logging_context, output_tensor, input_tensor.type,
+        node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorsQuantizationMatch(
+        logging_context, input_tensor, output_tensor, node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor,
+                                           num_dims, node->outputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    const int32_t* perm_data =
+        reinterpret_cast<const int32_t*>(perm_tensor.data.data);
+    std::array<size_t, XNN_MAX_TENSOR_DIMS> perm{};
+    std::array<bool, XNN_MAX_TENSOR_DIMS> seen{};
+    for (int i = 0; i < num_dims; i++) {
+      const int32_t axis = perm_data[i];
+      if (axis < 0 || axis >= num_dims || seen[axis]) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "invalid permutation of dimension #%d in TRANSPOSE node #%d", i,
+            node_index);
+        return kTfLiteError;
+      }
+      seen[axis] = true;
+      perm[i] = static_cast<size_t>(axis);
+    }
+
+    if (subgraph != nullptr) {
+      const xnn_status status = xnn_define_static_transpose(
+          subgraph, static_cast<size_t>(num_dims), perm.data(),
+          /*input_id=*/xnnpack_tensors[node->inputs->data[0]],
+          /*output_id=*/xnnpack_tensors[node->outputs->data[0]], /*flags=*/0);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "failed to delegate TRANSPOSE node #%d", node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+#endif  // XNNPACK_DELEGATE_ENABLE_TRANSFORMER_OPS
+
  private:
   Subgraph(xnn_runtime_t runtime, std::unordered_set<int>&& externals)
       : runtime_(runtime, &xnn_delete_runtime), externals_(externals) {}
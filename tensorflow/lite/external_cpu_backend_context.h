@@ -22,6 +22,8 @@ limitations under the License.
 
 namespace tflite {
 
+class PackedWeightsCache;
+
 // This is the base class for TF Lite internal backend contexts (like a
 // RUY-based cpu backend context class). A derived internal backend context is
 // generally a collection of utilities (i.e. a thread pool etc.) for TF Lite to
@@ -92,10 +94,22 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // The cache of rearranged constant weights that kernels may use, if any.
+  // Not owned.
+  void set_packed_weights_cache(PackedWeightsCache* packed_weights_cache) {
+    packed_weights_cache_ = packed_weights_cache;
+  }
+
+  PackedWeightsCache* packed_weights_cache() const {
+    return packed_weights_cache_;
+  }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
 
+  PackedWeightsCache* packed_weights_cache_ = nullptr;
+
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
       delete;
@@ -61,6 +61,12 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the execution-plan indices of the first and last nodes that may
+  // run at the same time as the node at `index`. Tensors used by any of them
+  // must not share memory. By default nodes run one after the other.
+  virtual size_t first_concurrent_node(size_t index) const { return index; }
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
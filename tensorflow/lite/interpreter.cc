@@ -231,7 +231,16 @@ TfLiteStatus Interpreter::AllocateTensors() {
     }
   }
 
-  return primary_subgraph().AllocateTensors();
+  TF_LITE_ENSURE_STATUS(primary_subgraph().AllocateTensors());
+
+  // Weights rearranged while preparing the kernels are written out for the
+  // next process that loads the model. Failing to do so only costs time.
+  PackedWeightsCache* packed_weights_cache = GetPackedWeightsCache();
+  if (packed_weights_cache && packed_weights_cache->Flush() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to write the packed weights cache.");
+  }
+  return kTfLiteOk;
 }
 
 void Interpreter::ReserveNodes(int count) {
@@ -291,6 +300,12 @@ TfLiteStatus Interpreter::Invoke() {
     }
   }
 
+  // Some kernels only rearrange their weights on the first invocation.
+  PackedWeightsCache* packed_weights_cache = GetPackedWeightsCache();
+  if (packed_weights_cache && packed_weights_cache->Flush() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to write the packed weights cache.");
+  }
   return kTfLiteOk;
 }
 
@@ -383,6 +398,28 @@ void Interpreter::SetCancellationFunction(void* data,
 
 bool Interpreter::IsCancelled() { return primary_subgraph().IsCancelled(); }
 
+TfLiteStatus Interpreter::SetParallelExecution(bool enabled) {
+  for (auto& subgraph : subgraphs_) {
+    TF_LITE_ENSURE_STATUS(subgraph->SetParallelExecution(enabled));
+  }
+  return kTfLiteOk;
+}
+
+void Interpreter::SetPackedWeightsCache(PackedWeightsCache* cache) {
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      external_contexts_[kTfLiteCpuBackendContext]);
+  if (cpu_backend_context) {
+    cpu_backend_context->set_packed_weights_cache(cache);
+  }
+}
+
+PackedWeightsCache* Interpreter::GetPackedWeightsCache() {
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      external_contexts_[kTfLiteCpuBackendContext]);
+  return cpu_backend_context ? cpu_backend_context->packed_weights_cache()
+                             : nullptr;
+}
+
 TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
   TfLiteStatus status = kTfLiteOk;
   for (auto& subgraph : subgraphs_) {
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/packed_weights_cache.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/string_type.h"
@@ -470,6 +471,28 @@ class Interpreter {
   /// WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  /// Enables or disables running nodes of the graph that don't depend on each
+  /// other at the same time, using the threads set with SetNumThreads(). This
+  /// helps models with parallel branches whose ops don't use all the threads
+  /// by themselves, at the cost of a bigger tensor arena. Nodes still run one
+  /// by one when a profiler is set or the graph has dynamic tensors, and also
+  /// for the first Invoke() after changing the number of threads.
+  /// AllocateTensors() must be called again after changing this.
+  /// Default: disabled.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetParallelExecution(bool enabled);
+
+  /// Sets the cache of rearranged constant weights used by the builtin
+  /// kernels, see PackedWeightsCache. Weights found in the cache are used in
+  /// place, and the ones computed by AllocateTensors() or Invoke() are added
+  /// to its file.
+  /// Must be called before AllocateTensors(). `cache` is not owned, must
+  /// outlive the interpreter and may be nullptr to stop using it. The cache
+  /// is set on the current CPU backend context, so this must be called again
+  /// after SetExternalContext(kTfLiteCpuBackendContext, ...).
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPackedWeightsCache(PackedWeightsCache* cache);
+
   /// Allow a delegate to look at the graph and modify the graph to handle
   /// parts of the graph themselves. After this is called, the graph may
   /// contain new nodes that replace 1 more nodes.
@@ -704,6 +727,9 @@ class Interpreter {
   // Sets the profiler to all subgraphs.
   void SetSubgraphProfiler();
 
+  // Returns the cache set with SetPackedWeightsCache(), or nullptr.
+  PackedWeightsCache* GetPackedWeightsCache();
+
   // Remove delegates (for fallback behaviour). The interpreter is invokable
   // afterwards.
   TfLiteStatus RemoveAllDelegates();
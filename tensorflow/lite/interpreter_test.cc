@@ -1051,6 +1051,76 @@ TEST(BasicInterpreter, DynamicTensorsResizeDescendants) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 10 * 14);
 }
 
+TEST(BasicInterpreter, ParallelExecutionOfIndependentBranches) {
+  // Two branches of two negate ops each, added one branch after the other.
+  Interpreter interpreter;
+  interpreter.AddTensors(5);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({3, 4});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {64},
+                                             quant);
+  }
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({1}, {3}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({2}, {4}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(interpreter.SetNumThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetParallelExecution(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The first op of each branch runs in the first wave, the second ones in
+  // the next.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+
+  // The first Invoke() runs the nodes one by one, the next ones in parallel.
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 64; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = run * 64 + i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 64; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(1)[i], -(run * 64 + i));
+      EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], -(run * 64 + i));
+      EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], run * 64 + i);
+      EXPECT_EQ(interpreter.typed_tensor<float>(4)[i], run * 64 + i);
+    }
+  }
+}
+
+TEST(BasicInterpreter, ParallelExecutionWithDynamicTensors) {
+  // Dynamic tensors make the interpreter run the nodes one by one.
+  Interpreter interpreter;
+  interpreter.AddTensors(4);
+  interpreter.SetInputs({0, 1});
+  interpreter.SetOutputs({2, 3});
+  TfLiteQuantizationParams quant;
+  interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "", {2, 2, 1, 1},
+                                           quant);
+  interpreter.SetTensorParametersReadWrite(1, kTfLiteInt32, "", {4, 2}, quant);
+  interpreter.SetTensorParametersReadWrite(2, kTfLiteFloat32, "", {}, quant);
+  interpreter.SetTensorParametersReadWrite(3, kTfLiteFloat32, "", {}, quant);
+
+  TfLiteRegistration* pad_op = tflite::ops::builtin::Register_PADV2();
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  interpreter.AddNodeWithParameters({0, 1}, {2}, nullptr, 0, nullptr, pad_op);
+  interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(interpreter.SetNumThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetParallelExecution(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  for (int i = 0; i < 8; ++i) {
+    interpreter.typed_tensor<int>(1)[i] = i < 4 ? 1 : 0;
+  }
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    ASSERT_EQ(interpreter.tensor(2)->bytes, sizeof(float) * 4 * 4);
+    ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 2 * 2);
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
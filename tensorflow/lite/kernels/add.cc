@@ -21,8 +21,10 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/lite/kernels/internal/optimized/elementwise_multithread.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
@@ -246,6 +248,18 @@ void EvalAdd(TfLiteContext* context, TfLiteNode* node, TfLiteAddParams* params,
                GetTensorData<data_type>(input1), GetTensorShape(input2), \
                GetTensorData<data_type>(input2), GetTensorShape(output), \
                GetTensorData<data_type>(output))
+#define TF_LITE_ADD_MULTITHREAD(type, opname, broadcast_opname, data_type) \
+  data_type output_activation_min, output_activation_max;                  \
+  CalculateActivationRange(params->activation, &output_activation_min,     \
+                           &output_activation_max);                        \
+  SetActivationParams(output_activation_min, output_activation_max,        \
+                      &op_params);                                         \
+  optimized_ops::BinaryArithmeticMultithread(                              \
+      op_params, GetTensorShape(input1), GetTensorData<data_type>(input1), \
+      GetTensorShape(input2), GetTensorData<data_type>(input2),            \
+      GetTensorShape(output), GetTensorData<data_type>(output),            \
+      type::opname, type::broadcast_opname,                                \
+      CpuBackendContext::GetFromContext(context))
   if (output->type == kTfLiteInt32) {
     if (kernel_type == kReference) {
       if (need_broadcast) {
@@ -254,11 +268,7 @@ void EvalAdd(TfLiteContext* context, TfLiteNode* node, TfLiteAddParams* params,
         TF_LITE_ADD(reference_ops, Add, int32_t);
       }
     } else {
-      if (need_broadcast) {
-        TF_LITE_ADD(optimized_ops, BroadcastAdd4DSlow, int32_t);
-      } else {
-        TF_LITE_ADD(optimized_ops, Add, int32_t);
-      }
+      TF_LITE_ADD_MULTITHREAD(optimized_ops, Add, BroadcastAdd4DSlow, int32_t);
     }
   } else if (output->type == kTfLiteFloat32) {
     if (kernel_type == kReference) {
@@ -268,13 +278,10 @@ void EvalAdd(TfLiteContext* context, TfLiteNode* node, TfLiteAddParams* params,
         TF_LITE_ADD(reference_ops, Add, float);
       }
     } else {
-      if (need_broadcast) {
-        TF_LITE_ADD(optimized_ops, BroadcastAddDispatch, float);
-      } else {
-        TF_LITE_ADD(optimized_ops, Add, float);
-      }
+      TF_LITE_ADD_MULTITHREAD(optimized_ops, Add, BroadcastAddDispatch, float);
     }
   }
+#undef TF_LITE_ADD_MULTITHREAD
 #undef TF_LITE_ADD
 }
 
@@ -306,6 +313,13 @@ TfLiteStatus EvalAddQuantized(TfLiteContext* context, TfLiteNode* node,
                GetTensorData<dtype>(input1), GetTensorShape(input2), \
                GetTensorData<dtype>(input2), GetTensorShape(output), \
                GetTensorData<dtype>(output));
+#define TF_LITE_ADD_MULTITHREAD(type, opname, broadcast_opname, dtype) \
+  optimized_ops::BinaryArithmeticMultithread(                          \
+      op_params, GetTensorShape(input1), GetTensorData<dtype>(input1), \
+      GetTensorShape(input2), GetTensorData<dtype>(input2),            \
+      GetTensorShape(output), GetTensorData<dtype>(output),            \
+      type::opname, type::broadcast_opname,                            \
+      CpuBackendContext::GetFromContext(context));
     if (output->type == kTfLiteInt8) {
       if (kernel_type == kReference) {
         if (need_broadcast) {
@@ -314,11 +328,8 @@ TfLiteStatus EvalAddQuantized(TfLiteContext* context, TfLiteNode* node,
           TF_LITE_ADD(reference_integer_ops, Add, int8_t);
         }
       } else {
-        if (need_broadcast) {
-          TF_LITE_ADD(optimized_integer_ops, BroadcastAddDispatch, int8_t);
-        } else {
-          TF_LITE_ADD(optimized_integer_ops, Add, int8_t);
-        }
+        TF_LITE_ADD_MULTITHREAD(optimized_integer_ops, Add,
+                                BroadcastAddDispatch, int8_t);
       }
     } else if (output->type == kTfLiteInt16) {
       if (need_broadcast) {
@@ -337,13 +348,11 @@ TfLiteStatus EvalAddQuantized(TfLiteContext* context, TfLiteNode* node,
           TF_LITE_ADD(reference_ops, Add, uint8_t);
         }
       } else {
-        if (need_broadcast) {
-          TF_LITE_ADD(optimized_ops, BroadcastAddDispatch, uint8_t);
-        } else {
-          TF_LITE_ADD(optimized_ops, Add, uint8_t);
-        }
+        TF_LITE_ADD_MULTITHREAD(optimized_ops, Add, BroadcastAddDispatch,
+                                uint8_t);
       }
     }
+#undef TF_LITE_ADD_MULTITHREAD
 #undef TF_LITE_ADD
   } else if (output->type == kTfLiteInt16) {
     tflite::ArithmeticParams op_params;
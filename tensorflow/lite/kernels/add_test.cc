@@ -15,6 +15,7 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -31,17 +32,21 @@ class BaseAddOpModel : public SingleOpModel {
  public:
   BaseAddOpModel(const TensorData& input1, const TensorData& input2,
                  const TensorData& output,
-                 ActivationFunctionType activation_type) {
+                 ActivationFunctionType activation_type,
+                 int num_threads = -1) {
     input1_ = AddInput(input1);
     input2_ = AddInput(input2);
     output_ = AddOutput(output);
     SetBuiltinOp(BuiltinOperator_ADD, BuiltinOptions_AddOptions,
                  CreateAddOptions(builder_, activation_type).Union());
-    BuildInterpreter({GetShape(input1_), GetShape(input2_)});
+    BuildInterpreter({GetShape(input1_), GetShape(input2_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   int input1() { return input1_; }
   int input2() { return input2_; }
+  int output() { return output_; }
 
  protected:
   int input1_;
@@ -226,6 +231,53 @@ TEST(FloatAddOpModel, MixedBroadcast) {
   }
 }
 
+// Large enough for the op to be split between threads.
+TEST(FloatAddOpModel, Multithreaded) {
+  const std::vector<int> shape = {1, 64, 64, 16};
+  const int size = 64 * 64 * 16;
+  FloatAddOpModel m({TensorType_FLOAT32, shape}, {TensorType_FLOAT32, shape},
+                    {TensorType_FLOAT32, {}}, ActivationFunctionType_RELU6,
+                    /*num_threads=*/4);
+  std::vector<float> input1(size);
+  std::vector<float> input2(size);
+  std::vector<float> expected(size);
+  for (int i = 0; i < size; ++i) {
+    input1[i] = static_cast<float>(i % 11) - 4.0f;
+    input2[i] = static_cast<float>(i % 5) * 0.5f;
+    expected[i] = std::min(6.0f, std::max(0.0f, input1[i] + input2[i]));
+  }
+  m.PopulateTensor<float>(m.input1(), input1);
+  m.PopulateTensor<float>(m.input2(), input2);
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
+TEST(FloatAddOpModel, MultithreadedWithBroadcast) {
+  const int height = 64;
+  const int width = 64;
+  const int depth = 16;
+  FloatAddOpModel m({TensorType_FLOAT32, {1, height, width, depth}},
+                    {TensorType_FLOAT32, {1, 1, width, depth}},
+                    {TensorType_FLOAT32, {}}, ActivationFunctionType_NONE,
+                    /*num_threads=*/4);
+  std::vector<float> input1(height * width * depth);
+  std::vector<float> input2(width * depth);
+  for (size_t i = 0; i < input1.size(); ++i) {
+    input1[i] = static_cast<float>(i % 13);
+  }
+  for (size_t i = 0; i < input2.size(); ++i) {
+    input2[i] = static_cast<float>(i) * 0.25f;
+  }
+  std::vector<float> expected(input1.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = input1[i] + input2[i % input2.size()];
+  }
+  m.PopulateTensor<float>(m.input1(), input1);
+  m.PopulateTensor<float>(m.input2(), input2);
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
 TEST(IntegerAddOpModel, NoActivation) {
   IntegerAddOpModel m({TensorType_INT32, {1, 2, 2, 1}},
                       {TensorType_INT32, {1, 2, 2, 1}}, {TensorType_INT32, {}},
@@ -561,5 +613,84 @@ TEST(QuantizedAddOpModel, QuantizedWithGenericdBroadcastInt16) {
   QuantizedWithGenericBroadcast<TensorType_INT16, int16_t>();
 }
 
+// Output shape of more than kMinElementwiseSizePerThread elements for each of
+// 4 threads. Neither its 67 rows nor its flat size split evenly between them.
+const std::vector<int> kMultithreadedShape = {1, 67, 33, 31};
+const std::vector<int> kMultithreadedBroadcastShape = {1, 1, 33, 31};
+
+// Returns `size` values cycling through [min, max] in steps of `step`.
+template <typename T>
+std::vector<T> CyclicData(int size, int min, int max, int step) {
+  std::vector<T> data(size);
+  for (int i = 0; i < size; ++i) {
+    data[i] = static_cast<T>(min + (i * step) % (max - min + 1));
+  }
+  return data;
+}
+
+int ShapeSize(const std::vector<int>& shape) {
+  int size = 1;
+  for (int dim : shape) {
+    size *= dim;
+  }
+  return size;
+}
+
+// Checks that ADD gives the same output with 4 threads as with 1, for input2
+// of `input2_shape` and raw input values in [data_min, data_max]. 8-bit
+// tensors are quantized to [quantized_min, quantized_max].
+template <TensorType tensor_type, typename T>
+void MultithreadedMatchesSingleThreaded(const std::vector<int>& input2_shape,
+                                        int data_min, int data_max,
+                                        float quantized_min = 0.0f,
+                                        float quantized_max = 0.0f) {
+  std::vector<T> outputs[2];
+  const int thread_counts[2] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    BaseAddOpModel m(
+        {tensor_type, kMultithreadedShape, quantized_min, quantized_max},
+        {tensor_type, input2_shape, quantized_min, quantized_max},
+        {tensor_type, {}, quantized_min, quantized_max},
+        ActivationFunctionType_NONE, thread_counts[i]);
+    m.PopulateTensor<T>(m.input1(),
+                        CyclicData<T>(ShapeSize(kMultithreadedShape),
+                                      data_min, data_max, /*step=*/7));
+    m.PopulateTensor<T>(m.input2(),
+                        CyclicData<T>(ShapeSize(input2_shape), data_min,
+                                      data_max, /*step=*/5));
+    m.Invoke();
+    outputs[i] = m.ExtractVector<T>(m.output());
+  }
+  EXPECT_THAT(outputs[1], ElementsAreArray(outputs[0]));
+}
+
+TEST(FloatAddOpModel, MultithreadedMatchesSingleThreaded) {
+  MultithreadedMatchesSingleThreaded<TensorType_FLOAT32, float>(
+      kMultithreadedShape, -8, 8);
+  MultithreadedMatchesSingleThreaded<TensorType_FLOAT32, float>(
+      kMultithreadedBroadcastShape, -8, 8);
+}
+
+TEST(IntegerAddOpModel, MultithreadedMatchesSingleThreaded) {
+  MultithreadedMatchesSingleThreaded<TensorType_INT32, int32_t>(
+      kMultithreadedShape, -8, 8);
+  MultithreadedMatchesSingleThreaded<TensorType_INT32, int32_t>(
+      kMultithreadedBroadcastShape, -8, 8);
+}
+
+TEST(QuantizedAddOpModel, MultithreadedMatchesSingleThreadedUInt8) {
+  MultithreadedMatchesSingleThreaded<TensorType_UINT8, uint8_t>(
+      kMultithreadedShape, 0, 255, -1.0f, 1.0f);
+  MultithreadedMatchesSingleThreaded<TensorType_UINT8, uint8_t>(
+      kMultithreadedBroadcastShape, 0, 255, -1.0f, 1.0f);
+}
+
+TEST(QuantizedAddOpModel, MultithreadedMatchesSingleThreadedInt8) {
+  MultithreadedMatchesSingleThreaded<TensorType_INT8, int8_t>(
+      kMultithreadedShape, -128, 127, -1.0f, 1.0f);
+  MultithreadedMatchesSingleThreaded<TensorType_INT8, int8_t>(
+      kMultithreadedBroadcastShape, -128, 127, -1.0f, 1.0f);
+}
+
 }  // namespace
 }  // namespace tflite
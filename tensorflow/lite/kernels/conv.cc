@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/packed_weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -487,15 +488,37 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     TfLiteTensor* hwcn_weights =
         &context->tensors[node->temporaries->data[data->hwcn_weights_index]];
     hwcn_weights->type = input_type;
-    hwcn_weights->allocation_type = kTfLiteArenaRwPersistent;
+    // The weights may be in the packed weights cache since the last time the
+    // node was prepared.
+    if (hwcn_weights->allocation_type == kTfLiteCustom) {
+      hwcn_weights->data.raw = nullptr;
+    }
+    PackedWeightsCache* packed_weights_cache =
+        IsConstantTensor(filter)
+            ? CpuBackendContext::GetPackedWeightsCache(context)
+            : nullptr;
+    const void* cached_weights =
+        packed_weights_cache
+            ? packed_weights_cache->Lookup(
+                  filter, PackedWeightsCache::kConvHwcnWeights, filter->bytes)
+            : nullptr;
+    hwcn_weights->allocation_type =
+        cached_weights ? kTfLiteCustom : kTfLiteArenaRwPersistent;
 
     auto hwcn_weights_status =
         context->ResizeTensor(context, hwcn_weights, hwcn_weights_size);
     if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
 
-    // TODO(petewarden): If Resize() is called when the size hasn't actually
-    // changed, this will do extra redundant work.
-    data->have_weights_been_transposed = false;
+    if (cached_weights) {
+      TF_LITE_ENSURE_EQ(context, hwcn_weights->bytes, filter->bytes);
+      hwcn_weights->data.raw =
+          static_cast<char*>(const_cast<void*>(cached_weights));
+      data->have_weights_been_transposed = true;
+    } else {
+      // TODO(petewarden): If Resize() is called when the size hasn't actually
+      // changed, this will do extra redundant work.
+      data->have_weights_been_transposed = false;
+    }
   }
 
   if (is_hybrid) {
@@ -1010,6 +1033,15 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
     TransposeFloatTensor(filter, hwcn_weights);
     data->have_weights_been_transposed = true;
+    // Written to the cache file after the invocation, for the next process
+    // that loads the model.
+    PackedWeightsCache* packed_weights_cache =
+        CpuBackendContext::GetPackedWeightsCache(context);
+    if (packed_weights_cache && IsConstantTensor(filter)) {
+      packed_weights_cache->Insert(filter, PackedWeightsCache::kConvHwcnWeights,
+                                   hwcn_weights->data.raw,
+                                   hwcn_weights->bytes);
+    }
   }
 
   TFLITE_DCHECK_EQ(input_type, input->type);
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/internal/reference/conv3d.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -31,9 +34,34 @@ namespace ops {
 namespace builtin {
 namespace conv3d {
 
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
+const int kTensorNotAllocated = -1;
+
+// The im2col of the optimized kernel is computed for a chunk of the output
+// points at a time, so that its buffer stays within this many bytes.
+const int kMaxIm2colBufferSize = 8 * 1024 * 1024;
+
 // Struct to carry data from Prepare to Eval.
 struct OpData {
   Padding3DValues padding;
+
+  // The optimized kernel multiplies the filter, transposed to
+  // [out_channels, filter_depth * filter_height * filter_width * in_channels],
+  // by the im2col of the input. Both are held in temporary tensors.
+  int im2col_tensor_id = kTensorNotAllocated;
+  int transposed_filter_tensor_id = kTensorNotAllocated;
+
+  int32_t im2col_index;
+  int32_t transposed_filter_index;
+
+  bool need_im2col = false;
+  // Whether the transposed filter holds the transpose of a constant filter,
+  // which then doesn't need to be transposed again on each Eval.
+  bool filter_transposed = false;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -45,6 +73,57 @@ void Free(TfLiteContext* context, void* buffer) {
   delete static_cast<OpData*>(buffer);
 }
 
+void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
+  const int rows = output->dims->data[1];
+  const int cols = output->dims->data[0];
+  const float* input_data = GetTensorData<float>(input);
+  float* output_data = GetTensorData<float>(output);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      const float in_value = input_data[i * cols + j];
+      output_data[j * rows + i] = in_value;
+    }
+  }
+}
+
+static TfLiteStatus AllocateTemporaryTensorsIfRequired(
+    TfLiteContext* context, TfLiteNode* node, KernelType kernel_type,
+    const TfLiteTensor* filter) {
+  auto* params = static_cast<TfLiteConv3DParams*>(node->builtin_data);
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+
+  int temporaries_count = 0;
+  if (kernel_type == kGenericOptimized) {
+    // A 1x1x1 filter with unit strides reads each input point once, in the
+    // order of the output points, so the input is its own im2col.
+    data->need_im2col =
+        !(filter->dims->data[0] == 1 && filter->dims->data[1] == 1 &&
+          filter->dims->data[2] == 1 && params->stride_depth == 1 &&
+          params->stride_height == 1 && params->stride_width == 1);
+    if (data->need_im2col) {
+      data->im2col_index = temporaries_count;
+      if (data->im2col_tensor_id == kTensorNotAllocated) {
+        TF_LITE_ENSURE_OK(
+            context, context->AddTensors(context, 1, &data->im2col_tensor_id));
+      }
+      ++temporaries_count;
+    }
+
+    data->transposed_filter_index = temporaries_count;
+    if (data->transposed_filter_tensor_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(context, context->AddTensors(
+                                     context, 1,
+                                     &data->transposed_filter_tensor_id));
+    }
+    ++temporaries_count;
+  }
+
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(temporaries_count);
+  return kTfLiteOk;
+}
+
+template <KernelType kernel_type>
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params = static_cast<TfLiteConv3DParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
@@ -79,6 +158,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_EQ(context, NumElements(bias), SizeOfDimension(filter, 4));
   }
 
+  TF_LITE_ENSURE_STATUS(
+      AllocateTemporaryTensorsIfRequired(context, node, kernel_type, filter));
+
   // Filter has shape of [filter_depth, filter_height, filter_width,
   // in_channels, out_channels].
   int batches = input->dims->data[0];
@@ -105,9 +187,53 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   output_size->data[2] = out_height;
   output_size->data[3] = out_width;
   output_size->data[4] = channels_out;
-  return context->ResizeTensor(context, output, output_size);
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, output, output_size));
+
+  if (kernel_type != kGenericOptimized) {
+    return kTfLiteOk;
+  }
+
+  const int filter_size =
+      filter_depth * filter_height * filter_width * filter->dims->data[3];
+  if (data->need_im2col) {
+    node->temporaries->data[data->im2col_index] = data->im2col_tensor_id;
+    TfLiteTensor* im2col;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                                data->im2col_index, &im2col));
+    const int num_points = batches * out_depth * out_height * out_width;
+    const int points_per_chunk = std::min(
+        num_points,
+        std::max(1, kMaxIm2colBufferSize /
+                        static_cast<int>(filter_size * sizeof(float))));
+    TfLiteIntArray* im2col_size = TfLiteIntArrayCreate(2);
+    im2col_size->data[0] = points_per_chunk;
+    im2col_size->data[1] = filter_size;
+    im2col->type = input_type;
+    im2col->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, im2col, im2col_size));
+  }
+
+  node->temporaries->data[data->transposed_filter_index] =
+      data->transposed_filter_tensor_id;
+  TfLiteTensor* transposed_filter;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, data->transposed_filter_index,
+                                &transposed_filter));
+  TfLiteIntArray* transposed_filter_size = TfLiteIntArrayCreate(2);
+  transposed_filter_size->data[0] = channels_out;
+  transposed_filter_size->data[1] = filter_size;
+  transposed_filter->type = input_type;
+  // A constant filter is transposed once, on the first Eval after Prepare.
+  transposed_filter->allocation_type =
+      IsConstantTensor(filter) ? kTfLiteArenaRwPersistent : kTfLiteArenaRw;
+  data->filter_transposed = false;
+  return context->ResizeTensor(context, transposed_filter,
+                               transposed_filter_size);
 }
 
+template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConv3DParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
@@ -137,11 +263,36 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input->type) {
     case kTfLiteFloat32:
-      reference_ops::Conv3D(runtime_params, GetTensorShape(input),
-                            GetTensorData<float>(input), GetTensorShape(filter),
-                            GetTensorData<float>(filter), GetTensorShape(bias),
-                            GetTensorData<float>(bias), GetTensorShape(output),
-                            GetTensorData<float>(output));
+      if (kernel_type == kReference) {
+        reference_ops::Conv3D(
+            runtime_params, GetTensorShape(input), GetTensorData<float>(input),
+            GetTensorShape(filter), GetTensorData<float>(filter),
+            GetTensorShape(bias), GetTensorData<float>(bias),
+            GetTensorShape(output), GetTensorData<float>(output));
+      } else {
+        TfLiteTensor* im2col = nullptr;
+        if (data->need_im2col) {
+          TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                                      data->im2col_index,
+                                                      &im2col));
+        }
+        TfLiteTensor* transposed_filter;
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node,
+                                           data->transposed_filter_index,
+                                           &transposed_filter));
+        if (!data->filter_transposed) {
+          TransposeFloatTensor(filter, transposed_filter);
+          data->filter_transposed = IsConstantTensor(filter);
+        }
+        optimized_ops::Conv3D(
+            runtime_params, GetTensorShape(input), GetTensorData<float>(input),
+            GetTensorShape(filter), GetTensorData<float>(transposed_filter),
+            GetTensorShape(bias), GetTensorData<float>(bias),
+            GetTensorShape(output), GetTensorData<float>(output),
+            GetTensorShape(im2col), GetTensorData<float>(im2col),
+            CpuBackendContext::GetFromContext(context));
+      }
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s currently not supported.",
@@ -153,12 +304,24 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
 }  // namespace conv3d
 
-TfLiteRegistration* Register_CONV_3D() {
-  static TfLiteRegistration r = {conv3d::Init, conv3d::Free, conv3d::Prepare,
-                                 conv3d::Eval};
+TfLiteRegistration* Register_CONV_3D_REF() {
+  static TfLiteRegistration r = {conv3d::Init, conv3d::Free,
+                                 conv3d::Prepare<conv3d::kReference>,
+                                 conv3d::Eval<conv3d::kReference>};
+  return &r;
+}
+
+TfLiteRegistration* Register_CONV_3D_GENERIC_OPT() {
+  static TfLiteRegistration r = {conv3d::Init, conv3d::Free,
+                                 conv3d::Prepare<conv3d::kGenericOptimized>,
+                                 conv3d::Eval<conv3d::kGenericOptimized>};
   return &r;
 }
 
+TfLiteRegistration* Register_CONV_3D() {
+  return Register_CONV_3D_GENERIC_OPT();
+}
+
 }  // namespace builtin
 }  // namespace ops
 }  // namespace tflite
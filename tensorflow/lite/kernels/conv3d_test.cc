@@ -14,14 +14,32 @@ limitations under the License.
 ==============================================================================*/
 #include <cstdint>
 #include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/memory/memory.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/string_type.h"
+
+#ifdef CONV3D_BENCHMARKS
+#include "testing/base/public/benchmark.h"
+#endif  // CONV3D_BENCHMARKS
 
 namespace tflite {
+namespace ops {
+namespace builtin {
+
+TfLiteRegistration* Register_CONV_3D_REF();
+TfLiteRegistration* Register_CONV_3D_GENERIC_OPT();
+
+}  // namespace builtin
+}  // namespace ops
+
 namespace {
 
 using ::testing::ElementsAre;
@@ -29,15 +47,21 @@ using ::testing::ElementsAreArray;
 
 class Conv3dOpModel : public SingleOpModel {
  public:
-  Conv3dOpModel(const TensorData& input, const TensorData& filter,
-                const TensorData& bias, const TensorData& output,
-                Padding padding = Padding_VALID, int32_t stride_depth = 1,
-                int32_t stride_width = 1, int32_t stride_height = 1,
+  Conv3dOpModel(TfLiteRegistration* registration, const TensorData& input,
+                const TensorData& filter, const TensorData& bias,
+                const TensorData& output, Padding padding = Padding_VALID,
+                int32_t stride_depth = 1, int32_t stride_width = 1,
+                int32_t stride_height = 1,
                 ActivationFunctionType activation = ActivationFunctionType_NONE,
                 int32_t dilation_depth = 1, int32_t dilation_width = 1,
-                int32_t dilation_height = 1) {
+                int32_t dilation_height = 1, int num_threads = -1,
+                std::initializer_list<float> filter_data = {}) {
     input_ = AddInput(input);
-    filter_ = AddInput(filter);
+    if (filter_data.size()) {
+      filter_ = AddConstInput(filter, filter_data);
+    } else {
+      filter_ = AddInput(filter);
+    }
     bias_ = AddInput(bias);
     output_ = AddOutput(output);
     SetBuiltinOp(
@@ -46,11 +70,16 @@ class Conv3dOpModel : public SingleOpModel {
                             stride_height, activation, dilation_depth,
                             dilation_width, dilation_height)
             .Union());
-    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_3D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
-  Conv3dOpModel(const TensorData& input, const TensorData& filter,
-                const TensorData& output, Padding padding = Padding_VALID,
+  Conv3dOpModel(TfLiteRegistration* registration, const TensorData& input,
+                const TensorData& filter, const TensorData& output,
+                Padding padding = Padding_VALID,
                 int32_t stride_depth = 1, int32_t stride_width = 1,
                 int32_t stride_height = 1,
                 ActivationFunctionType activation = ActivationFunctionType_NONE,
@@ -65,15 +94,25 @@ class Conv3dOpModel : public SingleOpModel {
                             stride_height, activation, dilation_depth,
                             dilation_width, dilation_height)
             .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_3D,
+                                                    registration);
     BuildInterpreter({GetShape(input_), GetShape(filter_)});
   }
 
   void SetFilter(std::initializer_list<float> f) { PopulateTensor(filter_, f); }
+  void SetFilter(const std::vector<float>& f) { PopulateTensor(filter_, f); }
 
   void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
 
   void SetInput(std::vector<float> data) { PopulateTensor(input_, data); }
 
+  // Resizes the input and prepares the model again.
+  void ResizeInput(const std::vector<int>& shape) {
+    ASSERT_EQ(interpreter_->ResizeInputTensor(input_, shape), kTfLiteOk);
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
 
@@ -91,39 +130,62 @@ std::vector<T> CreateRangeVector(int N) {
   return result;
 }
 
-TEST(Conv3dOpModel, InvalidInputDimsTest) {
-  EXPECT_DEATH_IF_SUPPORTED(Conv3dOpModel m({TensorType_FLOAT32, {2, 2, 4, 1}},
-                                            {TensorType_FLOAT32, {3, 2, 2, 1}},
-                                            {TensorType_FLOAT32, {}}),
-                            "input->dims->size != 5");
+// Returns n values of (i % period) * scale + offset. With a scale of a power
+// of two these are summed exactly whatever the order, so the optimized kernel
+// gives the same output as the reference one.
+std::vector<float> CreatePatternVector(int n, int period, float scale,
+                                       float offset) {
+  std::vector<float> result;
+  for (int i = 0; i < n; ++i) result.push_back((i % period) * scale + offset);
+  return result;
 }
 
-TEST(Conv3dOpModel, InvalidFilterDimsTest) {
+const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
+    {"Reference", ops::builtin::Register_CONV_3D_REF()},
+    {"GenericOptimized", ops::builtin::Register_CONV_3D_GENERIC_OPT()},
+});
+
+class Conv3dOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kKernelMap;
+  }
+};
+
+TEST_P(Conv3dOpTest, InvalidInputDimsTest) {
   EXPECT_DEATH_IF_SUPPORTED(
-      Conv3dOpModel m({TensorType_FLOAT32, {1, 2, 2, 4, 1}},
+      Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {2, 2, 4, 1}},
+                      {TensorType_FLOAT32, {3, 2, 2, 1}},
+                      {TensorType_FLOAT32, {}}),
+      "input->dims->size != 5");
+}
+
+TEST_P(Conv3dOpTest, InvalidFilterDimsTest) {
+  EXPECT_DEATH_IF_SUPPORTED(
+      Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 4, 1}},
                       {TensorType_FLOAT32, {3, 2, 2, 1}},
                       {TensorType_FLOAT32, {}}),
       "filter->dims->size != 5");
 }
 
-TEST(Conv3dOpModel, MismatchChannelSizeTest) {
+TEST_P(Conv3dOpTest, MismatchChannelSizeTest) {
   EXPECT_DEATH_IF_SUPPORTED(
-      Conv3dOpModel m({TensorType_FLOAT32, {1, 2, 2, 4, 1}},
+      Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 4, 1}},
                       {TensorType_FLOAT32, {1, 3, 2, 2, 2}},
                       {TensorType_FLOAT32, {}}),
       "input->dims->data.4. != filter->dims->data.3.");
 }
 
-TEST(Conv3dOpModel, MismatchBiasSizeTest) {
+TEST_P(Conv3dOpTest, MismatchBiasSizeTest) {
   EXPECT_DEATH_IF_SUPPORTED(
-      Conv3dOpModel m({TensorType_FLOAT32, {1, 2, 2, 4, 2}},
+      Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 4, 2}},
                       {TensorType_FLOAT32, {1, 3, 2, 2, 1}},
                       {TensorType_FLOAT32, {2}}, {TensorType_FLOAT32, {}}),
       "NumElements.bias. != SizeOfDimension.filter, 4.");
 }
 
-TEST(Conv3dOpModel, SimpleFloat32Test) {
-  Conv3dOpModel m({TensorType_FLOAT32, {1, 2, 2, 4, 2}},
+TEST_P(Conv3dOpTest, SimpleFloat32Test) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 4, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}});
 
@@ -136,8 +198,8 @@ TEST(Conv3dOpModel, SimpleFloat32Test) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({30, 6, 26, 10, 22, 14}));
 }
 
-TEST(Conv3dOpModel, PaddingValidTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {1, 3, 4, 5, 2}},
+TEST_P(Conv3dOpTest, PaddingValidTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 3, 4, 5, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}});
 
@@ -156,8 +218,8 @@ TEST(Conv3dOpModel, PaddingValidTest) {
                         -814, 386, -834, 390, -854, 394, -874, 398}));
 }
 
-TEST(Conv3dOpModel, PaddingSameTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {1, 3, 4, 5, 2}},
+TEST_P(Conv3dOpTest, PaddingSameTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 3, 4, 5, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}}, Padding_SAME);
 
@@ -183,8 +245,8 @@ TEST(Conv3dOpModel, PaddingSameTest) {
            220,  -220, 224,  -224, 228,  -228, 232,  -232, 237,  -237}));
 }
 
-TEST(Conv3dOpModel, StrideTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {2, 2, 3, 4, 2}},
+TEST_P(Conv3dOpTest, StrideTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {2, 2, 3, 4, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}}, Padding_VALID, /*stride_depth=*/2,
                   /*stride_width=*/2, /*stride_height=*/2);
@@ -198,8 +260,8 @@ TEST(Conv3dOpModel, StrideTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({52, 8, 68, 8, 244, 8, 260, 8}));
 }
 
-TEST(Conv3dOpModel, StrideAndPaddingSameTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {2, 2, 3, 4, 2}},
+TEST_P(Conv3dOpTest, StrideAndPaddingSameTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {2, 2, 3, 4, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}}, Padding_SAME, /*stride_depth=*/2,
                   /*stride_width=*/2, /*stride_height=*/2);
@@ -215,8 +277,8 @@ TEST(Conv3dOpModel, StrideAndPaddingSameTest) {
                                 164, -278, 180, -178, 80, -186, 88}));
 }
 
-TEST(Conv3dOpModel, DilationTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {2, 2, 3, 4, 2}},
+TEST_P(Conv3dOpTest, DilationTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {2, 2, 3, 4, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {}}, Padding_VALID, /*stride_depth=*/1,
                   /*stride_width=*/1, /*stride_height=*/1,
@@ -234,8 +296,8 @@ TEST(Conv3dOpModel, DilationTest) {
               ElementsAreArray({52, 8, 60, 8, 68, 8, 244, 8, 252, 8, 260, 8}));
 }
 
-TEST(Conv3dOpModel, BiasTest) {
-  Conv3dOpModel m({TensorType_FLOAT32, {2, 2, 3, 4, 2}},
+TEST_P(Conv3dOpTest, BiasTest) {
+  Conv3dOpModel m(GetRegistration(), {TensorType_FLOAT32, {2, 2, 3, 4, 2}},
                   {TensorType_FLOAT32, {2, 2, 2, 2, 2}},
                   {TensorType_FLOAT32, {2}}, {TensorType_FLOAT32, {}},
                   Padding_VALID, /*stride_depth=*/2,
@@ -252,5 +314,205 @@ TEST(Conv3dOpModel, BiasTest) {
               ElementsAreArray({53, 10, 69, 10, 245, 10, 261, 10}));
 }
 
+// Checks the optimized kernel against the reference one on a model large
+// enough for the im2col to be split between threads.
+TEST(Conv3dOpModel, MultithreadedMatchesReference) {
+  const TensorData input = {TensorType_FLOAT32, {2, 5, 6, 7, 3}};
+  const TensorData filter = {TensorType_FLOAT32, {3, 2, 3, 3, 4}};
+  const TensorData bias = {TensorType_FLOAT32, {4}};
+  const TensorData output = {TensorType_FLOAT32, {}};
+
+  std::vector<float> input_data(2 * 5 * 6 * 7 * 3);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 13) - 6.0f;
+  }
+  std::vector<float> filter_data(3 * 2 * 3 * 3 * 4);
+  for (size_t i = 0; i < filter_data.size(); ++i) {
+    filter_data[i] = static_cast<float>(i % 7) * 0.25f - 0.75f;
+  }
+  const std::vector<float> bias_data = {0.5f, -1.0f, 2.0f, 0.0f};
+
+  Conv3dOpModel reference(
+      ops::builtin::Register_CONV_3D_REF(), input, filter, bias, output,
+      Padding_SAME, /*stride_depth=*/1, /*stride_width=*/2,
+      /*stride_height=*/1, ActivationFunctionType_RELU6,
+      /*dilation_depth=*/2, /*dilation_width=*/1, /*dilation_height=*/2);
+  Conv3dOpModel optimized(
+      ops::builtin::Register_CONV_3D_GENERIC_OPT(), input, filter, bias,
+      output, Padding_SAME, /*stride_depth=*/1, /*stride_width=*/2,
+      /*stride_height=*/1, ActivationFunctionType_RELU6,
+      /*dilation_depth=*/2, /*dilation_width=*/1, /*dilation_height=*/2,
+      /*num_threads=*/4);
+  for (Conv3dOpModel* m : {&reference, &optimized}) {
+    m->SetInput(input_data);
+    m->SetFilter(filter_data);
+    m->SetBias(bias_data);
+    m->Invoke();
+  }
+
+  EXPECT_THAT(optimized.GetOutputShape(),
+              ElementsAreArray(reference.GetOutputShape()));
+  EXPECT_THAT(optimized.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(reference.GetOutput())));
+}
+
+// A constant filter is transposed on the first Eval after each Prepare only,
+// so later invocations, and those after a resize, must still match the
+// reference kernel.
+TEST(Conv3dOpModel, ConstantFilterMatchesReference) {
+  const TensorData input = {TensorType_FLOAT32, {1, 3, 4, 5, 3}};
+  const TensorData filter = {TensorType_FLOAT32, {2, 2, 2, 3, 2}};
+  const TensorData bias = {TensorType_FLOAT32, {2}};
+  const TensorData output = {TensorType_FLOAT32, {}};
+  const std::initializer_list<float> filter_data = {
+      1,  -1, 0.5,  1,    -1, 0.25, -0.5, 1,  1,  1,     -1, -1,
+      -1, 1,  0.75, -0.5, 1,  -1,   1,    -1, -1, 0.5,   1,  -1,
+      -1, 1,  1,    0.5,  -1, 1,    -0.5, 1,  1,  -1,    1,  0.25,
+      1,  -1, -1,   1,    -1, -1,   0.5,  1,  1,  -0.75, 1,  -1};
+
+  Conv3dOpModel reference(
+      ops::builtin::Register_CONV_3D_REF(), input, filter, bias, output,
+      Padding_SAME, /*stride_depth=*/1, /*stride_width=*/1,
+      /*stride_height=*/1, ActivationFunctionType_NONE,
+      /*dilation_depth=*/1, /*dilation_width=*/1, /*dilation_height=*/1,
+      /*num_threads=*/-1, filter_data);
+  Conv3dOpModel optimized(
+      ops::builtin::Register_CONV_3D_GENERIC_OPT(), input, filter, bias,
+      output, Padding_SAME, /*stride_depth=*/1, /*stride_width=*/1,
+      /*stride_height=*/1, ActivationFunctionType_NONE,
+      /*dilation_depth=*/1, /*dilation_width=*/1, /*dilation_height=*/1,
+      /*num_threads=*/-1, filter_data);
+  for (Conv3dOpModel* m : {&reference, &optimized}) {
+    m->SetBias({0.5, -1});
+  }
+
+  for (int offset : {-6, 3}) {
+    for (Conv3dOpModel* m : {&reference, &optimized}) {
+      m->SetInput(CreatePatternVector(1 * 3 * 4 * 5 * 3, 13, 1, offset));
+      m->Invoke();
+    }
+    EXPECT_THAT(optimized.GetOutput(),
+                ElementsAreArray(ArrayFloatNear(reference.GetOutput())));
+  }
+
+  for (Conv3dOpModel* m : {&reference, &optimized}) {
+    m->ResizeInput({2, 3, 5, 4, 3});
+    m->SetBias({0.5, -1});
+    m->SetInput(CreatePatternVector(2 * 3 * 5 * 4 * 3, 11, 1, -5));
+    m->Invoke();
+  }
+  EXPECT_THAT(optimized.GetOutputShape(), ElementsAre(2, 3, 5, 4, 2));
+  EXPECT_THAT(optimized.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(reference.GetOutput())));
+}
+
+// A 1x1x1 filter with unit strides reads the input as its own im2col.
+TEST(Conv3dOpModel, PointwiseMatchesReference) {
+  const TensorData input = {TensorType_FLOAT32, {2, 3, 4, 5, 6}};
+  const TensorData filter = {TensorType_FLOAT32, {1, 1, 1, 6, 3}};
+  const TensorData bias = {TensorType_FLOAT32, {3}};
+  const TensorData output = {TensorType_FLOAT32, {}};
+
+  Conv3dOpModel reference(ops::builtin::Register_CONV_3D_REF(), input, filter,
+                          bias, output, Padding_VALID, /*stride_depth=*/1,
+                          /*stride_width=*/1, /*stride_height=*/1,
+                          ActivationFunctionType_RELU);
+  Conv3dOpModel optimized(
+      ops::builtin::Register_CONV_3D_GENERIC_OPT(), input, filter, bias,
+      output, Padding_VALID, /*stride_depth=*/1, /*stride_width=*/1,
+      /*stride_height=*/1, ActivationFunctionType_RELU,
+      /*dilation_depth=*/1, /*dilation_width=*/1, /*dilation_height=*/1,
+      /*num_threads=*/2);
+  for (Conv3dOpModel* m : {&reference, &optimized}) {
+    m->SetInput(CreatePatternVector(2 * 3 * 4 * 5 * 6, 13, 1, -6));
+    m->SetFilter(CreatePatternVector(6 * 3, 7, 0.25, -0.75));
+    m->SetBias({1, -2, 0.5});
+    m->Invoke();
+  }
+
+  EXPECT_THAT(optimized.GetOutputShape(), ElementsAre(2, 3, 4, 5, 3));
+  EXPECT_THAT(optimized.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(reference.GetOutput())));
+}
+
+// Each output point takes 3 * 3 * 3 * 64 floats of im2col, so the 8MB im2col
+// buffer holds 1213 of the 2560 output points, and the optimized kernel runs
+// in three chunks, the last a partial one.
+TEST(Conv3dOpModel, MultipleIm2colChunksMatchReference) {
+  const TensorData input = {TensorType_FLOAT32, {1, 10, 16, 16, 64}};
+  const TensorData filter = {TensorType_FLOAT32, {3, 3, 3, 64, 2}};
+  const TensorData bias = {TensorType_FLOAT32, {2}};
+  const TensorData output = {TensorType_FLOAT32, {}};
+
+  Conv3dOpModel reference(ops::builtin::Register_CONV_3D_REF(), input, filter,
+                          bias, output, Padding_SAME);
+  Conv3dOpModel optimized(
+      ops::builtin::Register_CONV_3D_GENERIC_OPT(), input, filter, bias,
+      output, Padding_SAME, /*stride_depth=*/1, /*stride_width=*/1,
+      /*stride_height=*/1, ActivationFunctionType_NONE,
+      /*dilation_depth=*/1, /*dilation_width=*/1, /*dilation_height=*/1,
+      /*num_threads=*/2);
+  for (Conv3dOpModel* m : {&reference, &optimized}) {
+    m->SetInput(CreatePatternVector(10 * 16 * 16 * 64, 13, 1, -6));
+    m->SetFilter(CreatePatternVector(27 * 64 * 2, 7, 0.25, -0.75));
+    m->SetBias({0.5, -1});
+    m->Invoke();
+  }
+
+  EXPECT_THAT(optimized.GetOutputShape(), ElementsAre(1, 10, 16, 16, 2));
+  EXPECT_THAT(optimized.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(reference.GetOutput())));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Conv3dOpTest, Conv3dOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
+
+#ifdef CONV3D_BENCHMARKS
+
+// Compile with --copt="-DGOOGLE_COMMANDLINEFLAGS_FULL_API=1" and
+// --copt="-DCONV3D_BENCHMARKS"
+// Run with --benchmarks=all
+void BM_Conv3D(benchmark::State& state, TfLiteRegistration* registration) {
+  const int size = state.range(0);
+  const int channels = state.range(1);
+  const int num_threads = state.range(2);
+
+  Conv3dOpModel m(registration,
+                  {TensorType_FLOAT32, {1, 8, size, size, channels}},
+                  {TensorType_FLOAT32, {3, 3, 3, channels, channels}},
+                  {TensorType_FLOAT32, {channels}}, {TensorType_FLOAT32, {}},
+                  Padding_SAME, /*stride_depth=*/1, /*stride_width=*/1,
+                  /*stride_height=*/1, ActivationFunctionType_NONE,
+                  /*dilation_depth=*/1, /*dilation_width=*/1,
+                  /*dilation_height=*/1, num_threads);
+  m.SetInput(std::vector<float>(8 * size * size * channels, 1.0f));
+  m.SetFilter(std::vector<float>(27 * channels * channels, 0.5f));
+  m.SetBias(std::vector<float>(channels, 0.0f));
+
+  for (auto _ : state) {
+    m.Invoke();
+  }
+}
+
+void BM_Conv3DReference(benchmark::State& state) {
+  BM_Conv3D(state, ops::builtin::Register_CONV_3D_REF());
+}
+BENCHMARK(BM_Conv3DReference)
+    ->Args({16, 16, 1})
+    ->Args({32, 32, 1})
+    ->Args({56, 64, 1});
+
+void BM_Conv3DGenericOptimized(benchmark::State& state) {
+  BM_Conv3D(state, ops::builtin::Register_CONV_3D_GENERIC_OPT());
+}
+BENCHMARK(BM_Conv3DGenericOptimized)
+    ->Args({16, 16, 1})
+    ->Args({32, 32, 1})
+    ->Args({56, 64, 1})
+    ->Args({56, 64, 4});
+
+#endif  // CONV3D_BENCHMARKS
+
 }  // namespace
 }  // namespace tflite
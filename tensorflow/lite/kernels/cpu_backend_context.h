@@ -34,6 +34,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
 
+  // Returns the cache of rearranged constant weights set on the interpreter,
+  // or nullptr if there is none.
+  static PackedWeightsCache* GetPackedWeightsCache(TfLiteContext* context);
+
   CpuBackendContext();
   ~CpuBackendContext() override;
 
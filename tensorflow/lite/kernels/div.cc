@@ -17,8 +17,10 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/lite/kernels/internal/optimized/elementwise_multithread.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
@@ -125,6 +127,19 @@ void EvalDiv(TfLiteContext* context, TfLiteNode* node, TfLiteDivParams* params,
                GetTensorData<data_type>(input1), GetTensorShape(input2), \
                GetTensorData<data_type>(input2), GetTensorShape(output), \
                GetTensorData<data_type>(output))
+#define TF_LITE_DIV_MULTITHREAD(type, opname, broadcast_opname, data_type) \
+  tflite::ArithmeticParams op_params;                                      \
+  data_type output_activation_min, output_activation_max;                  \
+  CalculateActivationRange(params->activation, &output_activation_min,     \
+                           &output_activation_max);                        \
+  SetActivationParams(output_activation_min, output_activation_max,        \
+                      &op_params);                                         \
+  optimized_ops::BinaryArithmeticMultithread(                              \
+      op_params, GetTensorShape(input1), GetTensorData<data_type>(input1), \
+      GetTensorShape(input2), GetTensorData<data_type>(input2),            \
+      GetTensorShape(output), GetTensorData<data_type>(output),            \
+      type::opname, type::broadcast_opname,                                \
+      CpuBackendContext::GetFromContext(context))
   if (output->type == kTfLiteInt32) {
     if (kernel_type == kReference) {
       if (data->requires_broadcast) {
@@ -133,11 +148,7 @@ void EvalDiv(TfLiteContext* context, TfLiteNode* node, TfLiteDivParams* params,
         TF_LITE_DIV(reference_ops, Div, int32_t);
       }
     } else {
-      if (data->requires_broadcast) {
-        TF_LITE_DIV(optimized_ops, BroadcastDivSlow, int32_t);
-      } else {
-        TF_LITE_DIV(optimized_ops, Div, int32_t);
-      }
+      TF_LITE_DIV_MULTITHREAD(optimized_ops, Div, BroadcastDivSlow, int32_t);
     }
   } else if (output->type == kTfLiteFloat32) {
     if (kernel_type == kReference) {
@@ -147,13 +158,10 @@ void EvalDiv(TfLiteContext* context, TfLiteNode* node, TfLiteDivParams* params,
         TF_LITE_DIV(reference_ops, Div, float);
       }
     } else {
-      if (data->requires_broadcast) {
-        TF_LITE_DIV(optimized_ops, BroadcastDivSlow, float);
-      } else {
-        TF_LITE_DIV(optimized_ops, Div, float);
-      }
+      TF_LITE_DIV_MULTITHREAD(optimized_ops, Div, BroadcastDivSlow, float);
     }
   }
+#undef TF_LITE_DIV_MULTITHREAD
 #undef TF_LITE_DIV
 }
 
@@ -186,11 +194,12 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
         TF_LITE_DIV(reference_ops, Div, uint8_t);
       }
     } else {
-      if (need_broadcast) {
-        TF_LITE_DIV(optimized_ops, BroadcastDivSlow, uint8_t);
-      } else {
-        TF_LITE_DIV(optimized_ops, Div, uint8_t);
-      }
+      optimized_ops::BinaryArithmeticMultithread(
+          op_params, GetTensorShape(input1), GetTensorData<uint8_t>(input1),
+          GetTensorShape(input2), GetTensorData<uint8_t>(input2),
+          GetTensorShape(output), GetTensorData<uint8_t>(output),
+          optimized_ops::Div, optimized_ops::BroadcastDivSlow,
+          CpuBackendContext::GetFromContext(context));
     }
 #undef TF_LITE_DIV
   } else {
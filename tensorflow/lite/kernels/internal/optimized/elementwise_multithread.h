@@ -0,0 +1,206 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_ELEMENTWISE_MULTITHREAD_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_ELEMENTWISE_MULTITHREAD_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/reference/process_broadcast_shapes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Elementwise ops are bound by memory bandwidth rather than compute, so a
+// thread is only worth waking up for at least this many output elements.
+constexpr int kMinElementwiseSizePerThread = 16 * 1024;
+
+// Runs `fn` on the slice of a binary elementwise op given by the shapes and
+// data of the task.
+template <typename T, typename Fn>
+struct BinaryElementwiseWorkerTask : cpu_backend_threadpool::Task {
+  BinaryElementwiseWorkerTask(const Fn& fn, const RuntimeShape& input1_shape,
+                              const T* input1_data,
+                              const RuntimeShape& input2_shape,
+                              const T* input2_data,
+                              const RuntimeShape& output_shape, T* output_data)
+      : fn_(fn),
+        input1_shape_(input1_shape),
+        input1_data_(input1_data),
+        input2_shape_(input2_shape),
+        input2_data_(input2_data),
+        output_shape_(output_shape),
+        output_data_(output_data) {}
+
+  void Run() override {
+    fn_(input1_shape_, input1_data_, input2_shape_, input2_data_,
+        output_shape_, output_data_);
+  }
+
+ private:
+  const Fn& fn_;
+  const RuntimeShape input1_shape_;
+  const T* input1_data_;
+  const RuntimeShape input2_shape_;
+  const T* input2_data_;
+  const RuntimeShape output_shape_;
+  T* output_data_;
+};
+
+// Returns the shape of the elements [start, end) of `shape` along `dim`. A
+// dimension of size 1 is broadcast to every slice, so it is kept as is.
+inline RuntimeShape SliceShapeAlongDim(const RuntimeShape& shape, int dim,
+                                       int start, int end) {
+  RuntimeShape slice_shape(shape);
+  if (shape.Dims(dim) != 1) {
+    slice_shape.SetDim(dim, end - start);
+  }
+  return slice_shape;
+}
+
+// Returns the offset of the element `start` along `dim` in the data of
+// `shape`, which is 0 if that dimension is broadcast.
+inline int SliceOffsetAlongDim(const RuntimeShape& shape, int dim, int start) {
+  if (shape.Dims(dim) == 1) {
+    return 0;
+  }
+  int stride = 1;
+  for (int i = dim + 1; i < shape.DimensionsCount(); ++i) {
+    stride *= shape.Dims(i);
+  }
+  return start * stride;
+}
+
+// Splits a binary elementwise op, with or without broadcast, between the
+// threads of `cpu_backend_context`. `fn` is called once per slice, with the
+// same arguments as the op but for the shapes and data of the slice:
+//
+//   fn(input1_shape, input1_data, input2_shape, input2_data, output_shape,
+//      output_data)
+//
+// Inputs of the same shape are split as flat arrays. Otherwise the slices are
+// taken along the outermost dimension of the output that has more than one
+// element, with the shapes extended to the rank of the output. Small ops run
+// `fn` once, on the calling thread.
+template <typename T, typename Fn>
+inline void BinaryElementwiseMultithread(
+    const RuntimeShape& input1_shape, const T* input1_data,
+    const RuntimeShape& input2_shape, const T* input2_data,
+    const RuntimeShape& output_shape, T* output_data, const Fn& fn,
+    CpuBackendContext* cpu_backend_context) {
+  const int flat_size = output_shape.FlatSize();
+  const int max_threads =
+      cpu_backend_context ? cpu_backend_context->max_num_threads() : 1;
+  int thread_count =
+      std::min(max_threads, flat_size / kMinElementwiseSizePerThread);
+  if (thread_count <= 1) {
+    fn(input1_shape, input1_data, input2_shape, input2_data, output_shape,
+       output_data);
+    return;
+  }
+
+  const int dims_count = output_shape.DimensionsCount();
+  const bool is_flat = input1_shape.FlatSize() == flat_size &&
+                       input2_shape.FlatSize() == flat_size;
+  const RuntimeShape split_input1_shape =
+      is_flat ? RuntimeShape({flat_size})
+              : RuntimeShape::ExtendedShape(dims_count, input1_shape);
+  const RuntimeShape split_input2_shape =
+      is_flat ? RuntimeShape({flat_size})
+              : RuntimeShape::ExtendedShape(dims_count, input2_shape);
+  const RuntimeShape split_output_shape =
+      is_flat ? RuntimeShape({flat_size}) : RuntimeShape(output_shape);
+
+  int thread_dim = 0;
+  while (split_output_shape.Dims(thread_dim) == 1) {
+    ++thread_dim;
+  }
+  const int thread_dim_size = split_output_shape.Dims(thread_dim);
+  thread_count = std::min(thread_count, thread_dim_size);
+  if (thread_count <= 1) {
+    fn(input1_shape, input1_data, input2_shape, input2_data, output_shape,
+       output_data);
+    return;
+  }
+
+  std::vector<BinaryElementwiseWorkerTask<T, Fn>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    // Try to distribute the tasks as even as possible.
+    const int end = start + (thread_dim_size - start) / (thread_count - i);
+    tasks.emplace_back(
+        fn, SliceShapeAlongDim(split_input1_shape, thread_dim, start, end),
+        input1_data +
+            SliceOffsetAlongDim(split_input1_shape, thread_dim, start),
+        SliceShapeAlongDim(split_input2_shape, thread_dim, start, end),
+        input2_data +
+            SliceOffsetAlongDim(split_input2_shape, thread_dim, start),
+        SliceShapeAlongDim(split_output_shape, thread_dim, start, end),
+        output_data +
+            SliceOffsetAlongDim(split_output_shape, thread_dim, start));
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+template <typename T>
+using BinaryArithmeticFn = void (*)(const ArithmeticParams&,
+                                    const RuntimeShape&, const T*,
+                                    const RuntimeShape&, const T*,
+                                    const RuntimeShape&, T*);
+
+// Multithreaded version of the usual dispatch of arithmetic ops, which runs
+// `broadcast_fn` if ProcessBroadcastShapes() finds a broadcast and
+// `elementwise_fn` otherwise. The broadcast is worked out again for each
+// slice, as the broadcast shape of `params` doesn't hold for a slice.
+template <typename T>
+inline void BinaryArithmeticMultithread(
+    const ArithmeticParams& params, const RuntimeShape& input1_shape,
+    const T* input1_data, const RuntimeShape& input2_shape,
+    const T* input2_data, const RuntimeShape& output_shape, T* output_data,
+    BinaryArithmeticFn<T> elementwise_fn, BinaryArithmeticFn<T> broadcast_fn,
+    CpuBackendContext* cpu_backend_context) {
+  BinaryElementwiseMultithread(
+      input1_shape, input1_data, input2_shape, input2_data, output_shape,
+      output_data,
+      [&params, elementwise_fn, broadcast_fn](
+          const RuntimeShape& slice_input1_shape, const T* slice_input1_data,
+          const RuntimeShape& slice_input2_shape, const T* slice_input2_data,
+          const RuntimeShape& slice_output_shape, T* slice_output_data) {
+        ArithmeticParams slice_params = params;
+        if (reference_ops::ProcessBroadcastShapes(
+                slice_input1_shape, slice_input2_shape, &slice_params)) {
+          broadcast_fn(slice_params, slice_input1_shape, slice_input1_data,
+                       slice_input2_shape, slice_input2_data,
+                       slice_output_shape, slice_output_data);
+        } else {
+          elementwise_fn(slice_params, slice_input1_shape, slice_input1_data,
+                         slice_input2_shape, slice_input2_data,
+                         slice_output_shape, slice_output_data);
+        }
+      },
+      cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_ELEMENTWISE_MULTITHREAD_H_
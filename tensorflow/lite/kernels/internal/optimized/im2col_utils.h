@@ -15,7 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_IM2COL_UTILS_H_
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_IM2COL_UTILS_H_
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -282,6 +284,90 @@ void Im2col(const ConvParams& params, int kheight, int kwidth,
   }
 }
 
+// Gathers the input values that the output points [first_point, last_point)
+// of a 3D convolution are computed from, the points being numbered in NDHW
+// order. Row `i` of `im2col_data` holds the values for point
+// `first_point + i`, laid out like the filter: [kdepth, kheight, kwidth,
+// input channels]. Values over the padding are filled with `zero_byte`.
+template <typename T>
+void Im2col3D(const Conv3DParams& params, int kdepth, int kheight, int kwidth,
+              uint8 zero_byte, const RuntimeShape& input_shape,
+              const T* input_data, const RuntimeShape& output_shape,
+              int first_point, int last_point, T* im2col_data) {
+  ruy::profiler::ScopeLabel label("Im2col3D");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 5);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 5);
+
+  const int input_channels = input_shape.Dims(4);
+  const int input_width = input_shape.Dims(3);
+  const int input_height = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(1);
+  const int output_width = output_shape.Dims(3);
+  const int output_height = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(1);
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int pad_depth = params.padding_values.depth;
+  // The values under one row of the filter are contiguous in the input when
+  // the filter isn't dilated along the width.
+  const bool contiguous_rows = params.dilation_width == 1;
+  const int filter_row_size = kwidth * input_channels;
+
+  T* dst = im2col_data;
+  for (int point = first_point; point < last_point; ++point) {
+    int index = point;
+    const int out_x = index % output_width;
+    index /= output_width;
+    const int out_y = index % output_height;
+    index /= output_height;
+    const int out_d = index % output_depth;
+    const int batch = index / output_depth;
+    const int in_x_origin = out_x * params.stride_width - pad_width;
+    const int in_y_origin = out_y * params.stride_height - pad_height;
+    const int in_d_origin = out_d * params.stride_depth - pad_depth;
+
+    for (int filter_d = 0; filter_d < kdepth; ++filter_d) {
+      const int in_d = in_d_origin + filter_d * params.dilation_depth;
+      for (int filter_y = 0; filter_y < kheight; ++filter_y) {
+        const int in_y = in_y_origin + filter_y * params.dilation_height;
+        if (in_d < 0 || in_d >= input_depth || in_y < 0 ||
+            in_y >= input_height) {
+          memset(dst, zero_byte, filter_row_size * sizeof(T));
+        } else if (contiguous_rows) {
+          // Copy the part of the row inside the input at once, and pad the
+          // parts to its left and right.
+          const int x_start = std::max(0, -in_x_origin);
+          const int x_end =
+              std::max(x_start, std::min(kwidth, input_width - in_x_origin));
+          memset(dst, zero_byte, x_start * input_channels * sizeof(T));
+          if (x_end > x_start) {
+            memcpy(dst + x_start * input_channels,
+                   input_data + Offset(input_shape, batch, in_d, in_y,
+                                       in_x_origin + x_start, 0),
+                   (x_end - x_start) * input_channels * sizeof(T));
+          }
+          memset(dst + x_end * input_channels, zero_byte,
+                 (kwidth - x_end) * input_channels * sizeof(T));
+        } else {
+          for (int filter_x = 0; filter_x < kwidth; ++filter_x) {
+            const int in_x = in_x_origin + filter_x * params.dilation_width;
+            T* dst_values = dst + filter_x * input_channels;
+            if (in_x < 0 || in_x >= input_width) {
+              memset(dst_values, zero_byte, input_channels * sizeof(T));
+            } else {
+              memcpy(dst_values,
+                     input_data +
+                         Offset(input_shape, batch, in_d, in_y, in_x, 0),
+                     input_channels * sizeof(T));
+            }
+          }
+        }
+        dst += filter_row_size;
+      }
+    }
+  }
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 
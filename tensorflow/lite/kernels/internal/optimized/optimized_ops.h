@@ -1330,6 +1330,136 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
 #endif  //  defined(TF_LITE_USE_CBLAS) && defined(__APPLE__)
 }
 
+struct Im2col3DWorkerTask : cpu_backend_threadpool::Task {
+  Im2col3DWorkerTask(const Conv3DParams& params,
+                     const RuntimeShape& filter_shape,
+                     const RuntimeShape& input_shape, const float* input_data,
+                     const RuntimeShape& output_shape, int first_point,
+                     int last_point, float* im2col_data)
+      : params(params),
+        filter_shape(filter_shape),
+        input_shape(input_shape),
+        input_data(input_data),
+        output_shape(output_shape),
+        first_point(first_point),
+        last_point(last_point),
+        im2col_data(im2col_data) {}
+
+  void Run() override {
+    // NB: the float 0.0f value is represented by all zero bytes.
+    Im2col3D(params, filter_shape.Dims(0), filter_shape.Dims(1),
+             filter_shape.Dims(2), /*zero_byte=*/0, input_shape, input_data,
+             output_shape, first_point, last_point, im2col_data);
+  }
+
+ private:
+  const Conv3DParams& params;
+  const RuntimeShape& filter_shape;
+  const RuntimeShape& input_shape;
+  const float* input_data;
+  const RuntimeShape& output_shape;
+  int first_point;
+  int last_point;
+  float* im2col_data;
+};
+
+// Computes a 3D convolution as the product of the filter and the im2col of
+// the input. The filter is given transposed, with shape [output channels,
+// filter depth * filter height * filter width * input channels]. The output
+// points are processed in chunks of as many points as `im2col_shape` has
+// rows, so the im2col buffer doesn't need to hold the whole unrolled input,
+// and the im2col of each chunk is split between the threads. `im2col_data` is
+// null when the filter is 1x1x1 with unit strides, as the input is then used
+// directly.
+inline void Conv3D(const Conv3DParams& params, const RuntimeShape& input_shape,
+                   const float* input_data, const RuntimeShape& filter_shape,
+                   const float* transposed_filter_data,
+                   const RuntimeShape& bias_shape, const float* bias_data,
+                   const RuntimeShape& output_shape, float* output_data,
+                   const RuntimeShape& im2col_shape, float* im2col_data,
+                   CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Conv3D");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 5);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 5);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 5);
+
+  const int input_channels = MatchingDim(input_shape, 4, filter_shape, 3);
+  const int output_channels = MatchingDim(filter_shape, 4, output_shape, 4);
+  const int filter_size = FlatSizeSkipDim(filter_shape, 4);
+  const int num_points = FlatSizeSkipDim(output_shape, 4);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_channels);
+  }
+
+  int points_per_chunk = num_points;
+  if (im2col_data) {
+    TFLITE_DCHECK_EQ(im2col_shape.DimensionsCount(), 2);
+    TFLITE_DCHECK_EQ(im2col_shape.Dims(1), filter_size);
+    points_per_chunk = im2col_shape.Dims(0);
+  } else {
+    TFLITE_DCHECK_EQ(filter_size, input_channels);
+    TFLITE_DCHECK_EQ(FlatSizeSkipDim(input_shape, 4), num_points);
+  }
+
+  cpu_backend_gemm::MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = output_channels;
+  lhs_params.cols = filter_size;
+  cpu_backend_gemm::MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = filter_size;
+  cpu_backend_gemm::MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = output_channels;
+  cpu_backend_gemm::GemmParams<float, float> gemm_params;
+  gemm_params.bias = bias_data;
+  gemm_params.clamp_min = params.float_activation_min;
+  gemm_params.clamp_max = params.float_activation_max;
+
+  // Copying is cheap compared to the product, so a thread only gets a part of
+  // the im2col if it has enough points to copy.
+  constexpr int kMinPointsPerThread = 16;
+  std::vector<Im2col3DWorkerTask> tasks;
+  for (int first_point = 0; first_point < num_points;
+       first_point += points_per_chunk) {
+    const int last_point = std::min(first_point + points_per_chunk, num_points);
+    const int chunk_points = last_point - first_point;
+    const float* gemm_input_data = nullptr;
+    if (im2col_data) {
+      const int thread_count =
+          std::max(1, std::min(chunk_points / kMinPointsPerThread,
+                               cpu_backend_context->max_num_threads()));
+      tasks.clear();
+      tasks.reserve(thread_count);
+      int start = first_point;
+      for (int i = 0; i < thread_count; ++i) {
+        // Try to distribute the tasks as even as possible.
+        const int end = start + (last_point - start) / (thread_count - i);
+        tasks.emplace_back(params, filter_shape, input_shape, input_data,
+                           output_shape, start, end,
+                           im2col_data + (start - first_point) * filter_size);
+        start = end;
+      }
+      if (thread_count == 1) {
+        tasks[0].Run();
+      } else {
+        cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                        cpu_backend_context);
+      }
+      gemm_input_data = im2col_data;
+    } else {
+      gemm_input_data = input_data + first_point * input_channels;
+    }
+
+    rhs_params.cols = chunk_points;
+    dst_params.cols = chunk_points;
+    cpu_backend_gemm::Gemm(lhs_params, transposed_filter_data, rhs_params,
+                           gemm_input_data, dst_params,
+                           output_data + first_point * output_channels,
+                           gemm_params, cpu_backend_context);
+  }
+}
+
 inline void HybridConv(const ConvParams& params, float* scaling_factors_ptr,
                        const RuntimeShape& input_shape,
                        const int8_t* input_data,
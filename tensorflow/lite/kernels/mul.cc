@@ -19,8 +19,10 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/lite/kernels/internal/optimized/elementwise_multithread.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
@@ -128,6 +130,18 @@ void EvalMul(TfLiteContext* context, TfLiteNode* node, TfLiteMulParams* params,
                GetTensorData<data_type>(input1), GetTensorShape(input2), \
                GetTensorData<data_type>(input2), GetTensorShape(output), \
                GetTensorData<data_type>(output))
+#define TF_LITE_MUL_MULTITHREAD(type, opname, broadcast_opname, data_type) \
+  data_type output_activation_min, output_activation_max;                  \
+  CalculateActivationRange(params->activation, &output_activation_min,     \
+                           &output_activation_max);                        \
+  SetActivationParams(output_activation_min, output_activation_max,        \
+                      &op_params);                                         \
+  optimized_ops::BinaryArithmeticMultithread(                              \
+      op_params, GetTensorShape(input1), GetTensorData<data_type>(input1), \
+      GetTensorShape(input2), GetTensorData<data_type>(input2),            \
+      GetTensorShape(output), GetTensorData<data_type>(output),            \
+      type::opname, type::broadcast_opname,                                \
+      CpuBackendContext::GetFromContext(context))
 
   if (output->type == kTfLiteInt32) {
     if (kernel_type == kReference) {
@@ -137,11 +151,7 @@ void EvalMul(TfLiteContext* context, TfLiteNode* node, TfLiteMulParams* params,
         TF_LITE_MUL(reference_ops, Mul, int32_t);
       }
     } else {
-      if (need_broadcast) {
-        TF_LITE_MUL(optimized_ops, BroadcastMul4DSlow, int32_t);
-      } else {
-        TF_LITE_MUL(optimized_ops, Mul, int32_t);
-      }
+      TF_LITE_MUL_MULTITHREAD(optimized_ops, Mul, BroadcastMul4DSlow, int32_t);
     }
   } else if (output->type == kTfLiteFloat32) {
     if (kernel_type == kReference) {
@@ -151,13 +161,10 @@ void EvalMul(TfLiteContext* context, TfLiteNode* node, TfLiteMulParams* params,
         TF_LITE_MUL(reference_ops, Mul, float);
       }
     } else {
-      if (need_broadcast) {
-        TF_LITE_MUL(optimized_ops, BroadcastMulDispatch, float);
-      } else {
-        TF_LITE_MUL(optimized_ops, Mul, float);
-      }
+      TF_LITE_MUL_MULTITHREAD(optimized_ops, Mul, BroadcastMulDispatch, float);
     }
   }
+#undef TF_LITE_MUL_MULTITHREAD
 #undef TF_LITE_MUL
 }
 
@@ -184,6 +191,13 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                GetTensorData<dtype>(input1), GetTensorShape(input2), \
                GetTensorData<dtype>(input2), GetTensorShape(output), \
                GetTensorData<dtype>(output))
+#define TF_LITE_MUL_MULTITHREAD(type, opname, broadcast_opname, dtype) \
+  optimized_ops::BinaryArithmeticMultithread(                          \
+      op_params, GetTensorShape(input1), GetTensorData<dtype>(input1), \
+      GetTensorShape(input2), GetTensorData<dtype>(input2),            \
+      GetTensorShape(output), GetTensorData<dtype>(output),            \
+      type::opname, type::broadcast_opname,                            \
+      CpuBackendContext::GetFromContext(context))
     if (input1->type == kTfLiteInt8) {
       if (kernel_type == kReference) {
         if (need_broadcast) {
@@ -192,11 +206,8 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           TF_LITE_MUL(reference_integer_ops, Mul, int8_t);
         }
       } else {
-        if (need_broadcast) {
-          TF_LITE_MUL(optimized_integer_ops, BroadcastMulDispatch, int8_t);
-        } else {
-          TF_LITE_MUL(optimized_integer_ops, Mul, int8_t);
-        }
+        TF_LITE_MUL_MULTITHREAD(optimized_integer_ops, Mul,
+                                BroadcastMulDispatch, int8_t);
       }
     } else if (input1->type == kTfLiteInt16) {
       // We have this check, because in case of int16
@@ -223,13 +234,11 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           TF_LITE_MUL(reference_ops, Mul, uint8_t);
         }
       } else {
-        if (need_broadcast) {
-          TF_LITE_MUL(optimized_ops, BroadcastMulDispatch, uint8_t);
-        } else {
-          TF_LITE_MUL(optimized_ops, Mul, uint8_t);
-        }
+        TF_LITE_MUL_MULTITHREAD(optimized_ops, Mul, BroadcastMulDispatch,
+                                uint8_t);
       }
     }
+#undef TF_LITE_MUL_MULTITHREAD
 #undef TF_LITE_MUL
   } else if (input1->type == kTfLiteInt16 && input2->type == kTfLiteInt16 &&
              (output->type == kTfLiteUInt8 || output->type == kTfLiteInt8)) {
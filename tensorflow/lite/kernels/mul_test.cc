@@ -32,17 +32,21 @@ class BaseMulOpModel : public SingleOpModel {
  public:
   BaseMulOpModel(const TensorData& input1, const TensorData& input2,
                  const TensorData& output,
-                 ActivationFunctionType activation_type) {
+                 ActivationFunctionType activation_type,
+                 int num_threads = -1) {
     input1_ = AddInput(input1);
     input2_ = AddInput(input2);
     output_ = AddOutput(output);
     SetBuiltinOp(BuiltinOperator_MUL, BuiltinOptions_MulOptions,
                  CreateMulOptions(builder_, activation_type).Union());
-    BuildInterpreter({GetShape(input1_), GetShape(input2_)});
+    BuildInterpreter({GetShape(input1_), GetShape(input2_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   int input1() { return input1_; }
   int input2() { return input2_; }
+  int output() { return output_; }
 
  protected:
   int input1_;
@@ -488,5 +492,84 @@ TEST(QuantizedMulOpTest, QuantizedWithMixedBroadcastInt8) {
   QuantizedWithMixedBroadcast<TensorType_INT8, int8_t>();
 }
 
+// Output shape of more than kMinElementwiseSizePerThread elements for each of
+// 4 threads. Neither its 67 rows nor its flat size split evenly between them.
+const std::vector<int> kMultithreadedShape = {1, 67, 33, 31};
+const std::vector<int> kMultithreadedBroadcastShape = {1, 1, 33, 31};
+
+// Returns `size` values cycling through [min, max] in steps of `step`.
+template <typename T>
+std::vector<T> CyclicData(int size, int min, int max, int step) {
+  std::vector<T> data(size);
+  for (int i = 0; i < size; ++i) {
+    data[i] = static_cast<T>(min + (i * step) % (max - min + 1));
+  }
+  return data;
+}
+
+int ShapeSize(const std::vector<int>& shape) {
+  int size = 1;
+  for (int dim : shape) {
+    size *= dim;
+  }
+  return size;
+}
+
+// Checks that MUL gives the same output with 4 threads as with 1, for input2
+// of `input2_shape` and raw input values in [data_min, data_max]. 8-bit
+// tensors are quantized to [quantized_min, quantized_max].
+template <TensorType tensor_type, typename T>
+void MultithreadedMatchesSingleThreaded(const std::vector<int>& input2_shape,
+                                        int data_min, int data_max,
+                                        float quantized_min = 0.0f,
+                                        float quantized_max = 0.0f) {
+  std::vector<T> outputs[2];
+  const int thread_counts[2] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    BaseMulOpModel m(
+        {tensor_type, kMultithreadedShape, quantized_min, quantized_max},
+        {tensor_type, input2_shape, quantized_min, quantized_max},
+        {tensor_type, {}, quantized_min, quantized_max},
+        ActivationFunctionType_NONE, thread_counts[i]);
+    m.PopulateTensor<T>(m.input1(),
+                        CyclicData<T>(ShapeSize(kMultithreadedShape),
+                                      data_min, data_max, /*step=*/7));
+    m.PopulateTensor<T>(m.input2(),
+                        CyclicData<T>(ShapeSize(input2_shape), data_min,
+                                      data_max, /*step=*/5));
+    m.Invoke();
+    outputs[i] = m.ExtractVector<T>(m.output());
+  }
+  EXPECT_THAT(outputs[1], ElementsAreArray(outputs[0]));
+}
+
+TEST(FloatMulOpTest, MultithreadedMatchesSingleThreaded) {
+  MultithreadedMatchesSingleThreaded<TensorType_FLOAT32, float>(
+      kMultithreadedShape, -8, 8);
+  MultithreadedMatchesSingleThreaded<TensorType_FLOAT32, float>(
+      kMultithreadedBroadcastShape, -8, 8);
+}
+
+TEST(IntegerMulOpTest, MultithreadedMatchesSingleThreaded) {
+  MultithreadedMatchesSingleThreaded<TensorType_INT32, int32_t>(
+      kMultithreadedShape, -8, 8);
+  MultithreadedMatchesSingleThreaded<TensorType_INT32, int32_t>(
+      kMultithreadedBroadcastShape, -8, 8);
+}
+
+TEST(QuantizedMulOpTest, MultithreadedMatchesSingleThreadedUInt8) {
+  MultithreadedMatchesSingleThreaded<TensorType_UINT8, uint8_t>(
+      kMultithreadedShape, 0, 255, -1.0f, 1.0f);
+  MultithreadedMatchesSingleThreaded<TensorType_UINT8, uint8_t>(
+      kMultithreadedBroadcastShape, 0, 255, -1.0f, 1.0f);
+}
+
+TEST(QuantizedMulOpTest, MultithreadedMatchesSingleThreadedInt8) {
+  MultithreadedMatchesSingleThreaded<TensorType_INT8, int8_t>(
+      kMultithreadedShape, -128, 127, -1.0f, 1.0f);
+  MultithreadedMatchesSingleThreaded<TensorType_INT8, int8_t>(
+      kMultithreadedBroadcastShape, -128, 127, -1.0f, 1.0f);
+}
+
 }  // namespace
 }  // namespace tflite
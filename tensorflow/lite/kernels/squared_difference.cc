@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/elementwise_multithread.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/binary_function.h"
@@ -174,38 +176,58 @@ void EvalQuantizedSquaredDifference(TfLiteContext* context, TfLiteNode* node,
                                     const TfLiteTensor* input1,
                                     const TfLiteTensor* input2,
                                     TfLiteTensor* output) {
-  const auto* op_data = static_cast<const OpData*>(node->user_data);
-  if (data->requires_broadcast) {
-    reference_integer_ops::BroadcastBinaryFunction4DSlow(
-        op_data->arithmetic_params, GetTensorShape(input1),
-        GetTensorData<T>(input1), GetTensorShape(input2),
-        GetTensorData<T>(input2), GetTensorShape(output),
-        GetTensorData<T>(output), reference_integer_ops::CheckArithmeticParams,
-        SquaredDifference);
-  } else {
-    const int flat_size = GetTensorShape(input1).FlatSize();
-    reference_integer_ops::ElementWise(
-        flat_size, op_data->arithmetic_params, GetTensorData<int8_t>(input1),
-        GetTensorData<int8_t>(input2), GetTensorData<int8_t>(output),
-        reference_integer_ops::CheckArithmeticParams, SquaredDifference);
-  }
+  const ArithmeticParams& params = data->arithmetic_params;
+  const bool requires_broadcast = data->requires_broadcast;
+  optimized_ops::BinaryElementwiseMultithread(
+      GetTensorShape(input1), GetTensorData<T>(input1), GetTensorShape(input2),
+      GetTensorData<T>(input2), GetTensorShape(output),
+      GetTensorData<T>(output),
+      [&params, requires_broadcast](const RuntimeShape& input1_shape,
+                                    const T* input1_data,
+                                    const RuntimeShape& input2_shape,
+                                    const T* input2_data,
+                                    const RuntimeShape& output_shape,
+                                    T* output_data) {
+        if (requires_broadcast) {
+          reference_integer_ops::BroadcastBinaryFunction4DSlow(
+              params, input1_shape, input1_data, input2_shape, input2_data,
+              output_shape, output_data,
+              reference_integer_ops::CheckArithmeticParams, SquaredDifference);
+        } else {
+          reference_integer_ops::ElementWise(
+              MatchingFlatSize(input1_shape, input2_shape, output_shape),
+              params, input1_data, input2_data, output_data,
+              reference_integer_ops::CheckArithmeticParams, SquaredDifference);
+        }
+      },
+      CpuBackendContext::GetFromContext(context));
 }
 
 template <typename T>
 void EvalSquaredDifference(TfLiteContext* context, TfLiteNode* node,
                            const OpData* data, const TfLiteTensor* input1,
                            const TfLiteTensor* input2, TfLiteTensor* output) {
-  if (data->requires_broadcast) {
-    reference_ops::BroadcastBinaryFunction4DSlow<T, T, T>(
-        GetTensorShape(input1), GetTensorData<T>(input1),
-        GetTensorShape(input2), GetTensorData<T>(input2),
-        GetTensorShape(output), GetTensorData<T>(output), SquaredDifference<T>);
-  } else {
-    reference_ops::BinaryFunction<T, T, T>(
-        GetTensorShape(input1), GetTensorData<T>(input1),
-        GetTensorShape(input2), GetTensorData<T>(input2),
-        GetTensorShape(output), GetTensorData<T>(output), SquaredDifference<T>);
-  }
+  const bool requires_broadcast = data->requires_broadcast;
+  optimized_ops::BinaryElementwiseMultithread(
+      GetTensorShape(input1), GetTensorData<T>(input1), GetTensorShape(input2),
+      GetTensorData<T>(input2), GetTensorShape(output),
+      GetTensorData<T>(output),
+      [requires_broadcast](const RuntimeShape& input1_shape,
+                           const T* input1_data,
+                           const RuntimeShape& input2_shape,
+                           const T* input2_data,
+                           const RuntimeShape& output_shape, T* output_data) {
+        if (requires_broadcast) {
+          reference_ops::BroadcastBinaryFunction4DSlow<T, T, T>(
+              input1_shape, input1_data, input2_shape, input2_data,
+              output_shape, output_data, SquaredDifference<T>);
+        } else {
+          reference_ops::BinaryFunction<T, T, T>(
+              input1_shape, input1_data, input2_shape, input2_data,
+              output_shape, output_data, SquaredDifference<T>);
+        }
+      },
+      CpuBackendContext::GetFromContext(context));
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
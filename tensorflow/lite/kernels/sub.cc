@@ -22,8 +22,10 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/lite/kernels/internal/optimized/elementwise_multithread.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
@@ -324,17 +326,12 @@ void EvalSubImpl(TfLiteContext* context, TfLiteNode* node,
       break;
     case kGenericOptimized:
     case kNeonOptimized:
-      if (requires_broadcast) {
-        optimized_ops::BroadcastSubSlow(
-            op_params, GetTensorShape(input1), GetTensorData<data_type>(input1),
-            GetTensorShape(input2), GetTensorData<data_type>(input2),
-            GetTensorShape(output), GetTensorData<data_type>(output));
-      } else {
-        optimized_ops::SubWithActivation(
-            op_params, GetTensorShape(input1), GetTensorData<data_type>(input1),
-            GetTensorShape(input2), GetTensorData<data_type>(input2),
-            GetTensorShape(output), GetTensorData<data_type>(output));
-      }
+      optimized_ops::BinaryArithmeticMultithread(
+          op_params, GetTensorShape(input1), GetTensorData<data_type>(input1),
+          GetTensorShape(input2), GetTensorData<data_type>(input2),
+          GetTensorShape(output), GetTensorData<data_type>(output),
+          optimized_ops::SubWithActivation, optimized_ops::BroadcastSubSlow,
+          CpuBackendContext::GetFromContext(context));
       break;
   }
 }
@@ -416,14 +413,12 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
         TF_LITE_SUB(reference_ops, Add, uint8_t);
       }
     } else {
-      if (need_broadcast) {
-        optimized_ops::BroadcastAddDispatch(
-            op_params, GetTensorShape(input1), GetTensorData<uint8_t>(input1),
-            GetTensorShape(input2), GetTensorData<uint8_t>(input2),
-            GetTensorShape(output), GetTensorData<uint8_t>(output));
-      } else {
-        TF_LITE_SUB(optimized_ops, Add, uint8_t);
-      }
+      optimized_ops::BinaryArithmeticMultithread(
+          op_params, GetTensorShape(input1), GetTensorData<uint8_t>(input1),
+          GetTensorShape(input2), GetTensorData<uint8_t>(input2),
+          GetTensorShape(output), GetTensorData<uint8_t>(output),
+          optimized_ops::Add, optimized_ops::BroadcastAddDispatch,
+          CpuBackendContext::GetFromContext(context));
     }
   } else {
     // In the case of 16-bit sub with POT scaling, we use the sub kernels as
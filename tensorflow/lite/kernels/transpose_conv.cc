@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/packed_weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -197,10 +198,33 @@ TfLiteStatus ResizeAndTransposeWeights(TfLiteContext* context,
   transposed_weights_shape_array->data[2] = input_shape.Dims(0);
   transposed_weights_shape_array->data[3] = input_shape.Dims(3);
 
+  // Constant weights are transposed once per model if there is a packed
+  // weights cache, and then used from its file.
+  PackedWeightsCache* packed_weights_cache =
+      IsConstantTensor(weights)
+          ? CpuBackendContext::GetPackedWeightsCache(context)
+          : nullptr;
+  const void* cached_weights =
+      packed_weights_cache
+          ? packed_weights_cache->Lookup(
+                weights, PackedWeightsCache::kTransposeConvWeights,
+                weights->bytes)
+          : nullptr;
+
   transposed_weights->type = weights->type;
-  transposed_weights->allocation_type = kTfLiteDynamic;
+  // The weights may be in the cache since the last time the node was prepared.
+  if (transposed_weights->allocation_type == kTfLiteCustom) {
+    transposed_weights->data.raw = nullptr;
+  }
+  transposed_weights->allocation_type =
+      cached_weights ? kTfLiteCustom : kTfLiteDynamic;
   TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, transposed_weights,
                                               transposed_weights_shape_array));
+  if (cached_weights) {
+    transposed_weights->data.raw =
+        static_cast<char*>(const_cast<void*>(cached_weights));
+    return kTfLiteOk;
+  }
 
   // Transpose the weights from OHWI order to HWOI order.
   TransposeParams transpose_params;
@@ -234,6 +258,12 @@ TfLiteStatus ResizeAndTransposeWeights(TfLiteContext* context,
     return kTfLiteError;
   }
 
+  if (packed_weights_cache) {
+    packed_weights_cache->Insert(weights,
+                                 PackedWeightsCache::kTransposeConvWeights,
+                                 transposed_weights->data.raw,
+                                 transposed_weights->bytes);
+  }
   return kTfLiteOk;
 }
 
@@ -40,6 +40,7 @@ AllOpsResolver::AllOpsResolver() {
   AddGreater();
   AddGreaterEqual();
   AddHardSwish();
+  AddIf();
   AddL2Normalization();
   AddLess();
   AddLessEqual();
@@ -79,6 +80,7 @@ AllOpsResolver::AllOpsResolver() {
   AddSvdf();
   AddTanh();
   AddUnpack();
+  AddWhile();
 }
 
 }  // namespace tflite
@@ -0,0 +1,92 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/micro/system_setup.h"
+
+/*
+ * Memory planner benchmark. Times GreedyMemoryPlanner on synthetic graphs of
+ * 500 to 2000 buffers, shaped like a large model: a chain of activations with
+ * some long-lived skip connections, and a scratch buffer for some operators.
+ */
+
+namespace tflite {
+
+constexpr int kMaxBufferCount = 2000;
+constexpr int kBufferCounts[] = {500, 1000, 2000};
+
+// Enough for GreedyMemoryPlanner::per_buffer_size() bytes per buffer.
+constexpr int kScratchBufferSize = kMaxBufferCount * 64;
+alignas(16) uint8_t scratch_buffer[kScratchBufferSize];
+
+// A fixed pseudo-random sequence, so every target plans the same graphs.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+TfLiteStatus AddSyntheticGraph(ErrorReporter* error_reporter,
+                               MemoryPlanner* planner, int buffer_count) {
+  uint32_t state = 1;
+  int op = 0;
+  for (int i = 0; i < buffer_count; ++i) {
+    const uint32_t kind = NextRandom(&state) % 8;
+    // Sizes are multiples of 16 bytes, as in MicroAllocator.
+    const int size = 16 * (1 + NextRandom(&state) % 1024);
+    int first_time_used = op;
+    int last_time_used = op + 1;
+    if (kind == 0) {
+      // A skip connection, used again much later.
+      last_time_used = op + 2 + NextRandom(&state) % 32;
+    } else if (kind == 1) {
+      // A scratch buffer, only used by one operator.
+      last_time_used = op;
+    } else {
+      ++op;
+    }
+    TF_LITE_ENSURE_STATUS(planner->AddBuffer(error_reporter, size,
+                                             first_time_used, last_time_used));
+  }
+  return kTfLiteOk;
+}
+
+void PlanNBuffers(int buffer_count) {
+  GreedyMemoryPlanner planner(scratch_buffer, kScratchBufferSize);
+  if (AddSyntheticGraph(GetMicroErrorReporter(), &planner, buffer_count) !=
+      kTfLiteOk) {
+    MicroPrintf("Failed to add %d buffers", buffer_count);
+    return;
+  }
+  // Planning happens on the first query.
+  const int32_t start_ticks = GetCurrentTimeTicks();
+  const size_t arena_size = planner.GetMaximumMemorySize();
+  const int32_t ticks = GetCurrentTimeTicks() - start_ticks;
+  MicroPrintf("GreedyMemoryPlanner(%d buffers) took %d ticks (%d ms), %d bytes",
+              buffer_count, ticks, TicksToMs(ticks),
+              static_cast<int>(arena_size));
+}
+
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  tflite::InitializeTarget();
+  for (int buffer_count : tflite::kBufferCounts) {
+    tflite::PlanNBuffers(buffer_count);
+  }
+}
@@ -0,0 +1,787 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_interpreter.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_ops.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/system_setup.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+/*
+ * xcore kernel benchmark, run on the host. Sweeps the XC_ operators over grids
+ * of shapes, thread counts and channel group sizes. Each point is a model with
+ * a single operator, run through the XCoreInterpreter. The constant tensors
+ * hold pseudo-random data and are fetched from the model as they would be from
+ * flash on the device.
+ *
+ * Prints one JSON object per line (JSON Lines) with the fields
+ *   op, height, width, input_channels, output_channels, threads,
+ *   changrp_size: the point of the grid
+ *   iterations, ns_per_op: the timed invokes and their mean time
+ *   bytes_fetched: bytes copied from external memory per invoke
+ *   macs, macs_per_ns_host: the MACs of one invoke, and per nanosecond of
+ *   host wall clock time. These are not device cycles, so results are only
+ *   comparable between runs on the same host.
+ * Pass an operator name (e.g. XC_fc) to run only that operator.
+ */
+
+namespace tflite {
+namespace {
+
+using tflite::ops::micro::xcore::kBSOChannelGroupLength;
+using tflite::ops::micro::xcore::kChannelGroupLength;
+using tflite::ops::micro::xcore::kMaxThreads;
+
+// Large enough for the double buffered weights of the largest XC_fc
+constexpr int kTensorArenaSize = 2 * 1024 * 1024;
+alignas(16) uint8_t tensor_arena[kTensorArenaSize];
+
+// Each point runs for at least kMinBenchmarkNs and kMinIterations
+constexpr int64_t kMinBenchmarkNs = 50 * 1000 * 1000;
+constexpr int kMinIterations = 5;
+
+//**************************************
+// Single operator models
+//**************************************
+
+// Builds a model with one custom operator. Constant tensors are filled with
+// pseudo-random data unless their data is given.
+class OpModelBuilder {
+ public:
+  typedef int Tensor;
+
+  OpModelBuilder() { buffers_[n_buffers_++] = CreateBuffer(builder_); }
+
+  // Adds a tensor that is allocated in the arena
+  Tensor AddTensor(TensorType type, std::initializer_list<int32_t> shape) {
+    return AddTensorImpl(type, shape, 0);
+  }
+
+  // Adds a constant tensor with pseudo-random data
+  Tensor AddConstTensor(TensorType type, std::initializer_list<int32_t> shape) {
+    size_t bytes = SizeOfType(type);
+    for (int32_t dim : shape) bytes *= dim;
+    builder_.ForceVectorAlignment(bytes, sizeof(uint8_t), 16);
+    uint8_t* data;
+    auto vector = builder_.CreateUninitializedVector(bytes, &data);
+    for (size_t i = 0; i < bytes; i++) data[i] = std::rand() & 0xFF;
+    return AddTensorImpl(type, shape, AddBuffer(vector));
+  }
+
+  // Adds a constant tensor with the given data
+  Tensor AddConstTensor(TensorType type, std::initializer_list<int32_t> shape,
+                        const void* data, size_t bytes) {
+    builder_.ForceVectorAlignment(bytes, sizeof(uint8_t), 16);
+    auto vector =
+        builder_.CreateVector(static_cast<const uint8_t*>(data), bytes);
+    return AddTensorImpl(type, shape, AddBuffer(vector));
+  }
+
+  void SetNode(std::initializer_list<Tensor> inputs,
+               std::initializer_list<Tensor> outputs) {
+    n_inputs_ = 0;
+    n_outputs_ = 0;
+    for (Tensor input : inputs) inputs_[n_inputs_++] = input;
+    for (Tensor output : outputs) outputs_[n_outputs_++] = output;
+  }
+
+  flexbuffers::Builder& options() { return options_; }
+
+  // Finishes the model with the operator's node and custom options. The
+  // returned model has the lifetime of the builder.
+  const Model* Build(const char* opcode) {
+    // the subgraph inputs are the node's inputs that are not constant
+    int32_t subgraph_inputs[kMaxTensors];
+    int n_subgraph_inputs = 0;
+    for (int i = 0; i < n_inputs_; i++) {
+      if (tensor_buffers_[inputs_[i]] == 0) {
+        subgraph_inputs[n_subgraph_inputs++] = inputs_[i];
+      }
+    }
+
+    options_.Finish();
+    const auto operator_code = CreateOperatorCodeDirect(
+        builder_, /*deprecated_builtin_code=*/0, opcode, /*version=*/0,
+        BuiltinOperator_CUSTOM);
+    const auto op = CreateOperator(
+        builder_, 0, builder_.CreateVector(inputs_, n_inputs_),
+        builder_.CreateVector(outputs_, n_outputs_), BuiltinOptions_NONE, 0,
+        builder_.CreateVector(options_.GetBuffer()),
+        CustomOptionsFormat_FLEXBUFFERS);
+    const auto subgraph = CreateSubGraph(
+        builder_, builder_.CreateVector(tensors_, n_tensors_),
+        builder_.CreateVector(subgraph_inputs, n_subgraph_inputs),
+        builder_.CreateVector(outputs_, n_outputs_),
+        builder_.CreateVector(&op, 1));
+    const auto model = CreateModel(
+        builder_, TFLITE_SCHEMA_VERSION,
+        builder_.CreateVector(&operator_code, 1),
+        builder_.CreateVector(&subgraph, 1),
+        builder_.CreateString("xcore kernel benchmark"),
+        builder_.CreateVector(buffers_, n_buffers_));
+    FinishModelBuffer(builder_, model);
+
+    return GetModel(builder_.GetBufferPointer());
+  }
+
+  const uint8_t* data() { return builder_.GetBufferPointer(); }
+  size_t size() { return builder_.GetSize(); }
+
+ private:
+  static constexpr int kMaxTensors = 8;
+
+  static size_t SizeOfType(TensorType type) {
+    switch (type) {
+      case TensorType_INT16:
+        return sizeof(int16_t);
+      case TensorType_INT32:
+        return sizeof(int32_t);
+      default:
+        return sizeof(int8_t);
+    }
+  }
+
+  int AddBuffer(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data) {
+    TFLITE_DCHECK(n_buffers_ < kMaxTensors + 1);
+    buffers_[n_buffers_] = CreateBuffer(builder_, data);
+    return n_buffers_++;
+  }
+
+  Tensor AddTensorImpl(TensorType type, std::initializer_list<int32_t> shape,
+                       int buffer) {
+    TFLITE_DCHECK(n_tensors_ < kMaxTensors);
+    tensors_[n_tensors_] = CreateTensor(
+        builder_, builder_.CreateVector(shape.begin(), shape.size()), type,
+        buffer);
+    tensor_buffers_[n_tensors_] = buffer;
+    return n_tensors_++;
+  }
+
+  flatbuffers::FlatBufferBuilder builder_;
+  flexbuffers::Builder options_;
+
+  flatbuffers::Offset<Buffer> buffers_[kMaxTensors + 1];
+  int n_buffers_ = 0;
+  flatbuffers::Offset<tflite::Tensor> tensors_[kMaxTensors];
+  int tensor_buffers_[kMaxTensors];
+  int n_tensors_ = 0;
+  int32_t inputs_[kMaxTensors];
+  int n_inputs_ = 0;
+  int32_t outputs_[kMaxTensors];
+  int n_outputs_ = 0;
+};
+
+//**************************************
+// Benchmark grid
+//**************************************
+
+struct BenchmarkShape {
+  int32_t height;
+  int32_t width;
+  int32_t input_channels;
+  int32_t output_channels;
+};
+
+struct BenchmarkConfig {
+  BenchmarkShape shape;
+  int n_threads;
+  int changrp_size;
+};
+
+constexpr BenchmarkShape kShapes[] = {
+    {8, 8, 32, 32},
+    {16, 16, 32, 64},
+    {32, 32, 16, 16},
+};
+constexpr int kThreadCounts[] = {1, 2, 4, static_cast<int>(kMaxThreads)};
+constexpr int kChangrpSizes[] = {static_cast<int>(kChannelGroupLength),
+                                 static_cast<int>(kChannelGroupLength / 2)};
+
+// Adds the tensors, node and custom options of an operator to model. Returns
+// the MACs of one invocation, 0 if the operator does no MACs, or -1 to skip a
+// config the operator does not support or does not depend on.
+typedef int32_t (*BuildFunction)(OpModelBuilder& model,
+                                 const BenchmarkConfig& config);
+
+// Operators without channel groups only run with the default size
+static bool is_default_changrp(const BenchmarkConfig& config) {
+  return config.changrp_size == static_cast<int>(kChannelGroupLength);
+}
+
+static int32_t n_changrps(int32_t channels, int changrp_size) {
+  return (channels + changrp_size - 1) / changrp_size;
+}
+
+// Adds the "par" plan: n_threads threads, channel groups of changrp_size
+// channels and (if height > 0) one band of output rows per thread
+static void add_plan(flexbuffers::Builder& fbb, const BenchmarkConfig& config,
+                     int32_t channels, int32_t height, int32_t width) {
+  fbb.Map("par", [&]() {
+    fbb.Int("th", config.n_threads);
+    fbb.Vector("cg", [&]() {
+      for (int32_t start = 0; start < channels; start += config.changrp_size) {
+        fbb.Vector([&]() {
+          fbb.Int(start);
+          fbb.Int(std::min(start + config.changrp_size, channels) - 1);
+        });
+      }
+    });
+    if (height > 0) {
+      fbb.Vector("rc", [&]() {
+        const int32_t n_regions = std::min(height, config.n_threads);
+        for (int32_t i = 0, top = 0; i < n_regions; i++) {
+          const int32_t rows = (height - top) / (n_regions - i);
+          fbb.Vector([&]() {
+            fbb.Int(top);
+            fbb.Int(0);
+            fbb.Int(rows);
+            fbb.Int(width);
+          });
+          top += rows;
+        }
+      });
+    }
+  });
+}
+
+// Adds the "par" plan of an elementwise operator, its n_elements split evenly
+// between n_threads threads
+static void add_elementwise_plan(flexbuffers::Builder& fbb,
+                                 const BenchmarkConfig& config,
+                                 int32_t n_elements) {
+  fbb.Map("par", [&]() {
+    fbb.Int("th", config.n_threads);
+    fbb.Vector("eg", [&]() {
+      for (int i = 0, start = 0; i < config.n_threads; i++) {
+        const int32_t size = (n_elements - start) / (config.n_threads - i);
+        fbb.Int(size);
+        start += size;
+      }
+    });
+  });
+}
+
+static void add_mem(flexbuffers::Builder& fbb, int32_t weights_scratch_size,
+                    int32_t bias_scratch_size) {
+  fbb.Vector("mem", [&]() {
+    fbb.Int(weights_scratch_size);
+    fbb.Int(bias_scratch_size);
+  });
+}
+
+static OpModelBuilder::Tensor add_bso(OpModelBuilder& model, int32_t channels,
+                                      int changrp_size) {
+  return model.AddConstTensor(
+      TensorType_INT16, {n_changrps(channels, changrp_size), 7, 16});
+}
+
+// Shift and scale parameters of XC_add_8, both inputs scaled by one
+static OpModelBuilder::Tensor add_add_params(OpModelBuilder& model) {
+  static const int32_t kParams[] = {0, 1, 0, 1, 0, 0};
+  return model.AddConstTensor(TensorType_INT32, {6}, kParams, sizeof(kParams));
+}
+
+//**************************************
+// Conv2D
+//**************************************
+
+// Returns the MACs, macs_per_output for each output
+static int32_t build_conv2d(OpModelBuilder& model,
+                            const BenchmarkConfig& config,
+                            std::initializer_list<int32_t> weights_shape,
+                            int32_t input_channels, int32_t window_size,
+                            int32_t K_w, int32_t macs_per_output) {
+  const BenchmarkShape& s = config.shape;
+  // windows larger than 1x1 are padded to keep the image size
+  const int32_t pad = window_size / 2;
+
+  auto x = model.AddTensor(TensorType_INT8,
+                           {1, s.height, s.width, input_channels});
+  auto k = model.AddConstTensor(TensorType_INT8, weights_shape);
+  auto bso = add_bso(model, s.output_channels, config.changrp_size);
+  auto y = model.AddTensor(TensorType_INT8,
+                           {1, s.height, s.width, s.output_channels});
+  model.SetNode({x, k, bso}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    fbb.Vector("stride", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+    });
+    fbb.Vector("pad", [&]() {
+      fbb.Int(pad);
+      fbb.Int(pad);
+      fbb.Int(0);
+    });
+    if (K_w > 0) fbb.Int("Kw", K_w);
+    add_plan(fbb, config, s.output_channels, s.height, s.width);
+    // the weights of one channel group are padded like the weights tensor
+    int32_t weights_size = 1;
+    for (int32_t dim : weights_shape) weights_size *= dim;
+    add_mem(fbb, weights_size / s.output_channels * config.changrp_size,
+            kBSOChannelGroupLength * sizeof(int16_t));
+  });
+
+  return s.height * s.width * s.output_channels * macs_per_output;
+}
+
+static int32_t build_conv2d_deep(OpModelBuilder& model,
+                                 const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  return build_conv2d(model, config,
+                      {s.output_channels, 3, 3, s.input_channels},
+                      s.input_channels, 3, 0, 3 * 3 * s.input_channels);
+}
+
+// Shallow input convolutions have 4 input channels, with the rows of the
+// weights padded to 32 bytes
+static int32_t build_conv2d_shallowin(OpModelBuilder& model,
+                                      const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  return build_conv2d(model, config, {s.output_channels, 3, 8, 4}, 4, 3, 3,
+                      3 * 3 * 4);
+}
+
+static int32_t build_conv2d_1x1(OpModelBuilder& model,
+                                const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  return build_conv2d(model, config, {s.output_channels, s.input_channels},
+                      s.input_channels, 1, 0, s.input_channels);
+}
+
+// Depthwise convolutions have output_channels channels, and channel groups
+// that start on a multiple of 16 channels
+static int32_t build_conv2d_depthwise(OpModelBuilder& model,
+                                      const BenchmarkConfig& config) {
+  if (!is_default_changrp(config)) return -1;
+  const BenchmarkShape& s = config.shape;
+  return build_conv2d(model, config, {3, 3, s.output_channels},
+                      s.output_channels, 3, 0, 3 * 3);
+}
+
+//**************************************
+// Fully connected
+//**************************************
+
+// The input is the flattened input image
+static int32_t build_fully_connected(OpModelBuilder& model,
+                                     const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  const int32_t C_in = s.height * s.width * s.input_channels;
+
+  auto x = model.AddTensor(TensorType_INT8, {1, C_in});
+  auto k = model.AddConstTensor(TensorType_INT8, {s.output_channels, C_in});
+  auto bso = add_bso(model, s.output_channels, config.changrp_size);
+  auto y = model.AddTensor(TensorType_INT8, {1, s.output_channels});
+  model.SetNode({x, k, bso}, {y});
+
+  // each thread computes one channel group of a batch
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    add_plan(fbb, config, s.output_channels, 0, 0);
+    add_mem(fbb, config.n_threads * config.changrp_size * C_in,
+            config.n_threads * kBSOChannelGroupLength * sizeof(int16_t));
+  });
+
+  return C_in * s.output_channels;
+}
+
+//**************************************
+// Pooling
+//**************************************
+
+static int32_t build_pool2d(OpModelBuilder& model,
+                            const BenchmarkConfig& config, bool average) {
+  if (!is_default_changrp(config)) return -1;
+  const BenchmarkShape& s = config.shape;
+  const int32_t C = s.input_channels;
+
+  auto x = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  auto y = model.AddTensor(TensorType_INT8, {1, s.height / 2, s.width / 2, C});
+  model.SetNode({x}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    fbb.Vector("pool", [&]() {
+      fbb.Int(2);
+      fbb.Int(2);
+    });
+    fbb.Vector("stride", [&]() {
+      fbb.Int(2);
+      fbb.Int(2);
+    });
+    add_plan(fbb, config, C, s.height / 2, s.width / 2);
+  });
+
+  return average ? s.height * s.width * C : 0;
+}
+
+static int32_t build_maxpool2d(OpModelBuilder& model,
+                               const BenchmarkConfig& config) {
+  return build_pool2d(model, config, false);
+}
+
+static int32_t build_avgpool2d(OpModelBuilder& model,
+                               const BenchmarkConfig& config) {
+  return build_pool2d(model, config, true);
+}
+
+static int32_t build_avgpool2d_global(OpModelBuilder& model,
+                                      const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  const int32_t C = s.input_channels;
+  // bias (int32), scale (int8) and shift (uint16)
+  static const uint8_t kParams[8] = {0, 0, 0, 0, 1, 0, 0, 0};
+
+  auto x = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  auto bss =
+      model.AddConstTensor(TensorType_INT8, {8}, kParams, sizeof(kParams));
+  auto y = model.AddTensor(TensorType_INT8, {1, C});
+  model.SetNode({x, bss}, {y});
+
+  // each thread averages one channel group
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() { add_plan(fbb, config, C, 0, 0); });
+
+  return s.height * s.width * C;
+}
+
+//**************************************
+// Elementwise
+//**************************************
+
+static int32_t build_add_8(OpModelBuilder& model,
+                           const BenchmarkConfig& config) {
+  if (!is_default_changrp(config)) return -1;
+  const BenchmarkShape& s = config.shape;
+  const int32_t C = s.input_channels;
+
+  auto x0 = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  auto x1 = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  auto bss = add_add_params(model);
+  auto y = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  model.SetNode({x0, x1, bss}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() { add_elementwise_plan(fbb, config, s.height * s.width * C); });
+
+  // both inputs are scaled and accumulated
+  return 2 * s.height * s.width * C;
+}
+
+static int32_t build_lookup_8(OpModelBuilder& model,
+                              const BenchmarkConfig& config) {
+  if (!is_default_changrp(config)) return -1;
+  const BenchmarkShape& s = config.shape;
+  const int32_t C = s.input_channels;
+
+  auto x = model.AddTensor(TensorType_UINT8, {1, s.height, s.width, C});
+  auto lut = model.AddConstTensor(TensorType_UINT8, {256});
+  auto y = model.AddTensor(TensorType_UINT8, {1, s.height, s.width, C});
+  model.SetNode({x, lut}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() { add_elementwise_plan(fbb, config, s.height * s.width * C); });
+
+  return 0;
+}
+
+//**************************************
+// Binarized
+//**************************************
+
+// XC_bsign_8 is single threaded
+static int32_t build_bsign_8(OpModelBuilder& model,
+                             const BenchmarkConfig& config) {
+  if (!is_default_changrp(config) || config.n_threads != 1) return -1;
+  const BenchmarkShape& s = config.shape;
+  const int32_t C = s.input_channels;
+  if (C % 32 != 0) return -1;
+
+  auto x = model.AddTensor(TensorType_INT8, {1, s.height, s.width, C});
+  auto y = model.AddTensor(TensorType_INT32, {1, s.height, s.width, C / 32});
+  model.SetNode({x}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {});
+
+  return 0;
+}
+
+// Counts binary MACs, channels are bitpacked 32 to a word
+static int32_t build_bconv2d_bin(OpModelBuilder& model,
+                                 const BenchmarkConfig& config) {
+  if (!is_default_changrp(config)) return -1;
+  const BenchmarkShape& s = config.shape;
+  if (s.input_channels % 32 != 0 || s.output_channels % 32 != 0) return -1;
+  const int32_t out_height = s.height - 2;
+  const int32_t out_width = s.width - 2;
+
+  auto x = model.AddTensor(TensorType_INT32,
+                           {1, s.height, s.width, s.input_channels / 32});
+  auto k = model.AddConstTensor(
+      TensorType_INT32, {s.output_channels, 3, 3, s.input_channels / 32});
+  auto thresholds = model.AddConstTensor(TensorType_INT32, {s.output_channels});
+  auto y = model.AddTensor(TensorType_INT32,
+                           {1, out_height, out_width, s.output_channels / 32});
+  model.SetNode({x, k, thresholds}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    fbb.Vector("K", [&]() {
+      fbb.Int(s.output_channels);
+      fbb.Int(3);
+      fbb.Int(3);
+      fbb.Int(s.input_channels);
+    });
+    fbb.Vector("stride", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+    });
+    add_plan(fbb, config, s.output_channels, out_height, out_width);
+  });
+
+  return out_height * out_width * s.output_channels * 3 * 3 * s.input_channels;
+}
+
+//**************************************
+// Fused
+//**************************************
+
+static int32_t build_conv2d_deep_maxpool2d(OpModelBuilder& model,
+                                           const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+  const int32_t weights_per_channel = 3 * 3 * s.input_channels;
+
+  auto x = model.AddTensor(TensorType_INT8,
+                           {1, s.height, s.width, s.input_channels});
+  auto k = model.AddConstTensor(TensorType_INT8,
+                                {s.output_channels, 3, 3, s.input_channels});
+  auto bso = add_bso(model, s.output_channels, config.changrp_size);
+  auto y = model.AddTensor(TensorType_INT8, {1, s.height / 2, s.width / 2,
+                                             s.output_channels});
+  model.SetNode({x, k, bso}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    fbb.Vector("stride", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+    });
+    fbb.Vector("pad", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+      fbb.Int(0);
+    });
+    fbb.Vector("pool", [&]() {
+      fbb.Int(2);
+      fbb.Int(2);
+    });
+    add_plan(fbb, config, s.output_channels, s.height / 2, s.width / 2);
+    add_mem(fbb, weights_per_channel * config.changrp_size,
+            kBSOChannelGroupLength * sizeof(int16_t));
+  });
+
+  return s.height * s.width * s.output_channels * weights_per_channel;
+}
+
+static int32_t build_conv2d_1x1_add_8(OpModelBuilder& model,
+                                      const BenchmarkConfig& config) {
+  const BenchmarkShape& s = config.shape;
+
+  auto x = model.AddTensor(TensorType_INT8,
+                           {1, s.height, s.width, s.input_channels});
+  auto k = model.AddConstTensor(TensorType_INT8,
+                                {s.output_channels, s.input_channels});
+  auto bso = add_bso(model, s.output_channels, config.changrp_size);
+  auto x1 = model.AddTensor(TensorType_INT8,
+                            {1, s.height, s.width, s.output_channels});
+  auto bss = add_add_params(model);
+  auto y = model.AddTensor(TensorType_INT8,
+                           {1, s.height, s.width, s.output_channels});
+  model.SetNode({x, k, bso, x1, bss}, {y});
+
+  flexbuffers::Builder& fbb = model.options();
+  fbb.Map([&]() {
+    add_plan(fbb, config, s.output_channels, s.height, s.width);
+    add_mem(fbb, s.input_channels * config.changrp_size,
+            kBSOChannelGroupLength * sizeof(int16_t));
+  });
+
+  return s.height * s.width * s.output_channels * (s.input_channels + 2);
+}
+
+//**************************************
+// Operators
+//**************************************
+
+struct OpBenchmark {
+  const char* opcode;
+  TfLiteRegistration* (*registration)();
+  BuildFunction build;
+};
+
+// Not benchmarked:
+//   XC_bconv2d_bin_DI, XC_bconv2d_int8(_DIDO) and XC_bsign_bconv2d_* need
+//   output transforms and layer plans computed by the converter, XC_pad is
+//   under development and XC_argmax_16 and XC_requantize_16_to_8 are not
+//   inserted by the converter.
+namespace xc = tflite::ops::micro::xcore;
+const OpBenchmark kOps[] = {
+    {xc::Conv2D_Deep_OpCode, xc::Register_Conv2D_Deep, build_conv2d_deep},
+    {xc::Conv2D_Shallow_OpCode, xc::Register_Conv2D_Shallow,
+     build_conv2d_shallowin},
+    {xc::Conv2D_1x1_OpCode, xc::Register_Conv2D_1x1, build_conv2d_1x1},
+    {xc::Conv2D_Depthwise_OpCode, xc::Register_Conv2D_Depthwise,
+     build_conv2d_depthwise},
+    {xc::FullyConnected_8_OpCode, xc::Register_FullyConnected_8,
+     build_fully_connected},
+    {xc::MaxPool2D_OpCode, xc::Register_MaxPool2D, build_maxpool2d},
+    {xc::AvgPool2D_OpCode, xc::Register_AvgPool2D, build_avgpool2d},
+    {xc::AvgPool2D_Global_OpCode, xc::Register_AvgPool2D_Global,
+     build_avgpool2d_global},
+    {xc::Add_8_OpCode, xc::Register_Add_8, build_add_8},
+    {xc::Lookup_8_OpCode, xc::Register_Lookup_8, build_lookup_8},
+    {xc::Bsign_8_OpCode, xc::Register_BSign_8, build_bsign_8},
+    {xc::BConv2d_Bitpacked_OpCode, xc::Register_BConv2D_Bitpacked,
+     build_bconv2d_bin},
+    {xc::Conv2D_Deep_MaxPool2D_OpCode, xc::Register_Conv2D_Deep_MaxPool2D,
+     build_conv2d_deep_maxpool2d},
+    {xc::Conv2D_1x1_Add_8_OpCode, xc::Register_Conv2D_1x1_Add_8,
+     build_conv2d_1x1_add_8},
+};
+constexpr int kNumOps = sizeof(kOps) / sizeof(kOps[0]);
+
+using BenchmarkOpResolver = MicroMutableOpResolver<kNumOps>;
+
+//**************************************
+// Runner
+//**************************************
+
+static void set_random_inputs(micro::xcore::XCoreInterpreter& interpreter) {
+  for (size_t i = 0; i < interpreter.inputs_size(); i++) {
+    TfLiteTensor* input = interpreter.input(i);
+    for (size_t j = 0; j < input->bytes; j++) {
+      input->data.uint8[j] = std::rand() & 0xFF;
+    }
+  }
+}
+
+static TfLiteStatus run_invokes(micro::xcore::XCoreInterpreter& interpreter,
+                                int* iterations, int64_t* elapsed_ns) {
+  const auto start = std::chrono::steady_clock::now();
+  int n = 0;
+  int64_t ns = 0;
+  while (ns < kMinBenchmarkNs || n < kMinIterations) {
+    TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+    n++;
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+             .count();
+  }
+  *iterations = n;
+  *elapsed_ns = ns;
+  return kTfLiteOk;
+}
+
+// Runs one point of the grid, and prints its result unless it is skipped
+TfLiteStatus RunBenchmark(const OpBenchmark& op, const BenchmarkConfig& config,
+                          const BenchmarkOpResolver& resolver) {
+  OpModelBuilder builder;
+  const int32_t macs = op.build(builder, config);
+  if (macs < 0) return kTfLiteOk;
+  const Model* model = builder.Build(op.opcode);
+
+  // the constant tensors are fetched from the model, as from flash
+  ops::micro::xcore::SetHostExternalMemory(builder.data(), builder.size());
+
+  int iterations = 0;
+  int64_t elapsed_ns = 0;
+  size_t bytes_fetched = 0;
+  TfLiteStatus status;
+  {
+    micro::xcore::XCoreInterpreter interpreter(
+        model, resolver, tensor_arena, kTensorArenaSize,
+        GetMicroErrorReporter());
+    status = interpreter.AllocateTensors();
+    if (status == kTfLiteOk) {
+      set_random_inputs(interpreter);
+      status = interpreter.Invoke();  // warm up
+    }
+    if (status == kTfLiteOk) {
+      ops::micro::xcore::ResetFetchBytes();
+      status = run_invokes(interpreter, &iterations, &elapsed_ns);
+      bytes_fetched = ops::micro::xcore::GetFetchBytes() / iterations;
+    }
+  }
+  ops::micro::xcore::SetHostExternalMemory(nullptr, 0);
+
+  const BenchmarkShape& s = config.shape;
+  if (status != kTfLiteOk) {
+    MicroPrintf("%s failed for %dx%dx%d->%d, %d threads, changrp size %d",
+                op.opcode, s.height, s.width, s.input_channels,
+                s.output_channels, config.n_threads, config.changrp_size);
+    return status;
+  }
+
+  const double ns_per_op = static_cast<double>(elapsed_ns) / iterations;
+  printf(
+      "{\"op\":\"%s\",\"height\":%d,\"width\":%d,\"input_channels\":%d,"
+      "\"output_channels\":%d,\"threads\":%d,\"changrp_size\":%d,"
+      "\"iterations\":%d,\"ns_per_op\":%.0f,\"bytes_fetched\":%zu,"
+      "\"macs\":%d,\"macs_per_ns_host\":%.3f}\n",
+      op.opcode, s.height, s.width, s.input_channels, s.output_channels,
+      config.n_threads, config.changrp_size, iterations, ns_per_op,
+      bytes_fetched, macs, macs / ns_per_op);
+  fflush(stdout);
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  tflite::InitializeTarget();
+  std::srand(0);
+
+  const char* op_filter = (argc > 1) ? argv[1] : nullptr;
+
+  tflite::BenchmarkOpResolver resolver;
+  for (const auto& op : tflite::kOps) {
+    resolver.AddCustom(op.opcode, op.registration());
+  }
+
+  int n_failed = 0;
+  for (const auto& op : tflite::kOps) {
+    if (op_filter && strcmp(op_filter, op.opcode) != 0) continue;
+    for (const auto& shape : tflite::kShapes) {
+      for (int n_threads : tflite::kThreadCounts) {
+        for (int changrp_size : tflite::kChangrpSizes) {
+          if (tflite::RunBenchmark(op, {shape, n_threads, changrp_size},
+                                   resolver) != kTfLiteOk) {
+            n_failed++;
+          }
+        }
+      }
+    }
+  }
+
+  return (n_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_graph.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kConditionTensor = 0;
+
+struct OpData {
+  int then_subgraph_index;
+  int else_subgraph_index;
+};
+
+// Checks that two tensors passed between subgraphs hold the same data.
+TfLiteStatus CheckMatching(TfLiteContext* context,
+                           const TfLiteEvalTensor* first,
+                           const TfLiteEvalTensor* second) {
+  TF_LITE_ENSURE(context, first != nullptr);
+  TF_LITE_ENSURE(context, second != nullptr);
+  TF_LITE_ENSURE_TYPES_EQ(context, first->type, second->type);
+  size_t first_bytes;
+  size_t second_bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(first, &first_bytes));
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(second, &second_bytes));
+  TF_LITE_ENSURE_EQ(context, first_bytes, second_bytes);
+  return kTfLiteOk;
+}
+
+TfLiteStatus CopyTensor(const TfLiteEvalTensor* from, TfLiteEvalTensor* to) {
+  size_t bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(from, &bytes));
+  if (from->data.raw != to->data.raw) {
+    memcpy(to->data.raw, from->data.raw, bytes);
+  }
+  return kTfLiteOk;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const auto* params = static_cast<const TfLiteIfParams*>(node->builtin_data);
+  data->then_subgraph_index = params->then_subgraph_index;
+  data->else_subgraph_index = params->else_subgraph_index;
+
+  TF_LITE_ENSURE(context, NumInputs(node) > 0);
+
+  // Currently only bool is supported as the condition.
+  const TfLiteEvalTensor* cond =
+      tflite::micro::GetEvalInput(context, node, kConditionTensor);
+  TF_LITE_ENSURE_TYPES_EQ(context, cond->type, kTfLiteBool);
+  TF_LITE_ENSURE_EQ(context, ElementCount(*cond->dims), 1);
+
+  // The first input of the node is the condition. The rest of inputs are
+  // passed to the branch subgraphs.
+  const int num_inputs = NumInputs(node) - 1;
+  const int num_outputs = NumOutputs(node);
+
+  MicroGraph* graph = tflite::micro::GetMicroGraph(context);
+  const int branches[] = {data->then_subgraph_index,
+                          data->else_subgraph_index};
+  for (int subgraph : branches) {
+    TF_LITE_ENSURE(context, subgraph > 0);
+    TF_LITE_ENSURE(context, subgraph < graph->NumSubgraphs());
+    TF_LITE_ENSURE_EQ(context, graph->NumSubgraphInputs(subgraph),
+                      static_cast<size_t>(num_inputs));
+    TF_LITE_ENSURE_EQ(context, graph->NumSubgraphOutputs(subgraph),
+                      static_cast<size_t>(num_outputs));
+
+    // Tensors have static shapes in micro, so the tensors passed to and from
+    // both branches must match those of the node.
+    for (int i = 0; i < num_inputs; ++i) {
+      TF_LITE_ENSURE_OK(
+          context,
+          CheckMatching(context,
+                        tflite::micro::GetEvalInput(context, node, i + 1),
+                        graph->GetSubgraphInput(subgraph, i)));
+    }
+    for (int i = 0; i < num_outputs; ++i) {
+      TF_LITE_ENSURE_OK(
+          context, CheckMatching(context,
+                                 tflite::micro::GetEvalOutput(context, node, i),
+                                 graph->GetSubgraphOutput(subgraph, i)));
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+  const TfLiteEvalTensor* cond =
+      tflite::micro::GetEvalInput(context, node, kConditionTensor);
+  const int subgraph = cond->data.b[0] ? data->then_subgraph_index
+                                       : data->else_subgraph_index;
+
+  // Inputs and outputs are copied between the subgraphs, which are planned
+  // for the whole time the node runs.
+  MicroGraph* graph = tflite::micro::GetMicroGraph(context);
+  for (int i = 0; i < NumInputs(node) - 1; ++i) {
+    TF_LITE_ENSURE_OK(
+        context, CopyTensor(tflite::micro::GetEvalInput(context, node, i + 1),
+                            graph->GetSubgraphInput(subgraph, i)));
+  }
+
+  TF_LITE_ENSURE_OK(context, graph->InvokeSubgraph(subgraph));
+
+  for (int i = 0; i < NumOutputs(node); ++i) {
+    TF_LITE_ENSURE_OK(
+        context, CopyTensor(graph->GetSubgraphOutput(subgraph, i),
+                            tflite::micro::GetEvalOutput(context, node, i)));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteRegistration Register_IF() {
+  return {/*init=*/Init,
+          /*free=*/nullptr,
+          /*prepare=*/Prepare,
+          /*invoke=*/Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace tflite
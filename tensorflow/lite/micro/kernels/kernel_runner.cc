@@ -39,7 +39,7 @@ KernelRunner::KernelRunner(const TfLiteRegistration& registration,
       registration_(registration),
       tensors_(tensors) {
   // Prepare TfLiteContext:
-  context_.impl_ = static_cast<void*>(this);
+  context_.impl_ = static_cast<void*>(static_cast<MicroGraph*>(this));
   context_.ReportError = ReportOpError;
   context_.recommended_num_threads = 1;
   context_.GetTensor = GetTensor;
@@ -73,10 +73,48 @@ TfLiteStatus KernelRunner::Invoke() {
   return registration_.invoke(&context_, &node_);
 }
 
+int KernelRunner::NumSubgraphs() {
+  return graph_ != nullptr ? graph_->NumSubgraphs() : 0;
+}
+
+size_t KernelRunner::NumSubgraphInputs(int subgraph_index) {
+  return graph_ != nullptr ? graph_->NumSubgraphInputs(subgraph_index) : 0;
+}
+
+size_t KernelRunner::NumSubgraphOutputs(int subgraph_index) {
+  return graph_ != nullptr ? graph_->NumSubgraphOutputs(subgraph_index) : 0;
+}
+
+TfLiteEvalTensor* KernelRunner::GetSubgraphInput(int subgraph_index,
+                                                 int input_index) {
+  return graph_ != nullptr
+             ? graph_->GetSubgraphInput(subgraph_index, input_index)
+             : nullptr;
+}
+
+TfLiteEvalTensor* KernelRunner::GetSubgraphOutput(int subgraph_index,
+                                                  int output_index) {
+  return graph_ != nullptr
+             ? graph_->GetSubgraphOutput(subgraph_index, output_index)
+             : nullptr;
+}
+
+TfLiteStatus KernelRunner::InvokeSubgraph(int subgraph_index) {
+  if (graph_ == nullptr) {
+    MicroPrintf("KernelRunner has no subgraphs to invoke.");
+    return kTfLiteError;
+  }
+  return graph_->InvokeSubgraph(subgraph_index);
+}
+
+KernelRunner* KernelRunner::GetRunner(const struct TfLiteContext* context) {
+  return static_cast<KernelRunner*>(static_cast<MicroGraph*>(context->impl_));
+}
+
 TfLiteTensor* KernelRunner::GetTensor(const struct TfLiteContext* context,
                                       int tensor_index) {
   TFLITE_DCHECK(context != nullptr);
-  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  KernelRunner* runner = GetRunner(context);
   TFLITE_DCHECK(runner != nullptr);
 
   return &runner->tensors_[tensor_index];
@@ -85,7 +123,7 @@ TfLiteTensor* KernelRunner::GetTensor(const struct TfLiteContext* context,
 TfLiteEvalTensor* KernelRunner::GetEvalTensor(
     const struct TfLiteContext* context, int tensor_index) {
   TFLITE_DCHECK(context != nullptr);
-  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  KernelRunner* runner = GetRunner(context);
   TFLITE_DCHECK(runner != nullptr);
 
   TfLiteEvalTensor* eval_tensor =
@@ -104,7 +142,7 @@ TfLiteEvalTensor* KernelRunner::GetEvalTensor(
 void* KernelRunner::AllocatePersistentBuffer(TfLiteContext* context,
                                              size_t bytes) {
   TFLITE_DCHECK(context != nullptr);
-  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  KernelRunner* runner = GetRunner(context);
   TFLITE_DCHECK(runner != nullptr);
 
   return runner->allocator_->AllocateFromTail(bytes, kBufferAlignment);
@@ -116,7 +154,7 @@ TfLiteStatus KernelRunner::RequestScratchBufferInArena(TfLiteContext* context,
   TFLITE_DCHECK(context != nullptr);
   TFLITE_DCHECK(buffer_index != nullptr);
 
-  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  KernelRunner* runner = GetRunner(context);
   TFLITE_DCHECK(runner != nullptr);
 
   if (runner->scratch_buffer_count_ == kNumScratchBuffers_) {
@@ -139,7 +177,7 @@ TfLiteStatus KernelRunner::RequestScratchBufferInArena(TfLiteContext* context,
 
 void* KernelRunner::GetScratchBuffer(TfLiteContext* context, int buffer_index) {
   TFLITE_DCHECK(context != nullptr);
-  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  KernelRunner* runner = GetRunner(context);
   TFLITE_DCHECK(runner != nullptr);
 
   TFLITE_DCHECK(runner->scratch_buffer_count_ <= kNumScratchBuffers_);
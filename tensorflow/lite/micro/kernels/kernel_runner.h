@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/micro_graph.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 
 namespace tflite {
@@ -29,7 +30,11 @@ namespace micro {
 // array, outputs array, and any pre-builtin data. Calling Invoke() will
 // automatically walk the kernel and outputs will be ready on the TfLiteTensor
 // output provided during construction.
-class KernelRunner {
+//
+// Like the MicroInterpreter, the context's impl_ points to this class as a
+// MicroGraph. Control flow kernels reach the subgraphs of the graph passed to
+// SetMicroGraph(), which tests implement with fake subgraphs.
+class KernelRunner : public MicroGraph {
  public:
   KernelRunner(const TfLiteRegistration& registration, TfLiteTensor* tensors,
                int tensors_size, TfLiteIntArray* inputs,
@@ -45,7 +50,22 @@ class KernelRunner {
   // passed into the constructor of this class.
   TfLiteStatus Invoke();
 
+  // Sets the graph whose subgraphs control flow kernels see, before
+  // InitAndPrepare. Without one, there are no subgraphs.
+  void SetMicroGraph(MicroGraph* graph) { graph_ = graph; }
+
+  // MicroGraph implementation, forwarded to the graph that is set.
+  int NumSubgraphs() override;
+  size_t NumSubgraphInputs(int subgraph_index) override;
+  size_t NumSubgraphOutputs(int subgraph_index) override;
+  TfLiteEvalTensor* GetSubgraphInput(int subgraph_index,
+                                     int input_index) override;
+  TfLiteEvalTensor* GetSubgraphOutput(int subgraph_index,
+                                      int output_index) override;
+  TfLiteStatus InvokeSubgraph(int subgraph_index) override;
+
  protected:
+  static KernelRunner* GetRunner(const struct TfLiteContext* context);
   static TfLiteTensor* GetTensor(const struct TfLiteContext* context,
                                  int tensor_index);
   static TfLiteEvalTensor* GetEvalTensor(const struct TfLiteContext* context,
@@ -67,6 +87,7 @@ class KernelRunner {
   SimpleMemoryAllocator* allocator_ = nullptr;
   const TfLiteRegistration& registration_;
   TfLiteTensor* tensors_ = nullptr;
+  MicroGraph* graph_ = nullptr;
 
   TfLiteContext context_ = {};
   TfLiteNode node_ = {};
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/micro_graph.h"
 
 namespace tflite {
 namespace micro {
@@ -50,6 +51,29 @@ inline TfLiteEvalTensor* GetEvalOutput(const TfLiteContext* context,
   return context->GetEvalTensor(context, node->outputs->data[index]);
 }
 
+// Asks for an output to share the buffer of an input, for kernels that leave
+// the data unchanged. Must be called from Prepare. The request may be declined,
+// so Eval must still handle separate buffers.
+inline TfLiteStatus RequestInPlaceOutput(TfLiteContext* context,
+                                         const TfLiteNode* node,
+                                         int input_index, int output_index) {
+  TFLITE_DCHECK(context != nullptr);
+  TFLITE_DCHECK(node != nullptr);
+  if (context->RequestInPlaceOutput == nullptr) {
+    return kTfLiteOk;
+  }
+  return context->RequestInPlaceOutput(context,
+                                       node->inputs->data[input_index],
+                                       node->outputs->data[output_index]);
+}
+
+// Returns the subgraphs of the model, for control flow kernels. Only valid for
+// a context set up by the MicroInterpreter.
+inline MicroGraph* GetMicroGraph(const TfLiteContext* context) {
+  TFLITE_DCHECK(context != nullptr);
+  return static_cast<MicroGraph*>(context->impl_);
+}
+
 // Returns data for a TfLiteEvalTensor struct.
 template <typename T>
 T* GetTensorData(TfLiteEvalTensor* tensor) {
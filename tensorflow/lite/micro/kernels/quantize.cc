@@ -76,6 +76,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->quantization_params.scale = static_cast<double>(output->params.scale);
 
   data->input_zero_point = input->params.zero_point;
+
+  // Requantizing to the same params leaves the data unchanged, so the output
+  // can share the input's buffer.
+  if ((input->type == kTfLiteInt8) && (output->type == kTfLiteInt8) &&
+      (input->params.scale == output->params.scale) &&
+      (input->params.zero_point == output->params.zero_point)) {
+    return tflite::micro::RequestInPlaceOutput(context, node, 0, 0);
+  }
   return kTfLiteOk;
 }
 
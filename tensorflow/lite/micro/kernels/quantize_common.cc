@@ -95,6 +95,14 @@ TfLiteStatus EvalQuantizeReference(TfLiteContext* context, TfLiteNode* node) {
     // Int8 to Int8 requantization, required if the input and output tensors
     // have different scales and/or zero points.
     size_t size = ElementCount(*input->dims);
+    // Nothing to do when the output shares the input's buffer and params.
+    if ((output->type == kTfLiteInt8) &&
+        (input->data.raw == output->data.raw) &&
+        (data->requantize_output_multiplier == 1 << 30) &&
+        (data->requantize_output_shift == 1) &&
+        (data->input_zero_point == data->quantization_params.zero_point)) {
+      return kTfLiteOk;
+    }
     switch (output->type) {
       case kTfLiteInt8:
         reference_ops::Requantize(
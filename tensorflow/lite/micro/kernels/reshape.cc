@@ -75,7 +75,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, NumInputs(node) == 1 || NumInputs(node) == 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
   TF_LITE_ENSURE_EQ(context, ReshapeOutput(context, node), kTfLiteOk);
-  return kTfLiteOk;
+  // The output holds the same bytes as the input, so it can share its buffer.
+  return tflite::micro::RequestInPlaceOutput(context, node, kInputTensor,
+                                             kOutputTensor);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -0,0 +1,173 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_graph.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace {
+
+struct OpData {
+  int cond_subgraph_index;
+  int body_subgraph_index;
+};
+
+// Checks that two tensors passed between subgraphs hold the same data.
+TfLiteStatus CheckMatching(TfLiteContext* context,
+                           const TfLiteEvalTensor* first,
+                           const TfLiteEvalTensor* second) {
+  TF_LITE_ENSURE(context, first != nullptr);
+  TF_LITE_ENSURE(context, second != nullptr);
+  TF_LITE_ENSURE_TYPES_EQ(context, first->type, second->type);
+  size_t first_bytes;
+  size_t second_bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(first, &first_bytes));
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(second, &second_bytes));
+  TF_LITE_ENSURE_EQ(context, first_bytes, second_bytes);
+  return kTfLiteOk;
+}
+
+TfLiteStatus CopyTensor(const TfLiteEvalTensor* from, TfLiteEvalTensor* to) {
+  size_t bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(from, &bytes));
+  if (from->data.raw != to->data.raw) {
+    memcpy(to->data.raw, from->data.raw, bytes);
+  }
+  return kTfLiteOk;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const auto* params =
+      static_cast<const TfLiteWhileParams*>(node->builtin_data);
+  data->cond_subgraph_index = params->cond_subgraph_index;
+  data->body_subgraph_index = params->body_subgraph_index;
+  const int cond = data->cond_subgraph_index;
+  const int body = data->body_subgraph_index;
+
+  // The loop variables are passed in as the inputs of the node and of both
+  // subgraphs, come back as the outputs of the body, and are the outputs of
+  // the node at the end.
+  const int num_inputs = NumInputs(node);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), num_inputs);
+
+  MicroGraph* graph = tflite::micro::GetMicroGraph(context);
+  TF_LITE_ENSURE(context, cond > 0);
+  TF_LITE_ENSURE(context, cond < graph->NumSubgraphs());
+  TF_LITE_ENSURE(context, body > 0);
+  TF_LITE_ENSURE(context, body < graph->NumSubgraphs());
+  TF_LITE_ENSURE_EQ(context, graph->NumSubgraphInputs(cond),
+                    static_cast<size_t>(num_inputs));
+  TF_LITE_ENSURE_EQ(context, graph->NumSubgraphOutputs(cond),
+                    static_cast<size_t>(1));
+  TF_LITE_ENSURE_EQ(context, graph->NumSubgraphInputs(body),
+                    static_cast<size_t>(num_inputs));
+  TF_LITE_ENSURE_EQ(context, graph->NumSubgraphOutputs(body),
+                    static_cast<size_t>(num_inputs));
+
+  // Currently only bool is supported as the condition.
+  const TfLiteEvalTensor* cond_output = graph->GetSubgraphOutput(cond, 0);
+  TF_LITE_ENSURE_TYPES_EQ(context, cond_output->type, kTfLiteBool);
+  TF_LITE_ENSURE_EQ(context, ElementCount(*cond_output->dims), 1);
+
+  // Tensors have static shapes in micro, so the loop variables can't change
+  // size from one iteration to the next.
+  for (int i = 0; i < num_inputs; ++i) {
+    const TfLiteEvalTensor* input =
+        tflite::micro::GetEvalInput(context, node, i);
+    TF_LITE_ENSURE_OK(context, CheckMatching(context, input,
+                                             graph->GetSubgraphInput(cond, i)));
+    TF_LITE_ENSURE_OK(context, CheckMatching(context, input,
+                                             graph->GetSubgraphInput(body, i)));
+    TF_LITE_ENSURE_OK(
+        context,
+        CheckMatching(context, input, graph->GetSubgraphOutput(body, i)));
+    TF_LITE_ENSURE_OK(
+        context, CheckMatching(context, input,
+                               tflite::micro::GetEvalOutput(context, node, i)));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+  const int cond = data->cond_subgraph_index;
+  const int body = data->body_subgraph_index;
+  const int num_inputs = NumInputs(node);
+  MicroGraph* graph = tflite::micro::GetMicroGraph(context);
+
+  // The inputs of the condition subgraph hold the loop variables between
+  // iterations. They, like the other tensors passed between subgraphs, are
+  // planned for the whole time the node runs.
+  for (int i = 0; i < num_inputs; ++i) {
+    TF_LITE_ENSURE_OK(
+        context, CopyTensor(tflite::micro::GetEvalInput(context, node, i),
+                            graph->GetSubgraphInput(cond, i)));
+  }
+
+  while (true) {
+    TF_LITE_ENSURE_OK(context, graph->InvokeSubgraph(cond));
+    if (!graph->GetSubgraphOutput(cond, 0)->data.b[0]) {
+      break;
+    }
+
+    for (int i = 0; i < num_inputs; ++i) {
+      TF_LITE_ENSURE_OK(context, CopyTensor(graph->GetSubgraphInput(cond, i),
+                                            graph->GetSubgraphInput(body, i)));
+    }
+    TF_LITE_ENSURE_OK(context, graph->InvokeSubgraph(body));
+    for (int i = 0; i < num_inputs; ++i) {
+      TF_LITE_ENSURE_OK(context, CopyTensor(graph->GetSubgraphOutput(body, i),
+                                            graph->GetSubgraphInput(cond, i)));
+    }
+  }
+
+  for (int i = 0; i < num_inputs; ++i) {
+    TF_LITE_ENSURE_OK(
+        context, CopyTensor(graph->GetSubgraphInput(cond, i),
+                            tflite::micro::GetEvalOutput(context, node, i)));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteRegistration Register_WHILE() {
+  return {/*init=*/Init,
+          /*free=*/nullptr,
+          /*prepare=*/Prepare,
+          /*invoke=*/Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace tflite
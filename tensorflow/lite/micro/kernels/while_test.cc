@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <stdint.h>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/micro_graph.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kCondSubgraph = 1;
+constexpr int kBodySubgraph = 2;
+
+// A graph whose condition subgraph checks counter < limit, and whose body
+// subgraph adds one to the counter and passes the limit through, as the same
+// tensor for its input and output.
+class CountingGraph : public MicroGraph {
+ public:
+  explicit CountingGraph(TfLiteType cond_type = kTfLiteBool,
+                         size_t body_outputs = 2)
+      : body_outputs_(body_outputs) {
+    for (int i = 0; i < 2; ++i) {
+      InitTensor(&cond_inputs_[i], &cond_input_data_[i], kTfLiteInt32);
+      InitTensor(&body_inputs_[i], &body_input_data_[i], kTfLiteInt32);
+    }
+    InitTensor(&cond_output_, &cond_output_data_, cond_type);
+    InitTensor(&body_output_, &body_output_data_, kTfLiteInt32);
+  }
+
+  int NumSubgraphs() override { return 3; }
+
+  size_t NumSubgraphInputs(int subgraph_index) override { return 2; }
+
+  size_t NumSubgraphOutputs(int subgraph_index) override {
+    return subgraph_index == kCondSubgraph ? 1 : body_outputs_;
+  }
+
+  TfLiteEvalTensor* GetSubgraphInput(int subgraph_index,
+                                     int input_index) override {
+    if (input_index < 0 || input_index >= 2) return nullptr;
+    if (subgraph_index == kCondSubgraph) return &cond_inputs_[input_index];
+    if (subgraph_index == kBodySubgraph) return &body_inputs_[input_index];
+    return nullptr;
+  }
+
+  TfLiteEvalTensor* GetSubgraphOutput(int subgraph_index,
+                                      int output_index) override {
+    if (subgraph_index == kCondSubgraph && output_index == 0) {
+      return &cond_output_;
+    }
+    if (subgraph_index == kBodySubgraph && output_index == 0) {
+      return &body_output_;
+    }
+    if (subgraph_index == kBodySubgraph && output_index == 1 &&
+        body_outputs_ > 1) {
+      return &body_inputs_[1];
+    }
+    return nullptr;
+  }
+
+  TfLiteStatus InvokeSubgraph(int subgraph_index) override {
+    if (subgraph_index == kCondSubgraph) {
+      cond_output_data_ = cond_input_data_[0] < cond_input_data_[1];
+      ++cond_invokes_;
+      return kTfLiteOk;
+    }
+    if (subgraph_index == kBodySubgraph) {
+      body_output_data_ = body_input_data_[0] + 1;
+      ++body_invokes_;
+      return kTfLiteOk;
+    }
+    return kTfLiteError;
+  }
+
+  int cond_invokes() const { return cond_invokes_; }
+  int body_invokes() const { return body_invokes_; }
+
+ private:
+  template <typename T>
+  void InitTensor(TfLiteEvalTensor* tensor, T* data, TfLiteType type) {
+    static int dims_data[] = {1, 1};
+    tensor->data.data = data;
+    tensor->dims = IntArrayFromInts(dims_data);
+    tensor->type = type;
+  }
+
+  size_t body_outputs_;
+  int32_t cond_input_data_[2] = {0, 0};
+  int32_t body_input_data_[2] = {0, 0};
+  bool cond_output_data_ = false;
+  int32_t body_output_data_ = 0;
+  TfLiteEvalTensor cond_inputs_[2];
+  TfLiteEvalTensor body_inputs_[2];
+  TfLiteEvalTensor cond_output_;
+  TfLiteEvalTensor body_output_;
+  int cond_invokes_ = 0;
+  int body_invokes_ = 0;
+};
+
+// Runs a WHILE node over the counter and limit loop variables of graph, and
+// returns the status of Prepare, or of Invoke once prepared.
+TfLiteStatus RunWhile(CountingGraph* graph, int32_t counter, int32_t limit,
+                      int32_t* counter_output, int32_t* limit_output) {
+  int dims_data[] = {1, 1};
+  TfLiteIntArray* dims = IntArrayFromInts(dims_data);
+  int32_t input_data[] = {counter, limit};
+  TfLiteTensor tensors[] = {
+      CreateTensor(&input_data[0], dims),
+      CreateTensor(&input_data[1], dims),
+      CreateTensor(counter_output, dims),
+      CreateTensor(limit_output, dims),
+  };
+  int inputs_array_data[] = {2, 0, 1};
+  int outputs_array_data[] = {2, 2, 3};
+  TfLiteWhileParams params = {kCondSubgraph, kBodySubgraph};
+
+  const TfLiteRegistration registration = Register_WHILE();
+  micro::KernelRunner runner(registration, tensors,
+                             sizeof(tensors) / sizeof(tensors[0]),
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params);
+  runner.SetMicroGraph(graph);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  TfLiteStatus status = runner.Invoke();
+
+  // the loop starts from the node's inputs, which it must not change
+  TF_LITE_MICRO_EXPECT_EQ(counter, input_data[0]);
+  TF_LITE_MICRO_EXPECT_EQ(limit, input_data[1]);
+  return status;
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(WhileLoopsUntilConditionIsFalse) {
+  tflite::testing::CountingGraph graph;
+  int32_t counter = 0;
+  int32_t limit = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunWhile(&graph, 0, 5, &counter, &limit));
+  TF_LITE_MICRO_EXPECT_EQ(5, counter);
+  TF_LITE_MICRO_EXPECT_EQ(5, limit);
+  TF_LITE_MICRO_EXPECT_EQ(6, graph.cond_invokes());
+  TF_LITE_MICRO_EXPECT_EQ(5, graph.body_invokes());
+
+  // The loop variables start from the node's inputs on every run, not from
+  // where the last run left them.
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunWhile(&graph, 3, 5, &counter, &limit));
+  TF_LITE_MICRO_EXPECT_EQ(5, counter);
+  TF_LITE_MICRO_EXPECT_EQ(5, limit);
+  TF_LITE_MICRO_EXPECT_EQ(9, graph.cond_invokes());
+  TF_LITE_MICRO_EXPECT_EQ(7, graph.body_invokes());
+}
+
+TF_LITE_MICRO_TEST(WhileWithFalseConditionPassesInputsThrough) {
+  tflite::testing::CountingGraph graph;
+  int32_t counter = 0;
+  int32_t limit = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunWhile(&graph, 7, 3, &counter, &limit));
+  TF_LITE_MICRO_EXPECT_EQ(7, counter);
+  TF_LITE_MICRO_EXPECT_EQ(3, limit);
+  TF_LITE_MICRO_EXPECT_EQ(1, graph.cond_invokes());
+  TF_LITE_MICRO_EXPECT_EQ(0, graph.body_invokes());
+}
+
+TF_LITE_MICRO_TEST(WhileRejectsNonBoolCondition) {
+  tflite::testing::CountingGraph graph(kTfLiteInt32);
+  int32_t counter = 0;
+  int32_t limit = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::testing::RunWhile(&graph, 0, 5, &counter, &limit));
+  TF_LITE_MICRO_EXPECT_EQ(0, graph.cond_invokes());
+}
+
+TF_LITE_MICRO_TEST(WhileRejectsBodyWithoutEveryLoopVariable) {
+  tflite::testing::CountingGraph graph(kTfLiteBool, /*body_outputs=*/1);
+  int32_t counter = 0;
+  int32_t limit = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::testing::RunWhile(&graph, 0, 5, &counter, &limit));
+  TF_LITE_MICRO_EXPECT_EQ(0, graph.body_invokes());
+}
+
+TF_LITE_MICRO_TEST(WhileRejectsMissingSubgraphs) {
+  int32_t counter = 0;
+  int32_t limit = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      tflite::testing::RunWhile(nullptr, 0, 5, &counter, &limit));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -74,7 +74,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // allocate the stack for thread workers
   GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size, add_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op_data->stack_size * op_data->threads.size(),
       &op_data->stack_scratch_index));
 
@@ -101,8 +101,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   // initialize the dispatcher
   Dispatcher* dispatcher = GetDispatcher();
-  auto* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op_data->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op_data->stack_scratch_index);
   TF_LITE_ENSURE(context, stack);
   dispatcher->InitializeTasks(add_thread_worker, stack, op_data->stack_size);
 
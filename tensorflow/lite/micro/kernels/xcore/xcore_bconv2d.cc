@@ -51,57 +51,72 @@ struct BConv2DArguments {
 // -------------------------------------------------------------------- //
 
 struct BConv2DThreadData {
-  // TODO: change this when new dispatcher is rolled out
-
-  // This describes the region that that thread will process
-  const RowColRegion *job;
+  // The jobs (regions) the thread will claim
+  const RowColRegion *jobs;
+  JobClaimer claimer;
   int thread_scratch_idx = -1;
   bnn_b32_t *thread_scratch;  // size should be K_h * K_w * C_in / 32 + 8
   const BConv2DArguments *args;
 };
 
+// Claims the next job, returns nullptr when there are no jobs left
+static inline const RowColRegion *claim_job(BConv2DThreadData *td) {
+  int32_t index;
+  if (!td->claimer.Claim(index)) return nullptr;
+  return &td->jobs[index];
+}
+
 extern "C" {
 ATTRIBUTE_THREAD_FUNCTION void bconv2d_bitpacked_deepin_thread_worker(
     void *context) {
   auto *td = static_cast<BConv2DThreadData *>(context);
   auto *args = td->args;
-  auto *job = td->job;
-  bconv2d_bin_DI_valid(args->Y_bitpacked, (const bnn_b256_t *)args->X,
-                       (const bnn_b256_t *)args->K, args->thresholds, &args->x,
-                       &args->y, &args->k, job->left, job->top, job->cols,
-                       job->rows, 0, args->y.channels);
+  const RowColRegion *job;
+  while ((job = claim_job(td))) {
+    bconv2d_bin_DI_valid(args->Y_bitpacked, (const bnn_b256_t *)args->X,
+                         (const bnn_b256_t *)args->K, args->thresholds,
+                         &args->x, &args->y, &args->k, job->left, job->top,
+                         job->cols, job->rows, 0, args->y.channels);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void bconv2d_bitpacked_thread_worker(void *context) {
   auto *td = static_cast<BConv2DThreadData *>(context);
   auto *args = td->args;
-  auto *job = td->job;
-  bconv2d_bin_valid(args->Y_bitpacked, args->X, args->K, args->thresholds,
-                    td->thread_scratch, &args->x, &args->y, &args->k, job->left,
-                    job->top, job->cols, job->rows, 0, args->y.channels);
+  const RowColRegion *job;
+  while ((job = claim_job(td))) {
+    bconv2d_bin_valid(args->Y_bitpacked, args->X, args->K, args->thresholds,
+                      td->thread_scratch, &args->x, &args->y, &args->k,
+                      job->left, job->top, job->cols, job->rows, 0,
+                      args->y.channels);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void bconv2d_int8_deepin_deepout_thread_worker(
     void *context) {
   auto *td = static_cast<BConv2DThreadData *>(context);
   auto *args = td->args;
-  auto *job = td->job;
-  bconv2d_int8_DIDO_valid(args->Y_int8, (const bnn_b256_t *)args->X,
-                          (const bnn_b256_t *)args->K, args->post_act_mult,
-                          args->post_act_bias, args->output_trf_parameters,
-                          &args->x, &args->y, &args->k, job->left, job->top,
-                          job->cols, job->rows, 0, args->y.channels);
+  const RowColRegion *job;
+  while ((job = claim_job(td))) {
+    bconv2d_int8_DIDO_valid(args->Y_int8, (const bnn_b256_t *)args->X,
+                            (const bnn_b256_t *)args->K, args->post_act_mult,
+                            args->post_act_bias, args->output_trf_parameters,
+                            &args->x, &args->y, &args->k, job->left, job->top,
+                            job->cols, job->rows, 0, args->y.channels);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void bconv2d_int8_thread_worker(void *context) {
   auto *td = static_cast<BConv2DThreadData *>(context);
   auto *args = td->args;
-  auto *job = td->job;
-  bconv2d_int8_valid(args->Y_int8, args->X, args->K, args->post_act_mult,
-                     args->post_act_bias, args->accu_modifier,
-                     args->output_trf_parameters, td->thread_scratch, &args->x,
-                     &args->y, &td->args->k, job->left, job->top, job->cols,
-                     job->rows, 0, args->y.channels);
+  const RowColRegion *job;
+  while ((job = claim_job(td))) {
+    bconv2d_int8_valid(args->Y_int8, args->X, args->K, args->post_act_mult,
+                       args->post_act_bias, args->accu_modifier,
+                       args->output_trf_parameters, td->thread_scratch,
+                       &args->x, &args->y, &td->args->k, job->left, job->top,
+                       job->cols, job->rows, 0, args->y.channels);
+  }
 }
 }
 
@@ -111,7 +126,9 @@ ATTRIBUTE_THREAD_FUNCTION void bconv2d_int8_thread_worker(void *context) {
 
 struct BConv2DOpData
     : MultiThreadedOpData<BConv2DArguments, BConv2DThreadData> {
-  // The jobs (regions) threads will have to process.
+  // The regions of the parallelization plan, and the jobs they are split
+  // into for threads to claim (see CreateJobs)
+  PersistentArray<RowColRegion> regions;
   PersistentArray<RowColRegion> jobs;
 
   // TODO: remove this when better external memory handling is implemented
@@ -191,23 +208,19 @@ void *Init(TfLiteContext *context, const char *buffer, size_t length) {
       CustomOptionParser(parser.parseNamedCustomOption("par").AsMap());
 
   auto regions = par_parser.parseNamedCustomOption("rc").AsVector();
-  auto n_jobs = regions.size();
-  op_data->jobs.allocate(context, n_jobs);
-  for (int j{0}; j < n_jobs; j++) {
+  auto n_regions = regions.size();
+  op_data->regions.allocate(context, n_regions);
+  for (int j{0}; j < n_regions; j++) {
     auto region = regions[j].AsVector();
-    op_data->jobs.append({region[0].AsInt32(), region[1].AsInt32(),
-                          region[2].AsInt32(), region[3].AsInt32()});
+    op_data->regions.append({region[0].AsInt32(), region[1].AsInt32(),
+                             region[2].AsInt32(), region[3].AsInt32()});
   }
 
   auto n_threads = par_parser.parseNamedCustomOption("th").AsInt32();
-  // TODO: remove this check when new dispatcher is rolled out
-  TFLITE_CHECK_EQ(n_jobs, n_threads);
   op_data->threads.allocate(context, n_threads);
   BConv2DThreadData td;
   td.args = &op_data->args;
   for (int j{0}; j < n_threads; j++) {
-    // TODO: remove this when new dispatcher is rolled out
-    td.job = &op_data->jobs[j];
     op_data->threads.append(td);
   }
 
@@ -269,8 +282,18 @@ TfLiteStatus Prepare(TfLiteContext *context, TfLiteNode *node) {
     UNSUPPORTED_KERNEL_TYPE(BConv2DKernelType);
   }
 
+  // split the regions into the jobs threads will claim
+  const bool dynamic = GetDispatcher()->IsDynamicScheduling();
+  // statically, each thread runs the one region planned for it
+  if (!dynamic) {
+    TF_LITE_ENSURE_EQ(context, static_cast<int>(op_data->regions.size()),
+                      static_cast<int>(op_data->threads.size()));
+  }
+  TF_LITE_ENSURE_STATUS(
+      CreateJobs(context, op_data->regions, dynamic, op_data->jobs));
+
   BConv2DKernel<kernel_type>::calculate_worker_stack_size(op_data->stack_size);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op_data->stack_size * op_data->threads.size(),
       &op_data->stack_scratch_index));
 
@@ -344,8 +367,8 @@ TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
   }
 
   // initialize the threads
-  auto *stack = static_cast<char *>(
-      context->GetScratchBuffer(context, op_data->stack_scratch_index));
+  char *stack =
+      GetDispatcher()->GetStack(context, op_data->stack_scratch_index);
   TF_LITE_ENSURE(context, stack);
 
   Dispatcher *dispatcher = GetDispatcher();
@@ -353,7 +376,14 @@ TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
                               op_data->stack_size);
 
   // start threads
-  for (auto &thread : op_data->threads) {
+  JobQueue *queue = dispatcher->GetJobQueue();
+  const int n_jobs = op_data->jobs.size();
+  const int n_threads = op_data->threads.size();
+  queue->Reset(n_jobs);
+  for (int j{0}; j < n_threads; j++) {
+    auto &thread = op_data->threads[j];
+    thread.jobs = op_data->jobs.begin();
+    thread.claimer.Reset(queue, n_jobs, n_threads, j);
     if (kernel_type == BConv2DKernelType::kBitpacked ||
         kernel_type == BConv2DKernelType::kInt8) {
       thread.thread_scratch = static_cast<bnn_b32_t *>(
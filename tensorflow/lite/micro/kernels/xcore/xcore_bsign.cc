@@ -90,7 +90,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   /* Allocate the stack for thread workers */
   GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size, bsign_8_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op_data->stack_size * op_data->threads.size(),
       &op_data->stack_scratch_index));
 
@@ -108,8 +108,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   Dispatcher* dispatcher = GetDispatcher();
 
   // initialize the dispatcher
-  auto* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op_data->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op_data->stack_scratch_index);
   TF_LITE_ENSURE(context, stack);
   dispatcher->InitializeTasks(bsign_8_thread_worker, stack,
                               op_data->stack_size);
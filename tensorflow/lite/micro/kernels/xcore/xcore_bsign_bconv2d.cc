@@ -0,0 +1,508 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+#include <algorithm>
+#include <cstring>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_custom_options.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+
+extern "C" {
+#include "nn_operator.h"
+}
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace xcore {
+namespace bsign_bconv {
+
+// A streaming binarized pipeline: the int8 input is sign-packed and passed
+// through a chain of bitpacked convolutions one row at a time. Each layer
+// keeps only the K_h packed input rows its next output row needs in a rolling
+// line buffer, so neither the packed input nor the intermediate outputs are
+// ever stored as full tensors.
+
+constexpr int32_t kMaxPipelineLayers = 4;
+
+// -------------------------------------------------------------------- //
+// kernel argument type
+// -------------------------------------------------------------------- //
+
+struct BConv2DLayer {
+  const bnn_b32_t *K;
+  const int32_t *thresholds;  // bitpacked output only
+
+  nn_image_params_t x;
+  nn_image_params_t y;
+  nn_window_params_t k;
+
+  nn_image_params_t x_window;  // the K_h input rows under one output row
+  nn_image_params_t y_row;     // one output row
+
+  int weights_scratch_idx = -1;
+  int threshold_scratch_idx = -1;
+};
+
+struct PipelineArguments {
+  const int8_t *X;
+  int8_t zero_point_vec[VPU_INT8_EPV];
+  int32_t n_layers;
+  BConv2DLayer layers[kMaxPipelineLayers];
+
+  union {
+    bnn_b32_t *Y_bitpacked;
+    int8_t *Y_int8;
+  };
+
+  // for int8 output only
+  const int16_t *post_act_mult;
+  const int16_t *post_act_bias;
+  const output_transform_values_t *output_trf_parameters;
+  const int16_t *accu_modifier;
+};
+
+// -------------------------------------------------------------------- //
+// thread data type and worker functions
+// -------------------------------------------------------------------- //
+
+struct LineBuffer {
+  bnn_b32_t *rows;
+  int32_t row_words;
+  int32_t capacity;  // K_h of the layer reading the rows
+  int32_t start;     // the first input row held
+  int32_t end;       // one past the last input row held
+};
+
+struct PipelineThreadData {
+  const PipelineArguments *args;
+  const RowColRegion *jobs;
+  JobClaimer claimer;
+  bnn_b32_t *lines;           // the line buffers of all layers
+  bnn_b32_t *thread_scratch;  // size should be K_h * K_w * C_in / 32 + 8
+};
+
+static inline bnn_b32_t *next_row(LineBuffer &line) {
+  return &line.rows[(line.end - line.start) * line.row_words];
+}
+
+// Drops the rows before first, keeping the rest at the top of the buffer
+static inline void slide(LineBuffer &line, int32_t first) {
+  if (first < line.start || first >= line.end) {
+    line.start = line.end = first;
+    return;
+  }
+  if (first > line.start) {
+    memmove(line.rows, &line.rows[(first - line.start) * line.row_words],
+            (line.end - first) * line.row_words * sizeof(bnn_b32_t));
+  }
+  line.start = first;
+}
+
+// Makes the line buffer of layer top hold its input rows [first, first + K_h)
+//   Missing rows are computed by walking down to the layers they depend on,
+//   and back up as they are produced. This is a loop rather than a recursion
+//   so that the worker stack size can be computed.
+static void fill_lines(const PipelineThreadData *td, LineBuffer *lines,
+                       int32_t top, int32_t first) {
+  const PipelineArguments *args = td->args;
+  int32_t demand[kMaxPipelineLayers];
+
+  slide(lines[top], first);
+  demand[top] = first + lines[top].capacity;
+  int32_t l = top;
+  while (true) {
+    LineBuffer &line = lines[l];
+    if (line.end >= demand[l]) {
+      if (l == top) return;
+      // the window of layer l is complete, compute the next row above
+      const BConv2DLayer &layer = args->layers[l];
+      bconv2d_bin_valid(next_row(lines[l + 1]), line.rows, layer.K,
+                        layer.thresholds, td->thread_scratch, &layer.x_window,
+                        &layer.y_row, &layer.k, 0, 0, layer.y.width, 1, 0,
+                        layer.y.channels);
+      lines[l + 1].end++;
+      l++;
+    } else if (l == 0) {
+      // sign-pack the next input row
+      const int32_t row_length =
+          args->layers[0].x.width * args->layers[0].x.channels;
+      nn_bsign_8_job_t job = {0, row_length};
+      bsign_8(next_row(line), &args->X[line.end * row_length],
+              args->zero_point_vec, &job);
+      line.end++;
+    } else {
+      // the next row is an output row of the layer below
+      const BConv2DLayer &below = args->layers[l - 1];
+      const int32_t below_first = line.end * below.k.stride.vertical;
+      slide(lines[l - 1], below_first);
+      demand[l - 1] = below_first + below.k.shape.height;
+      l--;
+    }
+  }
+}
+
+// Runs the pipeline for the output rows of a job
+template <bool int8_output>
+static inline void run_job(const PipelineThreadData *td,
+                           const RowColRegion &job) {
+  const PipelineArguments *args = td->args;
+  const int32_t last = args->n_layers - 1;
+  const BConv2DLayer &layer = args->layers[last];
+
+  LineBuffer lines[kMaxPipelineLayers];
+  bnn_b32_t *storage = td->lines;
+  for (int32_t l = 0; l <= last; l++) {
+    const BConv2DLayer &reader = args->layers[l];
+    lines[l].rows = storage;
+    lines[l].row_words = reader.x.width * reader.x.channels / XS1_ALL_BITS_SIZE;
+    lines[l].capacity = reader.k.shape.height;
+    lines[l].start = lines[l].end = 0;
+    storage = &storage[lines[l].capacity * lines[l].row_words];
+  }
+
+  for (int32_t row = job.top; row < job.top + job.rows; row++) {
+    fill_lines(td, lines, last, row * layer.k.stride.vertical);
+    if (int8_output) {
+      bconv2d_int8_valid(&args->Y_int8[row * layer.y.width * layer.y.channels],
+                         lines[last].rows, layer.K, args->post_act_mult,
+                         args->post_act_bias, args->accu_modifier,
+                         args->output_trf_parameters, td->thread_scratch,
+                         &layer.x_window, &layer.y_row, &layer.k, job.left, 0,
+                         job.cols, 1, 0, layer.y.channels);
+    } else {
+      const int32_t row_words =
+          layer.y.width * layer.y.channels / XS1_ALL_BITS_SIZE;
+      bconv2d_bin_valid(&args->Y_bitpacked[row * row_words], lines[last].rows,
+                        layer.K, layer.thresholds, td->thread_scratch,
+                        &layer.x_window, &layer.y_row, &layer.k, job.left, 0,
+                        job.cols, 1, 0, layer.y.channels);
+    }
+  }
+}
+
+extern "C" {
+ATTRIBUTE_THREAD_FUNCTION void bsign_bconv2d_bitpacked_thread_worker(
+    void *context) {
+  auto *td = static_cast<PipelineThreadData *>(context);
+  int32_t index;
+  while (td->claimer.Claim(index)) {
+    run_job<false>(td, td->jobs[index]);
+  }
+}
+
+ATTRIBUTE_THREAD_FUNCTION void bsign_bconv2d_int8_thread_worker(
+    void *context) {
+  auto *td = static_cast<PipelineThreadData *>(context);
+  int32_t index;
+  while (td->claimer.Claim(index)) {
+    run_job<true>(td, td->jobs[index]);
+  }
+}
+}
+
+// -------------------------------------------------------------------- //
+// op data types
+// -------------------------------------------------------------------- //
+
+struct PipelineOpData
+    : MultiThreadedOpData<PipelineArguments, PipelineThreadData> {
+  PersistentArray<RowColRegion> regions;
+  PersistentArray<RowColRegion> jobs;
+
+  int thread_buffer_scratch_idx = -1;
+  size_t lines_size;
+  size_t thread_scratch_size;
+
+  // scratch for the int8 output parameters in external memory
+  int bias_scratch_idx = -1;
+  int multiplier_scratch_idx = -1;
+  int accu_modifier_scratch_idx = -1;
+  int output_trf_scratch_idx = -1;
+};
+
+// -------------------------------------------------------------------- //
+// op function implementations
+// -------------------------------------------------------------------- //
+
+void *Init(TfLiteContext *context, const char *buffer, size_t length) {
+  auto *op_data = construct_persistent_object<PipelineOpData>(context);
+  auto &args = op_data->args;
+
+  // one [C_out, K_h, K_w, C_in] kernel shape and one stride per layer
+  auto parser = CustomOptionParser(buffer, length);
+  auto Kshapes = parser.parseNamedCustomOption("K").AsVector();
+  auto strides = parser.parseNamedCustomOption("stride").AsVector();
+  args.n_layers = Kshapes.size();
+  if (args.n_layers < 1 || args.n_layers > kMaxPipelineLayers) {
+    TF_LITE_KERNEL_LOG(context,
+                       "BSign_BConv2D has %d layers, it supports 1 to %d.",
+                       args.n_layers, kMaxPipelineLayers);
+    args.n_layers = 0;  // rejected by Prepare
+  } else if (strides.size() != static_cast<size_t>(args.n_layers)) {
+    TF_LITE_KERNEL_LOG(context,
+                       "BSign_BConv2D has %d kernel shapes but %d strides.",
+                       args.n_layers, static_cast<int>(strides.size()));
+    args.n_layers = 0;
+  }
+  for (int32_t l = 0; l < args.n_layers; l++) {
+    auto &layer = args.layers[l];
+    auto Kshape = Kshapes[l].AsVector();
+    layer.y.channels = Kshape[0].AsUInt32();
+    layer.k.shape.height = Kshape[1].AsUInt32();
+    layer.k.shape.width = Kshape[2].AsUInt32();
+    layer.x.channels = Kshape[3].AsUInt32();
+
+    auto stride = strides[l].AsVector();
+    layer.k.stride.vertical = stride[0].AsInt32();
+    layer.k.stride.horizontal = stride[1].AsInt32();
+    layer.k.dilation.horizontal = 1;
+    layer.k.dilation.vertical = 1;
+  }
+
+  // parse parallelization plan
+  auto par_parser =
+      CustomOptionParser(parser.parseNamedCustomOption("par").AsMap());
+
+  auto regions = par_parser.parseNamedCustomOption("rc").AsVector();
+  auto n_regions = regions.size();
+  op_data->regions.allocate(context, n_regions);
+  for (int j{0}; j < n_regions; j++) {
+    auto region = regions[j].AsVector();
+    op_data->regions.append({region[0].AsInt32(), region[1].AsInt32(),
+                             region[2].AsInt32(), region[3].AsInt32()});
+  }
+
+  auto n_threads = par_parser.parseNamedCustomOption("th").AsInt32();
+  op_data->threads.allocate(context, n_threads);
+  PipelineThreadData td;
+  td.args = &op_data->args;
+  for (int j{0}; j < n_threads; j++) {
+    op_data->threads.append(td);
+  }
+
+  return op_data;
+}
+
+template <bool int8_output>
+TfLiteStatus Prepare(TfLiteContext *context, TfLiteNode *node) {
+  auto *op_data = reinterpret_cast<PipelineOpData *>(node->user_data);
+  auto &args = op_data->args;
+  // the layers of the options did not fit the pipeline, see Init
+  TF_LITE_ENSURE(context, args.n_layers > 0);
+  const int32_t last = args.n_layers - 1;
+
+  // the input, two tensors per bitpacked layer and the last layer's tensors
+  TF_LITE_ENSURE_EQ(context, NumInputs(node),
+                    1 + 2 * last + (int8_output ? 5 : 2));
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor *input = GetInput(context, node, 0);
+  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteInt8);
+
+  // derive the image of each layer from the one below (valid padding)
+  args.layers[0].x.height = (uint32_t)input->dims->data[1];
+  args.layers[0].x.width = (uint32_t)input->dims->data[2];
+
+  // rows are packed with a job of their own, only the zero point is kept
+  nn_bsign_8_job_t job;
+  bsign_8_prepare(&job, args.zero_point_vec,
+                  args.layers[0].x.width * args.layers[0].x.channels,
+                  input->params.zero_point, 1);
+  op_data->lines_size = 0;
+  op_data->thread_scratch_size = 0;
+  for (int32_t l = 0; l <= last; l++) {
+    auto &layer = args.layers[l];
+    if (l > 0) {
+      TF_LITE_ENSURE_EQ(context, layer.x.channels,
+                        args.layers[l - 1].y.channels);
+      layer.x.height = args.layers[l - 1].y.height;
+      layer.x.width = args.layers[l - 1].y.width;
+    }
+    TF_LITE_ENSURE_EQ(context, layer.x.channels % XS1_ALL_BITS_SIZE, 0);
+    // the output dimensions are unsigned, so they would wrap around
+    TF_LITE_ENSURE(context, layer.x.height >= layer.k.shape.height &&
+                                layer.x.width >= layer.k.shape.width);
+    layer.y.height =
+        (layer.x.height - layer.k.shape.height) / layer.k.stride.vertical + 1;
+    layer.y.width =
+        (layer.x.width - layer.k.shape.width) / layer.k.stride.horizontal + 1;
+    layer.x_window = {layer.k.shape.height, layer.x.width, layer.x.channels};
+    layer.y_row = {1, layer.y.width, layer.y.channels};
+
+    op_data->lines_size += layer.k.shape.height * layer.x.width *
+                           layer.x.channels / XS1_ALL_BITS_SIZE *
+                           sizeof(bnn_b32_t);
+    size_t thread_scratch_size =
+        4 * (layer.k.shape.height * layer.k.shape.width * layer.x.channels /
+                 XS1_ALL_BITS_SIZE +
+             XS3_VPU_VREG_WIDTH_WORDS);
+    op_data->thread_scratch_size =
+        std::max(op_data->thread_scratch_size, thread_scratch_size);
+
+    TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+        context, GetInput(context, node, 1 + 2 * l),
+        layer.weights_scratch_idx));
+    if (l < last || !int8_output) {
+      TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+          context, GetInput(context, node, 2 + 2 * l),
+          layer.threshold_scratch_idx));
+    }
+  }
+
+  const TfLiteTensor *output = GetOutput(context, node, 0);
+  TF_LITE_ENSURE_EQ(context, args.layers[last].y.height,
+                    (uint32_t)output->dims->data[1]);
+  TF_LITE_ENSURE_EQ(context, args.layers[last].y.width,
+                    (uint32_t)output->dims->data[2]);
+
+  if (int8_output) {
+    const int first = 2 + 2 * last;
+    TF_LITE_ENSURE_STATUS(
+        request_scratch_if_needed(context, GetInput(context, node, first),
+                                  op_data->multiplier_scratch_idx));
+    TF_LITE_ENSURE_STATUS(
+        request_scratch_if_needed(context, GetInput(context, node, first + 1),
+                                  op_data->bias_scratch_idx));
+    TF_LITE_ENSURE_STATUS(
+        request_scratch_if_needed(context, GetInput(context, node, first + 2),
+                                  op_data->output_trf_scratch_idx));
+    TF_LITE_ENSURE_STATUS(
+        request_scratch_if_needed(context, GetInput(context, node, first + 3),
+                                  op_data->accu_modifier_scratch_idx));
+  }
+
+  // split the regions into the jobs threads will claim
+  TF_LITE_ENSURE_STATUS(CreateJobs(context, op_data->regions,
+                                   GetDispatcher()->IsDynamicScheduling(),
+                                   op_data->jobs));
+
+  if (int8_output) {
+    GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size,
+                                  bsign_bconv2d_int8_thread_worker);
+  } else {
+    GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size,
+                                  bsign_bconv2d_bitpacked_thread_worker);
+  }
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
+      context, op_data->stack_size * op_data->threads.size(),
+      &op_data->stack_scratch_index));
+
+  // the line buffers and kernel scratch of each thread
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context,
+      (op_data->lines_size + op_data->thread_scratch_size) *
+          op_data->threads.size(),
+      &op_data->thread_buffer_scratch_idx));
+
+  return kTfLiteOk;
+}
+
+template <bool int8_output>
+TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
+  auto *op_data = reinterpret_cast<PipelineOpData *>(node->user_data);
+  auto &args = op_data->args;
+  const int32_t last = args.n_layers - 1;
+
+  args.X = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 0));
+  for (int32_t l = 0; l <= last; l++) {
+    auto &layer = args.layers[l];
+    TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+        context, layer.K, tflite::micro::GetEvalInput(context, node, 1 + 2 * l),
+        layer.weights_scratch_idx));
+    if (l < last || !int8_output) {
+      TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+          context, layer.thresholds,
+          tflite::micro::GetEvalInput(context, node, 2 + 2 * l),
+          layer.threshold_scratch_idx));
+    }
+  }
+
+  if (int8_output) {
+    const int first = 2 + 2 * last;
+    args.Y_int8 = tflite::micro::GetTensorData<int8_t>(
+        tflite::micro::GetEvalOutput(context, node, 0));
+    TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+        context, args.post_act_mult,
+        tflite::micro::GetEvalInput(context, node, first),
+        op_data->multiplier_scratch_idx));
+    TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+        context, args.post_act_bias,
+        tflite::micro::GetEvalInput(context, node, first + 1),
+        op_data->bias_scratch_idx));
+    TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+        context, args.output_trf_parameters,
+        tflite::micro::GetEvalInput(context, node, first + 2),
+        op_data->output_trf_scratch_idx));
+    TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+        context, args.accu_modifier,
+        tflite::micro::GetEvalInput(context, node, first + 3),
+        op_data->accu_modifier_scratch_idx));
+  } else {
+    args.Y_bitpacked = tflite::micro::GetTensorData<bnn_b32_t>(
+        tflite::micro::GetEvalOutput(context, node, 0));
+  }
+
+  // initialize the threads
+  char *stack =
+      GetDispatcher()->GetStack(context, op_data->stack_scratch_index);
+  TF_LITE_ENSURE(context, stack);
+  auto *thread_buffers = static_cast<int8_t *>(
+      context->GetScratchBuffer(context, op_data->thread_buffer_scratch_idx));
+  TF_LITE_ENSURE(context, thread_buffers);
+
+  Dispatcher *dispatcher = GetDispatcher();
+  if (int8_output) {
+    dispatcher->InitializeTasks(bsign_bconv2d_int8_thread_worker, stack,
+                                op_data->stack_size);
+  } else {
+    dispatcher->InitializeTasks(bsign_bconv2d_bitpacked_thread_worker, stack,
+                                op_data->stack_size);
+  }
+
+  // start threads
+  JobQueue *queue = dispatcher->GetJobQueue();
+  const int n_jobs = op_data->jobs.size();
+  const int n_threads = op_data->threads.size();
+  queue->Reset(n_jobs);
+  for (int j{0}; j < n_threads; j++) {
+    auto &thread = op_data->threads[j];
+    thread.jobs = op_data->jobs.begin();
+    thread.claimer.Reset(queue, n_jobs, n_threads, j);
+    thread.lines = reinterpret_cast<bnn_b32_t *>(thread_buffers);
+    thread.thread_scratch =
+        reinterpret_cast<bnn_b32_t *>(&thread_buffers[op_data->lines_size]);
+    thread_buffers = &thread_buffers[op_data->lines_size +
+                                     op_data->thread_scratch_size];
+    dispatcher->AddTask(reinterpret_cast<void *>(&thread));
+  }
+  dispatcher->JoinTasks();
+
+  return kTfLiteOk;
+}
+
+}  // namespace bsign_bconv
+
+TfLiteRegistration *Register_BSign_BConv2D_Bitpacked() {
+  static TfLiteRegistration r = {bsign_bconv::Init, nullptr,
+                                 bsign_bconv::Prepare<false>,
+                                 bsign_bconv::Eval<false>};
+  return &r;
+}
+
+TfLiteRegistration *Register_BSign_BConv2D_Int8() {
+  static TfLiteRegistration r = {bsign_bconv::Init, nullptr,
+                                 bsign_bconv::Prepare<true>,
+                                 bsign_bconv::Eval<true>};
+  return &r;
+}
+
+}  // namespace xcore
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,237 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <cstdint>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_ops.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+namespace xc = tflite::ops::micro::xcore;
+
+// Two 3x3 bitpacked convolutions of 32 channels, with valid padding
+constexpr int kLayers = 2;
+constexpr int kChannels = 32;
+constexpr int kWords = kChannels / 32;
+constexpr int kKernelSize = 3;
+constexpr int kHeight[kLayers + 1] = {7, 5, 3};
+constexpr int kWidth[kLayers + 1] = {6, 4, 2};
+constexpr int kKernelWords = kChannels * kKernelSize * kKernelSize * kWords;
+
+int8_t input_data[kHeight[0] * kWidth[0] * kChannels];
+int32_t kernel_data[kLayers][kKernelWords];
+int32_t threshold_data[kLayers][kChannels];
+
+void BuildRegion(flexbuffers::Builder& fbb, int rows, int cols) {
+  fbb.Map("par", [&]() {
+    fbb.Int("th", 1);
+    fbb.Vector("rc", [&]() {
+      fbb.Vector([&]() {
+        fbb.Int(0);
+        fbb.Int(0);
+        fbb.Int(rows);
+        fbb.Int(cols);
+      });
+    });
+  });
+}
+
+void BuildKernelShape(flexbuffers::Builder& fbb) {
+  fbb.Int(kChannels);
+  fbb.Int(kKernelSize);
+  fbb.Int(kKernelSize);
+  fbb.Int(kChannels);
+}
+
+// Options of one layer run on its own
+void BuildBConv2DOptions(flexbuffers::Builder& fbb, int layer) {
+  fbb.Map([&]() {
+    fbb.Vector("K", [&]() { BuildKernelShape(fbb); });
+    fbb.Vector("stride", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+    });
+    BuildRegion(fbb, kHeight[layer + 1], kWidth[layer + 1]);
+  });
+  fbb.Finish();
+}
+
+// Options of a pipeline of n_layers layers
+void BuildPipelineOptions(flexbuffers::Builder& fbb, int n_layers) {
+  fbb.Map([&]() {
+    fbb.Vector("K", [&]() {
+      for (int l = 0; l < n_layers; l++) {
+        fbb.Vector([&]() { BuildKernelShape(fbb); });
+      }
+    });
+    fbb.Vector("stride", [&]() {
+      for (int l = 0; l < n_layers; l++) {
+        fbb.Vector([&]() {
+          fbb.Int(1);
+          fbb.Int(1);
+        });
+      }
+    });
+    BuildRegion(fbb, kHeight[kLayers], kWidth[kLayers]);
+  });
+  fbb.Finish();
+}
+
+TfLiteStatus Run(const TfLiteRegistration& registration, TfLiteTensor* tensors,
+                 int tensors_size, int* inputs_array_data,
+                 int* outputs_array_data, const flexbuffers::Builder* fbb) {
+  micro::KernelRunner runner(registration, tensors, tensors_size,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), nullptr);
+  if (fbb) {
+    const std::vector<uint8_t>& options = fbb->GetBuffer();
+    TF_LITE_ENSURE_STATUS(runner.InitAndPrepare(
+        reinterpret_cast<const char*>(options.data()), options.size()));
+  } else {
+    TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  }
+  return runner.Invoke();
+}
+
+// Runs BSign_8, then each bitpacked BConv2D on the output of the one before
+TfLiteStatus RunUnfused(int32_t* output_data) {
+  int32_t packed_data[kHeight[0] * kWidth[0] * kWords];
+  int32_t hidden_data[kHeight[1] * kWidth[1] * kWords];
+
+  int input_dims[] = {4, 1, kHeight[0], kWidth[0], kChannels};
+  int packed_dims[] = {4, 1, kHeight[0], kWidth[0], kWords};
+  int hidden_dims[] = {4, 1, kHeight[1], kWidth[1], kWords};
+  int output_dims[] = {4, 1, kHeight[2], kWidth[2], kWords};
+  int kernel_dims[] = {4, kChannels, kKernelSize, kKernelSize, kWords};
+  int threshold_dims[] = {1, kChannels};
+
+  {
+    TfLiteTensor tensors[] = {
+        CreateTensor(input_data, IntArrayFromInts(input_dims)),
+        CreateTensor(packed_data, IntArrayFromInts(packed_dims)),
+    };
+    int inputs_array_data[] = {1, 0};
+    int outputs_array_data[] = {1, 1};
+    TF_LITE_ENSURE_STATUS(Run(*xc::Register_BSign_8(), tensors, 2,
+                              inputs_array_data, outputs_array_data, nullptr));
+  }
+
+  int32_t* layer_inputs[kLayers] = {packed_data, hidden_data};
+  int* layer_input_dims[kLayers] = {packed_dims, hidden_dims};
+  int32_t* layer_outputs[kLayers] = {hidden_data, output_data};
+  int* layer_output_dims[kLayers] = {hidden_dims, output_dims};
+  for (int l = 0; l < kLayers; l++) {
+    TfLiteTensor tensors[] = {
+        CreateTensor(layer_inputs[l], IntArrayFromInts(layer_input_dims[l])),
+        CreateTensor(kernel_data[l], IntArrayFromInts(kernel_dims)),
+        CreateTensor(threshold_data[l], IntArrayFromInts(threshold_dims)),
+        CreateTensor(layer_outputs[l], IntArrayFromInts(layer_output_dims[l])),
+    };
+    int inputs_array_data[] = {3, 0, 1, 2};
+    int outputs_array_data[] = {1, 3};
+    flexbuffers::Builder fbb;
+    BuildBConv2DOptions(fbb, l);
+    TF_LITE_ENSURE_STATUS(Run(*xc::Register_BConv2D_Bitpacked(), tensors, 4,
+                              inputs_array_data, outputs_array_data, &fbb));
+  }
+  return kTfLiteOk;
+}
+
+// Runs the layers as one BSign_BConv2D pipeline of n_layers layers
+TfLiteStatus RunPipeline(int n_layers, int32_t* output_data) {
+  int input_dims[] = {4, 1, kHeight[0], kWidth[0], kChannels};
+  int output_dims[] = {4, 1, kHeight[2], kWidth[2], kWords};
+  int kernel_dims[] = {4, kChannels, kKernelSize, kKernelSize, kWords};
+  int threshold_dims[] = {1, kChannels};
+
+  TfLiteTensor tensors[] = {
+      CreateTensor(input_data, IntArrayFromInts(input_dims)),
+      CreateTensor(kernel_data[0], IntArrayFromInts(kernel_dims)),
+      CreateTensor(threshold_data[0], IntArrayFromInts(threshold_dims)),
+      CreateTensor(kernel_data[1], IntArrayFromInts(kernel_dims)),
+      CreateTensor(threshold_data[1], IntArrayFromInts(threshold_dims)),
+      CreateTensor(output_data, IntArrayFromInts(output_dims)),
+  };
+  int inputs_array_data[] = {5, 0, 1, 2, 3, 4};
+  int outputs_array_data[] = {1, 5};
+  flexbuffers::Builder fbb;
+  BuildPipelineOptions(fbb, n_layers);
+  return Run(*xc::Register_BSign_BConv2D_Bitpacked(), tensors, 6,
+             inputs_array_data, outputs_array_data, &fbb);
+}
+
+void InitData() {
+  for (size_t i = 0; i < sizeof(input_data); i++) {
+    input_data[i] = static_cast<int8_t>(i * 37 + 11);
+  }
+  for (int l = 0; l < kLayers; l++) {
+    for (int i = 0; i < kKernelWords; i++) {
+      kernel_data[l][i] = static_cast<int32_t>(
+          static_cast<uint32_t>(i + 1 + l) * 2654435761u);
+    }
+    // around half of the kernel's bits, so the outputs are mixed
+    for (int c = 0; c < kChannels; c++) {
+      threshold_data[l][c] =
+          kKernelSize * kKernelSize * kChannels / 2 + (c % 7) - 3;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// The pipeline must give the output of its layers run one after the other
+TF_LITE_MICRO_TEST(PipelineMatchesUnfusedLayers) {
+  namespace xc = tflite::ops::micro::xcore;
+  using tflite::testing::kHeight;
+  using tflite::testing::kLayers;
+  using tflite::testing::kWidth;
+  using tflite::testing::kWords;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  constexpr int kOutputSize = kHeight[kLayers] * kWidth[kLayers] * kWords;
+  int32_t unfused_output[kOutputSize];
+  int32_t pipeline_output[kOutputSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunUnfused(unfused_output));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, tflite::testing::RunPipeline(
+                                         kLayers, pipeline_output));
+  for (int i = 0; i < kOutputSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(unfused_output[i], pipeline_output[i]);
+  }
+}
+
+// More layers than the pipeline holds are rejected rather than overflowing
+// its per-layer arrays
+TF_LITE_MICRO_TEST(PipelineRejectsTooManyLayers) {
+  namespace xc = tflite::ops::micro::xcore;
+  using tflite::testing::kHeight;
+  using tflite::testing::kLayers;
+  using tflite::testing::kWidth;
+  using tflite::testing::kWords;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  int32_t output[kHeight[kLayers] * kWidth[kLayers] * kWords];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunPipeline(5, output));
+}
+
+TF_LITE_MICRO_TESTS_END
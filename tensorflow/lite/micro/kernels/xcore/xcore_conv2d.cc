@@ -28,6 +28,9 @@ struct Conv2DArguments {
   nn_window_params_t window;                    // not used by 1x1
   int8_t zero_point;                            // not used by 1x1
   nn_conv2d_depthwise_flags_e depthwise_flags;  // only for depthwise
+  // only for depthwise, BSO is one channel group's block, see
+  // fetch_channel_group
+  bool bso_block_only = false;
 };
 
 struct Conv2DOpData {
@@ -38,6 +41,7 @@ struct Conv2DOpData {
   size_t stack_size;
   int weights_scratch_index = -1;
   int bias_scratch_index = -1;
+  bool double_buffered = false;
 };
 
 // -------------------------------------------------------------------- //
@@ -46,46 +50,81 @@ struct Conv2DOpData {
 
 struct Conv2DThreadData {
   Conv2DArguments *args;
-  nn_window_op_job_params_t job;
+  const RowColRegion *jobs;
+  JobClaimer claimer;
+  int32_t changrp_start;
+  int32_t changrp_size;
 };
 
+// Claims the next job, returns false when there are no jobs left
+static inline bool claim_job(Conv2DThreadData *td,
+                             nn_window_op_job_params_t &job) {
+  int32_t index;
+  if (!td->claimer.Claim(index)) return false;
+  const RowColRegion &region = td->jobs[index];
+  job = {{region.top, region.left, td->changrp_start},
+         {region.rows, region.cols, td->changrp_size}};
+  return true;
+}
+
 extern "C" {
 ATTRIBUTE_THREAD_FUNCTION void conv2d_shallow_thread_worker(void *context) {
   auto *td = static_cast<Conv2DThreadData *>(context);
   auto *args = td->args;
-  conv2d_shallowin_ext(args->Y, args->X, args->K, args->BSO, args->zero_point,
-                       &args->x_image, &args->y_image, &args->window, &td->job,
-                       CONV2D_SHALLOWIN_FLAG_SLICED_K);
+  nn_window_op_job_params_t job;
+  while (claim_job(td, job)) {
+    conv2d_shallowin_ext(args->Y, args->X, args->K, args->BSO,
+                         args->zero_point, &args->x_image, &args->y_image,
+                         &args->window, &job, CONV2D_SHALLOWIN_FLAG_SLICED_K);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void conv2d_deep_thread_worker(void *context) {
   auto *td = static_cast<Conv2DThreadData *>(context);
   auto *args = td->args;
-
-  conv2d_deep_ext(args->Y, args->X, args->K, args->BSO, args->zero_point,
-                  &args->x_image, &args->y_image, &args->window, &td->job,
-                  CONV2D_DEEP_FLAG_SLICED_K);
+  nn_window_op_job_params_t job;
+  while (claim_job(td, job)) {
+    conv2d_deep_ext(args->Y, args->X, args->K, args->BSO, args->zero_point,
+                    &args->x_image, &args->y_image, &args->window, &job,
+                    CONV2D_DEEP_FLAG_SLICED_K);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void conv2d_1x1_thread_worker(void *context) {
   auto *td = static_cast<Conv2DThreadData *>(context);
   auto *args = td->args;
-
-  // TODO: consider changing the kernel to unify this job struct
-  nn_conv2d_1x1_job_params_t job;
-  job.start = td->job.start;
-  job.size.channels = td->job.size.channels;
-  job.size.pixels = td->job.size.rows * td->job.size.cols;
-  conv2d_1x1_ext(args->Y, args->X, args->K, args->BSO, &args->x_image,
-                 &args->y_image, &job, CONV2D_1X1_FLAG_SLICED_K);
+  nn_window_op_job_params_t window_job;
+  while (claim_job(td, window_job)) {
+    // TODO: consider changing the kernel to unify this job struct
+    nn_conv2d_1x1_job_params_t job;
+    job.start = window_job.start;
+    job.size.channels = window_job.size.channels;
+    job.size.pixels = window_job.size.rows * window_job.size.cols;
+    conv2d_1x1_ext(args->Y, args->X, args->K, args->BSO, &args->x_image,
+                   &args->y_image, &job, CONV2D_1X1_FLAG_SLICED_K);
+  }
 }
 
 ATTRIBUTE_THREAD_FUNCTION void conv2d_depthwise_thread_worker(void *context) {
   auto *td = static_cast<Conv2DThreadData *>(context);
   auto *args = td->args;
-  conv2d_depthwise_ext(args->Y, args->X, args->K, args->BSO, args->zero_point,
-                       &args->x_image, &args->y_image, &args->window, &td->job,
-                       args->depthwise_flags);
+  nn_window_op_job_params_t job;
+  while (claim_job(td, job)) {
+    if (args->bso_block_only) {
+      // BSO is the block of the job's channel group only, so run the group as
+      // the first channels of images and weights that start at the group
+      const int32_t start = job.start.channels;
+      job.start.channels = 0;
+      conv2d_depthwise_ext(&args->Y[start], &args->X[start], &args->K[start],
+                           args->BSO, args->zero_point, &args->x_image,
+                           &args->y_image, &args->window, &job,
+                           args->depthwise_flags);
+    } else {
+      conv2d_depthwise_ext(args->Y, args->X, args->K, args->BSO,
+                           args->zero_point, &args->x_image, &args->y_image,
+                           &args->window, &job, args->depthwise_flags);
+    }
+  }
 }
 }
 
@@ -165,14 +204,25 @@ TfLiteStatus PrepareCommon(TfLiteContext *context, TfLiteNode *node) {
 
   auto *op_data = reinterpret_cast<Conv2DOpData *>(node->user_data);
 
-  TF_LITE_ENSURE_STATUS(
-      request_scratch_if_needed(context, GetInput(context, node, 1)->data.data,
-                                op_data->execution_plan.GetWeightsScratchSize(),
-                                op_data->weights_scratch_index));
-  TF_LITE_ENSURE_STATUS(
-      request_scratch_if_needed(context, GetInput(context, node, 2)->data.data,
-                                op_data->execution_plan.GetBiasScratchSize(),
-                                op_data->bias_scratch_index));
+  const auto *weights = GetInput(context, node, 1);
+  const auto *bso = GetInput(context, node, 2);
+
+  // double buffer the weights and biases fetched from external memory, so
+  // the next channel group is fetched while the current one is computed
+  op_data->double_buffered =
+      (op_data->execution_plan.changrps.size() > 1) &&
+      !(is_ram_address((uintptr_t)weights->data.data) &&
+        is_ram_address((uintptr_t)bso->data.data));
+  size_t n_buffers = op_data->double_buffered ? 2 : 1;
+
+  TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+      context, weights->data.data,
+      n_buffers * op_data->execution_plan.GetWeightsScratchSize(),
+      op_data->weights_scratch_index));
+  TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+      context, bso->data.data,
+      n_buffers * op_data->execution_plan.GetBiasScratchSize(),
+      op_data->bias_scratch_index));
 
   const auto &input_shape = GetTensorShape(GetInput(context, node, 0));
   op_data->args.x_image = {(uint32_t)input_shape.Dims(1),
@@ -200,9 +250,14 @@ TfLiteStatus Prepare(TfLiteContext *context, TfLiteNode *node) {
 
   auto *op_data = reinterpret_cast<Conv2DOpData *>(node->user_data);
 
+  // split the regions into the jobs threads will claim
+  TF_LITE_ENSURE_STATUS(CreateJobs(context, op_data->execution_plan.regions,
+                                   GetDispatcher()->IsDynamicScheduling(),
+                                   op_data->execution_plan.jobs));
+
   // allocate the stack for thread workers
   Conv2DKernel<kernel_type>::calculate_worker_stack_size(op_data->stack_size);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op_data->stack_size * op_data->execution_plan.regions.size(),
       &op_data->stack_scratch_index));
 
@@ -230,36 +285,60 @@ TfLiteStatus EvalCommon(TfLiteContext *context, TfLiteNode *node) {
   op_data->args.X = tflite::micro::GetTensorData<nn_image_t>(
       tflite::micro::GetEvalInput(context, node, 0));
 
-  if (op_data->weights_scratch_index >= 0) {
-    op_data->args.K = static_cast<nn_tensor_t *>(
-        context->GetScratchBuffer(context, op_data->weights_scratch_index));
-    TFLITE_DCHECK(op_data->args.K != nullptr);
-  }
-  if (op_data->bias_scratch_index >= 0) {
-    op_data->args.BSO = static_cast<nn_bso_block_t *>(
-        context->GetScratchBuffer(context, op_data->bias_scratch_index));
-    TFLITE_DCHECK(op_data->args.BSO != nullptr);
-  }
   return kTfLiteOk;
 }
 
-static void fetch_depthwise_subtensor(int8_t *dest, const nn_tensor_t *weights,
-                                      const unsigned K_h, const unsigned K_w,
-                                      const unsigned X_c,
-                                      const unsigned start_channel,
-                                      const unsigned channel_count) {
-  assert(start_channel % 16 == 0);
-  assert(channel_count % 4 == 0);
-
-  weights =
-      &(weights[start_channel]);  // Address of weights[0][0][start_channel]
-
-  // Total of K_h * K_w blocks, for a total of K_h*K_w*channel_count bytes
-  for (int k = 0; k < K_h * K_w; k++) {
-    FetchBuffer(&dest, weights, channel_count);
-    // memcpy(dest, weights, channel_count);
-    dest = &(dest[channel_count]);
-    weights = &(weights[X_c]);
+// Fetches (or queues on fetcher, if not nullptr) the weights and biases of a
+// channel group into weights_dest and bso_dest, and points args at them.
+template <Conv2DKernelType kernel_type>
+static void fetch_channel_group(const Conv2DOpData *op_data,
+                                Conv2DArguments &args, int8_t *weights_dest,
+                                int8_t *bso_dest,
+                                const int8_t *weights_src_array,
+                                const int8_t *bso_src_array,
+                                const size_t channel_size,
+                                const ChannelGroup &changrp,
+                                AsyncFetcher *fetcher) {
+  const int8_t *bso_src = &bso_src_array[changrp.index * kBSOChannelGroupBytes];
+
+  if (kernel_type == Conv2DKernelType::kDepthwise) {
+    // the weights are only sliced if they are external, the BSO is fetched
+    // whenever it is external
+    const bool sliced = op_data->weights_scratch_index >= 0;
+    if (sliced) {
+      assert(changrp.start % 16 == 0);
+      assert(changrp.size % 4 == 0);
+
+      // Total of K_h * K_w blocks, for a total of K_h*K_w*changrp.size bytes
+      args.K = weights_dest;
+      fetch_or_queue_strided(
+          fetcher, weights_dest, &weights_src_array[changrp.start],
+          changrp.size, args.window.shape.height * args.window.shape.width,
+          channel_size);
+    }
+
+    const auto *bso = (const nn_bso_block_t *)bso_src;
+    if (op_data->bias_scratch_index >= 0) {
+      // always copied, so that bso_dest holds the block once it is fetched
+      fetch_or_queue_strided(fetcher, bso_dest, bso_src, kBSOChannelGroupBytes,
+                             1, kBSOChannelGroupBytes);
+      bso = (const nn_bso_block_t *)bso_dest;
+    } else if (!sliced) {
+      return;  // args.BSO is the whole BSO, in RAM
+    }
+    // Unsliced, the kernel indexes the BSO by the job's channels, so the
+    // worker offsets the job to the channel group to index just this block
+    args.BSO = bso;
+    args.bso_block_only = !sliced;
+  } else {
+    size_t weights_fetch_size = channel_size * changrp.size;
+    args.K = weights_dest;
+    fetch_or_queue(fetcher, (int8_t **)&args.K,
+                   &weights_src_array[channel_size * changrp.start],
+                   weights_fetch_size);
+    args.BSO = (const nn_bso_block_t *)bso_dest;
+    fetch_or_queue(fetcher, (int8_t **)&args.BSO, bso_src,
+                   kBSOChannelGroupBytes);
   }
 }
 
@@ -270,8 +349,8 @@ TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
   auto *op_data = reinterpret_cast<Conv2DOpData *>(node->user_data);
 
   // initialize the threads
-  auto *stack = static_cast<char *>(
-      context->GetScratchBuffer(context, op_data->stack_scratch_index));
+  char *stack =
+      GetDispatcher()->GetStack(context, op_data->stack_scratch_index);
   TF_LITE_ENSURE(context, stack);
 
   Dispatcher *dispatcher = GetDispatcher();
@@ -279,11 +358,15 @@ TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
                               op_data->stack_size);
 
   // TODO: move this to init
-  // create thread data
-  int n_th = op_data->execution_plan.GetNumThreads();
-  Conv2DThreadData thread_data[n_th];
-  for (int j{0}; j < n_th; j++) {
-    thread_data[j].args = &op_data->args;
+  // create thread data, one set per weights buffer, with one task per region
+  Conv2DArguments args[2] = {op_data->args, op_data->args};
+  JobQueue *queue = dispatcher->GetJobQueue();
+  const int n_jobs = op_data->execution_plan.jobs.size();
+  const int n_regions = op_data->execution_plan.regions.size();
+  Conv2DThreadData thread_data[2 * n_regions];
+  for (int j{0}; j < 2 * n_regions; j++) {
+    thread_data[j].args = &args[j / n_regions];
+    thread_data[j].jobs = op_data->execution_plan.jobs.begin();
   }
 
   const auto *weights = tflite::micro::GetEvalInput(context, node, 1);
@@ -295,52 +378,82 @@ TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
   const auto *bso_src_array = tflite::micro::GetTensorData<int8_t>(
       tflite::micro::GetEvalInput(context, node, 2));
 
-  if (kernel_type == Conv2DKernelType::kDepthwise) {
-    if (op_data->weights_scratch_index >= 0) {
-      op_data->args.depthwise_flags = CONV2D_DEPTHWISE_FLAG_SLICED_K;
-    } else {
-      op_data->args.depthwise_flags = (nn_conv2d_depthwise_flags_e)0;
-      op_data->args.K = weights_src_array;
-      op_data->args.BSO = (const nn_bso_block_t *)bso_src_array;
+  // locate the (double) buffers for weights and biases
+  int8_t *weights_scratch[2] = {nullptr, nullptr};
+  int8_t *bso_scratch[2] = {nullptr, nullptr};
+  if (op_data->weights_scratch_index >= 0) {
+    weights_scratch[0] = static_cast<int8_t *>(
+        context->GetScratchBuffer(context, op_data->weights_scratch_index));
+    TFLITE_DCHECK(weights_scratch[0] != nullptr);
+    if (op_data->double_buffered) {
+      weights_scratch[1] =
+          weights_scratch[0] + op_data->execution_plan.GetWeightsScratchSize();
+    }
+  }
+  if (op_data->bias_scratch_index >= 0) {
+    bso_scratch[0] = static_cast<int8_t *>(
+        context->GetScratchBuffer(context, op_data->bias_scratch_index));
+    TFLITE_DCHECK(bso_scratch[0] != nullptr);
+    if (op_data->double_buffered) {
+      bso_scratch[1] =
+          bso_scratch[0] + op_data->execution_plan.GetBiasScratchSize();
     }
   }
 
-  size_t weights_src_offset = 0;
-  size_t biases_src_offset = 0;
-  for (int i_cg = 0; i_cg < op_data->execution_plan.changrps.size(); i_cg++) {
-    const auto &changrp = op_data->execution_plan.changrps[i_cg];
-
-    // fetch weights and biases
-    if (kernel_type == Conv2DKernelType::kDepthwise) {
+  if (kernel_type == Conv2DKernelType::kDepthwise) {
+    for (auto &arg : args) {
       if (op_data->weights_scratch_index >= 0) {
-        fetch_depthwise_subtensor((int8_t *)op_data->args.K, weights_src_array,
-                                  op_data->args.window.shape.height,
-                                  op_data->args.window.shape.width,
-                                  channel_size, changrp.start, changrp.size);
-      }
-      if (op_data->bias_scratch_index >= 0) {
-        FetchBuffer((int8_t **)&op_data->args.BSO,
-                    &bso_src_array[biases_src_offset], kBSOChannelGroupBytes);
-        biases_src_offset += kBSOChannelGroupBytes;
+        arg.depthwise_flags = CONV2D_DEPTHWISE_FLAG_SLICED_K;
+      } else {
+        arg.depthwise_flags = (nn_conv2d_depthwise_flags_e)0;
+        arg.K = weights_src_array;
+        arg.BSO = (const nn_bso_block_t *)bso_src_array;
       }
-    } else {
-      size_t weights_fetch_size = channel_size * changrp.size;
-      FetchBuffer((int8_t **)&op_data->args.K,
-                  &weights_src_array[weights_src_offset], weights_fetch_size);
-      weights_src_offset += weights_fetch_size;
-      FetchBuffer((int8_t **)&op_data->args.BSO,
-                  &bso_src_array[biases_src_offset], kBSOChannelGroupBytes);
-      biases_src_offset += kBSOChannelGroupBytes;
+    }
+  }
+
+  AsyncFetcher *fetcher = dispatcher->GetFetcher();
+  const int n_changrps = op_data->execution_plan.changrps.size();
+  if (n_changrps > 0) {
+    fetch_channel_group<kernel_type>(
+        op_data, args[0], weights_scratch[0], bso_scratch[0], weights_src_array,
+        bso_src_array, channel_size, op_data->execution_plan.changrps[0],
+        nullptr);
+  }
+
+  for (int i_cg = 0; i_cg < n_changrps; i_cg++) {
+    const auto &changrp = op_data->execution_plan.changrps[i_cg];
+    const int i_buf = op_data->double_buffered ? (i_cg % 2) : 0;
+    const bool prefetch = op_data->double_buffered && (i_cg + 1 < n_changrps);
+
+    // start fetching the next channel group into the other buffer
+    if (prefetch) {
+      fetch_channel_group<kernel_type>(
+          op_data, args[1 - i_buf], weights_scratch[1 - i_buf],
+          bso_scratch[1 - i_buf], weights_src_array, bso_src_array,
+          channel_size, op_data->execution_plan.changrps[i_cg + 1], fetcher);
+      fetcher->StartFetches();
     }
 
-    for (int i_rg = 0; i_rg < op_data->execution_plan.regions.size(); i_rg++) {
-      const auto &region = op_data->execution_plan.regions[i_rg];
+    queue->Reset(n_jobs);
+    for (int i_rg = 0; i_rg < n_regions; i_rg++) {
+      auto &td = thread_data[i_buf * n_regions + i_rg];
 
-      thread_data[i_rg].job = {{region.top, region.left, changrp.start},
-                               {region.rows, region.cols, changrp.size}};
-      dispatcher->AddTask(reinterpret_cast<void *>(&thread_data[i_rg]));
+      td.claimer.Reset(queue, n_jobs, n_regions, i_rg);
+      td.changrp_start = changrp.start;
+      td.changrp_size = changrp.size;
+      dispatcher->AddTask(reinterpret_cast<void *>(&td));
     }
     dispatcher->JoinTasks();
+
+    if (prefetch) {
+      fetcher->WaitFetches();
+    } else if (i_cg + 1 < n_changrps) {
+      fetch_channel_group<kernel_type>(
+          op_data, args[0], weights_scratch[0], bso_scratch[0],
+          weights_src_array, bso_src_array, channel_size,
+          op_data->execution_plan.changrps[i_cg + 1], nullptr);
+    }
   }
 
   return kTfLiteOk;
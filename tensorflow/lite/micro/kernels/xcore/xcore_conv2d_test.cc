@@ -0,0 +1,265 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <cstdint>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_ops.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_prefetcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+namespace xc = tflite::ops::micro::xcore;
+
+constexpr int kHeight = 4;
+constexpr int kWidth = 4;
+constexpr int kChangrpSize = xc::kChannelGroupLength;
+constexpr int kChangrps = 2;
+constexpr int kChannels = kChangrps * kChangrpSize;
+constexpr int kImageSize = kHeight * kWidth * kChannels;
+
+int8_t input_data[kImageSize];
+int8_t weights_data[3 * 3 * kChannels];
+int16_t bso_data[kChangrps * xc::kBSOChannelGroupLength];
+
+// Options of a 3x3 depthwise convolution that keeps the image size, run one
+// channel group at a time over n_regions bands of rows
+void BuildDepthwiseOptions(flexbuffers::Builder& fbb, int n_threads = 1,
+                           int n_regions = 1) {
+  fbb.Map([&]() {
+    fbb.Vector("stride", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+    });
+    fbb.Vector("pad", [&]() {
+      fbb.Int(1);
+      fbb.Int(1);
+      fbb.Int(0);
+    });
+    fbb.Map("par", [&]() {
+      fbb.Int("th", n_threads);
+      fbb.Vector("cg", [&]() {
+        for (int start = 0; start < kChannels; start += kChangrpSize) {
+          fbb.Vector([&]() {
+            fbb.Int(start);
+            fbb.Int(start + kChangrpSize - 1);
+          });
+        }
+      });
+      fbb.Vector("rc", [&]() {
+        for (int top = 0; top < kHeight; top += kHeight / n_regions) {
+          fbb.Vector([&]() {
+            fbb.Int(top);
+            fbb.Int(0);
+            fbb.Int(kHeight / n_regions);
+            fbb.Int(kWidth);
+          });
+        }
+      });
+    });
+    fbb.Vector("mem", [&]() {
+      fbb.Int(3 * 3 * kChangrpSize);
+      fbb.Int(xc::kBSOChannelGroupBytes);
+    });
+  });
+  fbb.Finish();
+}
+
+TfLiteStatus RunDepthwise(const flexbuffers::Builder& fbb,
+                          int8_t* output_data) {
+  int input_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {3, 3, 3, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  int output_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  TfLiteTensor tensors[] = {
+      CreateTensor(input_data, IntArrayFromInts(input_dims)),
+      CreateTensor(weights_data, IntArrayFromInts(weights_dims)),
+      CreateTensor(bso_data, IntArrayFromInts(bso_dims)),
+      CreateTensor(output_data, IntArrayFromInts(output_dims)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+
+  micro::KernelRunner runner(*xc::Register_Conv2D_Depthwise(), tensors,
+                             sizeof(tensors) / sizeof(tensors[0]),
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), nullptr);
+  const std::vector<uint8_t>& options = fbb.GetBuffer();
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare(
+      reinterpret_cast<const char*>(options.data()), options.size()));
+  return runner.Invoke();
+}
+
+// The depthwise convolution's inputs, as the WeightPrefetcher sees them
+TfLiteEvalTensor prefetch_tensors[3];
+
+TfLiteEvalTensor* GetPrefetchTensor(const TfLiteContext* context,
+                                    int tensor_index) {
+  return &prefetch_tensors[tensor_index];
+}
+
+// Prefetches the depthwise convolution's constant tensors in external memory
+// and makes them visible to FetchBuffer, as the interpreter does before
+// invoking the node
+TfLiteStatus PrefetchDepthwise(xc::WeightPrefetcher* prefetcher) {
+  int input_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {3, 3, 3, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  void* data[] = {input_data, weights_data, bso_data};
+  int* dims[] = {input_dims, weights_dims, bso_dims};
+  TfLiteType types[] = {kTfLiteInt8, kTfLiteInt8, kTfLiteInt16};
+  for (int i = 0; i < 3; i++) {
+    prefetch_tensors[i].data.data = data[i];
+    prefetch_tensors[i].dims = IntArrayFromInts(dims[i]);
+    prefetch_tensors[i].type = types[i];
+  }
+  TfLiteContext context = {};
+  context.GetEvalTensor = GetPrefetchTensor;
+  int inputs_array_data[] = {3, 0, 1, 2};
+  TfLiteNode node = {};
+  node.inputs = IntArrayFromInts(inputs_array_data);
+
+  TF_LITE_ENSURE_STATUS(prefetcher->Prefetch(&context, &node));
+  return prefetcher->Activate();
+}
+
+void InitData() {
+  for (int i = 0; i < kImageSize; i++) {
+    input_data[i] = static_cast<int8_t>(i * 7);
+  }
+  for (size_t i = 0; i < sizeof(weights_data); i++) {
+    weights_data[i] = static_cast<int8_t>(i * 5 - 64);
+  }
+  constexpr size_t kBsoLength = sizeof(bso_data) / sizeof(int16_t);
+  for (size_t i = 0; i < kBsoLength; i++) {
+    bso_data[i] = static_cast<int16_t>(i % 13);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// Only the BSO is in external memory, so the weights are used in place while
+// the BSO of each channel group is fetched
+TF_LITE_MICRO_TEST(DepthwiseFetchesExternalBsoOfUnslicedWeights) {
+  using tflite::testing::kImageSize;
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  flexbuffers::Builder fbb;
+  tflite::testing::BuildDepthwiseOptions(fbb);
+
+  int8_t ram_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunDepthwise(fbb, ram_output));
+
+  xc::SetHostExternalMemory(tflite::testing::bso_data,
+                            sizeof(tflite::testing::bso_data));
+  xc::ResetFetchBytes();
+  int8_t external_output[kImageSize];
+  const TfLiteStatus status =
+      tflite::testing::RunDepthwise(fbb, external_output);
+  const size_t fetched = xc::GetFetchBytes();
+  xc::SetHostExternalMemory(nullptr, 0);
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, status);
+  TF_LITE_MICRO_EXPECT_EQ(sizeof(tflite::testing::bso_data), fetched);
+  for (int i = 0; i < kImageSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(ram_output[i], external_output[i]);
+  }
+}
+
+// The thread data is sized by the regions the plan is split into, even when
+// the plan has fewer threads
+TF_LITE_MICRO_TEST(DepthwiseRunsMoreRegionsThanThreads) {
+  using tflite::testing::kImageSize;
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  flexbuffers::Builder one_region_fbb;
+  tflite::testing::BuildDepthwiseOptions(one_region_fbb);
+  int8_t one_region_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, tflite::testing::RunDepthwise(
+                                         one_region_fbb, one_region_output));
+
+  flexbuffers::Builder four_regions_fbb;
+  tflite::testing::BuildDepthwiseOptions(four_regions_fbb, 1, 4);
+  int8_t four_regions_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::testing::RunDepthwise(four_regions_fbb, four_regions_output));
+  for (int i = 0; i < kImageSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(one_region_output[i], four_regions_output[i]);
+  }
+}
+
+// The op reads the prefetched copy of the BSO instead of fetching it, and
+// gets the same output. Another dispatcher doesn't see the copy.
+TF_LITE_MICRO_TEST(DepthwiseReadsPrefetchedBso) {
+  using tflite::testing::kImageSize;
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  flexbuffers::Builder fbb;
+  tflite::testing::BuildDepthwiseOptions(fbb);
+
+  xc::SetHostExternalMemory(tflite::testing::bso_data,
+                            sizeof(tflite::testing::bso_data));
+  xc::ResetFetchBytes();
+  int8_t fetched_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunDepthwise(fbb, fetched_output));
+  TF_LITE_MICRO_EXPECT_EQ(sizeof(tflite::testing::bso_data),
+                          xc::GetFetchBytes());
+
+  constexpr size_t kRegionSize = sizeof(tflite::testing::bso_data);
+  alignas(8) static int8_t regions[2 * kRegionSize];
+  xc::WeightPrefetcher prefetcher(&dispatcher);
+  prefetcher.SetRegions(regions, &regions[kRegionSize], kRegionSize);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::PrefetchDepthwise(&prefetcher));
+
+  xc::ResetFetchBytes();
+  int8_t prefetched_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunDepthwise(fbb, prefetched_output));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0), xc::GetFetchBytes());
+  for (int i = 0; i < kImageSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(fetched_output[i], prefetched_output[i]);
+  }
+
+  xc::Dispatcher other_dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&other_dispatcher);
+  xc::ResetFetchBytes();
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunDepthwise(fbb, prefetched_output));
+  TF_LITE_MICRO_EXPECT_EQ(sizeof(tflite::testing::bso_data),
+                          xc::GetFetchBytes());
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, prefetcher.Reset());
+  xc::SetHostExternalMemory(nullptr, 0);
+}
+
+TF_LITE_MICRO_TESTS_END
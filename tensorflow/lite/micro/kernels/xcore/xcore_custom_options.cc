@@ -1,10 +1,87 @@
 #include "tensorflow/lite/micro/kernels/xcore/xcore_custom_options.h"
 
+#include <cstring>
+
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+
 namespace tflite {
 namespace ops {
 namespace micro {
 namespace xcore {
 
+// indexed by CustomOptionKey
+static const char *const kCustomOptionKeyNames[] = {
+    "",  // kUnknown
+    "stride", "stride_h", "stride_w", "Kw", "pool", "pad",
+    "par",    "mem",      "th",       "cg", "rc",
+};
+constexpr int kCustomOptionKeyCount =
+    sizeof(kCustomOptionKeyNames) / sizeof(kCustomOptionKeyNames[0]);
+
+static CustomOptionKey find_key(const char *key) {
+  for (int i = 1; i < kCustomOptionKeyCount; i++) {
+    if (strcmp(key, kCustomOptionKeyNames[i]) == 0) {
+      return static_cast<CustomOptionKey>(i);
+    }
+  }
+  return CustomOptionKey::kUnknown;
+}
+
+CustomOptionKeyCache::CustomOptionKeyCache()
+    : next_layout_(0), hits_(0), misses_(0) {
+  // an empty layout matches no key vector
+  for (auto &layout : layouts_) layout.size = kMaxCachedOptionKeys + 1;
+}
+
+bool CustomOptionKeyCache::Matches(const Layout &layout,
+                                   const flexbuffers::TypedVector &keys) const {
+  if (layout.size != keys.size()) return false;
+  for (size_t i = 0; i < layout.size; i++) {
+    const char *key = keys[i].AsKey();
+    const CustomOptionKey cached = layout.keys[i];
+    if (cached == CustomOptionKey::kUnknown) {
+      // unknown keys have no name to compare against
+      if (find_key(key) != CustomOptionKey::kUnknown) return false;
+    } else if (strcmp(key, kCustomOptionKeyNames[static_cast<int>(cached)]) !=
+               0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CustomOptionKeyCache::Lookup(const flexbuffers::TypedVector &keys,
+                                  CustomOptionKey *decoded) {
+  TFLITE_DCHECK(keys.size() <= kMaxCachedOptionKeys);
+
+  for (const auto &layout : layouts_) {
+    if (Matches(layout, keys)) {
+      for (size_t i = 0; i < layout.size; i++) decoded[i] = layout.keys[i];
+      hits_++;
+      return;
+    }
+  }
+
+  misses_++;
+  Layout &layout = layouts_[next_layout_];
+  next_layout_ = (next_layout_ + 1) % kCachedOptionKeyLayouts;
+  layout.size = keys.size();
+  for (size_t i = 0; i < layout.size; i++) {
+    layout.keys[i] = find_key(keys[i].AsKey());
+    decoded[i] = layout.keys[i];
+  }
+}
+
+// Decodes keys with the cache of the interpreter, if it has one, returns false
+//   if the keys are left to be found one at a time
+static bool decode_keys(const flexbuffers::TypedVector &keys,
+                        CustomOptionKey *decoded) {
+  CustomOptionKeyCache *cache = GetDispatcher()->GetOptionKeyCache();
+  if (!cache || keys.size() > kMaxCachedOptionKeys) return false;
+  cache->Lookup(keys, decoded);
+  return true;
+}
+
 CustomOptionParser::CustomOptionParser(const flexbuffers::Map &map)
     : keys_(flexbuffers::TypedVector::EmptyTypedVector()),
       values_(flexbuffers::Vector::EmptyVector()) {
@@ -22,10 +99,9 @@ CustomOptionParser::CustomOptionParser(const char *buffer, size_t buffer_length)
 }
 
 flexbuffers::Reference CustomOptionParser::parseNamedCustomOption(
-    const std::string &name) const {
+    const char *name) const {
   for (int i = 0; i < keys_.size(); ++i) {
-    const auto &key = keys_[i].AsString().str();
-    if (key.compare(name) == 0) {
+    if (strcmp(keys_[i].AsKey(), name) == 0) {
       return values_[i];
     }
   }
@@ -80,6 +156,21 @@ void parse_custom_options(TfLiteContext *context, const char *buffer,
                        &conv2d_params.K_w, &conv2d_params.pad, plan);
 }
 
+//*****************************
+// Conv2DParams + PoolingParams
+//*****************************
+void parse_custom_options(TfLiteContext *context, const char *buffer,
+                          size_t length, Conv2DParams &conv2d_params,
+                          PoolingParams &pooling_params, ExecutionPlan *plan) {
+  parse_custom_options(context, buffer, length, &conv2d_params.stride_h,
+                       &conv2d_params.stride_w, &pooling_params.pool_h,
+                       &pooling_params.pool_w, &conv2d_params.K_w,
+                       &conv2d_params.pad, plan);
+  // "stride" belongs to the convolution, fused pools do not overlap
+  pooling_params.stride_h = pooling_params.pool_h;
+  pooling_params.stride_w = pooling_params.pool_w;
+}
+
 //*****************************
 // All Params
 //*****************************
@@ -88,78 +179,100 @@ void parse_custom_options(TfLiteContext *context, const char *buffer,
                           int32_t *pool_h, int32_t *pool_w, int32_t *K_w,
                           Conv2DPadding *pad, ExecutionPlan *plan) {
   const uint8_t *buffer_t = reinterpret_cast<const uint8_t *>(buffer);
-  // std::cout << flexbuffers::GetRoot(buffer_t, length).ToString() <<
-  // std::endl;
   auto map = flexbuffers::GetRoot(buffer_t, length).AsMap();
 
   auto keys = map.Keys();
   auto values = map.Values();
+  CustomOptionKey option_keys[kMaxCachedOptionKeys];
+  const bool keys_decoded = decode_keys(keys, option_keys);
   for (int i = 0; i < map.size(); ++i) {
-    const std::string &key = keys[i].AsString().str();
-
-    if (key.compare("stride") == 0) {
-      const auto &vec =
-          values[i].AsVector();  // values represent [stride_h, stride_w]
-      if (stride_h) *stride_h = vec[0].AsInt32();
-      if (stride_w) *stride_w = vec[1].AsInt32();
-    } else if (key.compare("stride_h") == 0) {
-      if (stride_h) *stride_h = values[i].AsInt32();
-    } else if (key.compare("stride_w") == 0) {
-      if (stride_w) *stride_w = values[i].AsInt32();
-    } else if (key.compare("Kw") == 0) {
-      if (K_w) *K_w = values[i].AsInt32();
-    } else if (key.compare("pool") == 0) {
-      const auto &vec =
-          values[i].AsVector();  // values represent [pool_h, pool_w]
-      if (pool_h) *pool_h = vec[0].AsInt32();
-      if (pool_w) *pool_w = vec[1].AsInt32();
-    } else if (key.compare("pad") == 0) {
-      if (pad) {
+    switch (keys_decoded ? option_keys[i] : find_key(keys[i].AsKey())) {
+      case CustomOptionKey::kStride: {
         const auto &vec =
-            values[i].AsVector();  // values represent [top, left, zero_point]
-        pad->top = vec[0].AsInt32();
-        pad->left = vec[1].AsInt32();
-        pad->zero_point = vec[2].AsInt32();
+            values[i].AsVector();  // values represent [stride_h, stride_w]
+        if (stride_h) *stride_h = vec[0].AsInt32();
+        if (stride_w) *stride_w = vec[1].AsInt32();
+        break;
       }
-    } else if (key.compare("par") == 0) {
-      if (plan) {
-        const auto &plan_map = values[i].AsMap();
-        auto plan_keys = plan_map.Keys();
-        auto plan_values = plan_map.Values();
-        for (int j = 0; j < plan_map.size(); ++j) {
-          const std::string &plan_key = plan_keys[j].AsString().str();
-          if (plan_key.compare("th") == 0) {
-            plan->SetNumThreads(plan_values[j].AsInt32());
-          } else if (plan_key.compare("cg") == 0) {
-            const auto &changrps = plan_values[j].AsVector();
-            plan->changrps.allocate(context, changrps.size());
-            for (int k = 0; k < changrps.size(); k++) {
-              auto changrp =
-                  changrps[k].AsVector();  // values represent [start, end]
-              plan->changrps.append(
-                  {k, changrp[0].AsInt32(),
-                   changrp[1].AsInt32() - changrp[0].AsInt32() + 1});
-            }
-          } else if (plan_key.compare("rc") == 0) {
-            const auto &regions = plan_values[j].AsVector();
-            plan->regions.allocate(context, regions.size());
-            for (int k = 0; k < regions.size(); k++) {
-              auto region =
-                  regions[k]
-                      .AsVector();  // values represent [top, left, rows, cols]
-              plan->regions.append({region[0].AsInt32(), region[1].AsInt32(),
-                                    region[2].AsInt32(), region[3].AsInt32()});
+      case CustomOptionKey::kStrideH:
+        if (stride_h) *stride_h = values[i].AsInt32();
+        break;
+      case CustomOptionKey::kStrideW:
+        if (stride_w) *stride_w = values[i].AsInt32();
+        break;
+      case CustomOptionKey::kKw:
+        if (K_w) *K_w = values[i].AsInt32();
+        break;
+      case CustomOptionKey::kPool: {
+        const auto &vec =
+            values[i].AsVector();  // values represent [pool_h, pool_w]
+        if (pool_h) *pool_h = vec[0].AsInt32();
+        if (pool_w) *pool_w = vec[1].AsInt32();
+        break;
+      }
+      case CustomOptionKey::kPad:
+        if (pad) {
+          const auto &vec =
+              values[i].AsVector();  // values represent [top, left, zero_point]
+          pad->top = vec[0].AsInt32();
+          pad->left = vec[1].AsInt32();
+          pad->zero_point = vec[2].AsInt32();
+        }
+        break;
+      case CustomOptionKey::kPar:
+        if (plan) {
+          const auto &plan_map = values[i].AsMap();
+          auto plan_keys = plan_map.Keys();
+          auto plan_values = plan_map.Values();
+          CustomOptionKey plan_option_keys[kMaxCachedOptionKeys];
+          const bool plan_keys_decoded =
+              decode_keys(plan_keys, plan_option_keys);
+          for (int j = 0; j < plan_map.size(); ++j) {
+            switch (plan_keys_decoded ? plan_option_keys[j]
+                                      : find_key(plan_keys[j].AsKey())) {
+              case CustomOptionKey::kThreads:
+                plan->SetNumThreads(plan_values[j].AsInt32());
+                break;
+              case CustomOptionKey::kChannelGroups: {
+                const auto &changrps = plan_values[j].AsVector();
+                plan->changrps.allocate(context, changrps.size());
+                for (int k = 0; k < changrps.size(); k++) {
+                  auto changrp =
+                      changrps[k].AsVector();  // values represent [start, end]
+                  plan->changrps.append(
+                      {k, changrp[0].AsInt32(),
+                       changrp[1].AsInt32() - changrp[0].AsInt32() + 1});
+                }
+                break;
+              }
+              case CustomOptionKey::kRegions: {
+                const auto &regions = plan_values[j].AsVector();
+                plan->regions.allocate(context, regions.size());
+                for (int k = 0; k < regions.size(); k++) {
+                  // values represent [top, left, rows, cols]
+                  auto region = regions[k].AsVector();
+                  plan->regions.append(
+                      {region[0].AsInt32(), region[1].AsInt32(),
+                       region[2].AsInt32(), region[3].AsInt32()});
+                }
+                break;
+              }
+              default:
+                break;
             }
           }
         }
-      }
-    } else if (key.compare("mem") == 0) {
-      if (plan) {
-        const auto &vec = values[i].AsVector();  // values represent [weights
-                                                 // scratch, bias scratch]
-        plan->SetWeightsScratchSize(vec[0].AsInt32());
-        plan->SetBiasScratchSize(vec[1].AsInt32());
-      }
+        break;
+      case CustomOptionKey::kMem:
+        if (plan) {
+          const auto &vec = values[i].AsVector();  // values represent [weights
+                                                   // scratch, bias scratch]
+          plan->SetWeightsScratchSize(vec[0].AsInt32());
+          plan->SetBiasScratchSize(vec[1].AsInt32());
+        }
+        break;
+      default:
+        break;
     }
   }
 }
@@ -21,6 +21,11 @@ void parse_custom_options(TfLiteContext *context, const char *buffer,
                           size_t length, Conv2DParams &conv2d_params,
                           ExecutionPlan *plan = nullptr);
 
+void parse_custom_options(TfLiteContext *context, const char *buffer,
+                          size_t length, Conv2DParams &conv2d_params,
+                          PoolingParams &pooling_params,
+                          ExecutionPlan *plan = nullptr);
+
 void parse_custom_options(TfLiteContext *context, const char *buffer,
                           size_t length, int32_t *stride_h = nullptr,
                           int32_t *stride_w = nullptr,
@@ -28,6 +33,57 @@ void parse_custom_options(TfLiteContext *context, const char *buffer,
                           int32_t *K_w = nullptr, Conv2DPadding *pad = nullptr,
                           ExecutionPlan *plan = nullptr);
 
+// The option keys parse_custom_options knows
+enum class CustomOptionKey : uint8_t {
+  kUnknown,
+  kStride,
+  kStrideH,
+  kStrideW,
+  kKw,
+  kPool,
+  kPad,
+  kPar,
+  kMem,
+  kThreads,
+  kChannelGroups,
+  kRegions,
+};
+
+constexpr size_t kMaxCachedOptionKeys = 8;
+constexpr size_t kCachedOptionKeyLayouts = 4;
+
+// Remembers the keys of the option maps decoded last
+//   Maps of one opcode have the same keys in the same (sorted) order, so a key
+//   vector laid out like a cached one is confirmed with one strcmp per key
+//   instead of comparing each key against every known key. Owned by an
+//   interpreter and set on its Dispatcher, it is only used while that
+//   interpreter initializes its ops, one at a time.
+class CustomOptionKeyCache {
+ public:
+  CustomOptionKeyCache();
+
+  // Decodes the key at each position of keys into decoded, keys must not have
+  //   more than kMaxCachedOptionKeys elements
+  void Lookup(const flexbuffers::TypedVector &keys, CustomOptionKey *decoded);
+
+  size_t GetHits() const { return hits_; }
+  size_t GetMisses() const { return misses_; }
+
+ private:
+  struct Layout {
+    size_t size;
+    CustomOptionKey keys[kMaxCachedOptionKeys];
+  };
+
+  bool Matches(const Layout &layout,
+               const flexbuffers::TypedVector &keys) const;
+
+  Layout layouts_[kCachedOptionKeyLayouts];
+  size_t next_layout_;
+  size_t hits_;
+  size_t misses_;
+};
+
 class CustomOptionParser {
  private:
   flexbuffers::TypedVector keys_;
@@ -36,7 +92,7 @@ class CustomOptionParser {
  public:
   CustomOptionParser(const flexbuffers::Map &map);
   CustomOptionParser(const char *buffer, size_t buffer_length);
-  flexbuffers::Reference parseNamedCustomOption(const std::string &name) const;
+  flexbuffers::Reference parseNamedCustomOption(const char *name) const;
   flexbuffers::Vector parseElementwiseJobSizes() const;
 };
 
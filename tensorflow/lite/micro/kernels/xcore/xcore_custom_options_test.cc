@@ -0,0 +1,139 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <cstdint>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_custom_options.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+namespace xc = tflite::ops::micro::xcore;
+
+// Options of a pooling op, with the stride and pool size given
+void BuildPoolingOptions(flexbuffers::Builder& fbb, int32_t stride,
+                         int32_t pool) {
+  fbb.Map([&]() {
+    fbb.Vector("pool", [&]() {
+      fbb.Int(pool);
+      fbb.Int(pool);
+    });
+    fbb.Vector("stride", [&]() {
+      fbb.Int(stride);
+      fbb.Int(stride);
+    });
+  });
+  fbb.Finish();
+}
+
+// Options with as many keys as the pooling options, but other ones
+void BuildStrideOptions(flexbuffers::Builder& fbb, int32_t stride) {
+  fbb.Map([&]() {
+    fbb.Int("stride_h", stride);
+    fbb.Int("stride_w", stride);
+  });
+  fbb.Finish();
+}
+
+void ParsePoolingOptions(const flexbuffers::Builder& fbb, int32_t* stride_h,
+                         int32_t* stride_w, int32_t* pool_h, int32_t* pool_w) {
+  const std::vector<uint8_t>& buffer = fbb.GetBuffer();
+  xc::parse_custom_options(nullptr, reinterpret_cast<const char*>(&buffer[0]),
+                           buffer.size(), stride_h, stride_w, pool_h, pool_w);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// The options of ops of one kind are in separate buffers, but have the same
+// keys, which are only looked up for the first op
+TF_LITE_MICRO_TEST(KeysOfOneLayoutAreDecodedOnce) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::CustomOptionKeyCache cache;
+  dispatcher.SetOptionKeyCache(&cache);
+  xc::SetDispatcher(&dispatcher);
+
+  for (int32_t op = 0; op < 3; op++) {
+    flexbuffers::Builder fbb;
+    tflite::testing::BuildPoolingOptions(fbb, op + 1, op + 2);
+    int32_t stride_h = 0, stride_w = 0, pool_h = 0, pool_w = 0;
+    tflite::testing::ParsePoolingOptions(fbb, &stride_h, &stride_w, &pool_h,
+                                         &pool_w);
+    TF_LITE_MICRO_EXPECT_EQ(op + 1, stride_h);
+    TF_LITE_MICRO_EXPECT_EQ(op + 1, stride_w);
+    TF_LITE_MICRO_EXPECT_EQ(op + 2, pool_h);
+    TF_LITE_MICRO_EXPECT_EQ(op + 2, pool_w);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1), cache.GetMisses());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), cache.GetHits());
+}
+
+// Keys laid out differently are not taken for a cached layout of the same
+// size, and the layouts seen before stay cached
+TF_LITE_MICRO_TEST(OtherKeysOfTheSameSizeMissTheCache) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::CustomOptionKeyCache cache;
+  dispatcher.SetOptionKeyCache(&cache);
+  xc::SetDispatcher(&dispatcher);
+
+  flexbuffers::Builder pooling_fbb;
+  tflite::testing::BuildPoolingOptions(pooling_fbb, 2, 3);
+  int32_t stride_h = 0, stride_w = 0, pool_h = 0, pool_w = 0;
+  tflite::testing::ParsePoolingOptions(pooling_fbb, &stride_h, &stride_w,
+                                       &pool_h, &pool_w);
+
+  flexbuffers::Builder stride_fbb;
+  tflite::testing::BuildStrideOptions(stride_fbb, 4);
+  stride_h = 0;
+  stride_w = 0;
+  pool_h = 0;
+  pool_w = 0;
+  tflite::testing::ParsePoolingOptions(stride_fbb, &stride_h, &stride_w,
+                                       &pool_h, &pool_w);
+  TF_LITE_MICRO_EXPECT_EQ(4, stride_h);
+  TF_LITE_MICRO_EXPECT_EQ(4, stride_w);
+  TF_LITE_MICRO_EXPECT_EQ(0, pool_h);
+  TF_LITE_MICRO_EXPECT_EQ(0, pool_w);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), cache.GetMisses());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0), cache.GetHits());
+
+  tflite::testing::ParsePoolingOptions(pooling_fbb, &stride_h, &stride_w,
+                                       &pool_h, &pool_w);
+  TF_LITE_MICRO_EXPECT_EQ(2, stride_h);
+  TF_LITE_MICRO_EXPECT_EQ(3, pool_h);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), cache.GetMisses());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1), cache.GetHits());
+}
+
+// Without a cache, the keys are still found
+TF_LITE_MICRO_TEST(KeysAreFoundWithoutACache) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+
+  flexbuffers::Builder fbb;
+  tflite::testing::BuildPoolingOptions(fbb, 2, 3);
+  int32_t stride_h = 0, stride_w = 0, pool_h = 0, pool_w = 0;
+  tflite::testing::ParsePoolingOptions(fbb, &stride_h, &stride_w, &pool_h,
+                                       &pool_w);
+  TF_LITE_MICRO_EXPECT_EQ(2, stride_h);
+  TF_LITE_MICRO_EXPECT_EQ(2, stride_w);
+  TF_LITE_MICRO_EXPECT_EQ(3, pool_h);
+  TF_LITE_MICRO_EXPECT_EQ(3, pool_w);
+}
+
+TF_LITE_MICRO_TESTS_END
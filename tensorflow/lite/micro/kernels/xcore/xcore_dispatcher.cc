@@ -8,6 +8,7 @@
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
+#include "tensorflow/lite/micro/micro_time.h"
 
 namespace tflite {
 namespace ops {
@@ -23,14 +24,92 @@ Dispatcher *GetDispatcher() {
   return kDispatcher;
 }
 
+bool HasDispatcher() { return kDispatcher != nullptr; }
+
 #ifdef XCORE
 
+extern "C" {
+ATTRIBUTE_THREAD_FUNCTION void fetch_thread_worker(void *context) {
+  static_cast<AsyncFetcher *>(context)->RunFetches();
+}
+
+void dispatcher_task_worker(void *context) {
+  auto *slot = static_cast<TaskSlot *>(context);
+  slot->start_ticks = tflite::GetCurrentTimeTicks();
+  (slot->tasks->function)(slot->tasks->arguments[slot->index]);
+  slot->end_ticks = tflite::GetCurrentTimeTicks();
+}
+}
+
+// xCORE JobQueue implementation.
+// Uses a hardware lock to guard the job counter.
+JobQueue::JobQueue() : size_(0), next_(0) { lock_ = lock_alloc(); }
+
+JobQueue::~JobQueue() { lock_free(lock_); }
+
+bool JobQueue::Claim(int32_t &index) {
+  lock_acquire(lock_);
+  int32_t next = next_++;
+  lock_release(lock_);
+
+  if (next < size_) {
+    index = next;
+    return true;
+  }
+  return false;
+}
+
+// xCORE AsyncFetcher implementation.
+// Runs the queued fetches in a single thread group with its own stack.
+AsyncFetcher::AsyncFetcher() : size_(0), fetched_(0), started_(false) {
+  size_t stack_size;
+  GET_THREAD_FUNCTION_STACKSIZE(stack_size, fetch_thread_worker);
+  assert(stack_size <= sizeof(stack_));
+  group_ = thread_group_alloc();
+}
+
+AsyncFetcher::~AsyncFetcher() { thread_group_free(group_); }
+
+TfLiteStatus AsyncFetcher::StartFetches() {
+  if (size_ == 0) return kTfLiteOk;
+
+  thread_group_add(group_, fetch_thread_worker, this,
+                   stack_base(stack_, kFetchStackWords));
+  thread_group_start(group_);
+  started_ = true;
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncFetcher::WaitFetches() {
+  if (started_) {
+    int32_t wait_start_ticks = tflite::GetCurrentTimeTicks();
+    thread_group_wait(group_);
+    AddFetchTicks(tflite::GetCurrentTimeTicks() - wait_start_ticks);
+    AddFetchBytes(fetched_);
+    started_ = false;
+  }
+  size_ = 0;
+
+  return kTfLiteOk;
+}
+
 // xCORE Dispatcher implementation.
 // Uses a threadgroup_t to dispatch tasks to threads.
 Dispatcher::Dispatcher(tflite::ErrorReporter *reporter, bool use_current_core)
-    : use_current_thread_(use_current_core), reporter_(reporter) {
+    : use_current_thread_(use_current_core),
+      dynamic_scheduling_(false),
+      stack_pool_enabled_(false),
+      stack_pool_index_(-1),
+      stack_pool_size_(0),
+      stack_requests_size_(0),
+      option_key_cache_(nullptr),
+      prefetched_buffers_(nullptr),
+      n_prefetched_buffers_(0),
+      reporter_(reporter) {
   group_ = thread_group_alloc();
   tasks_.size = 0;
+  ResetStats();
 }
 
 Dispatcher::~Dispatcher() { thread_group_free(group_); }
@@ -38,6 +117,7 @@ Dispatcher::~Dispatcher() { thread_group_free(group_); }
 TfLiteStatus Dispatcher::JoinTasks() {
   if (tasks_.size == 0) return kTfLiteOk;
 
+  int32_t join_start_ticks = tflite::GetCurrentTimeTicks();
   int begin = 0;
 
   if (use_current_thread_) {
@@ -52,7 +132,7 @@ TfLiteStatus Dispatcher::JoinTasks() {
     size_t stack_offset = 0;
     size_t stack_words = tasks_.stack_size / kBytesPerStackword;
     for (int i = begin; i < tasks_.size; i++) {
-      thread_group_add(group_, tasks_.function, tasks_.arguments[i],
+      thread_group_add(group_, dispatcher_task_worker, &slots_[i],
                        stack_base(&tasks_.stack[stack_offset], stack_words));
       stack_offset += tasks_.stack_size;
     }
@@ -62,16 +142,17 @@ TfLiteStatus Dispatcher::JoinTasks() {
 
     if (use_current_thread_) {
       // spawn the first task in this thread
-      (tasks_.function)(tasks_.arguments[0]);
+      RunTask(tasks_, 0);
     }
 
     // wait for the thread group
     thread_group_wait(group_);
   } else {
     // spawn the only task in this thread
-    (tasks_.function)(tasks_.arguments[0]);
+    RunTask(tasks_, 0);
   }
 
+  UpdateStats(join_start_ticks);
   tasks_.size = 0;
 
   return kTfLiteOk;
@@ -79,31 +160,175 @@ TfLiteStatus Dispatcher::JoinTasks() {
 
 #else
 
+// x86 AsyncFetcher implementation.
+// Runs the queued fetches on a persistent helper thread.
+AsyncFetcher::AsyncFetcher()
+    : size_(0),
+      fetched_(0),
+      started_(false),
+      running_(false),
+      shutdown_(false) {
+  worker_ = std::thread(&AsyncFetcher::WorkerLoop, this);
+}
+
+AsyncFetcher::~AsyncFetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_condition_.notify_one();
+  worker_.join();
+}
+
+void AsyncFetcher::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    start_condition_.wait(lock, [this] { return shutdown_ || running_; });
+    if (shutdown_) return;
+
+    lock.unlock();
+    RunFetches();
+    lock.lock();
+    running_ = false;
+    done_condition_.notify_one();
+  }
+}
+
+TfLiteStatus AsyncFetcher::StartFetches() {
+  if (size_ == 0) return kTfLiteOk;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+  }
+  start_condition_.notify_one();
+  started_ = true;
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncFetcher::WaitFetches() {
+  if (started_) {
+    int32_t wait_start_ticks = tflite::GetCurrentTimeTicks();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_condition_.wait(lock, [this] { return !running_; });
+    AddFetchTicks(tflite::GetCurrentTimeTicks() - wait_start_ticks);
+    AddFetchBytes(fetched_);
+    started_ = false;
+  }
+  size_ = 0;
+
+  return kTfLiteOk;
+}
+
+// x86 JobQueue implementation.
+// Uses an atomic job counter.
+JobQueue::JobQueue() : size_(0), next_(0) {}
+
+JobQueue::~JobQueue() {}
+
+bool JobQueue::Claim(int32_t &index) {
+  int32_t next = next_.fetch_add(1, std::memory_order_relaxed);
+
+  if (next < size_) {
+    index = next;
+    return true;
+  }
+  return false;
+}
+
 // x86 Dispatcher implementation.
-// Uses a std::vector of std::thread to dispatch tasks to threads.
+// Uses a persistent pool of std::thread workers that park on a condition
+// variable between calls to JoinTasks, so threads are created once per
+// Dispatcher rather than once per task.
 Dispatcher::Dispatcher(tflite::ErrorReporter *reporter, bool use_current_core)
-    : use_current_thread_(use_current_core), reporter_(reporter) {
+    : use_current_thread_(use_current_core),
+      dynamic_scheduling_(false),
+      stack_pool_enabled_(false),
+      stack_pool_index_(-1),
+      stack_pool_size_(0),
+      stack_requests_size_(0),
+      option_key_cache_(nullptr),
+      prefetched_buffers_(nullptr),
+      n_prefetched_buffers_(0),
+      reporter_(reporter),
+      first_pool_task_(use_current_core ? 1 : 0),
+      n_workers_(kMaxThreads - (use_current_core ? 1 : 0)),
+      generation_(0),
+      pending_tasks_(0),
+      shutdown_(false) {
   tasks_.size = 0;
+  batch_.size = 0;
+  ResetStats();
+  for (int i = 0; i < n_workers_; i++) {
+    workers_[i] = std::thread(&Dispatcher::WorkerLoop, this, i);
+  }
 }
 
-Dispatcher::~Dispatcher() {}
+Dispatcher::~Dispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_condition_.notify_all();
+  for (int i = 0; i < n_workers_; i++) {
+    workers_[i].join();
+  }
+}
+
+void Dispatcher::WorkerLoop(int worker_index) {
+  size_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    // park until the next batch of tasks is released (or shutdown)
+    start_condition_.wait(lock, [this, seen_generation] {
+      return shutdown_ || (generation_ != seen_generation);
+    });
+    if (shutdown_) return;
+    seen_generation = generation_;
+
+    int task_index = worker_index + first_pool_task_;
+    if (task_index < batch_.size) {
+      const TaskArray batch = batch_;
+      lock.unlock();
+      RunTask(batch, task_index);
+      lock.lock();
+      if (--pending_tasks_ == 0) done_condition_.notify_one();
+    }
+  }
+}
 
 TfLiteStatus Dispatcher::JoinTasks() {
   if (tasks_.size == 0) return kTfLiteOk;
 
-  // NOTE: use_current_thread_ is ignored on non-xcore targets
-  int begin = 0;
+  int32_t join_start_ticks = tflite::GetCurrentTimeTicks();
+  int pool_tasks = tasks_.size - first_pool_task_;
+
+  if (pool_tasks > 0) {
+    // release the parked workers
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch_ = tasks_;
+      pending_tasks_ = batch_.size - first_pool_task_;
+      generation_++;
+    }
+    start_condition_.notify_all();
+  }
 
-  // Start threads
-  for (int i = begin; i < tasks_.size; i++) {
-    group_.push_back(std::thread(tasks_.function, tasks_.arguments[i]));
+  if (use_current_thread_) {
+    // run the first task in this thread
+    RunTask(tasks_, 0);
   }
 
-  // Join threads
-  for (auto &thread : group_) {
-    thread.join();
+  if (pool_tasks > 0) {
+    // wait for the workers
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_condition_.wait(lock, [this] { return pending_tasks_ == 0; });
   }
-  group_.clear();
+
+  UpdateStats(join_start_ticks);
   tasks_.size = 0;
 
   return kTfLiteOk;
@@ -122,6 +347,85 @@ TfLiteStatus Dispatcher::JoinTasks() {
 
 tflite::ErrorReporter *Dispatcher::GetReporter() { return reporter_; }
 
+AsyncFetcher *Dispatcher::GetFetcher() { return &fetcher_; }
+
+JobQueue *Dispatcher::GetJobQueue() { return &job_queue_; }
+
+void Dispatcher::ResetStats() { stats_ = DispatcherStats(); }
+
+void Dispatcher::SetPrefetchedBuffers(const PrefetchedBuffer *buffers,
+                                      int count) {
+  prefetched_buffers_ = buffers;
+  n_prefetched_buffers_ = count;
+}
+
+int8_t const *Dispatcher::ResolvePrefetched(int8_t const *src,
+                                            size_t size) const {
+  for (int i = 0; i < n_prefetched_buffers_; i++) {
+    const PrefetchedBuffer &buffer = prefetched_buffers_[i];
+    if ((src >= buffer.src) && (src + size <= buffer.src + buffer.size)) {
+      return &buffer.dest[src - buffer.src];
+    }
+  }
+  return src;
+}
+
+TfLiteStatus Dispatcher::RequestStack(TfLiteContext *context, size_t size,
+                                      int *scratch_index) {
+  if (!stack_pool_enabled_) {
+    return context->RequestScratchBufferInArena(context, size, scratch_index);
+  }
+  *scratch_index = -1;
+  stack_requests_size_ += size;
+  if (size > stack_pool_size_) stack_pool_size_ = size;
+  return kTfLiteOk;
+}
+
+char *Dispatcher::GetStack(TfLiteContext *context, int scratch_index) {
+  if (scratch_index < 0) {
+    if (stack_pool_index_ < 0) return nullptr;
+    scratch_index = stack_pool_index_;
+  }
+  return static_cast<char *>(context->GetScratchBuffer(context, scratch_index));
+}
+
+void Dispatcher::ResetStackRequests() {
+  stack_pool_index_ = -1;
+  stack_pool_size_ = 0;
+  stack_requests_size_ = 0;
+}
+
+void Dispatcher::RunTask(const TaskArray &tasks, int index) {
+  TaskSlot &slot = slots_[index];
+  slot.start_ticks = tflite::GetCurrentTimeTicks();
+  (tasks.function)(tasks.arguments[index]);
+  slot.end_ticks = tflite::GetCurrentTimeTicks();
+}
+
+void Dispatcher::UpdateStats(int32_t join_start_ticks) {
+  int32_t join_ticks = tflite::GetCurrentTimeTicks() - join_start_ticks;
+
+  // every thread is occupied until the slowest one finishes
+  int32_t last_end_ticks = slots_[0].end_ticks;
+  for (int i = 1; i < tasks_.size; i++) {
+    if (slots_[i].end_ticks - last_end_ticks > 0) {
+      last_end_ticks = slots_[i].end_ticks;
+    }
+  }
+  for (int i = 0; i < tasks_.size; i++) {
+    stats_.idle_ticks += last_end_ticks - slots_[i].end_ticks;
+
+    // keep the first start and the last end of each task
+    if (i >= stats_.n_tasks) {
+      stats_.task_start_ticks[i] = slots_[i].start_ticks;
+    }
+    stats_.task_end_ticks[i] = slots_[i].end_ticks;
+  }
+  if (tasks_.size > stats_.n_tasks) stats_.n_tasks = tasks_.size;
+  stats_.join_ticks += join_ticks;
+  stats_.join_count++;
+}
+
 TfLiteStatus Dispatcher::Reset() {
   tasks_.size = 0;
 
@@ -143,6 +447,7 @@ TfLiteStatus Dispatcher::AddTask(void *argument) {
 
   if (tasks_.size < kMaxThreads) {
     tasks_.arguments[tasks_.size] = argument;
+    slots_[tasks_.size] = {&tasks_, tasks_.size, 0, 0};
     tasks_.size++;
 
     return kTfLiteOk;
@@ -151,6 +456,89 @@ TfLiteStatus Dispatcher::AddTask(void *argument) {
   return kTfLiteError;
 }
 
+//**************************************
+//**************************************
+//**************************************
+// JobQueue methods common to
+//   XCORE & x86
+//**************************************
+//**************************************
+//**************************************
+
+void JobQueue::Reset(int32_t size) {
+  size_ = size;
+  next_ = 0;
+}
+
+void JobClaimer::Reset(JobQueue *queue, int32_t n_jobs, int32_t n_tasks,
+                       int32_t task) {
+  queue_ = (n_jobs == n_tasks) ? nullptr : queue;
+  job_ = task;
+}
+
+bool JobClaimer::Claim(int32_t &index) {
+  if (queue_) return queue_->Claim(index);
+  if (job_ < 0) return false;
+  index = job_;
+  job_ = -1;
+  return true;
+}
+
+//**************************************
+//**************************************
+//**************************************
+// AsyncFetcher methods common to
+//   XCORE & x86
+//**************************************
+//**************************************
+//**************************************
+
+TfLiteStatus AsyncFetcher::AddFetch(int8_t **dest, int8_t const *src,
+                                    size_t size) {
+  assert(!started_);
+  assert(size_ < kMaxFetchRequests);
+
+  if (size_ < kMaxFetchRequests) {
+    requests_[size_] = {dest, nullptr, src, size, 1, size};
+    size_++;
+
+    return kTfLiteOk;
+  }
+
+  return kTfLiteError;
+}
+
+TfLiteStatus AsyncFetcher::AddStridedFetch(int8_t *dest, int8_t const *src,
+                                           size_t block_size, size_t n_blocks,
+                                           size_t src_stride) {
+  assert(!started_);
+  assert(size_ < kMaxFetchRequests);
+
+  if (size_ < kMaxFetchRequests) {
+    requests_[size_] = {nullptr, dest, src, block_size, n_blocks, src_stride};
+    size_++;
+
+    return kTfLiteOk;
+  }
+
+  return kTfLiteError;
+}
+
+void AsyncFetcher::RunFetches() {
+  // counted by WaitFetches, on the inference thread
+  fetched_ = 0;
+  for (int i = 0; i < size_; i++) {
+    const FetchRequest &request = requests_[i];
+    if (request.dest) {
+      fetched_ += FetchBufferUntimed(request.dest, request.src, request.size);
+    } else {
+      fetched_ += FetchStridedBufferUntimed(request.blocks_dest, request.src,
+                                            request.size, request.n_blocks,
+                                            request.src_stride);
+    }
+  }
+}
+
 }  // namespace xcore
 }  // namespace micro
 }  // namespace ops
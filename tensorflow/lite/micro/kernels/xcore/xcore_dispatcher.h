@@ -13,6 +13,7 @@ extern "C" {
 #ifdef _TIME_H_
 #define _clock_defined
 #endif
+#include <xcore/lock.h>
 #include <xcore/thread.h>
 }
 
@@ -27,18 +28,19 @@ extern "C" {
     size_t _stack_words;                                                 \
     asm("ldc %[__dest], " STRINGIFY_THREAD_FUNCTION(NAME) ".nstackwords" \
         : [__dest] "=r"(_stack_words));                                  \
-    DEST = (_stack_words + 2) * 4;                                       \
+    DEST = (_stack_words + 2 + kTaskWrapperStackWords) * 4;              \
   }
 
 #else  // not XCORE
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
-#include <vector>
 
 #define ATTRIBUTE_THREAD_FUNCTION
 #define GET_THREAD_FUNCTION_STACKSIZE(DEST, NAME) DEST = 0
 
 typedef void (*thread_function_t)(void *);
-typedef std::vector<std::thread> threadgroup_t;
 #endif
 
 namespace tflite {
@@ -50,6 +52,10 @@ constexpr size_t kMaxThreads = 5;
 constexpr size_t kBytesPerStackword = 4;
 constexpr size_t kWordAlignment = 4;
 constexpr size_t kDoubleWordAlignment = 8;
+constexpr size_t kMaxFetchRequests = 2 * kMaxThreads;
+constexpr size_t kFetchStackWords = 64;
+// stack used by the Dispatcher's task wrapper on top of the task function
+constexpr size_t kTaskWrapperStackWords = 8;
 
 typedef struct TaskArray {
   ATTRIBUTE_THREAD_FUNCTION thread_function_t function;
@@ -59,6 +65,112 @@ typedef struct TaskArray {
   void *arguments[kMaxThreads];
 } TaskArray;
 
+// Task wrapper argument, records when each task started and ended
+typedef struct TaskSlot {
+  const TaskArray *tasks;
+  int index;
+  int32_t start_ticks;
+  int32_t end_ticks;
+} TaskSlot;
+
+typedef struct DispatcherStats {
+  int32_t join_count;
+  int32_t join_ticks;  // wall time spent in JoinTasks
+  int32_t idle_ticks;  // time threads spent waiting for the slowest thread
+  int32_t n_tasks;     // most tasks added to any join
+  int32_t task_start_ticks[kMaxThreads];  // when each task first started
+  int32_t task_end_ticks[kMaxThreads];    // when each task last ended
+} DispatcherStats;
+
+// A shared job counter that lets threads claim jobs dynamically
+class JobQueue {
+ public:
+  JobQueue();
+  ~JobQueue();
+
+  // Call only when no threads are claiming jobs
+  void Reset(int32_t size);
+
+  // Claims the next job, returns false once all jobs have been claimed
+  bool Claim(int32_t &index);
+
+ private:
+  int32_t size_;
+#ifdef XCORE
+  lock_t lock_;
+  int32_t next_;
+#else
+  std::atomic<int32_t> next_;
+#endif
+};
+
+// The jobs one task runs. With one job per task, task i runs job i only, as
+//   in the static split of the plan. With more jobs than tasks (dynamic
+//   scheduling), the task claims jobs from the shared JobQueue.
+class JobClaimer {
+ public:
+  // Call before each JoinTasks, the JobQueue is reset separately
+  void Reset(JobQueue *queue, int32_t n_jobs, int32_t n_tasks, int32_t task);
+
+  // Claims the next job, returns false once the task has no jobs left
+  bool Claim(int32_t &index);
+
+ private:
+  JobQueue *queue_;  // nullptr for the static split
+  int32_t job_;      // the task's own job, -1 once claimed
+};
+
+typedef struct FetchRequest {
+  int8_t **dest;  // nullptr for strided requests
+  int8_t *blocks_dest;
+  int8_t const *src;
+  size_t size;
+  // strided requests copy n_blocks blocks of size bytes, read src_stride bytes
+  // apart, contiguously into blocks_dest
+  size_t n_blocks;
+  size_t src_stride;
+} FetchRequest;
+
+// Copies buffers from external memory on a dedicated I/O thread so that
+// fetching the next weights can overlap with compute on the current ones.
+class AsyncFetcher {
+ public:
+  AsyncFetcher();
+  ~AsyncFetcher();
+
+  // Queue a FetchBuffer request. *dest is only valid after WaitFetches.
+  TfLiteStatus AddFetch(int8_t **dest, int8_t const *src, size_t size);
+  TfLiteStatus AddStridedFetch(int8_t *dest, int8_t const *src,
+                               size_t block_size, size_t n_blocks,
+                               size_t src_stride);
+  TfLiteStatus StartFetches();
+  TfLiteStatus WaitFetches();
+
+  // Runs the queued requests, called on the I/O thread
+  void RunFetches();
+
+ private:
+  FetchRequest requests_[kMaxFetchRequests];
+  int size_;
+  size_t fetched_;  // bytes copied by the last RunFetches
+  bool started_;
+#ifdef XCORE
+  threadgroup_t group_;
+  uint32_t stack_[kFetchStackWords];
+#else
+  void WorkerLoop();
+
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable start_condition_;
+  std::condition_variable done_condition_;
+  bool running_;
+  bool shutdown_;
+#endif
+};
+
+class CustomOptionKeyCache;
+
 class Dispatcher {
  public:
   Dispatcher(tflite::ErrorReporter *reporter, bool use_current_core = true);
@@ -72,17 +184,119 @@ class Dispatcher {
   TfLiteStatus Reset();
 
   tflite::ErrorReporter *GetReporter();
+  AsyncFetcher *GetFetcher();
+  JobQueue *GetJobQueue();
+
+  // With dynamic scheduling, operators split their output into
+  //   kJobsPerThread times more jobs than threads, and threads claim jobs from
+  //   the JobQueue until none are left. Set before AllocateTensors.
+  void SetDynamicScheduling(bool dynamic) { dynamic_scheduling_ = dynamic; }
+  bool IsDynamicScheduling() const { return dynamic_scheduling_; }
+
+  // The cache of the interpreter's option keys, used as the ops are
+  //   initialized. Without one, the keys are found one at a time.
+  void SetOptionKeyCache(CustomOptionKeyCache *cache) {
+    option_key_cache_ = cache;
+  }
+  CustomOptionKeyCache *GetOptionKeyCache() { return option_key_cache_; }
+
+  // The constant tensors fetched ahead of time by the interpreter's
+  //   WeightPrefetcher. FetchBuffer and FetchStridedBuffer read from these
+  //   copies rather than from external memory. Pass count = 0 to clear.
+  void SetPrefetchedBuffers(const PrefetchedBuffer *buffers, int count);
+  // Returns the prefetched copy of the size bytes at src if there is one,
+  //   otherwise src
+  int8_t const *ResolvePrefetched(int8_t const *src, size_t size) const;
+
+  const DispatcherStats &GetStats() const { return stats_; }
+  void ResetStats();
+
+  // Worker stacks. Operators request stack in Prepare and get it in Eval.
+  //   With the stack pool enabled, requests are not given scratch buffers of
+  //   their own (scratch_index is set to -1) but share one pool, sized to the
+  //   largest request. Once all ops are prepared, the pool is requested as a
+  //   scratch buffer used by the whole model and its index is set with
+  //   SetStackPool. The requests are cleared with ResetStackRequests before
+  //   each allocation, as every op requests its stack again in Prepare.
+  TfLiteStatus RequestStack(TfLiteContext *context, size_t size,
+                            int *scratch_index);
+  char *GetStack(TfLiteContext *context, int scratch_index);
+  void ResetStackRequests();
+
+  void EnableStackPool(bool enable) { stack_pool_enabled_ = enable; }
+  bool IsStackPoolEnabled() const { return stack_pool_enabled_; }
+  void SetStackPool(int scratch_index) { stack_pool_index_ = scratch_index; }
+  size_t GetStackPoolSize() const { return stack_pool_size_; }
+  // the total of all requests, i.e. the stack scratch the pool replaces
+  size_t GetStackRequestsSize() const { return stack_requests_size_; }
 
  private:
+  void RunTask(const TaskArray &tasks, int index);
+  void UpdateStats(int32_t join_start_ticks);
+
   bool use_current_thread_;
-  threadgroup_t group_;
+  bool dynamic_scheduling_;
+  bool stack_pool_enabled_;
+  int stack_pool_index_;
+  size_t stack_pool_size_;
+  size_t stack_requests_size_;
+  CustomOptionKeyCache *option_key_cache_;
+  const PrefetchedBuffer *prefetched_buffers_;
+  int n_prefetched_buffers_;
   TaskArray tasks_;
+  TaskSlot slots_[kMaxThreads];
+  DispatcherStats stats_;
   tflite::ErrorReporter *reporter_;
+  AsyncFetcher fetcher_;
+  JobQueue job_queue_;
+#ifdef XCORE
+  threadgroup_t group_;
+#else
+  // Persistent pool of parked workers, reused across JoinTasks calls.
+  //   Worker i runs task (i + first_pool_task_) of each released batch.
+  void WorkerLoop(int worker_index);
+
+  int first_pool_task_;
+  int n_workers_;
+  std::thread workers_[kMaxThreads];
+  std::mutex mutex_;
+  std::condition_variable start_condition_;
+  std::condition_variable done_condition_;
+  size_t generation_;  // incremented to release the parked workers
+  // The batch released in generation_, copied from tasks_ under mutex_. The
+  //   workers only read this copy, as tasks_ is refilled without the lock.
+  TaskArray batch_;
+  int pending_tasks_;  // pool tasks of batch_ not yet finished
+  bool shutdown_;
+#endif
 };
 
+// Fetch immediately when fetcher is nullptr, otherwise queue on the fetcher
+static inline void fetch_or_queue(AsyncFetcher *fetcher, int8_t **dest,
+                                  int8_t const *src, size_t size) {
+  if (fetcher) {
+    fetcher->AddFetch(dest, src, size);
+  } else {
+    FetchBuffer(dest, src, size);
+  }
+}
+
+static inline void fetch_or_queue_strided(AsyncFetcher *fetcher, int8_t *dest,
+                                          int8_t const *src, size_t block_size,
+                                          size_t n_blocks, size_t src_stride) {
+  if (fetcher) {
+    fetcher->AddStridedFetch(dest, src, block_size, n_blocks, src_stride);
+  } else {
+    FetchStridedBuffer(dest, src, block_size, n_blocks, src_stride);
+  }
+}
+
 // static, shared Dispatcher object
 Dispatcher *GetDispatcher();
 void SetDispatcher(Dispatcher *);
+// false when the ops run without an XCoreInterpreter, e.g. in a plain
+//   MicroInterpreter, where GetDispatcher must not be called
+bool HasDispatcher();
 
 }  // namespace xcore
 }  // namespace micro
@@ -0,0 +1,148 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+namespace xc = tflite::ops::micro::xcore;
+
+// Requests the stacks of three ops, as their Prepare does on allocation
+TfLiteStatus RequestStacks(xc::Dispatcher* dispatcher) {
+  const size_t sizes[] = {256, 1024, 512};
+  for (size_t size : sizes) {
+    int scratch_index = 0;
+    TF_LITE_ENSURE_STATUS(
+        dispatcher->RequestStack(nullptr, size, &scratch_index));
+    if (scratch_index != -1) return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+// The persistent buffers of the jobs, as the arena tail would hold them
+alignas(8) uint8_t persistent_buffer[1024];
+size_t persistent_used = 0;
+
+void* AllocatePersistentBuffer(TfLiteContext* context, size_t bytes) {
+  if (persistent_used + bytes > sizeof(persistent_buffer)) return nullptr;
+  void* buffer = &persistent_buffer[persistent_used];
+  persistent_used += (bytes + 7) / 8 * 8;
+  return buffer;
+}
+
+void ReportError(TfLiteContext* context, const char* format, ...) {}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(StackRequestsAreResetOnEachAllocation) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  dispatcher.EnableStackPool(true);
+
+  for (int allocation = 0; allocation < 2; allocation++) {
+    dispatcher.ResetStackRequests();
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                            tflite::testing::RequestStacks(&dispatcher));
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1024),
+                            dispatcher.GetStackPoolSize());
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(256 + 1024 + 512),
+                            dispatcher.GetStackRequestsSize());
+  }
+}
+
+// Without dynamic scheduling there is one job per task, and each task runs its
+// own job of the static split, whatever the order the tasks run in
+TF_LITE_MICRO_TEST(TasksRunTheirOwnJobOfTheStaticSplit) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  constexpr int kTasks = 3;
+  xc::JobQueue queue;
+  queue.Reset(kTasks);
+  xc::JobClaimer claimers[kTasks];
+  for (int task = 0; task < kTasks; task++) {
+    claimers[task].Reset(&queue, kTasks, kTasks, task);
+  }
+
+  for (int task = kTasks - 1; task >= 0; task--) {
+    int32_t index = -1;
+    TF_LITE_MICRO_EXPECT(claimers[task].Claim(index));
+    TF_LITE_MICRO_EXPECT_EQ(task, index);
+    TF_LITE_MICRO_EXPECT(!claimers[task].Claim(index));
+  }
+}
+
+// With more jobs than tasks, the tasks claim every job once from the queue
+TF_LITE_MICRO_TEST(TasksClaimDynamicJobsFromTheQueue) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  constexpr int kTasks = 3;
+  constexpr int kJobs = 4 * kTasks;
+  xc::JobQueue queue;
+  queue.Reset(kJobs);
+  xc::JobClaimer claimers[kTasks];
+  for (int task = 0; task < kTasks; task++) {
+    claimers[task].Reset(&queue, kJobs, kTasks, task);
+  }
+
+  // the first task claims jobs until the others take the rest
+  int claimed[kJobs] = {0};
+  int32_t index = -1;
+  for (int job = 0; job < kJobs; job++) {
+    TF_LITE_MICRO_EXPECT(claimers[job < 5 ? 0 : job % kTasks].Claim(index));
+    TF_LITE_MICRO_EXPECT_EQ(job, index);
+    claimed[index]++;
+  }
+  for (int task = 0; task < kTasks; task++) {
+    TF_LITE_MICRO_EXPECT(!claimers[task].Claim(index));
+  }
+  for (int job = 0; job < kJobs; job++) {
+    TF_LITE_MICRO_EXPECT_EQ(1, claimed[job]);
+  }
+}
+
+// Operators create their jobs once, as they are prepared, so a change of the
+// scheduling mode after that is rejected rather than ignored
+TF_LITE_MICRO_TEST(JobsAreNotReusedForAnotherSchedulingMode) {
+  namespace xc = tflite::ops::micro::xcore;
+
+  TfLiteContext context = {};
+  context.AllocatePersistentBuffer =
+      tflite::testing::AllocatePersistentBuffer;
+  context.ReportError = tflite::testing::ReportError;
+
+  xc::PersistentArray<xc::RowColRegion> regions;
+  regions.allocate(&context, 2);
+  regions.append({0, 0, 8, 4});
+  regions.append({8, 0, 8, 4});
+
+  xc::PersistentArray<xc::RowColRegion> jobs;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          xc::CreateJobs(&context, regions, false, jobs));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), jobs.size());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          xc::CreateJobs(&context, regions, false, jobs));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          xc::CreateJobs(&context, regions, true, jobs));
+
+  xc::PersistentArray<xc::RowColRegion> dynamic_jobs;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, xc::CreateJobs(&context, regions, true, dynamic_jobs));
+  TF_LITE_MICRO_EXPECT_EQ(2 * xc::kJobsPerRegion, dynamic_jobs.size());
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, xc::CreateJobs(&context, regions, false, dynamic_jobs));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -22,6 +22,7 @@ struct FullyConnectedOpData {
   size_t stack_size;
   int weights_scratch_index;
   int bias_scratch_index;
+  bool double_buffered;
 };
 
 struct FullyConnectedThreadData {
@@ -50,6 +51,7 @@ void* Init_8(TfLiteContext* context, const char* buffer, size_t length) {
   op->stack_size = 0;
   op->weights_scratch_index = -1;
   op->bias_scratch_index = -1;
+  op->double_buffered = false;
 
   TFLITE_DCHECK(buffer != nullptr);
   parse_custom_options(context, buffer, length, &op->execution_plan);
@@ -69,25 +71,78 @@ TfLiteStatus Prepare_8(TfLiteContext* context, TfLiteNode* node) {
 
   // allocate the stack for thread workers
   GET_THREAD_FUNCTION_STACKSIZE(op->stack_size, fully_connected_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op->stack_size * op->execution_plan.GetNumThreads(),
       &op->stack_scratch_index));
 
+  // double buffer the weights and biases fetched from external memory, so
+  // the next batch of channel groups is fetched while the current one is
+  // computed
+  int n_th = op->execution_plan.GetNumThreads();
+  int n_batches = (op->execution_plan.changrps.size() + n_th - 1) / n_th;
+  op->double_buffered = (n_batches > 1) &&
+                        !(is_ram_address((uintptr_t)weights->data.int8) &&
+                          is_ram_address((uintptr_t)bso->data.i16));
+  size_t n_buffers = op->double_buffered ? 2 : 1;
+
   // allocate scratch buffers for weights and biases (if necessary)
   if (!is_ram_address((uintptr_t)weights->data.int8)) {
     TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
-        context, op->execution_plan.GetWeightsScratchSize(),
+        context, n_buffers * op->execution_plan.GetWeightsScratchSize(),
         &op->weights_scratch_index));
   }
   if (!is_ram_address((uintptr_t)bso->data.i16)) {
     TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
-        context, op->execution_plan.GetBiasScratchSize(),
+        context, n_buffers * op->execution_plan.GetBiasScratchSize(),
         &op->bias_scratch_index));
   }
 
   return kTfLiteOk;
 }
 
+// Sets up the thread data for the batch of (at most n_th) channel groups
+// starting at first_changrp, fetching (or queueing on fetcher, if not nullptr)
+// their weights and biases into sW and sBSO. Returns the batch size.
+static int fetch_batch(FullyConnectedOpData* op, int first_changrp, int n_th,
+                       int32_t C_in, int8_t* Y, const int8_t* X,
+                       const int8_t* W, const int8_t* BSO, int8_t* sW,
+                       int8_t* sBSO, FullyConnectedThreadData* thread_data,
+                       AsyncFetcher* fetcher) {
+  // offset into the scratch spaces based on how many bytes we have loaded
+  // for this batch
+  size_t weights_dest_offset = 0;
+  size_t biases_dest_offset = 0;
+
+  int i_th = 0;
+  for (int i_cg = first_changrp;
+       (i_cg < op->execution_plan.changrps.size()) && (i_th < n_th); i_cg++) {
+    const ChannelGroup& changrp = op->execution_plan.changrps[i_cg];
+    FullyConnectedThreadData& td = thread_data[i_th];
+
+    size_t weights_fetch_size = C_in * changrp.size;
+    td.W = sW ? sW + weights_dest_offset : nullptr;
+    fetch_or_queue(fetcher, (int8_t**)&td.W, &W[C_in * changrp.start],
+                   weights_fetch_size);
+    weights_dest_offset += weights_fetch_size;
+
+    td.BSO = (const nn_bso_block_t*)(sBSO ? sBSO + biases_dest_offset
+                                          : nullptr);
+    fetch_or_queue(fetcher, (int8_t**)&td.BSO,
+                   &BSO[i_cg * kBSOChannelGroupBytes], kBSOChannelGroupBytes);
+    biases_dest_offset += kBSOChannelGroupBytes;
+
+    td.Y = &Y[changrp.start];
+    td.X = X;
+    td.C_in = C_in;
+    td.C_out_start = 0;
+    td.C_out_end = td.C_out_start + changrp.size;
+
+    i_th++;
+  }
+
+  return i_th;
+}
+
 TfLiteStatus Eval_8(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 0);
   const TfLiteEvalTensor* weights =
@@ -105,85 +160,74 @@ TfLiteStatus Eval_8(TfLiteContext* context, TfLiteNode* node) {
   Dispatcher* dispatcher = GetDispatcher();
 
   // initialize the dispatcher
-  char* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op->stack_scratch_index);
   TFLITE_DCHECK(stack != nullptr);
   dispatcher->InitializeTasks(fully_connected_thread_worker, stack,
                               op->stack_size);
 
-  // create thread data and tasks
-  int i_th = 0;
+  // create thread data, one set per weights buffer
   int n_th = op->execution_plan.GetNumThreads();
-  FullyConnectedThreadData thread_data[n_th];
-
-  // load weights & bias scratch buffers(if necessary)
-  size_t weights_dest_offset = 0;
-  size_t weights_src_offset = 0;
-  size_t biases_dest_offset = 0;
-  size_t biases_src_offset = 0;
-  size_t weights_fetch_size;
-  // size_t bias_fetch_size;
-  int8_t *sW, *tW;  // sW points to the head of the weights scratch space, tW
-                    // points to the head of the fetched weights which equals sW
-                    // for the first fetch but not for subsequent fetches
-  int8_t *sBSO,
-      *tBSO;  // sBSO points to the head of the BSO scratch space, tBSO
-              // points to the head of the fetched BSO which equals sBSO for
-              // the first fetch but not for subsequent fetches
+  FullyConnectedThreadData thread_data[2 * n_th];
 
+  // locate the (double) buffers for weights and biases
+  int8_t* sW[2] = {nullptr, nullptr};
+  int8_t* sBSO[2] = {nullptr, nullptr};
   if (op->weights_scratch_index >= 0) {
-    sW = static_cast<int8_t*>(
+    sW[0] = static_cast<int8_t*>(
         context->GetScratchBuffer(context, op->weights_scratch_index));
-    TFLITE_DCHECK(sW != nullptr);
+    TFLITE_DCHECK(sW[0] != nullptr);
+    if (op->double_buffered) {
+      sW[1] = sW[0] + op->execution_plan.GetWeightsScratchSize();
+    }
   }
   if (op->bias_scratch_index >= 0) {
-    sBSO = static_cast<int8_t*>(
+    sBSO[0] = static_cast<int8_t*>(
         context->GetScratchBuffer(context, op->bias_scratch_index));
-    TFLITE_DCHECK(sBSO != nullptr);
+    TFLITE_DCHECK(sBSO[0] != nullptr);
+    if (op->double_buffered) {
+      sBSO[1] = sBSO[0] + op->execution_plan.GetBiasScratchSize();
+    }
   }
 
-  for (int i_cg = 0; i_cg < op->execution_plan.changrps.size(); i_cg++) {
-    const ChannelGroup& changrp = op->execution_plan.changrps[i_cg];
-
-    // offset into the temp W and BSO pointers based on how many bytes we
-    // have loaded since the last JoinTasks
-    tW = sW + weights_dest_offset;
-    tBSO = sBSO + biases_dest_offset;
-
-    // fetch the weights and biases
-    weights_fetch_size = C_in * changrp.size;
-    FetchBuffer(
-        &tW, &tflite::micro::GetTensorData<int8_t>(weights)[weights_src_offset],
-        weights_fetch_size);
-    weights_dest_offset += weights_fetch_size;
-    weights_src_offset += weights_fetch_size;
-
-    FetchBuffer((int8_t**)&tBSO,
-                &tflite::micro::GetTensorData<int8_t>(bso)[biases_src_offset],
-                kBSOChannelGroupBytes);
-    biases_dest_offset += kBSOChannelGroupBytes;
-    biases_src_offset += kBSOChannelGroupBytes;
-
-    thread_data[i_th].Y =
-        &tflite::micro::GetTensorData<int8_t>(output)[changrp.start];
-    thread_data[i_th].X = tflite::micro::GetTensorData<int8_t>(input);
-    thread_data[i_th].W = tW;
-    thread_data[i_th].BSO = (const nn_bso_block_t*)tBSO;
-    thread_data[i_th].C_in = C_in;
-    thread_data[i_th].C_out_start = 0;
-    thread_data[i_th].C_out_end = thread_data[i_th].C_out_start + changrp.size;
-    dispatcher->AddTask(reinterpret_cast<void*>(&thread_data[i_th]));
+  int8_t* Y = tflite::micro::GetTensorData<int8_t>(output);
+  const int8_t* X = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* W = tflite::micro::GetTensorData<int8_t>(weights);
+  const int8_t* BSO = tflite::micro::GetTensorData<int8_t>(bso);
+  AsyncFetcher* fetcher = dispatcher->GetFetcher();
+
+  const int n_changrps = op->execution_plan.changrps.size();
+  int batch_size = fetch_batch(op, 0, n_th, C_in, Y, X, W, BSO, sW[0], sBSO[0],
+                               thread_data, nullptr);
+
+  for (int i_cg = 0, i_batch = 0; i_cg < n_changrps;
+       i_cg += batch_size, i_batch++) {
+    const int i_buf = op->double_buffered ? (i_batch % 2) : 0;
+    const int next_cg = i_cg + batch_size;
+    const bool prefetch = op->double_buffered && (next_cg < n_changrps);
+    int next_batch_size = 0;
+
+    // start fetching the next batch into the other buffer
+    if (prefetch) {
+      next_batch_size = fetch_batch(
+          op, next_cg, n_th, C_in, Y, X, W, BSO, sW[1 - i_buf],
+          sBSO[1 - i_buf], &thread_data[(1 - i_buf) * n_th], fetcher);
+      fetcher->StartFetches();
+    }
 
-    i_th++;
+    for (int i_th = 0; i_th < batch_size; i_th++) {
+      dispatcher->AddTask(
+          reinterpret_cast<void*>(&thread_data[i_buf * n_th + i_th]));
+    }
+    dispatcher->JoinTasks();
 
-    if (i_th == n_th) {
-      dispatcher->JoinTasks();
-      i_th = 0;
-      weights_dest_offset = 0;
-      biases_dest_offset = 0;
+    if (prefetch) {
+      fetcher->WaitFetches();
+    } else if (next_cg < n_changrps) {
+      next_batch_size = fetch_batch(op, next_cg, n_th, C_in, Y, X, W, BSO,
+                                    sW[0], sBSO[0], thread_data, nullptr);
     }
+    batch_size = next_batch_size;
   }
-  dispatcher->JoinTasks();  // finish up any added tasks
 
   return kTfLiteOk;
 }
@@ -0,0 +1,443 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_custom_options.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_ops.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+
+extern "C" {
+#include "nn_operator.h"
+}
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace xcore {
+namespace fused {
+
+// Fused ops compute a convolution and the op consuming its output one tile at
+// a time. Each thread keeps its tile of the intermediate tensor in a small
+// scratch buffer, so the full intermediate is never written to the arena.
+
+struct FusedThreadData {
+  const void *args;
+  const RowColRegion *jobs;
+  JobClaimer claimer;
+  int8_t *tile;  // this thread's slice of the tile scratch buffer
+  int32_t changrp_start;
+  int32_t changrp_size;
+};
+
+struct FusedOpData {
+  Conv2DParams params;
+  ExecutionPlan execution_plan;
+  int stack_scratch_index = -1;
+  size_t stack_size;
+  int tile_scratch_index = -1;
+  size_t tile_size;
+  int weights_scratch_index = -1;
+  int bias_scratch_index = -1;
+};
+
+static TfLiteStatus PrepareFused(TfLiteContext *context, TfLiteNode *node,
+                                 FusedOpData *op_data, size_t tile_size) {
+  const auto *weights = GetInput(context, node, 1);
+  const auto *bso = GetInput(context, node, 2);
+  TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+      context, weights->data.data,
+      op_data->execution_plan.GetWeightsScratchSize(),
+      op_data->weights_scratch_index));
+  TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+      context, bso->data.data, op_data->execution_plan.GetBiasScratchSize(),
+      op_data->bias_scratch_index));
+
+  // split the regions into the jobs threads will claim
+  TF_LITE_ENSURE_STATUS(CreateJobs(context, op_data->execution_plan.regions,
+                                   GetDispatcher()->IsDynamicScheduling(),
+                                   op_data->execution_plan.jobs));
+
+  // allocate one tile per task, there is one task per region
+  op_data->tile_size = tile_size;
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_size * op_data->execution_plan.regions.size(),
+      &op_data->tile_scratch_index));
+
+  // allocate the stack for thread workers
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
+      context, op_data->stack_size * op_data->execution_plan.regions.size(),
+      &op_data->stack_scratch_index));
+
+  return kTfLiteOk;
+}
+
+// Fetches the weights and biases of each channel group in turn, and runs the
+// fused worker over all jobs for it.
+static TfLiteStatus EvalFused(TfLiteContext *context, TfLiteNode *node,
+                              FusedOpData *op_data, thread_function_t worker,
+                              const void *args, const nn_tensor_t *&K,
+                              const nn_bso_block_t *&BSO,
+                              const size_t channel_size) {
+  Dispatcher *dispatcher = GetDispatcher();
+  char *stack = dispatcher->GetStack(context, op_data->stack_scratch_index);
+  TF_LITE_ENSURE(context, stack);
+  dispatcher->InitializeTasks(worker, stack, op_data->stack_size);
+
+  auto *tiles = static_cast<int8_t *>(
+      context->GetScratchBuffer(context, op_data->tile_scratch_index));
+  TF_LITE_ENSURE(context, tiles);
+
+  // the tiles were sized by region count in PrepareFused, so the tasks are too
+  const int n_regions = op_data->execution_plan.regions.size();
+  FusedThreadData thread_data[n_regions];
+  JobQueue *queue = dispatcher->GetJobQueue();
+  const int n_jobs = op_data->execution_plan.jobs.size();
+  for (int i_rg = 0; i_rg < n_regions; i_rg++) {
+    thread_data[i_rg].args = args;
+    thread_data[i_rg].jobs = op_data->execution_plan.jobs.begin();
+    thread_data[i_rg].tile = &tiles[i_rg * op_data->tile_size];
+  }
+
+  const auto *weights_src_array = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 1));
+  const auto *bso_src_array = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 2));
+
+  int8_t *weights_scratch = nullptr;
+  int8_t *bso_scratch = nullptr;
+  if (op_data->weights_scratch_index >= 0) {
+    weights_scratch = static_cast<int8_t *>(
+        context->GetScratchBuffer(context, op_data->weights_scratch_index));
+    TFLITE_DCHECK(weights_scratch != nullptr);
+  }
+  if (op_data->bias_scratch_index >= 0) {
+    bso_scratch = static_cast<int8_t *>(
+        context->GetScratchBuffer(context, op_data->bias_scratch_index));
+    TFLITE_DCHECK(bso_scratch != nullptr);
+  }
+
+  for (const auto &changrp : op_data->execution_plan.changrps) {
+    K = weights_scratch;
+    FetchBuffer((int8_t **)&K, &weights_src_array[channel_size * changrp.start],
+                channel_size * changrp.size);
+    BSO = (const nn_bso_block_t *)bso_scratch;
+    FetchBuffer((int8_t **)&BSO,
+                &bso_src_array[changrp.index * kBSOChannelGroupBytes],
+                kBSOChannelGroupBytes);
+
+    queue->Reset(n_jobs);
+    for (int i_rg = 0; i_rg < n_regions; i_rg++) {
+      thread_data[i_rg].claimer.Reset(queue, n_jobs, n_regions, i_rg);
+      thread_data[i_rg].changrp_start = changrp.start;
+      thread_data[i_rg].changrp_size = changrp.size;
+      dispatcher->AddTask(reinterpret_cast<void *>(&thread_data[i_rg]));
+    }
+    dispatcher->JoinTasks();
+  }
+
+  return kTfLiteOk;
+}
+
+//**************************************
+//**************************************
+//**************************************
+// Conv2D deep + MaxPool2D
+//**************************************
+//**************************************
+//**************************************
+namespace conv2d_deep_maxpool {
+
+struct ConvPoolArguments {
+  nn_image_t *Y;
+  const nn_image_t *X;
+  const nn_tensor_t *K;
+  const nn_bso_block_t *BSO;
+
+  nn_image_params_t x_image;
+  nn_image_params_t t_image;  // the pool_h conv rows under one pooled row
+  nn_image_params_t y_image;
+
+  nn_window_params_t conv_window;
+  nn_window_params_t pool_window;
+  int8_t zero_point;
+};
+
+struct ConvPoolOpData : FusedOpData {
+  ConvPoolArguments args;
+  PoolingParams pool_params;
+};
+
+extern "C" {
+ATTRIBUTE_THREAD_FUNCTION void conv2d_deep_maxpool_thread_worker(
+    void *context) {
+  auto *td = static_cast<FusedThreadData *>(context);
+  auto *args = static_cast<const ConvPoolArguments *>(td->args);
+  const int32_t pool_h = args->pool_window.shape.height;
+  const int32_t pool_w = args->pool_window.shape.width;
+
+  // the windows are moved so that each pooled row reads from the tile
+  nn_window_params_t conv_window = args->conv_window;
+  nn_window_params_t pool_window = args->pool_window;
+
+  int32_t index;
+  while (td->claimer.Claim(index)) {
+    const RowColRegion &region = td->jobs[index];
+    nn_window_op_job_params_t conv_job = {
+        {0, region.left * pool_w, td->changrp_start},
+        {pool_h, region.cols * pool_w, td->changrp_size}};
+
+    for (int32_t row = region.top; row < region.top + region.rows; row++) {
+      conv_window.start.row = args->conv_window.start.row +
+                              row * pool_h * args->conv_window.stride.vertical;
+      conv2d_deep_ext(td->tile, args->X, args->K, args->BSO, args->zero_point,
+                      &args->x_image, &args->t_image, &conv_window, &conv_job,
+                      CONV2D_DEEP_FLAG_SLICED_K);
+
+      pool_window.start.row = -row * pool_h;
+      nn_window_op_job_params_t pool_job = {
+          {row, region.left, td->changrp_start},
+          {1, region.cols, td->changrp_size}};
+      maxpool2d_ext(args->Y, td->tile, &args->t_image, &args->y_image,
+                    &pool_window, &pool_job, MAXPOOL2D_FLAG_NONE);
+    }
+  }
+}
+}
+
+void *Init(TfLiteContext *context, const char *buffer, size_t length) {
+  auto *op_data = construct_persistent_object<ConvPoolOpData>(context);
+
+  // parse custom options
+  TFLITE_DCHECK(buffer != nullptr);
+  parse_custom_options(context, buffer, length, op_data->params,
+                       op_data->pool_params, &op_data->execution_plan);
+
+  return op_data;
+}
+
+TfLiteStatus Prepare(TfLiteContext *context, TfLiteNode *node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  auto *op_data = reinterpret_cast<ConvPoolOpData *>(node->user_data);
+  auto &args = op_data->args;
+  const auto &params = op_data->params;
+  const auto &pool_params = op_data->pool_params;
+
+  const auto &input_shape = GetTensorShape(GetInput(context, node, 0));
+  args.x_image = {(uint32_t)input_shape.Dims(1), (uint32_t)input_shape.Dims(2),
+                  (uint32_t)input_shape.Dims(3)};
+
+  const auto &output_shape = GetTensorShape(GetOutput(context, node, 0));
+  args.y_image = {(uint32_t)output_shape.Dims(1),
+                  (uint32_t)output_shape.Dims(2),
+                  (uint32_t)output_shape.Dims(3)};
+
+  args.t_image = {(uint32_t)pool_params.pool_h,
+                  args.y_image.width * pool_params.pool_w,
+                  args.y_image.channels};
+
+  const auto &weight_shape = GetTensorShape(GetInput(context, node, 1));
+  args.conv_window.shape.height = weight_shape.Dims(1);
+  args.conv_window.shape.width = weight_shape.Dims(2);
+  args.conv_window.start = {-params.pad.top, -params.pad.left};
+  args.conv_window.stride = {params.stride_h, params.stride_w};
+  args.zero_point = params.pad.zero_point;
+
+  args.pool_window.shape = {(uint32_t)pool_params.pool_h,
+                            (uint32_t)pool_params.pool_w};
+  args.pool_window.start = {0, 0};
+  args.pool_window.stride = {pool_params.stride_h, pool_params.stride_w};
+
+  GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size,
+                                conv2d_deep_maxpool_thread_worker);
+
+  size_t tile_size =
+      args.t_image.height * args.t_image.width * args.t_image.channels;
+  return PrepareFused(context, node, op_data, tile_size);
+}
+
+TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
+  auto *op_data = reinterpret_cast<ConvPoolOpData *>(node->user_data);
+  auto &args = op_data->args;
+
+  args.Y = tflite::micro::GetTensorData<nn_image_t>(
+      tflite::micro::GetEvalOutput(context, node, 0));
+  args.X = tflite::micro::GetTensorData<nn_image_t>(
+      tflite::micro::GetEvalInput(context, node, 0));
+
+  const auto &weight_shape = tflite::micro::GetTensorShape(
+      tflite::micro::GetEvalInput(context, node, 1));
+  const size_t channel_size =
+      weight_shape.Dims(1) * weight_shape.Dims(2) * weight_shape.Dims(3);
+
+  return EvalFused(context, node, op_data, conv2d_deep_maxpool_thread_worker,
+                   &args, args.K, args.BSO, channel_size);
+}
+
+}  // namespace conv2d_deep_maxpool
+
+//**************************************
+//**************************************
+//**************************************
+// Conv2D 1x1 + Add
+//**************************************
+//**************************************
+//**************************************
+namespace conv2d_1x1_add {
+
+struct ConvAddArguments {
+  int8_t *Y;
+  const int8_t *X;
+  const nn_tensor_t *K;
+  const nn_bso_block_t *BSO;
+  const int8_t *X1;  // the other addend
+
+  nn_image_params_t x_image;
+  nn_image_params_t y_image;
+  nn_add_params_t add_params;
+};
+
+struct ConvAddOpData : FusedOpData {
+  ConvAddArguments args;
+  int input1_scratch_idx = -1;
+};
+
+extern "C" {
+ATTRIBUTE_THREAD_FUNCTION void conv2d_1x1_add_thread_worker(void *context) {
+  auto *td = static_cast<FusedThreadData *>(context);
+  auto *args = static_cast<const ConvAddArguments *>(td->args);
+  const int32_t C_in = args->x_image.channels;
+  const int32_t C_out = args->y_image.channels;
+
+  int32_t index;
+  while (td->claimer.Claim(index)) {
+    const RowColRegion &region = td->jobs[index];
+
+    // tiles are the part of one output row in the region, since the pixels of
+    // a region narrower than the image are not contiguous across rows
+    for (int32_t row = region.top; row < region.top + region.rows; row++) {
+      const int32_t pixel = row * args->y_image.width + region.left;
+      const int32_t tile_pixels = region.cols;
+      nn_image_params_t x_tile = {1, (uint32_t)tile_pixels, (uint32_t)C_in};
+      nn_image_params_t y_tile = {1, (uint32_t)tile_pixels, (uint32_t)C_out};
+      nn_conv2d_1x1_job_params_t job;
+      job.start = {0, 0, td->changrp_start};
+      job.size.channels = td->changrp_size;
+      job.size.pixels = tile_pixels;
+      conv2d_1x1_ext(td->tile, &args->X[pixel * C_in], args->K, args->BSO,
+                     &x_tile, &y_tile, &job, CONV2D_1X1_FLAG_SLICED_K);
+
+      if (td->changrp_size == C_out) {
+        add_elementwise(&args->Y[pixel * C_out], td->tile,
+                        &args->X1[pixel * C_out], &args->add_params, 0,
+                        tile_pixels * C_out);
+      } else {
+        for (int32_t p = 0; p < tile_pixels; p++) {
+          const int32_t offset = (pixel + p) * C_out + td->changrp_start;
+          add_elementwise(&args->Y[offset],
+                          &td->tile[p * C_out + td->changrp_start],
+                          &args->X1[offset], &args->add_params, 0,
+                          td->changrp_size);
+        }
+      }
+    }
+  }
+}
+}
+
+void *Init(TfLiteContext *context, const char *buffer, size_t length) {
+  auto *op_data = construct_persistent_object<ConvAddOpData>(context);
+
+  // parse custom options
+  TFLITE_DCHECK(buffer != nullptr);
+  parse_custom_options(context, buffer, length, op_data->params,
+                       &op_data->execution_plan);
+
+  return op_data;
+}
+
+TfLiteStatus Prepare(TfLiteContext *context, TfLiteNode *node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 5);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  auto *op_data = reinterpret_cast<ConvAddOpData *>(node->user_data);
+  auto &args = op_data->args;
+
+  const auto &input_shape = GetTensorShape(GetInput(context, node, 0));
+  args.x_image = {(uint32_t)input_shape.Dims(1), (uint32_t)input_shape.Dims(2),
+                  (uint32_t)input_shape.Dims(3)};
+
+  const auto &output_shape = GetTensorShape(GetOutput(context, node, 0));
+  args.y_image = {(uint32_t)output_shape.Dims(1),
+                  (uint32_t)output_shape.Dims(2),
+                  (uint32_t)output_shape.Dims(3)};
+
+  const auto *bss = GetInput(context, node, 4);
+  auto &params = args.add_params;
+  params.input[0].shr = bss->data.i32[0];
+  params.input[0].multiplier = bss->data.i32[1];
+  params.input[1].shr = bss->data.i32[2];
+  params.input[1].multiplier = bss->data.i32[3];
+  params.output.bias = bss->data.i32[4];
+  params.output.shr = bss->data.i32[5];
+
+  TF_LITE_ENSURE_STATUS(request_scratch_if_needed(
+      context, GetInput(context, node, 3), op_data->input1_scratch_idx));
+
+  // a tile holds one output row, which the region must lie within
+  for (const auto &region : op_data->execution_plan.regions) {
+    TF_LITE_ENSURE(context, region.left >= 0 && region.cols > 0);
+    TF_LITE_ENSURE(context, static_cast<uint32_t>(region.left + region.cols) <=
+                                args.y_image.width);
+  }
+
+  GET_THREAD_FUNCTION_STACKSIZE(op_data->stack_size,
+                                conv2d_1x1_add_thread_worker);
+
+  return PrepareFused(context, node, op_data,
+                      args.y_image.width * args.y_image.channels);
+}
+
+TfLiteStatus Eval(TfLiteContext *context, TfLiteNode *node) {
+  auto *op_data = reinterpret_cast<ConvAddOpData *>(node->user_data);
+  auto &args = op_data->args;
+
+  TF_LITE_ENSURE_STATUS(fetch_scratch_if_needed(
+      context, args.X1, tflite::micro::GetEvalInput(context, node, 3),
+      op_data->input1_scratch_idx));
+  args.Y = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalOutput(context, node, 0));
+  args.X = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 0));
+
+  const auto &weight_shape = tflite::micro::GetTensorShape(
+      tflite::micro::GetEvalInput(context, node, 1));
+
+  return EvalFused(context, node, op_data, conv2d_1x1_add_thread_worker, &args,
+                   args.K, args.BSO, weight_shape.Dims(1));
+}
+
+}  // namespace conv2d_1x1_add
+}  // namespace fused
+
+TfLiteRegistration *Register_Conv2D_Deep_MaxPool2D() {
+  static TfLiteRegistration r = {fused::conv2d_deep_maxpool::Init, nullptr,
+                                 fused::conv2d_deep_maxpool::Prepare,
+                                 fused::conv2d_deep_maxpool::Eval};
+  return &r;
+}
+
+TfLiteRegistration *Register_Conv2D_1x1_Add_8() {
+  static TfLiteRegistration r = {fused::conv2d_1x1_add::Init, nullptr,
+                                 fused::conv2d_1x1_add::Prepare,
+                                 fused::conv2d_1x1_add::Eval};
+  return &r;
+}
+
+}  // namespace xcore
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,296 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <cstdint>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_ops.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+namespace xc = tflite::ops::micro::xcore;
+
+// 4x4 images of two channel groups, the fused ops compute one group at a time
+constexpr int kHeight = 4;
+constexpr int kWidth = 4;
+constexpr int kChangrpSize = xc::kChannelGroupLength;
+constexpr int kChangrps = 2;
+constexpr int kChannels = kChangrps * kChangrpSize;
+constexpr int kImageSize = kHeight * kWidth * kChannels;
+constexpr int kPool = 2;
+constexpr int kPooledSize = (kHeight / kPool) * (kWidth / kPool) * kChannels;
+
+int8_t input_data[kImageSize];
+int8_t addend_data[kImageSize];
+int8_t weights_data[kChannels * 3 * 3 * kChannels];
+int16_t bso_data[kChangrps * xc::kBSOChannelGroupLength];
+int32_t bss_data[6] = {1, 0x2000, 1, 0x2000, 0, 6};
+
+// Splits the image of rows x cols pixels into n_regions regions side by side,
+// the pixels of a region narrower than the image are not contiguous
+void BuildPlan(flexbuffers::Builder& fbb, int rows, int cols, int n_regions) {
+  fbb.Map("par", [&]() {
+    fbb.Int("th", n_regions);
+    fbb.Vector("cg", [&]() {
+      for (int start = 0; start < kChannels; start += kChangrpSize) {
+        fbb.Vector([&]() {
+          fbb.Int(start);
+          fbb.Int(start + kChangrpSize - 1);
+        });
+      }
+    });
+    fbb.Vector("rc", [&]() {
+      for (int left = 0; left < cols; left += cols / n_regions) {
+        fbb.Vector([&]() {
+          fbb.Int(0);
+          fbb.Int(left);
+          fbb.Int(rows);
+          fbb.Int(cols / n_regions);
+        });
+      }
+    });
+  });
+}
+
+void BuildStride(flexbuffers::Builder& fbb, int stride) {
+  fbb.Vector("stride", [&]() {
+    fbb.Int(stride);
+    fbb.Int(stride);
+  });
+}
+
+void BuildPad(flexbuffers::Builder& fbb) {
+  fbb.Vector("pad", [&]() {
+    fbb.Int(1);
+    fbb.Int(1);
+    fbb.Int(0);
+  });
+}
+
+void BuildPool(flexbuffers::Builder& fbb) {
+  fbb.Vector("pool", [&]() {
+    fbb.Int(kPool);
+    fbb.Int(kPool);
+  });
+}
+
+TfLiteStatus Run(const TfLiteRegistration& registration, TfLiteTensor* tensors,
+                 int tensors_size, int* inputs_array_data,
+                 int* outputs_array_data, const flexbuffers::Builder& fbb) {
+  micro::KernelRunner runner(registration, tensors, tensors_size,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), nullptr);
+  const std::vector<uint8_t>& options = fbb.GetBuffer();
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare(
+      reinterpret_cast<const char*>(options.data()), options.size()));
+  return runner.Invoke();
+}
+
+// Runs Conv2D_Deep, then MaxPool2D on its output, each as one region
+TfLiteStatus RunConvPoolUnfused(int8_t* output_data) {
+  int8_t conv_data[kImageSize];
+  int image_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {4, kChannels, 3, 3, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  int pooled_dims[] = {4, 1, kHeight / kPool, kWidth / kPool, kChannels};
+
+  {
+    TfLiteTensor tensors[] = {
+        CreateTensor(input_data, IntArrayFromInts(image_dims)),
+        CreateTensor(weights_data, IntArrayFromInts(weights_dims)),
+        CreateTensor(bso_data, IntArrayFromInts(bso_dims)),
+        CreateTensor(conv_data, IntArrayFromInts(image_dims)),
+    };
+    int inputs_array_data[] = {3, 0, 1, 2};
+    int outputs_array_data[] = {1, 3};
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      BuildStride(fbb, 1);
+      BuildPad(fbb);
+      BuildPlan(fbb, kHeight, kWidth, 1);
+    });
+    fbb.Finish();
+    TF_LITE_ENSURE_STATUS(Run(*xc::Register_Conv2D_Deep(), tensors, 4,
+                              inputs_array_data, outputs_array_data, fbb));
+  }
+
+  TfLiteTensor tensors[] = {
+      CreateTensor(conv_data, IntArrayFromInts(image_dims)),
+      CreateTensor(output_data, IntArrayFromInts(pooled_dims)),
+  };
+  int inputs_array_data[] = {1, 0};
+  int outputs_array_data[] = {1, 1};
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    BuildStride(fbb, kPool);
+    BuildPool(fbb);
+    BuildPlan(fbb, kHeight / kPool, kWidth / kPool, 1);
+  });
+  fbb.Finish();
+  return Run(*xc::Register_MaxPool2D(), tensors, 2, inputs_array_data,
+             outputs_array_data, fbb);
+}
+
+TfLiteStatus RunConvPoolFused(int8_t* output_data) {
+  int image_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {4, kChannels, 3, 3, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  int pooled_dims[] = {4, 1, kHeight / kPool, kWidth / kPool, kChannels};
+
+  TfLiteTensor tensors[] = {
+      CreateTensor(input_data, IntArrayFromInts(image_dims)),
+      CreateTensor(weights_data, IntArrayFromInts(weights_dims)),
+      CreateTensor(bso_data, IntArrayFromInts(bso_dims)),
+      CreateTensor(output_data, IntArrayFromInts(pooled_dims)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    BuildStride(fbb, 1);
+    BuildPad(fbb);
+    BuildPool(fbb);
+    BuildPlan(fbb, kHeight / kPool, kWidth / kPool, 2);
+  });
+  fbb.Finish();
+  return Run(*xc::Register_Conv2D_Deep_MaxPool2D(), tensors, 4,
+             inputs_array_data, outputs_array_data, fbb);
+}
+
+// Runs Conv2D_1x1, as one region, then Add_8 of its output and the addend
+TfLiteStatus RunConvAddUnfused(int8_t* output_data) {
+  int8_t conv_data[kImageSize];
+  int image_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {2, kChannels, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  int bss_dims[] = {1, 6};
+
+  {
+    TfLiteTensor tensors[] = {
+        CreateTensor(input_data, IntArrayFromInts(image_dims)),
+        CreateTensor(weights_data, IntArrayFromInts(weights_dims)),
+        CreateTensor(bso_data, IntArrayFromInts(bso_dims)),
+        CreateTensor(conv_data, IntArrayFromInts(image_dims)),
+    };
+    int inputs_array_data[] = {3, 0, 1, 2};
+    int outputs_array_data[] = {1, 3};
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { BuildPlan(fbb, kHeight, kWidth, 1); });
+    fbb.Finish();
+    TF_LITE_ENSURE_STATUS(Run(*xc::Register_Conv2D_1x1(), tensors, 4,
+                              inputs_array_data, outputs_array_data, fbb));
+  }
+
+  TfLiteTensor tensors[] = {
+      CreateTensor(conv_data, IntArrayFromInts(image_dims)),
+      CreateTensor(addend_data, IntArrayFromInts(image_dims)),
+      CreateTensor(bss_data, IntArrayFromInts(bss_dims)),
+      CreateTensor(output_data, IntArrayFromInts(image_dims)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Map("par",
+            [&]() { fbb.Vector("eg", [&]() { fbb.Int(kImageSize); }); });
+  });
+  fbb.Finish();
+  return Run(*xc::Register_Add_8(), tensors, 4, inputs_array_data,
+             outputs_array_data, fbb);
+}
+
+TfLiteStatus RunConvAddFused(int8_t* output_data) {
+  int image_dims[] = {4, 1, kHeight, kWidth, kChannels};
+  int weights_dims[] = {2, kChannels, kChannels};
+  int bso_dims[] = {3, kChangrps, 7, 16};
+  int bss_dims[] = {1, 6};
+
+  TfLiteTensor tensors[] = {
+      CreateTensor(input_data, IntArrayFromInts(image_dims)),
+      CreateTensor(weights_data, IntArrayFromInts(weights_dims)),
+      CreateTensor(bso_data, IntArrayFromInts(bso_dims)),
+      CreateTensor(addend_data, IntArrayFromInts(image_dims)),
+      CreateTensor(bss_data, IntArrayFromInts(bss_dims)),
+      CreateTensor(output_data, IntArrayFromInts(image_dims)),
+  };
+  int inputs_array_data[] = {5, 0, 1, 2, 3, 4};
+  int outputs_array_data[] = {1, 5};
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() { BuildPlan(fbb, kHeight, kWidth, 2); });
+  fbb.Finish();
+  return Run(*xc::Register_Conv2D_1x1_Add_8(), tensors, 6, inputs_array_data,
+             outputs_array_data, fbb);
+}
+
+void InitData() {
+  for (int i = 0; i < kImageSize; i++) {
+    input_data[i] = static_cast<int8_t>(i * 7);
+    addend_data[i] = static_cast<int8_t>(i * 11 + 3);
+  }
+  for (size_t i = 0; i < sizeof(weights_data); i++) {
+    weights_data[i] = static_cast<int8_t>(i * 5 - 64);
+  }
+  constexpr size_t kBsoLength = sizeof(bso_data) / sizeof(int16_t);
+  for (size_t i = 0; i < kBsoLength; i++) {
+    bso_data[i] = static_cast<int16_t>(i % 13);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// The conv rows under each pooled row are computed in a tile, and must pool to
+// the output of the two ops run one after the other
+TF_LITE_MICRO_TEST(ConvMaxPoolMatchesUnfusedOps) {
+  namespace xc = tflite::ops::micro::xcore;
+  using tflite::testing::kPooledSize;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  int8_t unfused_output[kPooledSize];
+  int8_t fused_output[kPooledSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunConvPoolUnfused(unfused_output));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunConvPoolFused(fused_output));
+  for (int i = 0; i < kPooledSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(unfused_output[i], fused_output[i]);
+  }
+}
+
+// The fused op's regions are narrower than the image, so each row of a region
+// is a separate tile
+TF_LITE_MICRO_TEST(Conv1x1AddMatchesUnfusedOps) {
+  namespace xc = tflite::ops::micro::xcore;
+  using tflite::testing::kImageSize;
+
+  xc::Dispatcher dispatcher(tflite::GetMicroErrorReporter(), true);
+  xc::SetDispatcher(&dispatcher);
+  tflite::testing::InitData();
+
+  int8_t unfused_output[kImageSize];
+  int8_t fused_output[kImageSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunConvAddUnfused(unfused_output));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::RunConvAddFused(fused_output));
+  for (int i = 0; i < kImageSize; i++) {
+    TF_LITE_MICRO_EXPECT_EQ(unfused_output[i], fused_output[i]);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -2,10 +2,24 @@
 
 #include "tensorflow/lite/micro/kernels/xcore/xcore_interpreter.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+
 namespace tflite {
 namespace micro {
 namespace xcore {
 
+using tflite::ops::micro::xcore::kDoubleWordAlignment;
+
+// Only the xcore ops read their constant tensors with FetchBuffer, any other
+//   op would use the tensors in place and never see the prefetched copies
+static bool FetchesConstantTensors(const TfLiteRegistration* registration) {
+  return registration->custom_name &&
+         (strncmp(registration->custom_name, "XC_", 3) == 0);
+}
+
 XCoreInterpreter::XCoreInterpreter(const tflite::Model* model,
                                    const tflite::MicroOpResolver& resolver,
                                    tflite::MicroAllocator* allocator,
@@ -13,7 +27,10 @@ XCoreInterpreter::XCoreInterpreter(const tflite::Model* model,
                                    bool use_current_thread,
                                    tflite::MicroProfiler* profiler)
     : tflite::MicroInterpreter(model, resolver, allocator, reporter, profiler),
-      dispatcher_(reporter, use_current_thread) {
+      dispatcher_(reporter, use_current_thread),
+      allocator_(allocator),
+      prefetcher_(&dispatcher_) {
+  dispatcher_.SetOptionKeyCache(&option_key_cache_);
   SetDispatcher(&dispatcher_);
 }
 
@@ -24,7 +41,10 @@ XCoreInterpreter::XCoreInterpreter(const tflite::Model* model,
                                    bool use_current_thread,
                                    XCoreProfiler* profiler)
     : tflite::MicroInterpreter(model, resolver, allocator, reporter, profiler),
-      dispatcher_(reporter, use_current_thread) {
+      dispatcher_(reporter, use_current_thread),
+      allocator_(allocator),
+      prefetcher_(&dispatcher_) {
+  dispatcher_.SetOptionKeyCache(&option_key_cache_);
   SetDispatcher(&dispatcher_);
   if (profiler) {
     profiler->Init(allocator, operators_size());
@@ -41,11 +61,118 @@ XCoreInterpreter::XCoreInterpreter(const tflite::Model* model,
           model, resolver, MicroAllocator::Create(arena, arena_size, reporter),
           reporter, use_current_thread, profiler) {}
 
+TfLiteStatus XCoreInterpreter::AllocateTensors() {
+  // the ops request their stacks again as they are prepared
+  dispatcher_.ResetStackRequests();
+  tensors_allocated_ = false;
+  TF_LITE_ENSURE_STATUS(MicroInterpreter::AllocateTensors());
+  tensors_allocated_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus XCoreInterpreter::SetDynamicScheduling(bool dynamic) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(dispatcher_.GetReporter(),
+                         "SetDynamicScheduling() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  dispatcher_.SetDynamicScheduling(dynamic);
+  return kTfLiteOk;
+}
+
+TfLiteStatus XCoreInterpreter::RequestModelScratchBuffers(
+    tflite::MicroAllocator* arena_allocator) {
+  if (!dispatcher_.IsStackPoolEnabled()) return kTfLiteOk;
+
+  // never empty, the workers' stack size is 0 on the host
+  size_t pool_size = AlignSizeUp(
+      std::max(dispatcher_.GetStackPoolSize(), kDoubleWordAlignment),
+      kDoubleWordAlignment);
+  int scratch_index = -1;
+  TF_LITE_ENSURE_STATUS(arena_allocator->RequestModelScratchBufferInArena(
+      pool_size, &scratch_index));
+  dispatcher_.SetStackPool(scratch_index);
+
+  return kTfLiteOk;
+}
+
+size_t XCoreInterpreter::GetStackPoolSize() const {
+  return dispatcher_.IsStackPoolEnabled() ? dispatcher_.GetStackPoolSize() : 0;
+}
+
+size_t XCoreInterpreter::GetStackPoolSaving() const {
+  if (!dispatcher_.IsStackPoolEnabled()) return 0;
+  return dispatcher_.GetStackRequestsSize() - dispatcher_.GetStackPoolSize();
+}
+
 TfLiteTensor* XCoreInterpreter::tensor(size_t tensor_index) {
   auto ctx = context();
   return ctx.GetTensor(&ctx, tensor_index);
 }
 
+TfLiteStatus XCoreInterpreter::EnablePrefetching(size_t region_size) {
+  region_size = AlignSizeUp(region_size, kDoubleWordAlignment);
+  auto* regions = static_cast<int8_t*>(
+      allocator_->AllocatePersistentBuffer(2 * region_size));
+  if (!regions) return kTfLiteError;
+
+  prefetcher_.SetRegions(regions, &regions[region_size], region_size);
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus XCoreInterpreter::InvokeNode(int node_index) {
+  // A node of a called subgraph runs within its caller, which still reads the
+  //   active region, so the regions are only swapped between outermost nodes.
+  if (!prefetcher_.IsEnabled() || (invoke_depth_ > 0)) {
+    return MicroInterpreter::InvokeNode(node_index);
+  }
+
+  // Wait for this node's tensors, then start on the next node's. The patch
+  //   and streaming plans may run another node next, which then fetches its
+  //   own tensors as the prefetched ones won't match.
+  TF_LITE_ENSURE_STATUS(prefetcher_.Activate());
+  if (static_cast<size_t>(node_index) + 1 < operators_size()) {
+    tflite::NodeAndRegistration next = node_and_registration(node_index + 1);
+    if (FetchesConstantTensors(next.registration)) {
+      auto ctx = context();
+      TF_LITE_ENSURE_STATUS(prefetcher_.Prefetch(&ctx, &next.node));
+    }
+  }
+
+  invoke_depth_++;
+  TfLiteStatus status = MicroInterpreter::InvokeNode(node_index);
+  invoke_depth_--;
+  return status;
+}
+
+TfLiteStatus XCoreInterpreter::Invoke() {
+  if (!prefetcher_.IsEnabled() || operators_size() == 0) {
+    return MicroInterpreter::Invoke();
+  }
+
+  // the nodes only exist once the tensors are allocated
+  if (!tensors_allocated_) TF_LITE_ENSURE_STATUS(AllocateTensors());
+
+  // the ops find the prefetched tensors through this interpreter's dispatcher
+  SetDispatcher(&dispatcher_);
+
+  TfLiteStatus invoke_status = kTfLiteOk;
+  tflite::NodeAndRegistration first = node_and_registration(0);
+  if (FetchesConstantTensors(first.registration)) {
+    // the first node's tensors are fetched without overlap
+    auto ctx = context();
+    invoke_status = prefetcher_.Prefetch(&ctx, &first.node);
+  }
+  if (invoke_status == kTfLiteOk) {
+    invoke_status = MicroInterpreter::Invoke();
+  }
+  TfLiteStatus reset_status = prefetcher_.Reset();
+
+  return (invoke_status == kTfLiteOk) ? reset_status : invoke_status;
+}
+
 }  // namespace xcore
 }  // namespace micro
 }  // namespace tflite
@@ -2,7 +2,9 @@
 #ifndef XCORE_INTERPRETER_H_
 #define XCORE_INTERPRETER_H_
 
+#include "tensorflow/lite/micro/kernels/xcore/xcore_custom_options.h"
 #include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_prefetcher.h"
 #include "tensorflow/lite/micro/kernels/xcore/xcore_profiler.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
@@ -33,10 +35,55 @@ class XCoreInterpreter : public tflite::MicroInterpreter {
                    bool use_current_thread = true,
                    XCoreProfiler* profiler = nullptr);
 
+  // Allocates the tensors, and the worker stack pool if it is enabled
+  TfLiteStatus AllocateTensors() override;
+
   TfLiteTensor* tensor(size_t tensor_index);
 
+  // Fetch the constant tensors in external memory of the next operator into
+  // one of two arena regions of region_size bytes while the current operator
+  // runs. Tensors that do not fit are fetched by the operator as before.
+  TfLiteStatus EnablePrefetching(size_t region_size);
+
+  TfLiteStatus Invoke() override;
+
+  // Let threads claim smaller jobs dynamically to balance their load, see
+  // Dispatcher::SetDynamicScheduling. Fails after AllocateTensors, since the
+  // operators split their work into jobs as they are prepared.
+  TfLiteStatus SetDynamicScheduling(bool dynamic);
+
+  // Share one stack pool, sized to the largest worker stack request, between
+  //   all operators instead of planning a stack scratch buffer per operator.
+  //   The pool is a non-persistent scratch buffer in the arena head, used for
+  //   the whole invocation. Disabled by default. Call before AllocateTensors.
+  void EnableStackPool(bool enable) { dispatcher_.EnableStackPool(enable); }
+
+  // Size of the shared stack pool, available after AllocateTensors
+  size_t GetStackPoolSize() const;
+
+  // Stack scratch no longer requested from the arena planner, i.e. the sum of
+  //   the operators' stack requests less the pool. This is an upper bound on
+  //   the arena saving, since the planner may have overlapped some of them.
+  size_t GetStackPoolSaving() const;
+
+ protected:
+  // Starts prefetching the tensors of the node after node_index before
+  //   invoking it, when prefetching is enabled and the next node is an xcore
+  //   op. The nodes of called subgraphs don't prefetch, as their caller still
+  //   reads the tensors prefetched for it.
+  TfLiteStatus InvokeNode(int node_index) override;
+
+  // Requests the stack pool, when it is enabled, for the whole model
+  TfLiteStatus RequestModelScratchBuffers(
+      tflite::MicroAllocator* arena_allocator) override;
+
  private:
   tflite::ops::micro::xcore::Dispatcher dispatcher_;
+  tflite::ops::micro::xcore::CustomOptionKeyCache option_key_cache_;
+  tflite::MicroAllocator* allocator_;
+  tflite::ops::micro::xcore::WeightPrefetcher prefetcher_;
+  int invoke_depth_ = 0;  // InvokeNode calls in progress
+  bool tensors_allocated_ = false;
 };
 
 }  // namespace xcore
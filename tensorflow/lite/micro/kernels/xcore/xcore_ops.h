@@ -21,6 +21,10 @@ constexpr const char* Conv2D_Depthwise_OpCode = "XC_conv2d_depthwise";
 constexpr const char* Add_8_OpCode = "XC_add_8";
 constexpr const char* Pad_OpCode = "XC_pad";
 
+// Fused ops
+constexpr const char* Conv2D_Deep_MaxPool2D_OpCode = "XC_conv2d_deep_maxpool2d";
+constexpr const char* Conv2D_1x1_Add_8_OpCode = "XC_conv2d_1x1_add_8";
+
 // Binarized ops
 constexpr const char* Bsign_8_OpCode = "XC_bsign_8";
 constexpr const char* BConv2d_Bitpacked_OpCode = "XC_bconv2d_bin";
@@ -28,6 +32,8 @@ constexpr const char* BConv2d_Bitpacked_DeepIn_OpCode = "XC_bconv2d_bin_DI";
 constexpr const char* BConv2d_Int8_OpCode = "XC_bconv2d_int8";
 constexpr const char* BConv2d_Int8_DeepIn_DeepOut_OpCode =
     "XC_bconv2d_int8_DIDO";
+constexpr const char* BSign_BConv2d_Bitpacked_OpCode = "XC_bsign_bconv2d_bin";
+constexpr const char* BSign_BConv2d_Int8_OpCode = "XC_bsign_bconv2d_int8";
 
 // Currently unused, may be deprecated
 constexpr const char* Requantize_16_to_8_OpCode = "XC_requantize_16_to_8";
@@ -79,6 +85,12 @@ TfLiteRegistration* Register_BConv2D_Bitpacked_Deepin();
 TfLiteRegistration* Register_BConv2D_Bitpacked();
 TfLiteRegistration* Register_BConv2D_Int8_Deepin_Deepout();
 TfLiteRegistration* Register_BConv2D_Int8();
+TfLiteRegistration* Register_BSign_BConv2D_Bitpacked();
+TfLiteRegistration* Register_BSign_BConv2D_Int8();
+
+// Fused ops
+TfLiteRegistration* Register_Conv2D_Deep_MaxPool2D();
+TfLiteRegistration* Register_Conv2D_1x1_Add_8();
 
 // Under development
 TfLiteRegistration* Register_Pad();
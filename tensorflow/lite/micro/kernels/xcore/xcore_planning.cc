@@ -1,6 +1,8 @@
 // Copyright (c) 2020, XMOS Ltd, All rights reserved
 #include "tensorflow/lite/micro/kernels/xcore/xcore_planning.h"
 
+#include <algorithm>
+
 #include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
 
 namespace tflite {
@@ -30,6 +32,47 @@ void ExecutionPlan::SetBiasScratchSize(size_t size) {
 }
 size_t ExecutionPlan::GetBiasScratchSize() { return bias_scratch_size_; }
 
+//*****************************
+//*****************************
+//*****************************
+// Jobs
+//*****************************
+//*****************************
+//*****************************
+TfLiteStatus CreateJobs(TfLiteContext *context,
+                        PersistentArray<RowColRegion> &regions, bool dynamic,
+                        PersistentArray<RowColRegion> &jobs) {
+  if (regions.size() == 0) return kTfLiteOk;
+
+  size_t max_jobs_per_region = dynamic ? kJobsPerRegion : 1;
+  if (jobs.max_size() > 0) {
+    // already created, the persistent jobs can't be rebuilt for another mode
+    if (jobs.max_size() != regions.size() * max_jobs_per_region) {
+      TF_LITE_KERNEL_LOG(context,
+                         "The scheduling mode changed after the jobs were "
+                         "created, set it before AllocateTensors");
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+  jobs.allocate(context, regions.size() * max_jobs_per_region);
+
+  for (auto &region : regions) {
+    int32_t n_bands = std::min<int32_t>(region.rows, max_jobs_per_region);
+    if (n_bands < 1) n_bands = 1;
+
+    // split the rows as evenly as possible
+    int32_t top = region.top;
+    for (int32_t i_band = 0; i_band < n_bands; i_band++) {
+      int32_t rows = region.rows / n_bands + (i_band < region.rows % n_bands);
+      jobs.append({top, region.left, rows, region.cols});
+      top += rows;
+    }
+  }
+
+  return kTfLiteOk;
+}
+
 }  // namespace xcore
 }  // namespace micro
 }  // namespace ops
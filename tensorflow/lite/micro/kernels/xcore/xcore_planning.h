@@ -16,6 +16,8 @@ namespace xcore {
 constexpr size_t kChannelGroupLength = (16);
 constexpr size_t kBSOChannelGroupLength = (7 * kChannelGroupLength);
 constexpr size_t kBSOChannelGroupBytes = (kBSOChannelGroupLength * 2);
+// number of jobs each region is split into with dynamic scheduling
+constexpr size_t kJobsPerRegion = 4;
 
 typedef struct RowColRegion {
   int32_t top;
@@ -46,6 +48,7 @@ class ExecutionPlan {
 
   PersistentArray<RowColRegion> regions;
   PersistentArray<ChannelGroup> changrps;
+  PersistentArray<RowColRegion> jobs;  // see CreateJobs
 
  private:
   size_t n_threads_;
@@ -53,6 +56,14 @@ class ExecutionPlan {
   size_t bias_scratch_size_;
 };
 
+// Creates the jobs for threads to claim from the regions of a plan
+//   With dynamic scheduling each region is split into (up to) kJobsPerRegion
+//   bands of rows, otherwise there is one job per region. Fails if the jobs
+//   were already created with the other mode.
+TfLiteStatus CreateJobs(TfLiteContext *context,
+                        PersistentArray<RowColRegion> &regions, bool dynamic,
+                        PersistentArray<RowColRegion> &jobs);
+
 }  // namespace xcore
 }  // namespace micro
 }  // namespace ops
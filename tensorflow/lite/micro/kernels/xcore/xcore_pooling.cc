@@ -26,9 +26,21 @@ struct PoolingThreadParams {
   const nn_image_params_t* x_image;
   const nn_image_params_t* y_image;
   const nn_window_params_t* window;
-  nn_window_op_job_params_t job;
+  const RowColRegion* jobs;
+  JobClaimer claimer;
 };
 
+// Claims the next job, returns false when there are no jobs left
+static inline bool claim_job(PoolingThreadParams& params,
+                             nn_window_op_job_params_t& job) {
+  int32_t index;
+  if (!params.claimer.Claim(index)) return false;
+  const RowColRegion& region = params.jobs[index];
+  job = {{region.top, region.left, 0},
+         {region.rows, region.cols, (int32_t)params.y_image->channels}};
+  return true;
+}
+
 //**************************************
 //**************************************
 //**************************************
@@ -53,8 +65,12 @@ struct MaxPoolThreadData {
 extern "C" {
 ATTRIBUTE_THREAD_FUNCTION void maxpool_thread_worker(void* context) {
   MaxPoolThreadData* td = (MaxPoolThreadData*)context;
-  maxpool2d_ext(td->data.Y, td->data.X, td->params.x_image, td->params.y_image,
-                td->params.window, &td->params.job, MAXPOOL2D_FLAG_NONE);
+  nn_window_op_job_params_t job;
+  while (claim_job(td->params, job)) {
+    maxpool2d_ext(td->data.Y, td->data.X, td->params.x_image,
+                  td->params.y_image, td->params.window, &job,
+                  MAXPOOL2D_FLAG_NONE);
+  }
 }
 }
 
@@ -79,9 +95,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   MaxPoolOpData* op = reinterpret_cast<MaxPoolOpData*>(node->user_data);
 
+  // split the regions into the jobs threads will claim
+  TF_LITE_ENSURE_STATUS(CreateJobs(context, op->execution_plan.regions,
+                                   GetDispatcher()->IsDynamicScheduling(),
+                                   op->execution_plan.jobs));
+
   // allocate the stack for thread workers
   GET_THREAD_FUNCTION_STACKSIZE(op->stack_size, maxpool_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op->stack_size * op->execution_plan.GetNumThreads(),
       &op->stack_scratch_index));
 
@@ -99,8 +120,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   Dispatcher* dispatcher = GetDispatcher();
 
   // initialize the dispatcher
-  char* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op->stack_scratch_index);
   TFLITE_DCHECK(stack != nullptr);
   dispatcher->InitializeTasks(maxpool_thread_worker, stack, op->stack_size);
 
@@ -121,16 +141,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       {op->params.stride_h, op->params.stride_w}};
 
   // create tasks
-  for (int i_rg = 0; i_rg < op->execution_plan.regions.size(); i_rg++) {
-    const RowColRegion& region = op->execution_plan.regions[i_rg];
+  JobQueue* queue = dispatcher->GetJobQueue();
+  const int n_jobs = op->execution_plan.jobs.size();
+  const int n_regions = op->execution_plan.regions.size();
+  queue->Reset(n_jobs);
+  for (int i_rg = 0; i_rg < n_regions; i_rg++) {
     thread_data[i_rg].data.Y = tflite::micro::GetTensorData<nn_image_t>(output);
     thread_data[i_rg].data.X = tflite::micro::GetTensorData<nn_image_t>(input);
     thread_data[i_rg].params.x_image = &in_image;
     thread_data[i_rg].params.y_image = &out_image;
     thread_data[i_rg].params.window = &pooling_window;
-    thread_data[i_rg].params.job = {
-        {region.top, region.left, 0},
-        {region.rows, region.cols, output_shape.Dims(3)}};
+    thread_data[i_rg].params.jobs = op->execution_plan.jobs.begin();
+    thread_data[i_rg].params.claimer.Reset(queue, n_jobs, n_regions, i_rg);
 
     dispatcher->AddTask(reinterpret_cast<void*>(&thread_data[i_rg]));
   }
@@ -167,8 +189,12 @@ struct AvgPoolThreadData {
 extern "C" {
 ATTRIBUTE_THREAD_FUNCTION void avgpool_thread_worker(void* context) {
   AvgPoolThreadData* td = (AvgPoolThreadData*)context;
-  avgpool2d_ext(td->data.Y, td->data.X, td->params.x_image, td->params.y_image,
-                td->params.window, &td->params.job, AVGPOOL2D_FLAG_NONE);
+  nn_window_op_job_params_t job;
+  while (claim_job(td->params, job)) {
+    avgpool2d_ext(td->data.Y, td->data.X, td->params.x_image,
+                  td->params.y_image, td->params.window, &job,
+                  AVGPOOL2D_FLAG_NONE);
+  }
 }
 }
 
@@ -193,9 +219,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   AvgPoolOpData* op = reinterpret_cast<AvgPoolOpData*>(node->user_data);
 
+  // split the regions into the jobs threads will claim
+  TF_LITE_ENSURE_STATUS(CreateJobs(context, op->execution_plan.regions,
+                                   GetDispatcher()->IsDynamicScheduling(),
+                                   op->execution_plan.jobs));
+
   // allocate the stack for thread workers
   GET_THREAD_FUNCTION_STACKSIZE(op->stack_size, avgpool_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op->stack_size * op->execution_plan.GetNumThreads(),
       &op->stack_scratch_index));
 
@@ -213,8 +244,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   Dispatcher* dispatcher = GetDispatcher();
 
   // initialize the dispatcher
-  char* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op->stack_scratch_index);
   TFLITE_DCHECK(stack != nullptr);
   dispatcher->InitializeTasks(avgpool_thread_worker, stack, op->stack_size);
 
@@ -235,16 +265,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       {op->params.stride_h, op->params.stride_w}};
 
   // create tasks
-  for (int i_rg = 0; i_rg < op->execution_plan.regions.size(); i_rg++) {
-    const RowColRegion& region = op->execution_plan.regions[i_rg];
+  JobQueue* queue = dispatcher->GetJobQueue();
+  const int n_jobs = op->execution_plan.jobs.size();
+  const int n_regions = op->execution_plan.regions.size();
+  queue->Reset(n_jobs);
+  for (int i_rg = 0; i_rg < n_regions; i_rg++) {
     thread_data[i_rg].data.Y = tflite::micro::GetTensorData<nn_image_t>(output);
     thread_data[i_rg].data.X = tflite::micro::GetTensorData<nn_image_t>(input);
     thread_data[i_rg].params.x_image = &in_image;
     thread_data[i_rg].params.y_image = &out_image;
     thread_data[i_rg].params.window = &pooling_window;
-    thread_data[i_rg].params.job = {
-        {region.top, region.left, 0},
-        {region.rows, region.cols, output_shape.Dims(3)}};
+    thread_data[i_rg].params.jobs = op->execution_plan.jobs.begin();
+    thread_data[i_rg].params.claimer.Reset(queue, n_jobs, n_regions, i_rg);
     dispatcher->AddTask(reinterpret_cast<void*>(&thread_data[i_rg]));
   }
 
@@ -324,7 +356,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // allocate the stack for thread workers
   GET_THREAD_FUNCTION_STACKSIZE(op->stack_size, avgpool_global_thread_worker);
-  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+  TF_LITE_ENSURE_STATUS(GetDispatcher()->RequestStack(
       context, op->stack_size * op->execution_plan.GetNumThreads(),
       &op->stack_scratch_index));
 
@@ -342,8 +374,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   Dispatcher* dispatcher = GetDispatcher();
 
   // initialize the dispatcher
-  char* stack = static_cast<char*>(
-      context->GetScratchBuffer(context, op->stack_scratch_index));
+  char* stack = dispatcher->GetStack(context, op->stack_scratch_index);
   TFLITE_DCHECK(stack != nullptr);
   dispatcher->InitializeTasks(avgpool_global_thread_worker, stack,
                               op->stack_size);
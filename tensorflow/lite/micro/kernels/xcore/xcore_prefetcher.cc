@@ -0,0 +1,88 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+#include "tensorflow/lite/micro/kernels/xcore/xcore_prefetcher.h"
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace xcore {
+
+WeightPrefetcher::WeightPrefetcher(Dispatcher *dispatcher)
+    : dispatcher_(dispatcher),
+      regions_{nullptr, nullptr},
+      region_size_(0),
+      n_buffers_{0, 0},
+      active_(1) {}
+
+void WeightPrefetcher::SetRegions(int8_t *region0, int8_t *region1,
+                                  size_t region_size) {
+  regions_[0] = region0;
+  regions_[1] = region1;
+  region_size_ = region_size;
+}
+
+TfLiteStatus WeightPrefetcher::Prefetch(const TfLiteContext *context,
+                                        const TfLiteNode *node) {
+  const int next = 1 - active_;
+  size_t offset = 0;
+  n_buffers_[next] = 0;
+
+  for (int i = 0; i < node->inputs->size; i++) {
+    const int tensor_index = node->inputs->data[i];
+    if (tensor_index < 0) continue;  // optional input
+
+    const TfLiteEvalTensor *tensor =
+        context->GetEvalTensor(context, tensor_index);
+    const int8_t *src = static_cast<const int8_t *>(tensor->data.data);
+    if (!src || is_ram_address((uintptr_t)src)) continue;
+
+    size_t size;
+    TF_LITE_ENSURE_STATUS(
+        tflite::TfLiteEvalTensorByteLength(tensor, &size));
+    size_t aligned_size = AlignSizeUp(size, kDoubleWordAlignment);
+    if ((offset + aligned_size > region_size_) ||
+        (n_buffers_[next] == kMaxPrefetchedBuffers)) {
+      continue;  // left for the operator to fetch itself
+    }
+
+    PrefetchedBuffer &buffer = buffers_[next][n_buffers_[next]++];
+    buffer.src = src;
+    buffer.size = size;
+    buffer.dest = &regions_[next][offset];
+    offset += aligned_size;
+
+    // a plain copy, since the source may itself be prefetched in the active
+    // region which will be overwritten by the prefetch after this one
+    TF_LITE_ENSURE_STATUS(
+        fetcher_.AddStridedFetch(buffer.dest, src, size, 1, size));
+  }
+
+  return fetcher_.StartFetches();
+}
+
+TfLiteStatus WeightPrefetcher::Activate() {
+  TF_LITE_ENSURE_STATUS(fetcher_.WaitFetches());
+
+  active_ = 1 - active_;
+  dispatcher_->SetPrefetchedBuffers(buffers_[active_], n_buffers_[active_]);
+  // the other region is free, and empty until the next Prefetch fills it
+  n_buffers_[1 - active_] = 0;
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus WeightPrefetcher::Reset() {
+  TF_LITE_ENSURE_STATUS(fetcher_.WaitFetches());
+
+  dispatcher_->SetPrefetchedBuffers(nullptr, 0);
+  n_buffers_[0] = n_buffers_[1] = 0;
+  active_ = 1;
+
+  return kTfLiteOk;
+}
+
+}  // namespace xcore
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,59 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+#ifndef XCORE_PREFETCHER_H_
+#define XCORE_PREFETCHER_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace xcore {
+
+constexpr size_t kMaxPrefetchedBuffers = kMaxFetchRequests;
+
+// Fetches the constant tensors in external memory of the next operator while
+// the current operator runs.
+//
+// Two regions are used in turn, one holds the tensors of the running operator
+// (registered with the dispatcher, so visible to FetchBuffer) while the other
+// receives the tensors of the next operator.
+class WeightPrefetcher {
+ public:
+  explicit WeightPrefetcher(Dispatcher *dispatcher);
+  ~WeightPrefetcher() {}
+
+  void SetRegions(int8_t *region0, int8_t *region1, size_t region_size);
+  bool IsEnabled() const { return region_size_ > 0; }
+
+  // Queue the external constant inputs of node that fit in the free region
+  // and start fetching them on the I/O thread
+  TfLiteStatus Prefetch(const TfLiteContext *context, const TfLiteNode *node);
+
+  // Wait for the last Prefetch to complete and register the fetched tensors
+  // with the dispatcher, making them visible to FetchBuffer
+  // (none when there was no Prefetch since the last Activate)
+  TfLiteStatus Activate();
+
+  // Wait for any pending Prefetch and forget all prefetched tensors
+  TfLiteStatus Reset();
+
+  size_t GetRegionSize() const { return region_size_; }
+
+ private:
+  Dispatcher *dispatcher_;
+  AsyncFetcher fetcher_;
+  int8_t *regions_[2];
+  size_t region_size_;
+  PrefetchedBuffer buffers_[2][kMaxPrefetchedBuffers];
+  int n_buffers_[2];
+  int active_;  // region of the running operator
+};
+
+}  // namespace xcore
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // XCORE_PREFETCHER_H_
@@ -1,40 +1,191 @@
 // Copyright (c) 2019, XMOS Ltd, All rights reserved
 #include "tensorflow/lite/micro/kernels/xcore/xcore_profiler.h"
 
+#include <cstdarg>
+#include <cstring>
+
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_utils.h"
+#include "tensorflow/lite/micro/micro_string.h"
 #include "tensorflow/lite/micro/micro_time.h"
 
 namespace tflite {
 namespace micro {
 namespace xcore {
 
+using tflite::ops::micro::xcore::DispatcherStats;
+using tflite::ops::micro::xcore::GetDispatcher;
+using tflite::ops::micro::xcore::HasDispatcher;
+
+constexpr int kTraceLineLength = 256;
+
 void XCoreProfiler::Init(tflite::MicroAllocator* allocator,
                          size_t max_event_count) {
   max_event_count_ = max_event_count;
   event_durations_ = static_cast<uint32_t*>(
       allocator->AllocatePersistentBuffer(max_event_count * sizeof(uint32_t)));
+  if (extended_) {
+    event_idle_ticks_ =
+        static_cast<uint32_t*>(allocator->AllocatePersistentBuffer(
+            max_event_count * sizeof(uint32_t)));
+    events_ =
+        static_cast<XCoreProfilerEvent*>(allocator->AllocatePersistentBuffer(
+            max_event_count * sizeof(XCoreProfilerEvent)));
+  }
 }
 
 uint32_t const* XCoreProfiler::GetEventDurations() { return event_durations_; }
 
+uint32_t const* XCoreProfiler::GetEventIdleTicks() { return event_idle_ticks_; }
+
 size_t XCoreProfiler::GetNumEvents() { return event_count_; }
 
-void XCoreProfiler::ClearEvents() { event_count_ = 0; }
+XCoreProfilerEvent const* XCoreProfiler::GetEvents() { return events_; }
+
+size_t XCoreProfiler::GetNumDroppedEvents() { return dropped_event_count_; }
+
+void XCoreProfiler::ClearEvents() {
+  event_count_ = 0;
+  dropped_event_count_ = 0;
+}
 
 uint32_t XCoreProfiler::BeginEvent(const char* tag) {
   TFLITE_DCHECK(tag);
   event_tag_ = tag;
+  // a plain MicroInterpreter runs the ops without a dispatcher
+  if (HasDispatcher()) GetDispatcher()->ResetStats();
+  tflite::ops::micro::xcore::ResetFetchTicks();
   event_start_time_ = tflite::GetCurrentTimeTicks();
   return 0;
 }
 
 void XCoreProfiler::EndEvent(uint32_t event_handle) {
   int32_t event_end_time = tflite::GetCurrentTimeTicks();
-  event_count_ = event_count_ % max_event_count_;
-  // wrap if there are too many events
+  static const DispatcherStats kNoStats = DispatcherStats();
+  const DispatcherStats& stats =
+      HasDispatcher() ? GetDispatcher()->GetStats() : kNoStats;
+
+  if (extended_) {
+    // keep the trace consistent, drop rather than wrap
+    if (event_count_ == max_event_count_) {
+      dropped_event_count_++;
+      return;
+    }
+    XCoreProfilerEvent& event = events_[event_count_];
+    event.tag = event_tag_;
+    event.start_ticks = event_start_time_;
+    event.duration = event_end_time - event_start_time_;
+    event.fetch_ticks = tflite::ops::micro::xcore::GetFetchTicks();
+    event.join_ticks = stats.join_ticks;
+    event.idle_ticks = stats.idle_ticks;
+    event.n_tasks = stats.n_tasks;
+    for (int i = 0; i < stats.n_tasks; i++) {
+      event.task_start_ticks[i] = stats.task_start_ticks[i] - event_start_time_;
+      event.task_end_ticks[i] = stats.task_end_ticks[i] - event_start_time_;
+    }
+    event_idle_ticks_[event_count_] = stats.idle_ticks;
+  } else {
+    // wrap if there are too many events
+    event_count_ = event_count_ % max_event_count_;
+  }
   event_durations_[event_count_++] = event_end_time - event_start_time_;
 }
 
+//**************************************
+// Trace export
+//**************************************
+
+// Formats one piece of the trace and passes it to the writer
+static void write_trace(XCoreTraceWriter writer, void* context,
+                        const char* format, ...) {
+  char line[kTraceLineLength];
+  va_list args;
+  va_start(args, format);
+  int length = MicroVsnprintf(line, kTraceLineLength, format, args);
+  va_end(args);
+  writer(context, line, length - 1);  // without the terminator
+}
+
+// Converts ticks to microseconds, if the tick rate is known
+static uint32_t ticks_to_trace_time(uint32_t ticks) {
+  int32_t ticks_per_second = tflite::ticks_per_second();
+  if (ticks_per_second <= 0) return ticks;
+  return static_cast<uint32_t>(static_cast<uint64_t>(ticks) * 1000000 /
+                               ticks_per_second);
+}
+
+TfLiteStatus XCoreProfiler::WriteChromeTrace(XCoreTraceWriter writer,
+                                             void* context) {
+  if (!extended_ || !writer) return kTfLiteError;
+
+  write_trace(writer, context, "{\"traceEvents\":[");
+  uint32_t origin = (event_count_ > 0) ? events_[0].start_ticks : 0;
+  for (size_t i = 0; i < event_count_; i++) {
+    const XCoreProfilerEvent& event = events_[i];
+    uint32_t start = event.start_ticks - origin;
+
+    // the operator, on the inference thread
+    write_trace(writer, context,
+                "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                "\"ts\":%u,\"dur\":%u,\"args\":{\"fetch\":%u,\"join\":%u,"
+                "\"idle\":%u}}",
+                (i > 0) ? "," : "", event.tag, ticks_to_trace_time(start),
+                ticks_to_trace_time(event.duration),
+                ticks_to_trace_time(event.fetch_ticks),
+                ticks_to_trace_time(event.join_ticks),
+                ticks_to_trace_time(event.idle_ticks));
+
+    // its tasks, one row per worker
+    for (uint32_t j = 0; j < event.n_tasks; j++) {
+      write_trace(writer, context,
+                  ",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                  "\"ts\":%u,\"dur\":%u}",
+                  event.tag, j + 1,
+                  ticks_to_trace_time(start + event.task_start_ticks[j]),
+                  ticks_to_trace_time(event.task_end_ticks[j] -
+                                      event.task_start_ticks[j]));
+    }
+  }
+  write_trace(writer, context, "],\"otherData\":{\"dropped_events\":%u}}\n",
+              static_cast<uint32_t>(dropped_event_count_));
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus XCoreProfiler::WriteBinaryTrace(XCoreTraceWriter writer,
+                                             void* context) {
+  if (!extended_ || !writer) return kTfLiteError;
+
+  const uint32_t header[] = {kTraceBinaryVersion,
+                             static_cast<uint32_t>(tflite::ticks_per_second()),
+                             static_cast<uint32_t>(kMaxTraceThreads),
+                             static_cast<uint32_t>(event_count_),
+                             static_cast<uint32_t>(dropped_event_count_)};
+  writer(context, "XCTR", 4);
+  writer(context, reinterpret_cast<const char*>(header), sizeof(header));
+
+  for (size_t i = 0; i < event_count_; i++) {
+    const XCoreProfilerEvent& event = events_[i];
+    size_t tag_length = strlen(event.tag);
+    if (tag_length > UINT8_MAX) tag_length = UINT8_MAX;
+    const uint8_t tag_length_byte = static_cast<uint8_t>(tag_length);
+    writer(context, reinterpret_cast<const char*>(&tag_length_byte), 1);
+    writer(context, event.tag, tag_length);
+
+    const uint32_t fields[] = {event.start_ticks, event.duration,
+                               event.fetch_ticks, event.join_ticks,
+                               event.idle_ticks,  event.n_tasks};
+    writer(context, reinterpret_cast<const char*>(fields), sizeof(fields));
+    for (uint32_t j = 0; j < event.n_tasks; j++) {
+      const uint32_t task[] = {event.task_start_ticks[j],
+                               event.task_end_ticks[j]};
+      writer(context, reinterpret_cast<const char*>(task), sizeof(task));
+    }
+  }
+
+  return kTfLiteOk;
+}
+
 }  // namespace xcore
 }  // namespace micro
-}  // namespace tflite
\ No newline at end of file
+}  // namespace tflite
@@ -4,6 +4,7 @@
 #define XCORE_PROFILER_H_
 
 #include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
 
@@ -15,9 +16,34 @@ namespace tflite {
 namespace micro {
 namespace xcore {
 
+constexpr size_t kMaxTraceThreads = tflite::ops::micro::xcore::kMaxThreads;
+constexpr uint32_t kTraceBinaryVersion = 1;
+
+// Everything recorded about one operator in extended mode
+//   Task ticks are relative to start_ticks, and cover all JoinTasks calls of
+//   the operator.
+typedef struct XCoreProfilerEvent {
+  const char* tag;
+  uint32_t start_ticks;
+  uint32_t duration;
+  uint32_t fetch_ticks;  // in FetchBuffer or waiting for async fetches
+  uint32_t join_ticks;   // in JoinTasks
+  uint32_t idle_ticks;   // threads waiting for the slowest thread
+  uint32_t n_tasks;
+  uint32_t task_start_ticks[kMaxTraceThreads];
+  uint32_t task_end_ticks[kMaxTraceThreads];
+} XCoreProfilerEvent;
+
+// Receives the exported trace in pieces, e.g. to write to a file or a port
+typedef void (*XCoreTraceWriter)(void* context, const char* data,
+                                 size_t size);
+
 class XCoreProfiler : public tflite::MicroProfiler {
  public:
-  explicit XCoreProfiler(){};
+  // In extended mode, each event also records its tag, fetch and join times
+  //   and the start and end ticks of every worker. Events are then not
+  //   wrapped but dropped (and counted) once max_event_count is reached.
+  explicit XCoreProfiler(bool extended = false) : extended_(extended){};
   ~XCoreProfiler() override = default;
 
   void Init(tflite::MicroAllocator* allocator,
@@ -33,12 +59,37 @@ class XCoreProfiler : public tflite::MicroProfiler {
   uint32_t const* GetEventDurations();
   size_t GetNumEvents();
 
+  // Extended mode only, nullptr otherwise
+  XCoreProfilerEvent const* GetEvents();
+  // Time threads spent idle waiting for the slowest thread of each event,
+  // i.e. the load imbalance of the operator's jobs
+  uint32_t const* GetEventIdleTicks();
+  size_t GetNumDroppedEvents();
+
+  // Export the extended events as Chrome trace JSON (chrome://tracing or
+  //   Perfetto), one row per worker. Timestamps are in microseconds if
+  //   ticks_per_second() is known, otherwise in ticks.
+  TfLiteStatus WriteChromeTrace(XCoreTraceWriter writer, void* context);
+
+  // Export the extended events in a compact binary format, in native byte
+  //   order:
+  //     header: "XCTR", version, ticks per second, n threads, n events,
+  //             n dropped events (uint32 each, after the magic)
+  //     event:  tag length (uint8), tag (not terminated), then start,
+  //             duration, fetch, join, idle ticks and n tasks (uint32 each),
+  //             then the start and end ticks of each task (uint32 each)
+  TfLiteStatus WriteBinaryTrace(XCoreTraceWriter writer, void* context);
+
  private:
+  bool extended_;
   const char* event_tag_;
   uint32_t event_start_time_;
   size_t event_count_ = 0;
   size_t max_event_count_ = 0;
-  uint32_t* event_durations_;
+  size_t dropped_event_count_ = 0;
+  uint32_t* event_durations_ = nullptr;
+  uint32_t* event_idle_ticks_ = nullptr;
+  XCoreProfilerEvent* events_ = nullptr;
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
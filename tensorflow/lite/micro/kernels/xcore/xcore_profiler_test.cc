@@ -0,0 +1,129 @@
+// Copyright (c) 2021, XMOS Ltd, All rights reserved
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/kernels/xcore/xcore_profiler.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 4096;
+alignas(16) uint8_t arena[kArenaSize];
+
+// Collects the exported trace
+constexpr size_t kTraceSize = 2048;
+char trace[kTraceSize];
+size_t trace_size = 0;
+
+void WriteTrace(void* context, const char* data, size_t size) {
+  if (trace_size + size < kTraceSize) {
+    memcpy(&trace[trace_size], data, size);
+  }
+  trace_size += size;
+  trace[trace_size < kTraceSize ? trace_size : kTraceSize - 1] = '\0';
+}
+
+void ClearTrace() {
+  trace_size = 0;
+  trace[0] = '\0';
+}
+
+// Records the events of three operators in a profiler with room for two
+// events. No dispatcher is set, as with a plain MicroInterpreter.
+void ProfileOperators(tflite::micro::xcore::XCoreProfiler* profiler) {
+  tflite::ops::micro::xcore::SetDispatcher(nullptr);
+  profiler->Init(tflite::MicroAllocator::Create(
+                     arena, kArenaSize, tflite::GetMicroErrorReporter()),
+                 2);
+  const char* tags[] = {"CONV", "ADD", "POOL"};
+  for (const char* tag : tags) {
+    profiler->EndEvent(profiler->BeginEvent(tag));
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ChromeTraceHasEveryRecordedEvent) {
+  tflite::micro::xcore::XCoreProfiler profiler(true);
+  tflite::testing::ProfileOperators(&profiler);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), profiler.GetNumEvents());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1),
+                          profiler.GetNumDroppedEvents());
+
+  tflite::testing::ClearTrace();
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      profiler.WriteChromeTrace(tflite::testing::WriteTrace, nullptr));
+  const char* trace = tflite::testing::trace;
+  TF_LITE_MICRO_EXPECT_EQ(strlen(trace), tflite::testing::trace_size);
+  const char* start = "{\"traceEvents\":[{\"name\":\"CONV\",\"ph\":\"X\"";
+  TF_LITE_MICRO_EXPECT_EQ(0, strncmp(trace, start, strlen(start)));
+  TF_LITE_MICRO_EXPECT(strstr(trace, "},{\"name\":\"ADD\",\"ph\":\"X\""));
+  TF_LITE_MICRO_EXPECT(!strstr(trace, "POOL"));
+  const char* end = "],\"otherData\":{\"dropped_events\":1}}\n";
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, strcmp(&trace[strlen(trace) - strlen(end)], end));
+}
+
+TF_LITE_MICRO_TEST(BinaryTraceHasEveryRecordedEvent) {
+  tflite::micro::xcore::XCoreProfiler profiler(true);
+  tflite::testing::ProfileOperators(&profiler);
+
+  tflite::testing::ClearTrace();
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      profiler.WriteBinaryTrace(tflite::testing::WriteTrace, nullptr));
+  const char* trace = tflite::testing::trace;
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(trace, "XCTR", 4));
+
+  uint32_t header[5];
+  memcpy(header, &trace[4], sizeof(header));
+  TF_LITE_MICRO_EXPECT_EQ(tflite::micro::xcore::kTraceBinaryVersion,
+                          header[0]);
+  TF_LITE_MICRO_EXPECT_EQ(
+      static_cast<uint32_t>(tflite::micro::xcore::kMaxTraceThreads),
+      header[2]);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(2), header[3]);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(1), header[4]);
+
+  // the events have no tasks without a dispatcher
+  constexpr size_t kEventFields = 6 * sizeof(uint32_t);
+  size_t offset = 4 + sizeof(header);
+  const char* tags[] = {"CONV", "ADD"};
+  for (const char* tag : tags) {
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<int>(strlen(tag)),
+                            static_cast<int>(trace[offset]));
+    TF_LITE_MICRO_EXPECT_EQ(0, memcmp(&trace[offset + 1], tag, strlen(tag)));
+    uint32_t fields[6];
+    memcpy(fields, &trace[offset + 1 + strlen(tag)], kEventFields);
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(0), fields[5]);
+    offset += 1 + strlen(tag) + kEventFields;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(offset, tflite::testing::trace_size);
+}
+
+// Without extended mode only the durations are kept, and wrap
+TF_LITE_MICRO_TEST(PlainProfilerKeepsOnlyDurations) {
+  tflite::micro::xcore::XCoreProfiler profiler(false);
+  tflite::testing::ProfileOperators(&profiler);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1), profiler.GetNumEvents());
+  TF_LITE_MICRO_EXPECT(profiler.GetEventDurations() != nullptr);
+  TF_LITE_MICRO_EXPECT(profiler.GetEventIdleTicks() == nullptr);
+  TF_LITE_MICRO_EXPECT(profiler.GetEvents() == nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      profiler.WriteChromeTrace(tflite::testing::WriteTrace, nullptr));
+}
+
+TF_LITE_MICRO_TESTS_END
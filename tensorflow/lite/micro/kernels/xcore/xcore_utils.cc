@@ -2,6 +2,9 @@
 
 #include <complex>
 
+#include "tensorflow/lite/micro/kernels/xcore/xcore_dispatcher.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
 extern "C" {
 #include "nn_op_utils.h"
 }
@@ -75,7 +78,29 @@ static inline void memload(void *dest, void *src, size_t size) {
   }
 }
 
-size_t FetchBuffer(int8_t **dest, int8_t const *src, size_t size) {
+#ifndef XCORE
+static uintptr_t kHostExternalMemoryStart = 0;
+static uintptr_t kHostExternalMemoryEnd = 0;
+
+void SetHostExternalMemory(const void *start, size_t size) {
+  kHostExternalMemoryStart = reinterpret_cast<uintptr_t>(start);
+  kHostExternalMemoryEnd = kHostExternalMemoryStart + size;
+}
+
+bool IsHostExternalAddress(uintptr_t a) {
+  return (a >= kHostExternalMemoryStart) && (a < kHostExternalMemoryEnd);
+}
+#endif
+
+// Returns the prefetched copy of src if there is one, otherwise src
+static inline int8_t const *resolve_source(int8_t const *src, size_t size) {
+  // the kernel tests run the ops without a dispatcher
+  if (!HasDispatcher()) return src;
+  return GetDispatcher()->ResolvePrefetched(src, size);
+}
+
+size_t FetchBufferUntimed(int8_t **dest, int8_t const *src, size_t size) {
+  src = resolve_source(src, size);
   if (is_ram_address((uintptr_t)src)) {
     *dest = (int8_t *)src;
     return 0;
@@ -85,6 +110,53 @@ size_t FetchBuffer(int8_t **dest, int8_t const *src, size_t size) {
   }
 }
 
+size_t FetchStridedBufferUntimed(int8_t *dest, int8_t const *src,
+                                 size_t block_size, size_t n_blocks,
+                                 size_t src_stride) {
+  // the blocks are always copied since the destination layout differs from
+  // the source layout
+  for (int k = 0; k < n_blocks; k++) {
+    memload((void *)dest, (void *)resolve_source(src, block_size), block_size);
+    dest = &(dest[block_size]);
+    src = &(src[src_stride]);
+  }
+  return block_size * n_blocks;
+}
+
+static int32_t kFetchTicks = 0;
+
+int32_t GetFetchTicks() { return kFetchTicks; }
+
+void ResetFetchTicks() { kFetchTicks = 0; }
+
+void AddFetchTicks(int32_t ticks) { kFetchTicks += ticks; }
+
+static size_t kFetchBytes = 0;
+
+size_t GetFetchBytes() { return kFetchBytes; }
+
+void ResetFetchBytes() { kFetchBytes = 0; }
+
+void AddFetchBytes(size_t bytes) { kFetchBytes += bytes; }
+
+size_t FetchBuffer(int8_t **dest, int8_t const *src, size_t size) {
+  int32_t start_ticks = tflite::GetCurrentTimeTicks();
+  size_t fetched = FetchBufferUntimed(dest, src, size);
+  AddFetchTicks(tflite::GetCurrentTimeTicks() - start_ticks);
+  AddFetchBytes(fetched);
+  return fetched;
+}
+
+size_t FetchStridedBuffer(int8_t *dest, int8_t const *src, size_t block_size,
+                          size_t n_blocks, size_t src_stride) {
+  int32_t start_ticks = tflite::GetCurrentTimeTicks();
+  size_t fetched =
+      FetchStridedBufferUntimed(dest, src, block_size, n_blocks, src_stride);
+  AddFetchTicks(tflite::GetCurrentTimeTicks() - start_ticks);
+  AddFetchBytes(fetched);
+  return fetched;
+}
+
 }  // namespace xcore
 }  // namespace micro
 }  // namespace ops
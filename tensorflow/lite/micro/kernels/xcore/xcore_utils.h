@@ -43,11 +43,21 @@ static inline T *construct_persistent_object(TfLiteContext *context) {
   return new (context->AllocatePersistentBuffer(context, sizeof(T))) T;
 }
 
+#ifndef XCORE
+/* On the host all memory is RAM, unless a range is marked as external memory
+ *  with SetHostExternalMemory. Constant tensors in the range are then fetched
+ *  as they would be from flash or DDR on the device, e.g. so that a benchmark
+ *  can measure the fetches. Pass size = 0 to clear.
+ */
+void SetHostExternalMemory(const void *start, size_t size);
+bool IsHostExternalAddress(uintptr_t a);
+#endif
+
 static inline bool is_ram_address(uintptr_t a) {
 #ifdef XCORE
   return ((a >= 0x80000) && (a <= 0x100000));
 #else
-  return true;
+  return !IsHostExternalAddress(a);
 #endif
 }
 
@@ -72,8 +82,54 @@ extern "C" {
 static inline void memload(void *dest, void *src, size_t size);
 }
 
+/* Fetch size bytes from src into *dest
+ *  If src is (or has a prefetched copy) in RAM, *dest is pointed at it instead
+ *
+ *  Returns the number of bytes copied
+ */
 size_t FetchBuffer(int8_t **dest, int8_t const *src, size_t size);
 
+/* Fetch n_blocks blocks of block_size bytes, read src_stride bytes apart, into
+ *  consecutive locations starting at dest
+ *
+ *  Returns the number of bytes copied
+ */
+size_t FetchStridedBuffer(int8_t *dest, int8_t const *src, size_t block_size,
+                          size_t n_blocks, size_t src_stride);
+
+/* As FetchBuffer and FetchStridedBuffer, but not counted in the fetch ticks
+ *  For fetches that overlap with compute, on the AsyncFetcher I/O thread.
+ */
+size_t FetchBufferUntimed(int8_t **dest, int8_t const *src, size_t size);
+size_t FetchStridedBufferUntimed(int8_t *dest, int8_t const *src,
+                                 size_t block_size, size_t n_blocks,
+                                 size_t src_stride);
+
+/* Ticks the inference thread spent fetching since the last ResetFetchTicks
+ *  FetchBuffer and FetchStridedBuffer add their time, AsyncFetcher adds the
+ *  time spent waiting for its fetches.
+ */
+int32_t GetFetchTicks();
+void ResetFetchTicks();
+void AddFetchTicks(int32_t ticks);
+
+/* Bytes copied from external memory since the last ResetFetchBytes
+ *  FetchBuffer and FetchStridedBuffer add their copies, AsyncFetcher adds the
+ *  copies of its I/O thread once they are waited for.
+ */
+size_t GetFetchBytes();
+void ResetFetchBytes();
+void AddFetchBytes(size_t bytes);
+
+/* A buffer in external memory that was fetched ahead of time into dest
+ *  Registered with Dispatcher::SetPrefetchedBuffers.
+ */
+typedef struct PrefetchedBuffer {
+  int8_t const *src;
+  size_t size;
+  int8_t *dest;
+} PrefetchedBuffer;
+
 template <typename T>
 static inline TfLiteStatus fetch_scratch_if_needed(
     TfLiteContext *context, T *&array, const TfLiteEvalTensor *tensor,
@@ -15,27 +15,186 @@ limitations under the License.
 
 #include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
 
+#include <climits>
+
 namespace tflite {
 
-// Simple stable in-place sort function. Not time-efficient for large arrays.
+namespace {
+
+// The values and ids sorted by ReverseSortInPlace(), in descending order of
+// value.
+struct ValuesAndIds {
+  int* values;
+  int* ids;
+
+  bool Before(int a, int b) const { return values[a] > values[b]; }
+
+  void Swap(int a, int b) const {
+    const int value_temp = values[a];
+    values[a] = values[b];
+    values[b] = value_temp;
+    const int id_temp = ids[a];
+    ids[a] = ids[b];
+    ids[b] = id_temp;
+  }
+};
+
+// Buffer ids, in ascending order of their offsets.
+struct IdsByOffset {
+  int* ids;
+  const int* offsets;
+
+  bool Before(int a, int b) const { return offsets[ids[a]] < offsets[ids[b]]; }
+
+  void Swap(int a, int b) const {
+    const int id_temp = ids[a];
+    ids[a] = ids[b];
+    ids[b] = id_temp;
+  }
+};
+
+// Moves the entries in [start, middle) to after the ones in [middle, end).
+template <typename Entries>
+void RotateEntries(const Entries& entries, int start, int middle, int end) {
+  int left = middle - start;
+  int right = end - middle;
+  while (left != right) {
+    if (left > right) {
+      for (int i = 0; i < right; ++i) {
+        entries.Swap(middle - left + i, middle + i);
+      }
+      left -= right;
+    } else {
+      for (int i = 0; i < left; ++i) {
+        entries.Swap(middle - left + i, middle + right - left + i);
+      }
+      right -= left;
+    }
+  }
+  for (int i = 0; i < left; ++i) {
+    entries.Swap(middle - left + i, middle + i);
+  }
+}
+
+// Stably merges the sorted runs [start, middle) and [middle, end) without any
+// extra memory, by rotating the entries that are out of place and then
+// merging the two halves. See "Stable Minimum Storage Merging by Symmetric
+// Comparisons", Kim and Kutzner. Each half is at most half as long, so the
+// merges still to do fit in a fixed size stack.
+template <typename Entries>
+void MergeInPlace(const Entries& entries, int start, int middle, int end) {
+  constexpr int kMaxPendingMerges = 32;
+  int pending[kMaxPendingMerges][3];
+  int pending_count = 0;
+  while (true) {
+    if ((start >= middle) || (middle >= end)) {
+      // Nothing to merge.
+    } else if ((middle - start) == 1) {
+      // Move the single entry on the left after the ones that sort before it.
+      int low = middle;
+      int high = end;
+      while (low < high) {
+        const int half = (low + high) / 2;
+        if (entries.Before(half, start)) {
+          low = half + 1;
+        } else {
+          high = half;
+        }
+      }
+      for (int i = start; i < (low - 1); ++i) {
+        entries.Swap(i, i + 1);
+      }
+    } else if ((end - middle) == 1) {
+      // Move the single entry on the right before the ones that sort after
+      // it.
+      int low = start;
+      int high = middle;
+      while (low < high) {
+        const int half = (low + high) / 2;
+        if (!entries.Before(middle, half)) {
+          low = half + 1;
+        } else {
+          high = half;
+        }
+      }
+      for (int i = middle; i > low; --i) {
+        entries.Swap(i, i - 1);
+      }
+    } else {
+      const int half = (start + end) / 2;
+      const int n = half + middle;
+      int low;
+      int high;
+      if (middle > half) {
+        low = n - end;
+        high = half;
+      } else {
+        low = start;
+        high = middle;
+      }
+      const int last = n - 1;
+      while (low < high) {
+        const int c = (low + high) / 2;
+        if (!entries.Before(last - c, c)) {
+          low = c + 1;
+        } else {
+          high = c;
+        }
+      }
+      const int rotate_end = n - low;
+      if ((low < middle) && (middle < rotate_end)) {
+        RotateEntries(entries, low, middle, rotate_end);
+      }
+      // Merge the first half now, and the second one after it.
+      pending[pending_count][0] = half;
+      pending[pending_count][1] = rotate_end;
+      pending[pending_count][2] = end;
+      ++pending_count;
+      middle = low;
+      end = half;
+      continue;
+    }
+    if (pending_count == 0) {
+      return;
+    }
+    --pending_count;
+    start = pending[pending_count][0];
+    middle = pending[pending_count][1];
+    end = pending[pending_count][2];
+  }
+}
+
+// Stable in-place sort. Short runs are insertion sorted, and then merged in
+// place, so this takes O(n log n) comparisons, O(n log^2 n) moves and no
+// extra memory.
+template <typename Entries>
+void SortInPlace(const Entries& entries, int size) {
+  constexpr int kRunSize = 16;
+  for (int run_start = 0; run_start < size; run_start += kRunSize) {
+    const int run_end =
+        ((run_start + kRunSize) < size) ? (run_start + kRunSize) : size;
+    for (int i = run_start + 1; i < run_end; ++i) {
+      for (int j = i; (j > run_start) && entries.Before(j, j - 1); --j) {
+        entries.Swap(j - 1, j);
+      }
+    }
+  }
+  for (int run_size = kRunSize; run_size < size; run_size *= 2) {
+    for (int start = 0; (start + run_size) < size; start += 2 * run_size) {
+      const int end =
+          ((start + 2 * run_size) < size) ? (start + 2 * run_size) : size;
+      MergeInPlace(entries, start, start + run_size, end);
+    }
+  }
+}
+
+}  // namespace
+
+// Stable in-place sort function, in descending order, see SortInPlace().
 // Would normally be in an anonymous namespace to keep it private, but we want
 // to be able to test it externally.
 void ReverseSortInPlace(int* values, int* ids, int size) {
-  bool any_swapped;
-  do {
-    any_swapped = false;
-    for (int i = 1; i < size; ++i) {
-      if (values[i - 1] < values[i]) {
-        const int value_temp = values[i - 1];
-        values[i - 1] = values[i];
-        values[i] = value_temp;
-        const int id_temp = ids[i - 1];
-        ids[i - 1] = ids[i];
-        ids[i] = id_temp;
-        any_swapped = true;
-      }
-    }
-  } while (any_swapped);
+  SortInPlace(ValuesAndIds{values, ids}, size);
 }
 
 GreedyMemoryPlanner::GreedyMemoryPlanner(unsigned char* scratch_buffer,
@@ -54,8 +213,14 @@ GreedyMemoryPlanner::GreedyMemoryPlanner(unsigned char* scratch_buffer,
   buffer_ids_sorted_ = reinterpret_cast<int*>(next_free);
   next_free += sizeof(int) * max_buffer_count_;
 
-  buffers_sorted_by_offset_ = reinterpret_cast<ListEntry*>(next_free);
-  next_free += sizeof(ListEntry) * max_buffer_count_;
+  buffer_ids_by_time_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  buffer_time_positions_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  time_index_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
 
   buffer_offsets_ = reinterpret_cast<int*>(next_free);
 }
@@ -94,47 +259,89 @@ TfLiteStatus GreedyMemoryPlanner::AddBuffer(
   return kTfLiteOk;
 }
 
-bool GreedyMemoryPlanner::DoesEntryOverlapInTime(
-    const GreedyMemoryPlanner::ListEntry* entry, const int first_time_used,
-    const int last_time_used) const {
-  const BufferRequirements* entry_requirements =
-      &requirements_[entry->requirements_index];
-  if (entry_requirements->first_time_used > last_time_used) {
-    return false;
+int GreedyMemoryPlanner::LatestTimeUsed(int node) const {
+  if (node < buffer_count_) {
+    return time_index_[node];
   }
-  if (first_time_used > entry_requirements->last_time_used) {
-    return false;
+  const int buffer_id = buffer_ids_by_time_[node - buffer_count_];
+  if (buffer_offsets_[buffer_id] == -1) {
+    // Not placed yet.
+    return INT_MIN;
+  }
+  return requirements_[buffer_id].last_time_used;
+}
+
+void GreedyMemoryPlanner::AddToTimeIndex(int buffer_id) {
+  int node = buffer_count_ + buffer_time_positions_[buffer_id];
+  for (node /= 2; node >= 1; node /= 2) {
+    const int left = LatestTimeUsed(2 * node);
+    const int right = LatestTimeUsed(2 * node + 1);
+    time_index_[node] = (left > right) ? left : right;
+  }
+}
+
+void GreedyMemoryPlanner::CollectActiveBuffers(int root,
+                                               const int first_time_used,
+                                               int* active_count) {
+  // Walk the nodes under root in order, skipping the ones where nothing
+  // placed is still in use at first_time_used.
+  int node = root;
+  while (true) {
+    if (LatestTimeUsed(node) >= first_time_used) {
+      if (node < buffer_count_) {
+        node = 2 * node;
+        continue;
+      }
+      active_ids_[(*active_count)++] =
+          buffer_ids_by_time_[node - buffer_count_];
+    }
+    // Go up past the right children, whose parents are done, and then over
+    // to the next right child.
+    while ((node != root) && (node & 1)) {
+      node /= 2;
+    }
+    if (node == root) {
+      return;
+    }
+    ++node;
   }
-  return true;
 }
 
-GreedyMemoryPlanner::ListEntry*
-GreedyMemoryPlanner::NextSimultaneouslyActiveBuffer(
-    const GreedyMemoryPlanner::ListEntry* start, const int first_time_used,
-    const int last_time_used) {
-  ListEntry* result = nullptr;
-  ListEntry* candidate_next_entry;
-  if (start == nullptr) {
-    candidate_next_entry = &buffers_sorted_by_offset_[first_entry_index_];
-  } else {
-    if (start->next_entry_index == -1) {
-      return nullptr;
+int GreedyMemoryPlanner::FindSimultaneouslyActiveBuffers(
+    const int first_time_used, const int last_time_used) {
+  // Only the buffers first used no later than last_time_used can be active,
+  // and they're at the start of buffer_ids_by_time_.
+  int low = 0;
+  int high = buffer_count_;
+  while (low < high) {
+    const int half = (low + high) / 2;
+    if (requirements_[buffer_ids_by_time_[half]].first_time_used <=
+        last_time_used) {
+      low = half + 1;
+    } else {
+      high = half;
     }
-    candidate_next_entry = &buffers_sorted_by_offset_[start->next_entry_index];
   }
-  do {
-    if (DoesEntryOverlapInTime(candidate_next_entry, first_time_used,
-                               last_time_used)) {
-      result = candidate_next_entry;
-      break;
+
+  // Visit the nodes of the tree that cover exactly those positions.
+  int active_count = 0;
+  int left = buffer_count_;
+  int right = buffer_count_ + low;
+  while (left < right) {
+    if (left & 1) {
+      CollectActiveBuffers(left++, first_time_used, &active_count);
     }
-    if (candidate_next_entry->next_entry_index == -1) {
-      break;
+    if (right & 1) {
+      CollectActiveBuffers(--right, first_time_used, &active_count);
     }
-    candidate_next_entry =
-        &buffers_sorted_by_offset_[candidate_next_entry->next_entry_index];
-  } while (true);
-  return result;
+    left /= 2;
+    right /= 2;
+  }
+
+  // Sort them by offset. The order of buffers with the same offset doesn't
+  // change which gap is found.
+  SortInPlace(IdsByOffset{active_ids_, buffer_offsets_}, active_count);
+  return active_count;
 }
 
 void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
@@ -143,6 +350,20 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
   }
   need_to_calculate_offsets_ = false;
 
+  // Index the buffers by when they're first used, so the ones active at the
+  // same time as a given buffer can be found quickly. Nothing is placed yet,
+  // so every node of the tree starts off below any time.
+  for (int i = 0; i < buffer_count_; ++i) {
+    buffer_sizes_sorted_[i] = -requirements_[i].first_time_used;
+    buffer_ids_by_time_[i] = i;
+  }
+  ReverseSortInPlace(buffer_sizes_sorted_, buffer_ids_by_time_, buffer_count_);
+  for (int i = 0; i < buffer_count_; ++i) {
+    buffer_time_positions_[buffer_ids_by_time_[i]] = i;
+    time_index_[i] = INT_MIN;
+    buffer_offsets_[i] = -1;
+  }
+
   // Start off by ordering the buffers in descending order of size.
   // This helps find a more compact layout. Intuitively, you can think
   // about putting the large buffers in place first, and then the
@@ -156,86 +377,55 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
       idx_from_tail--;
       buffer_sizes_sorted_[idx_from_tail] = requirements_[i].size;
       buffer_ids_sorted_[idx_from_tail] = i;
-      buffer_offsets_[i] = -1;
     } else {
       buffer_sizes_sorted_[idx_from_head] = requirements_[i].size;
       buffer_ids_sorted_[idx_from_head] = i;
-      buffer_offsets_[i] = requirements_[i].offline_offset;
       idx_from_head++;
     }
   }
 
-  // This sorting algorithm is naive, and may end up taking a very long time
-  // with hundreds of buffers. Do not sort the offline planned offsets.
+  // Do not sort the offline planned offsets.
   ReverseSortInPlace(&buffer_sizes_sorted_[idx_from_head],
                      &buffer_ids_sorted_[idx_from_head],
                      buffer_count_ - idx_from_head);
+  // The sizes aren't needed any more, so their memory holds the ids of the
+  // simultaneously active buffers from now on.
+  active_ids_ = buffer_sizes_sorted_;
 
-  // Initialize the first entry to the first buffer in
-  // buffer_ids_sorted_.
+  // Work through the buffers to find a good gap to place each one.
   //   - If there are no offline planned offsets, the largest buffer will be
   //     first, and the buffers will be handled in size order.
   //   - If offline offsets are present, these will be handled first in order
   //     for the greedy algorithm to utilized gaps in the offline plan.
-  first_entry_index_ = 0;
-  next_free_entry_ = 1;
-  ListEntry* first_entry = &buffers_sorted_by_offset_[first_entry_index_];
-  first_entry->next_entry_index = -1;  // to mark the entry as end of list
-  int buffer_id = buffer_ids_sorted_[0];
-  first_entry->requirements_index = buffer_id;
-  if (requirements_[buffer_id].offline_offset == kOnlinePlannedBuffer) {
-    buffer_offsets_[buffer_id] = 0;
-  }
-  first_entry->offset = buffer_offsets_[buffer_id];
-
-  // Work through the rest of the buffers to find a good gap to place each one.
-  for (int i = 1; i < buffer_count_; ++i) {
+  for (int i = 0; i < buffer_count_; ++i) {
     // The id is the order the buffer was originally added by the client.
-    buffer_id = buffer_ids_sorted_[i];
+    const int buffer_id = buffer_ids_sorted_[i];
     // Look at what size and time range the buffer needs to be active.
     BufferRequirements* wanted_requirements = &requirements_[buffer_id];
     const int wanted_size = wanted_requirements->size;
-    const int wanted_first_time_used = wanted_requirements->first_time_used;
-    const int wanted_last_time_used = wanted_requirements->last_time_used;
-
-    // Find the first buffer that's active in our time range. All placed
-    // buffers are stored in the order of their starting position in the arena
-    // so that it's easy to find the next buffer in memory, and so the gap.
-    // The candidate_entry variable holds the buffer that we're considering
-    // placing the current buffer after.
 
     int candidate_offset = 0;
-    // Loop through the offset-ordered list of buffers, looking for gaps.
     if (wanted_requirements->offline_offset == kOnlinePlannedBuffer) {
-      ListEntry* prior_entry = nullptr;
-      while (true) {
-        // Find out what the next active buffer is.
-        ListEntry* next_entry = NextSimultaneouslyActiveBuffer(
-            prior_entry, wanted_first_time_used, wanted_last_time_used);
-
-        if (prior_entry) {
-          BufferRequirements* candidate_requirements =
-              &requirements_[prior_entry->requirements_index];
-          const int prior_entry_offset =
-              prior_entry->offset + candidate_requirements->size;
-          if (prior_entry_offset > candidate_offset) {
-            candidate_offset = prior_entry_offset;
-          }
-        }
-        if (next_entry == nullptr) {
-          // We're at the end of the list, so we can always append the buffer
-          // here.
-          break;
-        }
+      // Loop through the buffers that are active in our time range, in offset
+      // order, looking for gaps.
+      const int active_count = FindSimultaneouslyActiveBuffers(
+          wanted_requirements->first_time_used,
+          wanted_requirements->last_time_used);
+      for (int n = 0; n < active_count; ++n) {
+        const int active_id = active_ids_[n];
         // Find out how much space there is between us and the next buffer.
-        const int gap = next_entry->offset - candidate_offset;
+        const int gap = buffer_offsets_[active_id] - candidate_offset;
         if (gap >= wanted_size) {
           // This entry has a big enough gap between it and the next, so
           // use it!
           break;
         }
-        // The gap wasn't big enough, so move on to another candidate.
-        prior_entry = next_entry;
+        // The gap wasn't big enough, so move on to after this buffer.
+        const int active_end =
+            buffer_offsets_[active_id] + requirements_[active_id].size;
+        if (active_end > candidate_offset) {
+          candidate_offset = active_end;
+        }
       }
     } else {
       // Offline planned offset are to be considered constant
@@ -246,44 +436,9 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
     // buffers in this time range and so we can put it at offset zero.
     // Record the buffer's offset in our plan.
     buffer_offsets_[buffer_id] = candidate_offset;
-    // Add the newly-placed buffer to our offset-ordered list, so that
-    // subsequent passes can fit in their buffers around it.
-    ListEntry* new_entry = &buffers_sorted_by_offset_[next_free_entry_];
-    new_entry->offset = candidate_offset;
-    new_entry->requirements_index = buffer_id;
-    const int new_entry_index = next_free_entry_;
-    ++next_free_entry_;
-
-    if (first_entry->offset > candidate_offset) {
-      // The new entry offset is smaller than the first entry offset =>
-      // replace the first entry
-      first_entry = new_entry;
-      first_entry->next_entry_index = first_entry_index_;
-      first_entry_index_ = new_entry_index;
-    } else {
-      ListEntry* current_entry = first_entry;
-      // Make sure that we insert the buffer at the correct place in the
-      // buffer-offset-ordered list
-      while (true) {
-        const int next_entry_index = current_entry->next_entry_index;
-        if (next_entry_index == -1) {
-          // We're at the end of the list, so just add the new entry here.
-          current_entry->next_entry_index = new_entry_index;
-          new_entry->next_entry_index = -1;
-          break;
-        }
-        // not at the end of the list -> take a look at next entry
-        ListEntry* next_entry = &buffers_sorted_by_offset_[next_entry_index];
-        if (next_entry->offset > candidate_offset) {
-          // We're at the right spot to do an insertion and retain the sorting
-          // order, so place the new entry here.
-          new_entry->next_entry_index = current_entry->next_entry_index;
-          current_entry->next_entry_index = new_entry_index;
-          break;
-        }
-        current_entry = next_entry;
-      }
-    }
+    // Add the newly-placed buffer to the time index, so that subsequent
+    // passes can fit in their buffers around it.
+    AddToTimeIndex(buffer_id);
   }
 }
 
@@ -292,21 +447,14 @@ size_t GreedyMemoryPlanner::GetMaximumMemorySize() {
   if (buffer_count_ == 0) {
     return 0;
   }
-  ListEntry* entry = &buffers_sorted_by_offset_[first_entry_index_];
   size_t max_size = 0;
-  while (entry) {
-    BufferRequirements* requirements =
-        &requirements_[entry->requirements_index];
+  for (int i = 0; i < buffer_count_; ++i) {
     // TODO(b/148246793): Update all size and offset variables types from
     //                    int to size_t
-    const size_t current_size = entry->offset + requirements->size;
+    const size_t current_size = buffer_offsets_[i] + requirements_[i].size;
     if (current_size > max_size) {
       max_size = current_size;
     }
-    if (entry->next_entry_index == -1) {
-      break;
-    }
-    entry = &buffers_sorted_by_offset_[entry->next_entry_index];
   }
   return max_size;
 }
@@ -34,7 +34,9 @@ constexpr int kOnlinePlannedBuffer = -1;
 //  - The buffers are sorted in descending order of size.
 //  - The largest buffer is placed at offset zero.
 //  - The rest of the buffers are looped through in descending size order.
-//  - The other buffers that need to be in memory at the same time are found.
+//  - The other buffers that need to be in memory at the same time are found,
+//    using an index of the placed buffers ordered by when they're first used,
+//    and sorted by offset.
 //  - The first gap between simultaneously active buffers that the current
 //    buffer fits into will be used.
 //  - If no large-enough gap is found, the current buffer is placed after the
@@ -43,6 +45,9 @@ constexpr int kOnlinePlannedBuffer = -1;
 //
 // This is not guaranteed to produce the best placement, since that's an
 // NP-Complete problem, but in practice it should produce one that's decent.
+// The buffers are sorted in O(n log^2 n) time, and each one then takes
+// O(log n) time plus the time to sort the k buffers active at the same time,
+// O(k log^2 k), so planning stays fast for graphs with thousands of buffers.
 class GreedyMemoryPlanner : public MemoryPlanner {
  public:
   // You need to pass in an area of memory to be used for planning. This memory
@@ -87,34 +92,37 @@ class GreedyMemoryPlanner : public MemoryPlanner {
   // is an O(N^2) complexity operation, so only use for testing.
   bool DoAnyBuffersOverlap(ErrorReporter* error_reporter);
 
-  // Used to store a list of buffers ordered by their offset.
-  struct ListEntry {
-    int offset;
-    int requirements_index;
-    int next_entry_index;
-  };
-
   // Number of bytes required in order to plan a buffer.
   static size_t per_buffer_size() {
     const int per_buffer_size =
         sizeof(BufferRequirements) +  // requirements_
-        sizeof(int) +                 // buffer_sizes_sorted_
+        sizeof(int) +                 // buffer_sizes_sorted_, active_ids_
         sizeof(int) +                 // buffer_ids_sorted_
-        sizeof(ListEntry) +           // buffers_sorted_by_offset_
-        sizeof(int);                  // buffer_offsets_;
+        sizeof(int) +                 // buffer_offsets_
+        sizeof(int) +                 // buffer_ids_by_time_
+        sizeof(int) +                 // buffer_time_positions_
+        sizeof(int);                  // time_index_
     return per_buffer_size;
   }
 
  private:
-  // Whether a buffer is active in a given time range.
-  bool DoesEntryOverlapInTime(const ListEntry* entry, const int first_time_used,
-                              const int last_time_used) const;
+  // Records that a buffer has been placed, so it's found by
+  // FindSimultaneouslyActiveBuffers().
+  void AddToTimeIndex(int buffer_id);
+
+  // Fills active_ids_ with the placed buffers that are active in a given time
+  // range, sorted by offset, and returns how many there are.
+  int FindSimultaneouslyActiveBuffers(const int first_time_used,
+                                      const int last_time_used);
 
-  // Walks the list to return the next buffer that is active in a given time
-  // range, or a null pointer if there are none.
-  ListEntry* NextSimultaneouslyActiveBuffer(const ListEntry* start,
-                                            const int first_time_used,
-                                            const int last_time_used);
+  // Adds the placed buffers under a node of the time index that are still
+  // active at first_time_used to active_ids_.
+  void CollectActiveBuffers(int root, const int first_time_used,
+                            int* active_count);
+
+  // The largest last_time_used of the placed buffers under a node of the time
+  // index, or INT_MIN if none are placed.
+  int LatestTimeUsed(int node) const;
 
   // If there isn't an up to date plan, calculate a new one.
   void CalculateOffsetsIfNeeded();
@@ -141,13 +149,21 @@ class GreedyMemoryPlanner : public MemoryPlanner {
   //     offline planned buffers,
   //     online planned buffers sorted by size
   //   }
+  // Once sorted, buffer_sizes_sorted_ is reused for active_ids_.
   int* buffer_sizes_sorted_;
   int* buffer_ids_sorted_;
-  ListEntry* buffers_sorted_by_offset_;
-  int next_free_entry_;    // Index of the next free entry of
-                           // buffers_sorted_by_offset_
-  int first_entry_index_;  // Index of the first entry (smallest offset) of
-                           // buffers_sorted_by_offset_
+
+  // The time index. Buffers are ordered by their first_time_used in
+  // buffer_ids_by_time_, and buffer_time_positions_ maps each buffer to its
+  // position in that order. time_index_ is a tree over those positions, that
+  // holds the largest last_time_used of the placed buffers below each node.
+  // Its leaves, from buffer_count_ on, aren't stored, see LatestTimeUsed().
+  int* buffer_ids_by_time_;
+  int* buffer_time_positions_;
+  int* time_index_;
+
+  // The simultaneously active buffers found for the buffer being placed.
+  int* active_ids_ = nullptr;
 
   // Stores the outcome of the plan, the location of each buffer in the arena.
   int* buffer_offsets_;
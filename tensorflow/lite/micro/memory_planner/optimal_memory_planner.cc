@@ -0,0 +1,296 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+
+namespace tflite {
+
+OptimalMemoryPlanner::OptimalMemoryPlanner(unsigned char* scratch_buffer,
+                                           int scratch_buffer_size,
+                                           int max_search_nodes)
+    : buffer_count_(0),
+      max_search_nodes_(max_search_nodes),
+      best_size_(0),
+      search_node_count_(0),
+      is_plan_optimal_(false),
+      need_to_calculate_offsets_(true) {
+  // Allocate the arrays we need within the scratch buffer arena.
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+  unsigned char* next_free = scratch_buffer;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+
+  buffer_ids_sorted_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  buffer_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  best_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  placed_index_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  next_choice_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  high_water_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  active_ids_ = reinterpret_cast<int*>(next_free);
+}
+
+OptimalMemoryPlanner::~OptimalMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus OptimalMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  current->offline_offset = kOnlinePlannedBuffer;
+  ++buffer_count_;
+  need_to_calculate_offsets_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus OptimalMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used, int offline_offset) {
+  BufferRequirements* current = &requirements_[buffer_count_];
+  if (AddBuffer(error_reporter, size, first_time_used, last_time_used) !=
+      kTfLiteOk) {
+    return kTfLiteError;
+  }
+  current->offline_offset = offline_offset;
+  return kTfLiteOk;
+}
+
+bool OptimalMemoryPlanner::DoBuffersOverlapInTime(int a, int b) const {
+  const BufferRequirements* a_requirements = &requirements_[a];
+  const BufferRequirements* b_requirements = &requirements_[b];
+  if (a_requirements->first_time_used > b_requirements->last_time_used) {
+    return false;
+  }
+  if (b_requirements->first_time_used > a_requirements->last_time_used) {
+    return false;
+  }
+  return true;
+}
+
+int OptimalMemoryPlanner::LowestFreeOffset(int buffer_id) {
+  // Gather the placed buffers that are active at the same time, in offset
+  // order.
+  int active_count = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    if ((i == buffer_id) || (buffer_offsets_[i] == -1) ||
+        !DoBuffersOverlapInTime(i, buffer_id)) {
+      continue;
+    }
+    int j = active_count++;
+    while ((j > 0) &&
+           (buffer_offsets_[active_ids_[j - 1]] > buffer_offsets_[i])) {
+      active_ids_[j] = active_ids_[j - 1];
+      --j;
+    }
+    active_ids_[j] = i;
+  }
+
+  // Then take the first gap that's large enough.
+  const int size = requirements_[buffer_id].size;
+  int candidate_offset = 0;
+  for (int i = 0; i < active_count; ++i) {
+    const int active_id = active_ids_[i];
+    const int active_offset = buffer_offsets_[active_id];
+    if ((candidate_offset + size) <= active_offset) {
+      break;
+    }
+    const int active_end = active_offset + requirements_[active_id].size;
+    if (active_end > candidate_offset) {
+      candidate_offset = active_end;
+    }
+  }
+  return candidate_offset;
+}
+
+void OptimalMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+  search_node_count_ = 0;
+
+  // Place the offline planned buffers, and sort the others by descending size.
+  // Buffers of equal size are taken in reverse order of being added, as in
+  // GreedyMemoryPlanner.
+  int online_count = 0;
+  int offline_high_water = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const BufferRequirements* current = &requirements_[i];
+    buffer_offsets_[i] = current->offline_offset;
+    if (current->offline_offset != kOnlinePlannedBuffer) {
+      const int end = current->offline_offset + current->size;
+      if (end > offline_high_water) {
+        offline_high_water = end;
+      }
+      continue;
+    }
+    int j = online_count++;
+    while ((j > 0) && (requirements_[buffer_ids_sorted_[j - 1]].size <=
+                       current->size)) {
+      buffer_ids_sorted_[j] = buffer_ids_sorted_[j - 1];
+      --j;
+    }
+    buffer_ids_sorted_[j] = i;
+  }
+
+  // No arena can be smaller than the buffers active at any one time, and the
+  // most buffers are active just as one of them starts being used.
+  int lower_bound = offline_high_water;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const int time = requirements_[i].first_time_used;
+    int active_size = 0;
+    for (int j = 0; j < buffer_count_; ++j) {
+      if ((requirements_[j].first_time_used <= time) &&
+          (requirements_[j].last_time_used >= time)) {
+        active_size += requirements_[j].size;
+      }
+    }
+    if (active_size > lower_bound) {
+      lower_bound = active_size;
+    }
+  }
+
+  for (int i = 0; i < buffer_count_; ++i) {
+    best_offsets_[i] = buffer_offsets_[i];
+  }
+  best_size_ = offline_high_water;
+  if (online_count == 0) {
+    is_plan_optimal_ = true;
+    return;
+  }
+  best_size_ = -1;
+  is_plan_optimal_ = true;
+
+  int depth = 0;
+  placed_index_[0] = -1;
+  next_choice_[0] = 0;
+  while (depth >= 0) {
+    // Take back whatever was placed at this depth on the last visit.
+    if (placed_index_[depth] != -1) {
+      buffer_offsets_[buffer_ids_sorted_[placed_index_[depth]]] = -1;
+      placed_index_[depth] = -1;
+    }
+    // Always finish the first, greedy, plan before checking the budget.
+    if ((best_size_ != -1) && (search_node_count_ >= max_search_nodes_)) {
+      is_plan_optimal_ = false;
+      break;
+    }
+
+    // Choose the next buffer to place at this depth. If the previous buffer
+    // isn't active at the same time as this one, swapping the two gives the
+    // same plan, so only the order that follows buffer_ids_sorted_ is tried.
+    const int previous_index = (depth > 0) ? placed_index_[depth - 1] : -1;
+    int choice = next_choice_[depth];
+    for (; choice < online_count; ++choice) {
+      const int buffer_id = buffer_ids_sorted_[choice];
+      if (buffer_offsets_[buffer_id] != -1) {
+        continue;
+      }
+      if ((choice < previous_index) &&
+          !DoBuffersOverlapInTime(buffer_id,
+                                  buffer_ids_sorted_[previous_index])) {
+        continue;
+      }
+      break;
+    }
+    if (choice == online_count) {
+      --depth;
+      continue;
+    }
+    next_choice_[depth] = choice + 1;
+    ++search_node_count_;
+
+    const int buffer_id = buffer_ids_sorted_[choice];
+    const int offset = LowestFreeOffset(buffer_id);
+    const int previous_high_water =
+        (depth > 0) ? high_water_[depth - 1] : offline_high_water;
+    const int end = offset + requirements_[buffer_id].size;
+    const int high_water =
+        (end > previous_high_water) ? end : previous_high_water;
+    if ((best_size_ != -1) && (high_water >= best_size_)) {
+      continue;
+    }
+    buffer_offsets_[buffer_id] = offset;
+    placed_index_[depth] = choice;
+    high_water_[depth] = high_water;
+
+    if (depth == (online_count - 1)) {
+      for (int i = 0; i < buffer_count_; ++i) {
+        best_offsets_[i] = buffer_offsets_[i];
+      }
+      best_size_ = high_water;
+      if (best_size_ <= lower_bound) {
+        break;
+      }
+      continue;
+    }
+    ++depth;
+    placed_index_[depth] = -1;
+    next_choice_[depth] = 0;
+  }
+}
+
+size_t OptimalMemoryPlanner::GetMaximumMemorySize() {
+  CalculateOffsetsIfNeeded();
+  return best_size_;
+}
+
+int OptimalMemoryPlanner::GetBufferCount() { return buffer_count_; }
+
+TfLiteStatus OptimalMemoryPlanner::GetOffsetForBuffer(
+    tflite::ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  CalculateOffsetsIfNeeded();
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  *offset = best_offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+bool OptimalMemoryPlanner::IsPlanOptimal() {
+  CalculateOffsetsIfNeeded();
+  return is_plan_optimal_;
+}
+
+int OptimalMemoryPlanner::GetSearchNodeCount() {
+  CalculateOffsetsIfNeeded();
+  return search_node_count_;
+}
+
+}  // namespace tflite
@@ -0,0 +1,164 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+
+namespace tflite {
+
+// A memory planner that searches for the smallest arena that can hold the
+// buffers, using a bounded branch and bound search.
+//
+// It is much slower than GreedyMemoryPlanner, so it's meant to be run offline
+// on the host, with the result stored in the model's OfflineMemoryAllocation
+// metadata (see micro_allocator.cc) so that devices get the tighter arena with
+// no runtime cost.
+//
+// The algorithm works like this:
+//  - Every arrangement of the buffers can be compacted into one where each
+//    buffer sits at the lowest offset that's free of the simultaneously active
+//    buffers placed before it, for some order of placement. So the search
+//    only needs to explore placement orders, not offsets.
+//  - Offline planned buffers are placed first, at their given offsets.
+//  - The first order tried is descending size, which gives the same plan as
+//    GreedyMemoryPlanner, so the result is never worse than the greedy one.
+//  - Any partial plan whose high-water mark already reaches the best complete
+//    plan found so far is abandoned.
+//  - Two consecutive buffers that aren't active at the same time are only
+//    placed in one of their two orders, since both give the same plan.
+//  - The search stops when it has visited max_search_nodes partial plans, or
+//    when a plan matches the lower bound given by the largest total size of
+//    the buffers active at any one time.
+//
+// If the search space is exhausted within the budget the plan is optimal,
+// which IsPlanOptimal() reports. Otherwise it's the best one found.
+class OptimalMemoryPlanner : public MemoryPlanner {
+ public:
+  // Enough for graphs of a few dozen buffers to be solved exactly in a second
+  // or so on a desktop machine.
+  static constexpr int kDefaultMaxSearchNodes = 1000000;
+
+  // The scratch buffer is used in the same way as GreedyMemoryPlanner's, but
+  // each buffer requires about 44 bytes of it.
+  OptimalMemoryPlanner(unsigned char* scratch_buffer, int scratch_buffer_size,
+                       int max_search_nodes = kDefaultMaxSearchNodes);
+  ~OptimalMemoryPlanner() override;
+
+  // Record details of a buffer we want to place.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+
+  // Record details of an offline planned buffer offset we want to place.
+  // offline_offset is the buffer offset from the start of the arena.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int offline_offset);
+
+  // Returns the high-water mark of used memory. This is the minimum size of a
+  // memory arena you'd need to allocate to hold these buffers.
+  size_t GetMaximumMemorySize() override;
+
+  // How many buffers have been recorded.
+  int GetBufferCount() override;
+
+  // Where a given buffer should be placed in the memory arena.
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+
+  // Whether the search completed, so no smaller arena exists for the buffers.
+  bool IsPlanOptimal();
+
+  // How many partial plans the search visited.
+  int GetSearchNodeCount();
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() {
+    const int per_buffer_size =
+        sizeof(BufferRequirements) +  // requirements_
+        sizeof(int) +                 // buffer_ids_sorted_
+        sizeof(int) +                 // buffer_offsets_
+        sizeof(int) +                 // best_offsets_
+        sizeof(int) +                 // placed_index_
+        sizeof(int) +                 // next_choice_
+        sizeof(int) +                 // high_water_
+        sizeof(int);                  // active_ids_
+    return per_buffer_size;
+  }
+
+ private:
+  // Whether two buffers are active at the same time.
+  bool DoBuffersOverlapInTime(int a, int b) const;
+
+  // The lowest offset the buffer fits at, given the buffers placed so far.
+  int LowestFreeOffset(int buffer_id);
+
+  // If there isn't an up to date plan, calculate a new one.
+  void CalculateOffsetsIfNeeded();
+
+  // How many buffers we can plan for, based on the arena size we're given in
+  // the constructor.
+  int max_buffer_count_;
+
+  // The number of buffers added so far.
+  int buffer_count_;
+
+  // The budget for the search, in partial plans visited.
+  int max_search_nodes_;
+
+  // Records the client-provided information about each buffer.
+  struct BufferRequirements {
+    int size;
+    int offline_offset;
+    int first_time_used;
+    int last_time_used;
+  };
+  BufferRequirements* requirements_;
+
+  // Online planned buffers, sorted by descending size.
+  int* buffer_ids_sorted_;
+
+  // The partial plan being explored, with -1 for buffers not yet placed.
+  int* buffer_offsets_;
+
+  // The best complete plan found so far.
+  int* best_offsets_;
+  int best_size_;
+
+  // The search stack, one entry per online buffer placed. placed_index_ and
+  // next_choice_ index into buffer_ids_sorted_.
+  int* placed_index_;
+  int* next_choice_;
+  int* high_water_;
+
+  // Working list of the placed buffers that overlap in time with the one
+  // being placed, sorted by offset.
+  int* active_ids_;
+
+  int search_node_count_;
+  bool is_plan_optimal_;
+
+  // Whether buffers have been added since the last plan was calculated.
+  bool need_to_calculate_offsets_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
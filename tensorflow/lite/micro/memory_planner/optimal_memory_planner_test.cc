@@ -0,0 +1,147 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+constexpr int kScratchBufferSize = 4096;
+unsigned char g_scratch_buffer[kScratchBufferSize];
+unsigned char g_greedy_scratch_buffer[kScratchBufferSize];
+
+// A case where placing the largest buffers first leaves a gap that the rest
+// can't use.
+constexpr int kBufferCount = 5;
+const int kSizes[kBufferCount] = {3, 4, 10, 9, 4};
+const int kFirstTimesUsed[kBufferCount] = {2, 1, 0, 5, 4};
+const int kLastTimesUsed[kBufferCount] = {4, 4, 2, 8, 7};
+
+bool DoAnyBuffersOverlap(tflite::MemoryPlanner* planner, const int* sizes,
+                         const int* first_times_used,
+                         const int* last_times_used, int count) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  for (int i = 0; i < count; ++i) {
+    int a_offset;
+    planner->GetOffsetForBuffer(&micro_error_reporter, i, &a_offset);
+    for (int j = 0; j < i; ++j) {
+      int b_offset;
+      planner->GetOffsetForBuffer(&micro_error_reporter, j, &b_offset);
+      if ((first_times_used[i] > last_times_used[j]) ||
+          (first_times_used[j] > last_times_used[i])) {
+        continue;
+      }
+      if ((a_offset < (b_offset + sizes[j])) &&
+          (b_offset < (a_offset + sizes[i]))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestBeatsGreedy) {
+  tflite::MicroErrorReporter micro_error_reporter;
+
+  tflite::OptimalMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize);
+  tflite::GreedyMemoryPlanner greedy_planner(g_greedy_scratch_buffer,
+                                             kScratchBufferSize);
+  for (int i = 0; i < kBufferCount; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk,
+        planner.AddBuffer(&micro_error_reporter, kSizes[i], kFirstTimesUsed[i],
+                          kLastTimesUsed[i]));
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk, greedy_planner.AddBuffer(&micro_error_reporter, kSizes[i],
+                                            kFirstTimesUsed[i],
+                                            kLastTimesUsed[i]));
+  }
+
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(20),
+                          greedy_planner.GetMaximumMemorySize());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(17),
+                          planner.GetMaximumMemorySize());
+  TF_LITE_MICRO_EXPECT(planner.IsPlanOptimal());
+  TF_LITE_MICRO_EXPECT(!DoAnyBuffersOverlap(&planner, kSizes, kFirstTimesUsed,
+                                            kLastTimesUsed, kBufferCount));
+}
+
+TF_LITE_MICRO_TEST(TestSearchBudget) {
+  tflite::MicroErrorReporter micro_error_reporter;
+
+  // With no budget the greedy plan is returned.
+  tflite::OptimalMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize,
+                                       0);
+  for (int i = 0; i < kBufferCount; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk,
+        planner.AddBuffer(&micro_error_reporter, kSizes[i], kFirstTimesUsed[i],
+                          kLastTimesUsed[i]));
+  }
+
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(20),
+                          planner.GetMaximumMemorySize());
+  TF_LITE_MICRO_EXPECT(!planner.IsPlanOptimal());
+  TF_LITE_MICRO_EXPECT_EQ(kBufferCount, planner.GetSearchNodeCount());
+  TF_LITE_MICRO_EXPECT(!DoAnyBuffersOverlap(&planner, kSizes, kFirstTimesUsed,
+                                            kLastTimesUsed, kBufferCount));
+}
+
+TF_LITE_MICRO_TEST(TestOfflinePlannedBuffers) {
+  tflite::MicroErrorReporter micro_error_reporter;
+
+  tflite::OptimalMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize);
+  const int sizes[] = {10, 20, 10};
+  const int first_times_used[] = {0, 0, 1};
+  const int last_times_used[] = {1, 1, 2};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(&micro_error_reporter, sizes[0],
+                                   first_times_used[0], last_times_used[0],
+                                   /*offline_offset=*/20));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(&micro_error_reporter, sizes[1],
+                                   first_times_used[1], last_times_used[1]));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(&micro_error_reporter, sizes[2],
+                                   first_times_used[2], last_times_used[2]));
+
+  int offset = -1;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 0, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(20, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 1, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 2, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(30, offset);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(40),
+                          planner.GetMaximumMemorySize());
+  TF_LITE_MICRO_EXPECT(planner.IsPlanOptimal());
+}
+
+TF_LITE_MICRO_TEST(TestNoBuffers) {
+  tflite::OptimalMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0),
+                          planner.GetMaximumMemorySize());
+  TF_LITE_MICRO_EXPECT(planner.IsPlanOptimal());
+}
+
+TF_LITE_MICRO_TESTS_END
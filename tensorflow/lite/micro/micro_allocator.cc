@@ -46,6 +46,9 @@ constexpr size_t kMaxScratchBuffersPerOp = 12;
 // needs a node id assignment.
 constexpr int kUnassignedScratchBufferRequestIndex = -1;
 
+// Used as the node of scratch buffer requests that span the whole model.
+constexpr int kModelScratchBufferRequestIndex = -2;
+
 // Used to hold information used during allocation calculations.
 struct AllocationInfo {
   size_t bytes;
@@ -54,8 +57,13 @@ struct AllocationInfo {
   int last_used;
   int32_t offline_offset;
   bool needs_allocating;
+  // Index of the buffer this one shares memory with, or kNotInPlace.
+  int in_place_of;
 };
 
+// Sentinel value used to mark a buffer that has memory of its own.
+constexpr int kNotInPlace = -1;
+
 // We align tensor buffers to 16-byte boundaries, since this is a common
 // requirement for SIMD extensions.
 constexpr int kBufferAlignment = 16;
@@ -81,6 +89,52 @@ class MicroBuiltinDataAllocator : public BuiltinDataAllocator {
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
+// Finds the subgraph that holds a tensor of the model, and turns the index of
+// the tensor into its index in that subgraph.
+const SubGraph* GetTensorSubgraph(const Model* model, int* tensor_index) {
+  const auto* subgraphs = model->subgraphs();
+  for (size_t i = 0; i < subgraphs->size(); ++i) {
+    const SubGraph* subgraph = subgraphs->Get(i);
+    const int tensor_count = subgraph->tensors()->size();
+    if (*tensor_index < tensor_count) {
+      return subgraph;
+    }
+    *tensor_index -= tensor_count;
+  }
+  return nullptr;
+}
+
+// Fills in the subgraphs that an IF or WHILE operator calls, and returns how
+// many there are.
+int GetCalledSubgraphs(const Model* model, const Operator* op, int* called) {
+  const auto* opcodes = model->operator_codes();
+  if (op->opcode_index() >= opcodes->size()) {
+    return 0;
+  }
+  switch (GetBuiltinCode(opcodes->Get(op->opcode_index()))) {
+    case BuiltinOperator_IF: {
+      const IfOptions* options = op->builtin_options_as_IfOptions();
+      if (options == nullptr) {
+        return 0;
+      }
+      called[0] = options->then_subgraph_index();
+      called[1] = options->else_subgraph_index();
+      return (called[0] == called[1]) ? 1 : 2;
+    }
+    case BuiltinOperator_WHILE: {
+      const WhileOptions* options = op->builtin_options_as_WhileOptions();
+      if (options == nullptr) {
+        return 0;
+      }
+      called[0] = options->cond_subgraph_index();
+      called[1] = options->body_subgraph_index();
+      return (called[0] == called[1]) ? 1 : 2;
+    }
+    default:
+      return 0;
+  }
+}
+
 #if !defined(__clang__)
 // Helper function to check flatbuffer metadata correctness. This function is
 // not called by default. Hence it's not linked in to the final binary code.
@@ -167,9 +221,14 @@ class AllocationInfoBuilder {
   TfLiteStatus GetOfflinePlannedOffsets(
       const Model* model, const int32_t** offline_planner_offsets);
 
+  // Works out when each node of the model runs in the plan. The nodes of a
+  // subgraph run one after another, and an IF or WHILE node runs for as long
+  // as the subgraphs it calls, whose nodes are laid out inside it. `times`
+  // must hold two ints for each node and each subgraph of the model.
+  TfLiteStatus AddNodeTimes(const Model* model, int* times);
+
   // Add allocaiton information for the tensors.
-  TfLiteStatus AddTensors(const SubGraph* subgraph,
-                          const int32_t* offline_offsets,
+  TfLiteStatus AddTensors(const Model* model, const int32_t* offline_offsets,
                           TfLiteEvalTensor* eval_tensors);
 
   // Add allocation information for the scratch buffers.
@@ -177,22 +236,139 @@ class AllocationInfoBuilder {
       internal::ScratchBufferRequest* scratch_buffer_requests,
       ScratchBufferHandle* scratch_buffer_handles);
 
+  // Applies the size and lifetime of tensor plan requests.
+  TfLiteStatus AddTensorPlans(const internal::TensorPlanRequest* requests);
+
+  // Puts the outputs of in-place requests into the buffers of their inputs,
+  // extending the lifetime of those buffers to cover the outputs. Requests
+  // that can't be honoured are skipped.
+  void AddInPlaceOutputs(const internal::InPlaceOutputRequest* requests);
+
   // Returns a pointer to the built AllocationInfo array.
   const AllocationInfo* Finish() const { return info_; }
 
  private:
+  // Lays out the nodes of a subgraph from `*time` on, and moves `*time` past
+  // them.
+  TfLiteStatus LayOutSubgraph(const Model* model, int subgraph_index,
+                              int* time);
+
   AllocationInfo* info_ = nullptr;
   size_t tensor_count_ = 0;
   size_t buffer_count_ = 0;
   ErrorReporter* reporter_ = nullptr;
+
+  // The first and last time each node and subgraph of the model runs.
+  int node_count_ = 0;
+  int subgraph_count_ = 0;
+  int* node_first_ = nullptr;
+  int* node_last_ = nullptr;
+  int* subgraph_first_ = nullptr;
+  int* subgraph_last_ = nullptr;
+  // The number of times at which the nodes run.
+  int time_count_ = 0;
 };
 
-TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
+TfLiteStatus AllocationInfoBuilder::AddNodeTimes(const Model* model,
+                                                 int* times) {
+  subgraph_count_ = model->subgraphs()->size();
+  node_count_ = SubgraphNodeOffset(model, subgraph_count_);
+  node_first_ = times;
+  node_last_ = node_first_ + node_count_;
+  subgraph_first_ = node_last_ + node_count_;
+  subgraph_last_ = subgraph_first_ + subgraph_count_;
+  for (int i = 0; i < subgraph_count_; ++i) {
+    subgraph_first_[i] = -1;
+    subgraph_last_[i] = -1;
+  }
+
+  // Mark the subgraphs that are called by a node, and so are laid out inside
+  // it. The first subgraph, and any that aren't called, run on their own.
+  constexpr int kCalled = -2;
+  for (int i = 0; i < subgraph_count_; ++i) {
+    const SubGraph* subgraph = model->subgraphs()->Get(i);
+    for (size_t n = 0; n < subgraph->operators()->size(); ++n) {
+      int called[2];
+      const int called_count =
+          GetCalledSubgraphs(model, subgraph->operators()->Get(n), called);
+      for (int c = 0; c < called_count; ++c) {
+        if ((called[c] >= 0) && (called[c] < subgraph_count_)) {
+          subgraph_last_[called[c]] = kCalled;
+        }
+      }
+    }
+  }
+
+  int time = 0;
+  for (int i = 0; i < subgraph_count_; ++i) {
+    if ((i == 0) || (subgraph_last_[i] != kCalled)) {
+      subgraph_first_[i] = time;
+      TF_LITE_ENSURE_STATUS(LayOutSubgraph(model, i, &time));
+      subgraph_last_[i] = time - 1;
+    }
+  }
+  time_count_ = time;
+
+  for (int i = 0; i < subgraph_count_; ++i) {
+    if (subgraph_first_[i] == -1) {
+      TF_LITE_REPORT_ERROR(reporter_,
+                           "Subgraph %d is only called by the subgraphs it "
+                           "calls",
+                           i);
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus AllocationInfoBuilder::LayOutSubgraph(const Model* model,
+                                                   int subgraph_index,
+                                                   int* time) {
+  const SubGraph* subgraph = model->subgraphs()->Get(subgraph_index);
+  const int node_offset = SubgraphNodeOffset(model, subgraph_index);
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const int node_index = node_offset + i;
+    node_first_[node_index] = (*time)++;
+
+    int called[2];
+    const int called_count =
+        GetCalledSubgraphs(model, subgraph->operators()->Get(i), called);
+    for (int c = 0; c < called_count; ++c) {
+      const int callee = called[c];
+      if ((callee < 0) || (callee >= subgraph_count_)) {
+        TF_LITE_REPORT_ERROR(reporter_, "Node %d calls invalid subgraph %d",
+                             node_index, callee);
+        return kTfLiteError;
+      }
+      // A subgraph's tensors are planned for the one node that calls it.
+      if (subgraph_first_[callee] != -1) {
+        TF_LITE_REPORT_ERROR(reporter_,
+                             "Subgraph %d is called by more than one node, or "
+                             "by itself",
+                             callee);
+        return kTfLiteError;
+      }
+      subgraph_first_[callee] = node_first_[node_index];
+      TF_LITE_ENSURE_STATUS(LayOutSubgraph(model, callee, time));
+    }
+
+    node_last_[node_index] = *time - 1;
+    for (int c = 0; c < called_count; ++c) {
+      subgraph_last_[called[c]] = node_last_[node_index];
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus AllocationInfoBuilder::AddTensors(const Model* model,
                                                const int32_t* offline_offsets,
                                                TfLiteEvalTensor* eval_tensors) {
   TFLITE_DCHECK(eval_tensors != nullptr);
+  TFLITE_DCHECK(node_first_ != nullptr);
 
-  // Set up allocation info for all tensors.
+  // Set up allocation info for all tensors. Offline offsets only cover the
+  // tensors of the first subgraph.
+  const size_t offline_count = model->subgraphs()->Get(0)->tensors()->size();
   for (size_t i = 0; i < tensor_count_; ++i) {
     AllocationInfo* current = &info_[i];
     current->output_ptr = &(eval_tensors[i].data.data);
@@ -200,45 +376,71 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     TF_LITE_ENSURE_STATUS(
         TfLiteEvalTensorByteLength(&eval_tensors[i], &current->bytes));
 
+    int tensor_index = i;
+    const SubGraph* subgraph = GetTensorSubgraph(model, &tensor_index);
     current->first_created = -1;
     current->last_used = -1;
-    current->needs_allocating = (eval_tensors[i].data.data == nullptr) &&
-                                (!subgraph->tensors()->Get(i)->is_variable());
-    if (offline_offsets) {
+    current->needs_allocating =
+        (eval_tensors[i].data.data == nullptr) &&
+        (!subgraph->tensors()->Get(tensor_index)->is_variable());
+    current->in_place_of = kNotInPlace;
+    if (offline_offsets && (i < offline_count)) {
       current->offline_offset = offline_offsets[i];
     } else {
       current->offline_offset = kOnlinePlannedBuffer;
     }
   }
 
-  for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
-    const int tensor_index = subgraph->inputs()->Get(i);
-    AllocationInfo* current = &info_[tensor_index];
-    current->first_created = 0;
-  }
-
-  // Mark all outputs as persistent to the end of the invocation.
-  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
-    const int tensor_index = subgraph->outputs()->Get(i);
-    AllocationInfo* current = &info_[tensor_index];
-    current->last_used = subgraph->operators()->size() - 1;
-  }
-
-  // Figure out when the first and last use of each tensor is.
-  for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
-    const auto* op = subgraph->operators()->Get(i);
-    for (size_t n = 0; n < op->inputs()->size(); ++n) {
-      const int tensor_index = op->inputs()->Get(n);
+  for (int s = 0; s < subgraph_count_; ++s) {
+    const SubGraph* subgraph = model->subgraphs()->Get(s);
+    const int tensor_offset = SubgraphTensorOffset(model, s);
+    const int node_offset = SubgraphNodeOffset(model, s);
+
+    // The inputs and outputs of other subgraphs are kept for the whole run of
+    // the node that calls them, as WHILE feeds the outputs of its body back
+    // into its inputs.
+    const bool is_main = (s == 0);
+    for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
+      const int tensor_index = tensor_offset + subgraph->inputs()->Get(i);
       AllocationInfo* current = &info_[tensor_index];
-      if (((current->last_used == -1) || (current->last_used < i))) {
-        current->last_used = i;
+      current->first_created = subgraph_first_[s];
+      if (!is_main) {
+        current->last_used = subgraph_last_[s];
       }
     }
-    for (size_t n = 0; n < op->outputs()->size(); ++n) {
-      const int tensor_index = op->outputs()->Get(n);
+
+    // Mark all outputs as persistent to the end of the invocation.
+    for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+      const int tensor_index = tensor_offset + subgraph->outputs()->Get(i);
       AllocationInfo* current = &info_[tensor_index];
-      if ((current->first_created == -1) || (current->first_created > i)) {
-        current->first_created = i;
+      if (!is_main) {
+        current->first_created = subgraph_first_[s];
+      }
+      current->last_used = subgraph_last_[s];
+    }
+
+    // Figure out when the first and last use of each tensor is.
+    for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
+      const auto* op = subgraph->operators()->Get(i);
+      const int first = node_first_[node_offset + i];
+      const int last = node_last_[node_offset + i];
+      for (size_t n = 0; n < op->inputs()->size(); ++n) {
+        if (op->inputs()->Get(n) < 0) {
+          continue;
+        }
+        const int tensor_index = tensor_offset + op->inputs()->Get(n);
+        AllocationInfo* current = &info_[tensor_index];
+        if (((current->last_used == -1) || (current->last_used < last))) {
+          current->last_used = last;
+        }
+      }
+      for (size_t n = 0; n < op->outputs()->size(); ++n) {
+        const int tensor_index = tensor_offset + op->outputs()->Get(n);
+        AllocationInfo* current = &info_[tensor_index];
+        if ((current->first_created == -1) ||
+            (current->first_created > first)) {
+          current->first_created = first;
+        }
       }
     }
   }
@@ -300,11 +502,14 @@ TfLiteStatus AllocationInfoBuilder::GetOfflinePlannedOffsets(
         *offline_planner_offsets =
             reinterpret_cast<const int32_t*>(&metadata_buffer[3]);
 
-        if (tensor_count_ != nbr_tensors) {
+        // The offsets are for the tensors of the first subgraph.
+        const size_t subgraph_tensor_count =
+            model->subgraphs()->Get(0)->tensors()->size();
+        if (subgraph_tensor_count != nbr_tensors) {
           TF_LITE_REPORT_ERROR(reporter_,
                                "Nbr of offline buffer offsets (%d) in metadata "
                                "not equal nbr tensors (%d)\n",
-                               nbr_tensors, tensor_count_);
+                               nbr_tensors, subgraph_tensor_count);
           return kTfLiteError;
         }
       }
@@ -326,14 +531,108 @@ TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     AllocationInfo* current = &info_[i];
     current->output_ptr = reinterpret_cast<void**>(&current_handle->data);
     current->bytes = current_request->bytes;
-    current->first_created = current_request->node_idx;
-    current->last_used = current_request->node_idx;
+    if (current_request->node_idx == kModelScratchBufferRequestIndex) {
+      current->first_created = 0;
+      current->last_used = time_count_ - 1;
+    } else {
+      current->first_created = node_first_[current_request->node_idx];
+      current->last_used = node_last_[current_request->node_idx];
+    }
     current->offline_offset = kOnlinePlannedBuffer;
     current->needs_allocating = true;
+    current->in_place_of = kNotInPlace;
   }
   return kTfLiteOk;
 }
 
+TfLiteStatus AllocationInfoBuilder::AddTensorPlans(
+    const internal::TensorPlanRequest* requests) {
+  for (const internal::TensorPlanRequest* request = requests;
+       request != nullptr; request = request->next) {
+    if ((request->tensor_idx < 0) ||
+        (static_cast<size_t>(request->tensor_idx) >= tensor_count_)) {
+      TF_LITE_REPORT_ERROR(reporter_, "Tensor plan for invalid tensor %d",
+                           request->tensor_idx);
+      return kTfLiteError;
+    }
+    if ((request->first_used < 0) ||
+        (request->first_used > request->last_used) ||
+        (request->last_used >= node_count_)) {
+      TF_LITE_REPORT_ERROR(reporter_,
+                           "Tensor plan for tensor %d has invalid nodes %d to "
+                           "%d",
+                           request->tensor_idx, request->first_used,
+                           request->last_used);
+      return kTfLiteError;
+    }
+    AllocationInfo* current = &info_[request->tensor_idx];
+    if (current->offline_offset != kOnlinePlannedBuffer) {
+      TF_LITE_REPORT_ERROR(reporter_,
+                           "Tensor plan for offline planned tensor %d",
+                           request->tensor_idx);
+      return kTfLiteError;
+    }
+    if (request->bytes != 0) {
+      current->bytes = request->bytes;
+    }
+    const int first = node_first_[request->first_used];
+    const int last = node_last_[request->last_used];
+    if ((current->first_created == -1) || (current->first_created > first)) {
+      current->first_created = first;
+    }
+    if ((current->last_used == -1) || (current->last_used < last)) {
+      current->last_used = last;
+    }
+  }
+  return kTfLiteOk;
+}
+
+void AllocationInfoBuilder::AddInPlaceOutputs(
+    const internal::InPlaceOutputRequest* requests) {
+  for (const internal::InPlaceOutputRequest* request = requests;
+       request != nullptr; request = request->next) {
+    if ((request->input_tensor_idx < 0) ||
+        (static_cast<size_t>(request->input_tensor_idx) >= tensor_count_) ||
+        (request->output_tensor_idx < 0) ||
+        (static_cast<size_t>(request->output_tensor_idx) >= tensor_count_)) {
+      continue;
+    }
+    // Requests are made in node order, so an input that is itself in place
+    // already points at the buffer that owns the memory.
+    int root_index = request->input_tensor_idx;
+    if (info_[root_index].in_place_of != kNotInPlace) {
+      root_index = info_[root_index].in_place_of;
+    }
+    AllocationInfo* root = &info_[root_index];
+    AllocationInfo* output = &info_[request->output_tensor_idx];
+    if ((root == output) || !root->needs_allocating ||
+        !output->needs_allocating ||
+        (root->offline_offset != kOnlinePlannedBuffer) ||
+        (output->offline_offset != kOnlinePlannedBuffer) ||
+        (output->bytes > root->bytes)) {
+      continue;
+    }
+    // Outputs that already own memory for others keep it.
+    bool is_root = false;
+    for (size_t i = 0; i < tensor_count_; ++i) {
+      if (info_[i].in_place_of == request->output_tensor_idx) {
+        is_root = true;
+        break;
+      }
+    }
+    if (is_root) {
+      continue;
+    }
+    // The output is created by an operator reading the input, so only the end
+    // of the shared lifetime can move.
+    if (output->last_used > root->last_used) {
+      root->last_used = output->last_used;
+    }
+    output->needs_allocating = false;
+    output->in_place_of = root_index;
+  }
+}
+
 TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
                         GreedyMemoryPlanner* planner,
                         const AllocationInfo* allocation_info,
@@ -374,6 +673,14 @@ TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
       ++planner_index;
     }
   }
+  // Then point in-place buffers at the memory they share.
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->in_place_of != kNotInPlace) {
+      *current->output_ptr =
+          *allocation_info[current->in_place_of].output_ptr;
+    }
+  }
   return kTfLiteOk;
 }
 }  // namespace
@@ -595,6 +902,22 @@ TfLiteStatus InitializeTfLiteEvalTensorFromFlatbuffer(
 
 }  // namespace internal
 
+size_t SubgraphTensorOffset(const Model* model, int subgraph_index) {
+  size_t offset = 0;
+  for (int i = 0; i < subgraph_index; ++i) {
+    offset += model->subgraphs()->Get(i)->tensors()->size();
+  }
+  return offset;
+}
+
+size_t SubgraphNodeOffset(const Model* model, int subgraph_index) {
+  size_t offset = 0;
+  for (int i = 0; i < subgraph_index; ++i) {
+    offset += model->subgraphs()->Get(i)->operators()->size();
+  }
+  return offset;
+}
+
 MicroAllocator::MicroAllocator(SimpleMemoryAllocator* memory_allocator,
                                ErrorReporter* error_reporter)
     : memory_allocator_(memory_allocator),
@@ -638,6 +961,9 @@ TfLiteStatus MicroAllocator::StartModelAllocation(
   }
 
   model_is_allocating_ = true;
+  in_place_output_requests_ = nullptr;
+  last_in_place_output_request_ = nullptr;
+  tensor_plan_requests_ = nullptr;
 
   TF_LITE_ENSURE_STATUS(InitScratchBufferData());
   TF_LITE_ENSURE_STATUS(AllocateTfLiteEvalTensors(model, eval_tensors));
@@ -666,7 +992,11 @@ TfLiteStatus MicroAllocator::FinishModelAllocation(
       scratch_buffer_handles, scratch_buffer_request_count_));
   TF_LITE_ENSURE_STATUS(CommitStaticMemoryPlan(model, subgraph, eval_tensors,
                                                *scratch_buffer_handles));
-  TF_LITE_ENSURE_STATUS(AllocateVariables(subgraph, eval_tensors));
+  for (size_t i = 0; i < model->subgraphs()->size(); ++i) {
+    TF_LITE_ENSURE_STATUS(
+        AllocateVariables(model->subgraphs()->Get(i),
+                          eval_tensors + SubgraphTensorOffset(model, i)));
+  }
 
   model_is_allocating_ = false;
   return kTfLiteOk;
@@ -717,6 +1047,90 @@ TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t bytes,
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroAllocator::RequestModelScratchBufferInArena(
+    size_t bytes, int* buffer_idx) {
+  if (!model_is_allocating_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: Model scratch buffer requested "
+                         "outside of model allocation");
+    return kTfLiteError;
+  }
+  // The requests are stored in the head, like those of the nodes:
+  TF_LITE_ENSURE_STATUS(memory_allocator_->SetHeadBufferSize(
+      sizeof(internal::ScratchBufferRequest) *
+          (scratch_buffer_request_count_ + 1),
+      alignof(internal::ScratchBufferRequest)));
+  internal::ScratchBufferRequest* current_request =
+      &GetScratchBufferRequests()[scratch_buffer_request_count_];
+  *current_request = {};
+  current_request->bytes = bytes;
+  current_request->node_idx = kModelScratchBufferRequestIndex;
+
+  *buffer_idx = scratch_buffer_request_count_;
+  ++scratch_buffer_request_count_;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroAllocator::RequestInPlaceOutput(int input_tensor_idx,
+                                                  int output_tensor_idx) {
+  internal::InPlaceOutputRequest* request =
+      reinterpret_cast<internal::InPlaceOutputRequest*>(
+          memory_allocator_->AllocateFromTail(
+              sizeof(internal::InPlaceOutputRequest),
+              alignof(internal::InPlaceOutputRequest)));
+  if (request == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for an in-place output "
+                         "request");
+    return kTfLiteError;
+  }
+  request->input_tensor_idx = input_tensor_idx;
+  request->output_tensor_idx = output_tensor_idx;
+  request->next = nullptr;
+
+  // Keep the requests in node order, so chains of in-place operators resolve
+  // to the first input.
+  if (last_in_place_output_request_ == nullptr) {
+    in_place_output_requests_ = request;
+  } else {
+    last_in_place_output_request_->next = request;
+  }
+  last_in_place_output_request_ = request;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroAllocator::RequestTensorPlan(int tensor_idx, size_t bytes,
+                                               int first_used,
+                                               int last_used) {
+  if (!model_is_allocating_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: Tensor plan requested outside of "
+                         "model allocation");
+    return kTfLiteError;
+  }
+  internal::TensorPlanRequest* request =
+      reinterpret_cast<internal::TensorPlanRequest*>(
+          memory_allocator_->AllocateFromTail(
+              sizeof(internal::TensorPlanRequest),
+              alignof(internal::TensorPlanRequest)));
+  if (request == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for a tensor plan request");
+    return kTfLiteError;
+  }
+  request->tensor_idx = tensor_idx;
+  request->bytes = bytes;
+  request->first_used = first_used;
+  request->last_used = last_used;
+  request->next = tensor_plan_requests_;
+  tensor_plan_requests_ = request;
+  return kTfLiteOk;
+}
+
+uint8_t* MicroAllocator::AllocateTempBuffer(size_t bytes, size_t alignment) {
+  return memory_allocator_->AllocateTemp(bytes, alignment);
+}
+
 TfLiteStatus MicroAllocator::FinishPrepareNodeAllocations(int node_id) {
   // When a node has finished preparing, all temp allocations performed by the
   // kernel should be cleaned up:
@@ -750,6 +1164,28 @@ size_t MicroAllocator::used_bytes() const {
   return memory_allocator_->GetUsedBytes();
 }
 
+TfLiteStatus MicroAllocator::AcquireHead(const void* user,
+                                         const void** previous_user) {
+  if (head_claimed_.test_and_set(std::memory_order_acquire)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: The arena head is in use by %s",
+                         (head_owner_ == user) ? "the same model"
+                                               : "another model");
+    return kTfLiteError;
+  }
+  if (previous_user != nullptr) {
+    *previous_user = head_owner_;
+  }
+  head_owner_ = user;
+  return kTfLiteOk;
+}
+
+void MicroAllocator::ReleaseHead(const void* user) {
+  if (head_owner_ == user) {
+    head_claimed_.clear(std::memory_order_release);
+  }
+}
+
 TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     const Model* model, NodeAndRegistration** node_and_registrations) {
   TFLITE_DCHECK(node_and_registrations);
@@ -757,9 +1193,12 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
   const SubGraph* subgraph = GetSubGraphFromModel(model);
   TFLITE_DCHECK(subgraph != nullptr);
 
+  // The nodes of all subgraphs are held in one array.
+  const size_t node_count =
+      SubgraphNodeOffset(model, model->subgraphs()->size());
   NodeAndRegistration* output = reinterpret_cast<NodeAndRegistration*>(
       memory_allocator_->AllocateFromTail(
-          sizeof(NodeAndRegistration) * subgraph->operators()->size(),
+          sizeof(NodeAndRegistration) * node_count,
           alignof(NodeAndRegistration)));
   if (output == nullptr) {
     TF_LITE_REPORT_ERROR(
@@ -783,81 +1222,91 @@ TfLiteStatus MicroAllocator::PrepareNodeAndRegistrationDataFromFlatbuffer(
   TfLiteStatus status = kTfLiteOk;
   auto* opcodes = model->operator_codes();
   MicroBuiltinDataAllocator builtin_data_allocator(memory_allocator_);
-  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
-    const auto* op = subgraph->operators()->Get(i);
-    const size_t index = op->opcode_index();
-    if (index >= opcodes->size()) {
-      TF_LITE_REPORT_ERROR(error_reporter_,
-                           "Missing registration for opcode_index %d\n", index);
-      return kTfLiteError;
-    }
-    auto* opcode = (*opcodes)[index];
-    status =
-        GetRegistrationFromOpCode(opcode, op_resolver, error_reporter_,
-                                  &(node_and_registrations[i].registration));
-    if (status != kTfLiteOk) {
-      TF_LITE_REPORT_ERROR(error_reporter_,
-                           "Failed to get registration from op code %s\n ",
-                           EnumNameBuiltinOperator(GetBuiltinCode(opcode)));
-      return status;
-    }
-    const auto* registration = node_and_registrations[i].registration;
-    if (registration == nullptr) {
-      TF_LITE_REPORT_ERROR(error_reporter_, "Skipping op for opcode_index %d\n",
-                           index);
-      return kTfLiteError;
-    }
-    BuiltinOperator op_type =
-        static_cast<BuiltinOperator>(registration->builtin_code);
-
-    const char* custom_data = nullptr;
-    size_t custom_data_size = 0;
-    unsigned char* builtin_data = nullptr;
-
-    if (op_type == BuiltinOperator_CUSTOM) {
-      // Custom Ops may or may not have a non-null custom_options field.
-      if (op->custom_options() != nullptr) {
-        custom_data =
-            reinterpret_cast<const char*>(op->custom_options()->data());
-        custom_data_size = op->custom_options()->size();
+  // The nodes of all subgraphs are held in one array, one subgraph after
+  // another.
+  size_t node_index = 0;
+  for (size_t s = 0; s < model->subgraphs()->size(); ++s) {
+    subgraph = model->subgraphs()->Get(s);
+    for (size_t i = 0; i < subgraph->operators()->size(); ++i, ++node_index) {
+      const auto* op = subgraph->operators()->Get(i);
+      const size_t index = op->opcode_index();
+      if (index >= opcodes->size()) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Missing registration for opcode_index %d\n",
+                             index);
+        return kTfLiteError;
       }
-    } else {
-      if (op->custom_options() != nullptr) {
-        TF_LITE_REPORT_ERROR(
-            error_reporter_,
-            "Unsupported behavior: found builtin operator %s with custom "
-            "options.\n",
-            EnumNameBuiltinOperator(op_type));
+      auto* opcode = (*opcodes)[index];
+      NodeAndRegistration* node_and_registration =
+          &node_and_registrations[node_index];
+      status =
+          GetRegistrationFromOpCode(opcode, op_resolver, error_reporter_,
+                                    &(node_and_registration->registration));
+      if (status != kTfLiteOk) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Failed to get registration from op code %s\n ",
+                             EnumNameBuiltinOperator(GetBuiltinCode(opcode)));
+        return status;
+      }
+      const auto* registration = node_and_registration->registration;
+      if (registration == nullptr) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Skipping op for opcode_index %d\n", index);
         return kTfLiteError;
       }
+      BuiltinOperator op_type =
+          static_cast<BuiltinOperator>(registration->builtin_code);
+
+      const char* custom_data = nullptr;
+      size_t custom_data_size = 0;
+      unsigned char* builtin_data = nullptr;
+
+      if (op_type == BuiltinOperator_CUSTOM) {
+        // Custom Ops may or may not have a non-null custom_options field.
+        if (op->custom_options() != nullptr) {
+          custom_data =
+              reinterpret_cast<const char*>(op->custom_options()->data());
+          custom_data_size = op->custom_options()->size();
+        }
+      } else {
+        if (op->custom_options() != nullptr) {
+          TF_LITE_REPORT_ERROR(
+              error_reporter_,
+              "Unsupported behavior: found builtin operator %s with custom "
+              "options.\n",
+              EnumNameBuiltinOperator(op_type));
+          return kTfLiteError;
+        }
 
-      MicroOpResolver::BuiltinParseFunction parser =
-          op_resolver.GetOpDataParser(op_type);
-      if (parser == nullptr) {
-        TF_LITE_REPORT_ERROR(error_reporter_, "Did not find a parser for %s",
-                             EnumNameBuiltinOperator(op_type));
+        MicroOpResolver::BuiltinParseFunction parser =
+            op_resolver.GetOpDataParser(op_type);
+        if (parser == nullptr) {
+          TF_LITE_REPORT_ERROR(error_reporter_, "Did not find a parser for %s",
+                               EnumNameBuiltinOperator(op_type));
 
-        return kTfLiteError;
+          return kTfLiteError;
+        }
+        TF_LITE_ENSURE_STATUS(parser(op, error_reporter_,
+                                     &builtin_data_allocator,
+                                     (void**)(&builtin_data)));
       }
-      TF_LITE_ENSURE_STATUS(parser(op, error_reporter_, &builtin_data_allocator,
-                                   (void**)(&builtin_data)));
-    }
 
-    TfLiteIntArray* inputs_array;
-    TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
-        memory_allocator_, error_reporter_, op->inputs(), &inputs_array));
-
-    TfLiteIntArray* outputs_array;
-    TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
-        memory_allocator_, error_reporter_, op->outputs(), &outputs_array));
-
-    TfLiteNode* node = &(node_and_registrations[i].node);
-    *node = {};
-    node->inputs = inputs_array;
-    node->outputs = outputs_array;
-    node->builtin_data = reinterpret_cast<void*>(builtin_data);
-    node->custom_initial_data = custom_data;
-    node->custom_initial_data_size = custom_data_size;
+      TfLiteIntArray* inputs_array;
+      TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
+          memory_allocator_, error_reporter_, op->inputs(), &inputs_array));
+
+      TfLiteIntArray* outputs_array;
+      TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
+          memory_allocator_, error_reporter_, op->outputs(), &outputs_array));
+
+      TfLiteNode* node = &(node_and_registration->node);
+      *node = {};
+      node->inputs = inputs_array;
+      node->outputs = outputs_array;
+      node->builtin_data = reinterpret_cast<void*>(builtin_data);
+      node->custom_initial_data = custom_data;
+      node->custom_initial_data_size = custom_data_size;
+    }
   }
 
   return kTfLiteOk;
@@ -865,7 +1314,8 @@ TfLiteStatus MicroAllocator::PrepareNodeAndRegistrationDataFromFlatbuffer(
 
 TfLiteTensor* MicroAllocator::AllocatePersistentTfLiteTensor(
     const Model* model, TfLiteEvalTensor* eval_tensors, int tensor_index) {
-  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  int subgraph_tensor_index = tensor_index;
+  const SubGraph* subgraph = GetTensorSubgraph(model, &subgraph_tensor_index);
   TFLITE_DCHECK(subgraph != nullptr);
 
   // This value is allocated from persistent arena space. It is guaranteed to be
@@ -876,7 +1326,8 @@ TfLiteTensor* MicroAllocator::AllocatePersistentTfLiteTensor(
   // Populate any fields from the flatbuffer, since this TfLiteTensor struct is
   // allocated in the persistent section of the arena, ensure that additional
   // allocations also take place in that section of the arena.
-  if (PopulateTfLiteTensorFromFlatbuffer(model, subgraph, tensor, tensor_index,
+  if (PopulateTfLiteTensorFromFlatbuffer(model, subgraph, tensor,
+                                         subgraph_tensor_index,
                                          /*allocate_temp=*/false) !=
       kTfLiteOk) {
     TF_LITE_REPORT_ERROR(error_reporter_,
@@ -897,7 +1348,8 @@ TfLiteTensor* MicroAllocator::AllocatePersistentTfLiteTensor(
 
 TfLiteTensor* MicroAllocator::AllocateTempTfLiteTensor(
     const Model* model, TfLiteEvalTensor* eval_tensors, int tensor_index) {
-  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  int subgraph_tensor_index = tensor_index;
+  const SubGraph* subgraph = GetTensorSubgraph(model, &subgraph_tensor_index);
   TFLITE_DCHECK(subgraph != nullptr);
 
   // This value is allocated from temporary arena space. It is guaranteed to be
@@ -910,7 +1362,8 @@ TfLiteTensor* MicroAllocator::AllocateTempTfLiteTensor(
   // Populate any fields from the flatbuffer, since this TfLiteTensor struct is
   // allocated in the temp section of the arena, ensure that additional
   // allocations also take place in that section of the arena.
-  if (PopulateTfLiteTensorFromFlatbuffer(model, subgraph, tensor, tensor_index,
+  if (PopulateTfLiteTensorFromFlatbuffer(model, subgraph, tensor,
+                                         subgraph_tensor_index,
                                          /*allocate_temp=*/true) != kTfLiteOk) {
     TF_LITE_REPORT_ERROR(
         error_reporter_,
@@ -939,7 +1392,8 @@ TfLiteStatus MicroAllocator::AllocateTfLiteEvalTensors(
   const SubGraph* subgraph = GetSubGraphFromModel(model);
   TFLITE_DCHECK(subgraph != nullptr);
 
-  size_t alloc_count = subgraph->tensors()->size();
+  // The tensors of all subgraphs are held in one array.
+  size_t alloc_count = SubgraphTensorOffset(model, model->subgraphs()->size());
   TfLiteEvalTensor* tensors =
       reinterpret_cast<TfLiteEvalTensor*>(memory_allocator_->AllocateFromTail(
           sizeof(TfLiteEvalTensor) * alloc_count, alignof(TfLiteEvalTensor)));
@@ -952,9 +1406,11 @@ TfLiteStatus MicroAllocator::AllocateTfLiteEvalTensors(
   }
 
   for (size_t i = 0; i < alloc_count; ++i) {
+    int tensor_index = i;
+    subgraph = GetTensorSubgraph(model, &tensor_index);
     TfLiteStatus status = internal::InitializeTfLiteEvalTensorFromFlatbuffer(
-        memory_allocator_, *subgraph->tensors()->Get(i), model->buffers(),
-        error_reporter_, &tensors[i]);
+        memory_allocator_, *subgraph->tensors()->Get(tensor_index),
+        model->buffers(), error_reporter_, &tensors[i]);
     if (status != kTfLiteOk) {
       TF_LITE_REPORT_ERROR(error_reporter_, "Failed to initialize tensor %d",
                            i);
@@ -1011,9 +1467,8 @@ ErrorReporter* MicroAllocator::error_reporter() const {
 
 const SubGraph* MicroAllocator::GetSubGraphFromModel(const Model* model) {
   auto* subgraphs = model->subgraphs();
-  if (subgraphs->size() != 1) {
-    TF_LITE_REPORT_ERROR(error_reporter_,
-                         "Only 1 subgraph is currently supported.\n");
+  if (subgraphs->size() == 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Model has no subgraphs.\n");
     return nullptr;
   }
   return (*subgraphs)[0];
@@ -1034,8 +1489,9 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
   // allocated from the temp section and cleaned up at the bottom of this
   // function.
 
-  size_t allocation_info_count =
-      subgraph->tensors()->size() + scratch_buffer_request_count_;
+  const size_t subgraph_count = model->subgraphs()->size();
+  const size_t tensor_count = SubgraphTensorOffset(model, subgraph_count);
+  size_t allocation_info_count = tensor_count + scratch_buffer_request_count_;
   size_t bytes = sizeof(AllocationInfo) * allocation_info_count;
 
   // Allocate an array of AllocationInfo structs from the temp section. This
@@ -1050,16 +1506,34 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
     return kTfLiteError;
   }
 
+  // The times at which the nodes and subgraphs run in the plan, also from the
+  // temp section.
+  const size_t times_bytes =
+      sizeof(int) * 2 * (SubgraphNodeOffset(model, subgraph_count) +
+                         subgraph_count);
+  int* times = reinterpret_cast<int*>(
+      memory_allocator_->AllocateTemp(times_bytes, alignof(int)));
+  if (times == nullptr) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "Failed to allocate memory for node times, %d bytes required",
+        times_bytes);
+    return kTfLiteError;
+  }
+
   // Use the AllocationInfoBuilder class to help determine where buffers are
-  // used in the subgraph.
-  AllocationInfoBuilder builder(allocation_info, subgraph->tensors()->size(),
+  // used in the model.
+  AllocationInfoBuilder builder(allocation_info, tensor_count,
                                 scratch_buffer_request_count_, error_reporter_);
 
   const int32_t* offline_planner_offsets = nullptr;
   TF_LITE_ENSURE_STATUS(
       builder.GetOfflinePlannedOffsets(model, &offline_planner_offsets));
+  TF_LITE_ENSURE_STATUS(builder.AddNodeTimes(model, times));
   TF_LITE_ENSURE_STATUS(
-      builder.AddTensors(subgraph, offline_planner_offsets, eval_tensors));
+      builder.AddTensors(model, offline_planner_offsets, eval_tensors));
+  TF_LITE_ENSURE_STATUS(builder.AddTensorPlans(tensor_plan_requests_));
+  builder.AddInPlaceOutputs(in_place_output_requests_);
 
   internal::ScratchBufferRequest* scratch_buffer_requests =
       GetScratchBufferRequests();
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MICRO_MICRO_ALLOCATOR_H_
 #define TENSORFLOW_LITE_MICRO_MICRO_ALLOCATOR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -56,10 +57,32 @@ typedef struct {
   size_t bytes;
   // Node where the buffer is allocated for. This provides useful information to
   // determine the lifetime of the buffer. In AllocationInfo, this buffer will
-  // have `before` = node_idx and `after` = node_idx.
+  // have `before` = node_idx and `after` = node_idx. Buffers requested for the
+  // whole model have a node_idx of -2, and are used by every node.
   int node_idx;
 } ScratchBufferRequest;
 
+// Holds a kernel's request for an output tensor to share the buffer of one of
+// its inputs. Requests are kept in the tail section as a list in node order,
+// and are applied when the memory plan is committed.
+typedef struct InPlaceOutputRequest {
+  int input_tensor_idx;
+  int output_tensor_idx;
+  struct InPlaceOutputRequest* next;
+} InPlaceOutputRequest;
+
+// Holds a request to plan a tensor with a different size, or across more
+// nodes, than the model graph gives it. Requests are kept in the tail section
+// and are applied when the memory plan is committed.
+typedef struct TensorPlanRequest {
+  int tensor_idx;
+  // Bytes to plan for the tensor, or 0 to keep its own size.
+  size_t bytes;
+  int first_used;
+  int last_used;
+  struct TensorPlanRequest* next;
+} TensorPlanRequest;
+
 }  // namespace internal
 
 typedef struct {
@@ -67,6 +90,14 @@ typedef struct {
   const TfLiteRegistration* registration;
 } NodeAndRegistration;
 
+// The tensors and nodes of all subgraphs of a model are held in one array
+// each, one subgraph after another, starting with the first subgraph so that
+// its indices are the same as in the flatbuffer. These return the index in
+// those arrays of the first tensor or node of a subgraph, or the total count
+// when `subgraph_index` is the number of subgraphs.
+size_t SubgraphTensorOffset(const Model* model, int subgraph_index);
+size_t SubgraphNodeOffset(const Model* model, int subgraph_index);
+
 // Holds a pointer to a buffer for a scratch buffer requested by a kernel during
 // the model prepare stage. This struct is allocated in-place and allows for
 // quick pointer-indexed lookup for speed during model inference.
@@ -173,6 +204,31 @@ class MicroAllocator {
   // buffers will be accessible by the out-param in that method.
   TfLiteStatus RequestScratchBufferInArena(size_t bytes, int* buffer_idx);
 
+  // Register a scratch buffer of size `bytes` that stays allocated while any
+  // node of the model runs, e.g. to be shared by all of them. It is planned in
+  // the head with the other non-persistent buffers, and is accessible like the
+  // buffers from RequestScratchBufferInArena(). Must be called after the nodes
+  // are prepared and before FinishModelAllocation().
+  TfLiteStatus RequestModelScratchBufferInArena(size_t bytes, int* buffer_idx);
+
+  // Asks for the output tensor to share the buffer of the input tensor when
+  // the memory plan is committed. The request is dropped if either tensor
+  // isn't planned online, or if the output is larger than the input, in which
+  // case the tensors get separate buffers as usual.
+  TfLiteStatus RequestInPlaceOutput(int input_tensor_idx,
+                                    int output_tensor_idx);
+
+  // Asks for a tensor to be planned with a buffer of `bytes` (or its own size
+  // if `bytes` is 0) that stays allocated from node `first_used` to node
+  // `last_used`, as well as for its own lifetime. Must be called before
+  // FinishModelAllocation(), and the tensor can't be offline planned.
+  TfLiteStatus RequestTensorPlan(int tensor_idx, size_t bytes, int first_used,
+                                 int last_used);
+
+  // Allocates a buffer from the temp section of the arena. The buffer is only
+  // valid until the next call to ResetTempAllocations().
+  virtual uint8_t* AllocateTempBuffer(size_t bytes, size_t alignment);
+
   // Finish allocating a specific NodeAndRegistration prepare block (kernel
   // entry for a model) with a given node ID. This call ensures that any scratch
   // buffer requests and temporary allocations are handled and ready for the
@@ -183,6 +239,29 @@ class MicroAllocator {
   // `FinishModelAllocation`. Otherwise, it will return 0.
   size_t used_bytes() const;
 
+  // Returns the number of scratch buffers requested by the kernels of the
+  // model, which are indexed from 0 in the handles returned by
+  // FinishModelAllocation().
+  size_t scratch_buffer_count() const { return scratch_buffer_request_count_; }
+
+  // Claims the head section of the arena for `user`. The head holds the
+  // non-persistent tensors and scratch buffers of every model allocated from
+  // this allocator, so claiming it fails while another user holds it, rather
+  // than overwriting the tensors of a model that is allocating or invoking.
+  // Each successful claim must be followed by ReleaseHead(). The claim is an
+  // atomic test-and-set, so it is safe against a model started from an
+  // interrupt. `previous_user`, if given, is set to the user that claimed the
+  // head before, whose data it may still hold.
+  TfLiteStatus AcquireHead(const void* user,
+                           const void** previous_user = nullptr);
+
+  // Releases the head section claimed by `user`.
+  void ReleaseHead(const void* user);
+
+  // Returns true if `user` was the last to claim the head section, so that the
+  // tensor data it left there is still intact.
+  bool HeadOwnedBy(const void* user) const { return head_owner_ == user; }
+
  protected:
   MicroAllocator(SimpleMemoryAllocator* memory_allocator,
                  ErrorReporter* error_reporter);
@@ -228,7 +307,8 @@ class MicroAllocator {
 
   ErrorReporter* error_reporter() const;
 
-  // Returns the first subgraph from the model.
+  // Returns the first subgraph from the model, which is the one that is
+  // invoked. Other subgraphs are called by control flow operators.
   const SubGraph* GetSubGraphFromModel(const Model* model);
 
  private:
@@ -268,10 +348,22 @@ class MicroAllocator {
   // section when a model is allocating.
   size_t scratch_buffer_request_count_ = 0;
 
+  // Holds the in-place output requests of the model that is allocating, in
+  // the order they were made.
+  internal::InPlaceOutputRequest* in_place_output_requests_ = nullptr;
+  internal::InPlaceOutputRequest* last_in_place_output_request_ = nullptr;
+
+  // Holds the tensor plan requests of the model that is allocating.
+  internal::TensorPlanRequest* tensor_plan_requests_ = nullptr;
+
   // Holds the byte length of the memory plan with the largest head usage. Used
   // to ensure that multi-tenant allocations can share the head for buffers.
   size_t max_head_buffer_usage_ = 0;
 
+  // The last user to claim the head section, and whether it still holds it.
+  const void* head_owner_ = nullptr;
+  std::atomic_flag head_claimed_ = ATOMIC_FLAG_INIT;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
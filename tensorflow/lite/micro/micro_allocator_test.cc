@@ -117,6 +117,13 @@ void VerifyRegistrationAndNodeAllocation(
   }
 }
 
+bool BuffersOverlap(const void* a, size_t a_bytes, const void* b,
+                    size_t b_bytes) {
+  const uint8_t* a_start = static_cast<const uint8_t*>(a);
+  const uint8_t* b_start = static_cast<const uint8_t*>(b);
+  return (a_start < b_start + b_bytes) && (b_start < a_start + a_bytes);
+}
+
 }  // namespace
 }  // namespace testing
 }  // namespace tflite
@@ -850,4 +857,151 @@ TF_LITE_MICRO_TEST(TestTypicalFirstOpAndSecondOpWithScratchTensors) {
   TF_LITE_MICRO_EXPECT_EQ(0, eval_tensors[5].data.uint8 - start);
 }
 
+TF_LITE_MICRO_TEST(TestInPlaceOutputSharesInputBuffer) {
+  constexpr int number_tensors = 4;
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  tflite::NodeAndRegistration* node_and_registration;
+  const int32_t metadata_buffer[tflite::testing::kOfflinePlannerHeaderSize +
+                                number_tensors] = {/*version=*/1,
+                                                   /*subgraph=*/0,
+                                                   number_tensors,
+                                                   /*t0=*/-1,
+                                                   /*t1=*/-1,
+                                                   /*t2=*/-1,
+                                                   /*t3=*/-1};
+  constexpr int number_connections = 3;
+  tflite::testing::NodeConnection node_list[number_connections] = {
+      {/*input=*/{tflite::testing::t0},
+       /*output=*/{tflite::testing::t1}},
+      {/*input=*/{tflite::testing::t1},
+       /*output=*/{tflite::testing::t2}},
+      {/*input=*/{tflite::testing::t2},
+       /*output=*/{tflite::testing::t3}}};
+
+  const tflite::Model* model = tflite::testing::GetModelWithOfflinePlanning(
+      number_tensors, metadata_buffer, node_list, number_connections);
+
+  TfLiteEvalTensor* eval_tensors = nullptr;
+  tflite::ScratchBufferHandle* scratch_buffer_handles = nullptr;
+  constexpr size_t arena_size = 4096;
+  uint8_t arena[arena_size];
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      arena, arena_size, tflite::GetMicroErrorReporter());
+
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      allocator->StartModelAllocation(model, op_resolver,
+                                      &node_and_registration, &eval_tensors));
+  // The second node asks for its output, t2, to share the buffer of t1.
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      allocator->RequestInPlaceOutput(tflite::testing::t1,
+                                      tflite::testing::t2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->FinishPrepareNodeAllocations(
+                                         /*node_id=*/1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, allocator->FinishModelAllocation(model, eval_tensors,
+                                                  &scratch_buffer_handles));
+
+  // t1 now lives until t2 is last used, so t3 can't reuse it.
+  uint8_t* start = eval_tensors[0].data.uint8;
+  TF_LITE_MICRO_EXPECT_EQ(0, eval_tensors[0].data.uint8 - start);
+  TF_LITE_MICRO_EXPECT_EQ(48, eval_tensors[1].data.uint8 - start);
+  TF_LITE_MICRO_EXPECT_EQ(48, eval_tensors[2].data.uint8 - start);
+  TF_LITE_MICRO_EXPECT_EQ(0, eval_tensors[3].data.uint8 - start);
+}
+
+TF_LITE_MICRO_TEST(TestModelScratchBufferSpansEveryNode) {
+  constexpr int number_tensors = 4;
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  tflite::NodeAndRegistration* node_and_registration;
+  const int32_t metadata_buffer[tflite::testing::kOfflinePlannerHeaderSize +
+                                number_tensors] = {/*version=*/1,
+                                                   /*subgraph=*/0,
+                                                   number_tensors,
+                                                   /*t0=*/-1,
+                                                   /*t1=*/-1,
+                                                   /*t2=*/-1,
+                                                   /*t3=*/-1};
+  constexpr int number_connections = 3;
+  tflite::testing::NodeConnection node_list[number_connections] = {
+      {/*input=*/{tflite::testing::t0},
+       /*output=*/{tflite::testing::t1}},
+      {/*input=*/{tflite::testing::t1},
+       /*output=*/{tflite::testing::t2}},
+      {/*input=*/{tflite::testing::t2},
+       /*output=*/{tflite::testing::t3}}};
+
+  const tflite::Model* model = tflite::testing::GetModelWithOfflinePlanning(
+      number_tensors, metadata_buffer, node_list, number_connections);
+
+  TfLiteEvalTensor* eval_tensors = nullptr;
+  tflite::ScratchBufferHandle* scratch_buffer_handles = nullptr;
+  constexpr size_t arena_size = 4096;
+  uint8_t arena[arena_size];
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      arena, arena_size, tflite::GetMicroErrorReporter());
+
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      allocator->StartModelAllocation(model, op_resolver,
+                                      &node_and_registration, &eval_tensors));
+  // The first and last nodes each ask for a scratch buffer, then the whole
+  // model asks for one.
+  constexpr size_t scratch_bytes = 32;
+  int first_index = -1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->RequestScratchBufferInArena(
+                                         scratch_bytes, &first_index));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->FinishPrepareNodeAllocations(
+                                         /*node_id=*/0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->FinishPrepareNodeAllocations(
+                                         /*node_id=*/1));
+  int last_index = -1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->RequestScratchBufferInArena(
+                                         scratch_bytes, &last_index));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->FinishPrepareNodeAllocations(
+                                         /*node_id=*/2));
+  int model_index = -1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          allocator->RequestModelScratchBufferInArena(
+                              scratch_bytes, &model_index));
+  TF_LITE_MICRO_EXPECT_EQ(2, model_index);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, allocator->FinishModelAllocation(model, eval_tensors,
+                                                  &scratch_buffer_handles));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(3),
+                          allocator->scratch_buffer_count());
+
+  // The model's buffer is in the head, and is not shared with any tensor or
+  // node scratch buffer.
+  const void* model_buffer = scratch_buffer_handles[model_index].data;
+  TF_LITE_MICRO_EXPECT(model_buffer >= static_cast<void*>(arena));
+  TF_LITE_MICRO_EXPECT(model_buffer < static_cast<void*>(arena + arena_size));
+  for (int i = 0; i < number_tensors; ++i) {
+    size_t tensor_bytes = 0;
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk, tflite::TfLiteEvalTensorByteLength(&eval_tensors[i],
+                                                      &tensor_bytes));
+    TF_LITE_MICRO_EXPECT(!tflite::testing::BuffersOverlap(
+        model_buffer, scratch_bytes, eval_tensors[i].data.data, tensor_bytes));
+  }
+  TF_LITE_MICRO_EXPECT(!tflite::testing::BuffersOverlap(
+      model_buffer, scratch_bytes, scratch_buffer_handles[first_index].data,
+      scratch_bytes));
+  TF_LITE_MICRO_EXPECT(!tflite::testing::BuffersOverlap(
+      model_buffer, scratch_bytes, scratch_buffer_handles[last_index].data,
+      scratch_bytes));
+}
+
+TF_LITE_MICRO_TEST(TestModelScratchBufferOutsideModelAllocationFails) {
+  constexpr size_t arena_size = 1024;
+  uint8_t arena[arena_size];
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      arena, arena_size, tflite::GetMicroErrorReporter());
+  int buffer_index = -1;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      allocator->RequestModelScratchBufferInArena(32, &buffer_index));
+}
+
 TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,51 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_GRAPH_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_GRAPH_H_
+
+#include <cstddef>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Gives control flow kernels, such as IF and WHILE, access to the other
+// subgraphs of the model. The MicroInterpreter points context->impl_ at an
+// instance of this class, see tflite::micro::GetMicroGraph().
+//
+// Tensors of a subgraph are planned in the same arena as those of the node
+// that calls it, and keep their buffers for as long as that node runs.
+class MicroGraph {
+ public:
+  virtual ~MicroGraph() {}
+
+  virtual int NumSubgraphs() = 0;
+  virtual size_t NumSubgraphInputs(int subgraph_index) = 0;
+  virtual size_t NumSubgraphOutputs(int subgraph_index) = 0;
+
+  // Returns the eval tensor of an input or output of a subgraph, or nullptr if
+  // the subgraph or index is out of range.
+  virtual TfLiteEvalTensor* GetSubgraphInput(int subgraph_index,
+                                             int input_index) = 0;
+  virtual TfLiteEvalTensor* GetSubgraphOutput(int subgraph_index,
+                                              int output_index) = 0;
+
+  // Runs the nodes of a subgraph, whose inputs must already be filled in.
+  virtual TfLiteStatus InvokeSubgraph(int subgraph_index) = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_GRAPH_H_
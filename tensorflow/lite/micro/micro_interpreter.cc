@@ -42,37 +42,80 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
 }
 #endif  // !defined(TF_LITE_STRIP_ERROR_STRINGS)
 
+// Holds the arena head of an allocator, which may be shared with other
+// interpreters, until it goes out of scope.
+class ScopedHeadClaim {
+ public:
+  ScopedHeadClaim(MicroAllocator* allocator, const void* user)
+      : allocator_(allocator),
+        user_(user),
+        status_(allocator->AcquireHead(user, &previous_user_)) {}
+
+  ~ScopedHeadClaim() {
+    if (status_ == kTfLiteOk) {
+      allocator_->ReleaseHead(user_);
+    }
+  }
+
+  TfLiteStatus status() const { return status_; }
+
+  // The user that claimed the head before this claim.
+  const void* previous_user() const { return previous_user_; }
+
+ private:
+  MicroAllocator* allocator_;
+  const void* user_;
+  const void* previous_user_ = nullptr;
+  TfLiteStatus status_;
+};
+
 }  // namespace
 
 namespace internal {
 
 ContextHelper::ContextHelper(ErrorReporter* error_reporter,
-                             MicroAllocator* allocator, const Model* model)
-    : allocator_(allocator), error_reporter_(error_reporter), model_(model) {}
+                             MicroAllocator* allocator, const Model* model,
+                             MicroInterpreter* interpreter)
+    : allocator_(allocator),
+      error_reporter_(error_reporter),
+      model_(model),
+      interpreter_(interpreter) {}
+
+ContextHelper* ContextHelper::FromContext(const TfLiteContext* context) {
+  return static_cast<ContextHelper*>(static_cast<MicroGraph*>(context->impl_));
+}
 
 void* ContextHelper::AllocatePersistentBuffer(TfLiteContext* ctx,
                                               size_t bytes) {
-  return reinterpret_cast<ContextHelper*>(ctx->impl_)
-      ->allocator_->AllocatePersistentBuffer(bytes);
+  return FromContext(ctx)->allocator_->AllocatePersistentBuffer(bytes);
 }
 
 TfLiteStatus ContextHelper::RequestScratchBufferInArena(TfLiteContext* ctx,
                                                         size_t bytes,
                                                         int* buffer_idx) {
-  ContextHelper* helper = reinterpret_cast<ContextHelper*>(ctx->impl_);
+  ContextHelper* helper = FromContext(ctx);
   return helper->allocator_->RequestScratchBufferInArena(bytes, buffer_idx);
 }
 
 void* ContextHelper::GetScratchBuffer(TfLiteContext* ctx, int buffer_idx) {
-  ContextHelper* helper = reinterpret_cast<ContextHelper*>(ctx->impl_);
+  ContextHelper* helper = FromContext(ctx);
   ScratchBufferHandle* handle = helper->scratch_buffer_handles_ + buffer_idx;
   return handle->data;
 }
 
+TfLiteStatus ContextHelper::RequestInPlaceOutput(TfLiteContext* ctx,
+                                                 int input_tensor_idx,
+                                                 int output_tensor_idx) {
+  ContextHelper* helper = FromContext(ctx);
+  return helper->allocator_->RequestInPlaceOutput(
+      helper->tensor_offset_ + input_tensor_idx,
+      helper->tensor_offset_ + output_tensor_idx);
+}
+
 void ContextHelper::ReportOpError(struct TfLiteContext* context,
                                   const char* format, ...) {
 #ifndef TF_LITE_STRIP_ERROR_STRINGS
-  ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  ContextHelper* helper = FromContext(context);
   va_list args;
   va_start(args, format);
   TF_LITE_REPORT_ERROR(helper->error_reporter_, format, args);
@@ -82,15 +125,16 @@ void ContextHelper::ReportOpError(struct TfLiteContext* context,
 
 TfLiteTensor* ContextHelper::GetTensor(const struct TfLiteContext* context,
                                        int tensor_idx) {
-  ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  ContextHelper* helper = FromContext(context);
   return helper->allocator_->AllocateTempTfLiteTensor(
-      helper->model_, helper->eval_tensors_, tensor_idx);
+      helper->model_, helper->eval_tensors_,
+      helper->tensor_offset_ + tensor_idx);
 }
 
 TfLiteEvalTensor* ContextHelper::GetEvalTensor(
     const struct TfLiteContext* context, int tensor_idx) {
-  ContextHelper* helper = reinterpret_cast<ContextHelper*>(context->impl_);
-  return &helper->eval_tensors_[tensor_idx];
+  ContextHelper* helper = FromContext(context);
+  return &helper->eval_tensors_[helper->tensor_offset_ + tensor_idx];
 }
 
 void ContextHelper::SetTfLiteEvalTensors(TfLiteEvalTensor* eval_tensors) {
@@ -102,6 +146,56 @@ void ContextHelper::SetScratchBufferHandles(
   scratch_buffer_handles_ = scratch_buffer_handles;
 }
 
+int ContextHelper::SetSubgraph(int subgraph_index) {
+  const int previous_index = subgraph_index_;
+  subgraph_index_ = subgraph_index;
+  tensor_offset_ = SubgraphTensorOffset(model_, subgraph_index);
+  return previous_index;
+}
+
+int ContextHelper::NumSubgraphs() { return model_->subgraphs()->size(); }
+
+size_t ContextHelper::NumSubgraphInputs(int subgraph_index) {
+  if ((subgraph_index < 0) || (subgraph_index >= NumSubgraphs())) {
+    return 0;
+  }
+  return model_->subgraphs()->Get(subgraph_index)->inputs()->size();
+}
+
+size_t ContextHelper::NumSubgraphOutputs(int subgraph_index) {
+  if ((subgraph_index < 0) || (subgraph_index >= NumSubgraphs())) {
+    return 0;
+  }
+  return model_->subgraphs()->Get(subgraph_index)->outputs()->size();
+}
+
+TfLiteEvalTensor* ContextHelper::GetSubgraphInput(int subgraph_index,
+                                                  int input_index) {
+  if ((input_index < 0) ||
+      (static_cast<size_t>(input_index) >= NumSubgraphInputs(subgraph_index))) {
+    return nullptr;
+  }
+  const SubGraph* subgraph = model_->subgraphs()->Get(subgraph_index);
+  return &eval_tensors_[SubgraphTensorOffset(model_, subgraph_index) +
+                        subgraph->inputs()->Get(input_index)];
+}
+
+TfLiteEvalTensor* ContextHelper::GetSubgraphOutput(int subgraph_index,
+                                                   int output_index) {
+  if ((output_index < 0) ||
+      (static_cast<size_t>(output_index) >=
+       NumSubgraphOutputs(subgraph_index))) {
+    return nullptr;
+  }
+  const SubGraph* subgraph = model_->subgraphs()->Get(subgraph_index);
+  return &eval_tensors_[SubgraphTensorOffset(model_, subgraph_index) +
+                        subgraph->outputs()->Get(output_index)];
+}
+
+TfLiteStatus ContextHelper::InvokeSubgraph(int subgraph_index) {
+  return interpreter_->InvokeSubgraph(subgraph_index);
+}
+
 }  // namespace internal
 
 MicroInterpreter::MicroInterpreter(const Model* model,
@@ -118,7 +212,7 @@ MicroInterpreter::MicroInterpreter(const Model* model,
       tensors_allocated_(false),
       initialization_status_(kTfLiteError),
       eval_tensors_(nullptr),
-      context_helper_(error_reporter_, &allocator_, model),
+      context_helper_(error_reporter_, &allocator_, model, this),
       input_tensors_(nullptr),
       output_tensors_(nullptr) {
   Init(profiler);
@@ -136,7 +230,7 @@ MicroInterpreter::MicroInterpreter(const Model* model,
       tensors_allocated_(false),
       initialization_status_(kTfLiteError),
       eval_tensors_(nullptr),
-      context_helper_(error_reporter_, &allocator_, model),
+      context_helper_(error_reporter_, &allocator_, model, this),
       input_tensors_(nullptr),
       output_tensors_(nullptr) {
   Init(profiler);
@@ -144,7 +238,9 @@ MicroInterpreter::MicroInterpreter(const Model* model,
 
 MicroInterpreter::~MicroInterpreter() {
   if (node_and_registrations_ != nullptr) {
-    for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+    const size_t node_count =
+        SubgraphNodeOffset(model_, model_->subgraphs()->size());
+    for (size_t i = 0; i < node_count; ++i) {
       TfLiteNode* node = &(node_and_registrations_[i].node);
       const TfLiteRegistration* registration =
           node_and_registrations_[i].registration;
@@ -160,15 +256,17 @@ MicroInterpreter::~MicroInterpreter() {
 void MicroInterpreter::Init(MicroProfiler* profiler) {
   const flatbuffers::Vector<flatbuffers::Offset<SubGraph>>* subgraphs =
       model_->subgraphs();
-  if (subgraphs->size() != 1) {
-    TF_LITE_REPORT_ERROR(error_reporter_,
-                         "Only 1 subgraph is currently supported.\n");
+  if (subgraphs->size() == 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Model has no subgraphs.\n");
     initialization_status_ = kTfLiteError;
     return;
   }
   subgraph_ = (*subgraphs)[0];
 
-  context_.impl_ = static_cast<void*>(&context_helper_);
+  // Control flow kernels find the other subgraphs through context->impl_, see
+  // tflite::micro::GetMicroGraph().
+  context_.impl_ =
+      static_cast<void*>(static_cast<MicroGraph*>(&context_helper_));
   context_.ReportError = context_helper_.ReportOpError;
   context_.GetTensor = context_helper_.GetTensor;
   context_.GetEvalTensor = context_helper_.GetEvalTensor;
@@ -179,6 +277,9 @@ void MicroInterpreter::Init(MicroProfiler* profiler) {
 }
 
 TfLiteStatus MicroInterpreter::AllocateTensors() {
+  ScopedHeadClaim head_claim(&allocator_, this);
+  TF_LITE_ENSURE_STATUS(head_claim.status());
+
   if (allocator_.StartModelAllocation(model_, op_resolver_,
                                       &node_and_registrations_,
                                       &eval_tensors_) != kTfLiteOk) {
@@ -199,51 +300,83 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_.AllocatePersistentBuffer = context_helper_.AllocatePersistentBuffer;
   context_.RequestScratchBufferInArena = nullptr;
   context_.GetScratchBuffer = nullptr;
-
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
-    size_t init_data_size;
-    const char* init_data;
-    if (registration->builtin_code == BuiltinOperator_CUSTOM) {
-      init_data = reinterpret_cast<const char*>(node->custom_initial_data);
-      init_data_size = node->custom_initial_data_size;
-    } else {
-      init_data = reinterpret_cast<const char*>(node->builtin_data);
-      init_data_size = 0;
-    }
-    if (registration->init) {
-      node->user_data =
-          registration->init(&context_, init_data, init_data_size);
+  context_.RequestInPlaceOutput = nullptr;
+
+  // The nodes of every subgraph are initialized and prepared, each with the
+  // context referring to the tensors of its own subgraph.
+  for (size_t s = 0; s < model_->subgraphs()->size(); ++s) {
+    context_helper_.SetSubgraph(s);
+    const size_t node_end = SubgraphNodeOffset(model_, s + 1);
+    for (size_t i = SubgraphNodeOffset(model_, s); i < node_end; ++i) {
+      auto* node = &(node_and_registrations_[i].node);
+      auto* registration = node_and_registrations_[i].registration;
+      size_t init_data_size;
+      const char* init_data;
+      if (registration->builtin_code == BuiltinOperator_CUSTOM) {
+        init_data = reinterpret_cast<const char*>(node->custom_initial_data);
+        init_data_size = node->custom_initial_data_size;
+      } else {
+        init_data = reinterpret_cast<const char*>(node->builtin_data);
+        init_data_size = 0;
+      }
+      if (registration->init) {
+        node->user_data =
+            registration->init(&context_, init_data, init_data_size);
+      }
     }
   }
+  context_helper_.SetSubgraph(0);
 
-  // Both AllocatePersistentBuffer and RequestScratchBufferInArena is
-  // available in Prepare stage.
+  // AllocatePersistentBuffer, RequestScratchBufferInArena and
+  // RequestInPlaceOutput are available in Prepare stage.
   context_.RequestScratchBufferInArena =
       context_helper_.RequestScratchBufferInArena;
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
-    if (registration->prepare) {
-      TfLiteStatus prepare_status = registration->prepare(&context_, node);
-      if (prepare_status != kTfLiteOk) {
-        TF_LITE_REPORT_ERROR(
-            error_reporter_,
-            "Node %s (number %df) failed to prepare with status %d",
-            OpNameFromRegistration(registration), i, prepare_status);
-        return kTfLiteError;
+  context_.RequestInPlaceOutput = context_helper_.RequestInPlaceOutput;
+  for (size_t s = 0; s < model_->subgraphs()->size(); ++s) {
+    context_helper_.SetSubgraph(s);
+    const size_t node_end = SubgraphNodeOffset(model_, s + 1);
+    for (size_t i = SubgraphNodeOffset(model_, s); i < node_end; ++i) {
+      auto* node = &(node_and_registrations_[i].node);
+      auto* registration = node_and_registrations_[i].registration;
+      if (registration->prepare) {
+        TfLiteStatus prepare_status = registration->prepare(&context_, node);
+        if (prepare_status != kTfLiteOk) {
+          TF_LITE_REPORT_ERROR(
+              error_reporter_,
+              "Node %s (number %df) failed to prepare with status %d",
+              OpNameFromRegistration(registration), i, prepare_status);
+          context_helper_.SetSubgraph(0);
+          return kTfLiteError;
+        }
       }
+      allocator_.FinishPrepareNodeAllocations(/*node_id=*/i);
     }
-    allocator_.FinishPrepareNodeAllocations(/*node_id=*/i);
   }
+  context_helper_.SetSubgraph(0);
 
   // Prepare is done, we're ready for Invoke. Memory allocation is no longer
   // allowed. Kernels can only fetch scratch buffers via GetScratchBuffer.
   context_.AllocatePersistentBuffer = nullptr;
   context_.RequestScratchBufferInArena = nullptr;
+  context_.RequestInPlaceOutput = nullptr;
   context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
 
+  // The patch and streaming plans change how the tensors of the first layers
+  // are planned, so they have to be made before the memory plan is committed.
+  if (patch_count_ > 1) {
+    TF_LITE_ENSURE_STATUS(patch_plan_.Init(error_reporter_, &allocator_,
+                                           subgraph_, node_and_registrations_,
+                                           eval_tensors_, patch_count_));
+  }
+  if (streaming_) {
+    TF_LITE_ENSURE_STATUS(streaming_plan_.Init(error_reporter_, &allocator_,
+                                               subgraph_,
+                                               node_and_registrations_,
+                                               eval_tensors_));
+  }
+
+  TF_LITE_ENSURE_STATUS(RequestModelScratchBuffers(&allocator_));
+
   TF_LITE_ENSURE_OK(&context_,
                     allocator_.FinishModelAllocation(model_, eval_tensors_,
                                                      &scratch_buffer_handles_));
@@ -305,6 +438,30 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
 }
 
 TfLiteStatus MicroInterpreter::Invoke() {
+  return InvokeModel(StreamingPlan::kUnknownShift);
+}
+
+TfLiteStatus MicroInterpreter::InvokeStreaming(int new_rows) {
+  if (!streaming_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "InvokeStreaming() needs EnableStreaming() to be "
+                         "called before AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (new_rows < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid number of new rows %d",
+                         new_rows);
+    return kTfLiteError;
+  }
+  return InvokeModel(new_rows);
+}
+
+TfLiteStatus MicroInterpreter::ClaimArenaHead() {
+  ScopedHeadClaim head_claim(&allocator_, this);
+  return head_claim.status();
+}
+
+TfLiteStatus MicroInterpreter::InvokeModel(int new_rows) {
   if (initialization_status_ != kTfLiteOk) {
     TF_LITE_REPORT_ERROR(error_reporter_,
                          "Invoke() called after initialization failed\n");
@@ -317,39 +474,165 @@ TfLiteStatus MicroInterpreter::Invoke() {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
 
+  // Other interpreters sharing the allocator can't use the arena head until
+  // this one is done with it.
+  ScopedHeadClaim head_claim(&allocator_, this);
+  TF_LITE_ENSURE_STATUS(head_claim.status());
+  // Another interpreter has overwritten the inputs of this one since they were
+  // filled in.
+  if (head_claim.previous_user() != this) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Invoke() called after another model used the arena "
+                         "head, call ClaimArenaHead() before filling in the "
+                         "inputs");
+    return kTfLiteError;
+  }
+
+  // Until the stage has run, the feature maps it keeps don't match its input.
+  if (streaming_plan_.active()) {
+    streaming_plan_.StartFrame(new_rows);
+  }
+
   for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
+    if (streaming_plan_.active() &&
+        (static_cast<int>(i) == streaming_plan_.first_node())) {
+      TF_LITE_ENSURE_STATUS(InvokeStream());
+      i = streaming_plan_.last_node();
+      continue;
+    }
+    if (patch_plan_.active() &&
+        (static_cast<int>(i) == patch_plan_.first_node())) {
+      TF_LITE_ENSURE_STATUS(InvokePatches());
+      i = patch_plan_.last_node();
+      continue;
+    }
+    TF_LITE_ENSURE_STATUS(InvokeNode(i));
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::InvokeNode(int node_index) {
+  auto* node = &(node_and_registrations_[node_index].node);
+  auto* registration = node_and_registrations_[node_index].registration;
 
 // This ifdef is needed (even though ScopedMicroProfiler itself is a no-op with
 // -DTF_LITE_STRIP_ERROR_STRINGS) because the function OpNameFromRegistration is
 // only defined for builds with the error strings.
 #if !defined(TF_LITE_STRIP_ERROR_STRINGS)
-    ScopedMicroProfiler scoped_profiler(
-        OpNameFromRegistration(registration),
-        reinterpret_cast<MicroProfiler*>(context_.profiler));
+  ScopedMicroProfiler scoped_profiler(
+      OpNameFromRegistration(registration),
+      reinterpret_cast<MicroProfiler*>(context_.profiler));
 #endif
 
-    TFLITE_DCHECK(registration->invoke);
-    TfLiteStatus invoke_status = registration->invoke(&context_, node);
+  TFLITE_DCHECK(registration->invoke);
+  TfLiteStatus invoke_status = registration->invoke(&context_, node);
 
-    // All TfLiteTensor structs used in the kernel are allocated from temp
-    // memory in the allocator. This creates a chain of allocations in the
-    // temp section. The call below resets the chain of allocations to
-    // prepare for the next call.
-    allocator_.ResetTempAllocations();
+  // All TfLiteTensor structs used in the kernel are allocated from temp
+  // memory in the allocator. This creates a chain of allocations in the
+  // temp section. The call below resets the chain of allocations to
+  // prepare for the next call.
+  allocator_.ResetTempAllocations();
 
-    if (invoke_status == kTfLiteError) {
-      TF_LITE_REPORT_ERROR(
-          error_reporter_,
-          "Node %s (number %d) failed to invoke with status %d",
-          OpNameFromRegistration(registration), i, invoke_status);
-      return kTfLiteError;
-    } else if (invoke_status != kTfLiteOk) {
-      return invoke_status;
+  if (invoke_status == kTfLiteError) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Node %s (number %d) failed to invoke with status %d",
+                         OpNameFromRegistration(registration), node_index,
+                         invoke_status);
+    return kTfLiteError;
+  }
+  return invoke_status;
+}
+
+TfLiteStatus MicroInterpreter::InvokeSubgraph(int subgraph_index) {
+  // The first subgraph is only run by Invoke(), so can't be called by a node.
+  const int subgraph_count = model_->subgraphs()->size();
+  if ((subgraph_index <= 0) || (subgraph_index >= subgraph_count)) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Can't invoke subgraph %d",
+                         subgraph_index);
+    return kTfLiteError;
+  }
+
+  const int caller_index = context_helper_.SetSubgraph(subgraph_index);
+  TfLiteStatus status = kTfLiteOk;
+  const size_t node_end = SubgraphNodeOffset(model_, subgraph_index + 1);
+  for (size_t i = SubgraphNodeOffset(model_, subgraph_index);
+       (i < node_end) && (status == kTfLiteOk); ++i) {
+    status = InvokeNode(i);
+  }
+  context_helper_.SetSubgraph(caller_index);
+  return status;
+}
+
+TfLiteStatus MicroInterpreter::InvokePatches() {
+  patch_plan_.SaveTensors(eval_tensors_);
+  TfLiteStatus status = kTfLiteOk;
+  // Patches are run bottom up, so that the lead-in rows each one writes into
+  // the stage output are then overwritten by the patch above.
+  for (int patch = patch_plan_.patch_count() - 1;
+       (patch >= 0) && (status == kTfLiteOk); --patch) {
+    patch_plan_.SetPatch(patch);
+    for (int layer = 0;
+         (layer < patch_plan_.layer_count()) && (status == kTfLiteOk);
+         ++layer) {
+      status = InvokeNode(patch_plan_.SetLayerTensors(layer, eval_tensors_));
     }
   }
+  patch_plan_.RestoreTensors(eval_tensors_);
+  return status;
+}
 
+TfLiteStatus MicroInterpreter::InvokeStream() {
+  TfLiteStatus status = kTfLiteOk;
+  for (int layer = 0;
+       (layer < streaming_plan_.layer_count()) && (status == kTfLiteOk);
+       ++layer) {
+    const int band_count = streaming_plan_.StartLayer(layer, eval_tensors_);
+    for (int band = 0; (band < band_count) && (status == kTfLiteOk); ++band) {
+      status = InvokeNode(streaming_plan_.SetBand(layer, band, eval_tensors_));
+      streaming_plan_.RestoreBand(layer, eval_tensors_);
+    }
+  }
+  if (status == kTfLiteOk) {
+    streaming_plan_.FinishFrame();
+  }
+  return status;
+}
+
+TfLiteStatus MicroInterpreter::SetPatchCount(int patch_count) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetPatchCount() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (patch_count < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid patch count %d",
+                         patch_count);
+    return kTfLiteError;
+  }
+  if (streaming_ && (patch_count > 1)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Patches can't be used with streaming");
+    return kTfLiteError;
+  }
+  patch_count_ = patch_count;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::EnableStreaming() {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableStreaming() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (patch_count_ > 1) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Streaming can't be used with patches");
+    return kTfLiteError;
+  }
+  streaming_ = true;
   return kTfLiteOk;
 }
 
@@ -388,18 +671,23 @@ TfLiteTensor* MicroInterpreter::tensor(size_t index) {
 }
 
 TfLiteStatus MicroInterpreter::ResetVariableTensors() {
-  for (size_t i = 0; i < subgraph_->tensors()->size(); ++i) {
-    auto* tensor = subgraph_->tensors()->Get(i);
-    if (tensor->is_variable()) {
-      size_t buffer_size;
-      TF_LITE_ENSURE_STATUS(
-          TfLiteEvalTensorByteLength(&eval_tensors_[i], &buffer_size));
-
-      int value = 0;
-      if (tensor->type() == tflite::TensorType_INT8) {
-        value = tensor->quantization()->zero_point()->Get(0);
+  for (size_t s = 0; s < model_->subgraphs()->size(); ++s) {
+    const SubGraph* subgraph = model_->subgraphs()->Get(s);
+    TfLiteEvalTensor* eval_tensors =
+        eval_tensors_ + SubgraphTensorOffset(model_, s);
+    for (size_t i = 0; i < subgraph->tensors()->size(); ++i) {
+      auto* tensor = subgraph->tensors()->Get(i);
+      if (tensor->is_variable()) {
+        size_t buffer_size;
+        TF_LITE_ENSURE_STATUS(
+            TfLiteEvalTensorByteLength(&eval_tensors[i], &buffer_size));
+
+        int value = 0;
+        if (tensor->type() == tflite::TensorType_INT8) {
+          value = tensor->quantization()->zero_point()->Get(0);
+        }
+        memset(eval_tensors[i].data.raw, value, buffer_size);
       }
-      memset(eval_tensors_[i].data.raw, value, buffer_size);
     }
   }
 
@@ -23,8 +23,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_graph.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/micro/patch_plan.h"
+#include "tensorflow/lite/micro/streaming_plan.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -34,16 +37,19 @@ limitations under the License.
 
 namespace tflite {
 
+class MicroInterpreter;
+
 namespace internal {
 
 // A helper class to encapsulate the implementation of APIs in Context.
-// context->impl_ points to an instance of this class.
+// context->impl_ points to an instance of this class, as a MicroGraph.
 // Check tensorflow/lite/c/common.h for detailed descriptions.
 // TODO(b/16157777): Consider rolling this class into MicroInterpreter.
-class ContextHelper {
+class ContextHelper : public MicroGraph {
  public:
   explicit ContextHelper(ErrorReporter* error_reporter,
-                         MicroAllocator* allocator, const Model* model);
+                         MicroAllocator* allocator, const Model* model,
+                         MicroInterpreter* interpreter);
 
   // Functions that will be assigned to function pointers on TfLiteContext:
   static void* AllocatePersistentBuffer(TfLiteContext* ctx, size_t bytes);
@@ -51,6 +57,9 @@ class ContextHelper {
                                                   size_t bytes,
                                                   int* buffer_idx);
   static void* GetScratchBuffer(TfLiteContext* ctx, int buffer_idx);
+  static TfLiteStatus RequestInPlaceOutput(TfLiteContext* ctx,
+                                           int input_tensor_idx,
+                                           int output_tensor_idx);
   static void ReportOpError(struct TfLiteContext* context, const char* format,
                             ...);
   static TfLiteTensor* GetTensor(const struct TfLiteContext* context,
@@ -64,12 +73,34 @@ class ContextHelper {
   // Sets the pointer to a list of ScratchBufferHandle instances.
   void SetScratchBufferHandles(ScratchBufferHandle* scratch_buffer_handles);
 
+  // Makes the tensor indices that kernels pass to the context refer to the
+  // tensors of a subgraph, and returns the subgraph they referred to before.
+  int SetSubgraph(int subgraph_index);
+
+  // MicroGraph implementation, for control flow kernels.
+  int NumSubgraphs() override;
+  size_t NumSubgraphInputs(int subgraph_index) override;
+  size_t NumSubgraphOutputs(int subgraph_index) override;
+  TfLiteEvalTensor* GetSubgraphInput(int subgraph_index,
+                                     int input_index) override;
+  TfLiteEvalTensor* GetSubgraphOutput(int subgraph_index,
+                                      int output_index) override;
+  TfLiteStatus InvokeSubgraph(int subgraph_index) override;
+
  private:
+  static ContextHelper* FromContext(const TfLiteContext* context);
+
   MicroAllocator* allocator_ = nullptr;
   ErrorReporter* error_reporter_ = nullptr;
   const Model* model_ = nullptr;
+  MicroInterpreter* interpreter_ = nullptr;
   TfLiteEvalTensor* eval_tensors_ = nullptr;
   ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
+
+  // The subgraph whose nodes are being initialized, prepared or invoked, and
+  // the index of its first tensor in eval_tensors_.
+  int subgraph_index_ = 0;
+  size_t tensor_offset_ = 0;
 };
 
 }  // namespace internal
@@ -93,20 +124,55 @@ class MicroInterpreter {
   // have allocation handled in more than one interpreter or for recording
   // allocations inside the interpreter. The lifetime of the allocator must be
   // as long as that of the interpreter object.
+  //
+  // Interpreters that share an allocator keep their persistent allocations
+  // apart in the tail, and share the head for their other tensors. Only one of
+  // them can allocate or invoke at a time: AllocateTensors() and Invoke() fail
+  // while another one is running. Once another interpreter has run, the data
+  // of this one's non-persistent tensors, including its inputs and outputs, is
+  // gone, and Invoke() fails until ClaimArenaHead() is called before filling
+  // in the inputs again, see owns_arena_head().
   MicroInterpreter(const Model* model, const MicroOpResolver& op_resolver,
                    MicroAllocator* allocator, ErrorReporter* error_reporter,
                    MicroProfiler* profiler = nullptr);
 
-  ~MicroInterpreter();
+  virtual ~MicroInterpreter();
 
   // Runs through the model and allocates all necessary input, output and
   // intermediate tensors.
-  TfLiteStatus AllocateTensors();
+  virtual TfLiteStatus AllocateTensors();
 
+  // Invokes the first subgraph of the model. Other subgraphs are run by the IF
+  // and WHILE operators that call them.
   // In order to support partial graph runs for strided models, this can return
   // values other than kTfLiteOk and kTfLiteError.
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
-  TfLiteStatus Invoke();
+  virtual TfLiteStatus Invoke();
+
+  // Runs the leading conv, depthwise conv and pooling layers of the model in
+  // `patch_count` bands of rows, so that the large feature maps inside them
+  // are never held in full. The layers are chosen by AllocateTensors(), see
+  // patch_plan.h. Must be called before AllocateTensors().
+  TfLiteStatus SetPatchCount(int patch_count);
+
+  // Returns the plan made by AllocateTensors() when a patch count is set.
+  const PatchPlan& patch_plan() const { return patch_plan_; }
+
+  // Keeps the feature maps of the leading conv, depthwise conv and pooling
+  // layers of the model from one invoke to the next, so that InvokeStreaming()
+  // only computes the rows that depend on new input rows. The layers are
+  // chosen by AllocateTensors(), see streaming_plan.h. Must be called before
+  // AllocateTensors(), and can't be used with SetPatchCount().
+  TfLiteStatus EnableStreaming();
+
+  // Invokes the model after the input of the streamed layers moved up by
+  // `new_rows` rows along its height since the last invoke, with the new rows
+  // filled in at the bottom. The first call, and a call after Invoke() or a
+  // failed invoke, computes all of the rows.
+  TfLiteStatus InvokeStreaming(int new_rows);
+
+  // Returns the plan made by AllocateTensors() when streaming is enabled.
+  const StreamingPlan& streaming_plan() const { return streaming_plan_; }
 
   // size_t tensors_size() const { return context_.tensors_size; }
   size_t tensors_size() const { return subgraph_->tensors()->Length(); }
@@ -173,15 +239,55 @@ class MicroInterpreter {
   // arena_used_bytes() + 16.
   size_t arena_used_bytes() const { return allocator_.used_bytes(); }
 
+  // Returns false if another interpreter sharing the allocator has used the
+  // arena head since this one last did, which overwrites the data of this
+  // one's non-persistent tensors. Outputs are only valid until another
+  // interpreter runs.
+  bool owns_arena_head() const { return allocator_.HeadOwnedBy(this); }
+
+  // Takes the arena head back from the other interpreters sharing the
+  // allocator, so that Invoke() can run once the inputs are filled in again.
+  // Fails while another interpreter is allocating or invoking.
+  TfLiteStatus ClaimArenaHead();
+
  protected:
+  // Invokes a single node. Every node run by Invoke(), including those of the
+  // patch and streaming plans and of called subgraphs, goes through here.
+  virtual TfLiteStatus InvokeNode(int node_index);
+
+  // Called by AllocateTensors() once every node is prepared, before the memory
+  // plan is committed, to request scratch buffers that are used by the whole
+  // model rather than by one node, see
+  // MicroAllocator::RequestModelScratchBufferInArena().
+  virtual TfLiteStatus RequestModelScratchBuffers(
+      MicroAllocator* arena_allocator) {
+    return kTfLiteOk;
+  }
+
   const MicroAllocator& allocator() const { return allocator_; }
   const TfLiteContext& context() const { return context_; }
 
  private:
+  friend class internal::ContextHelper;
+
   // TODO(b/158263161): Consider switching to Create() function to enable better
   // error reporting during initialization.
   void Init(MicroProfiler* profiler);
 
+  // Invokes the model, with the input of the streaming plan moved up by
+  // `new_rows` rows, or by an unknown number if it is negative.
+  TfLiteStatus InvokeModel(int new_rows);
+
+  // Invokes the nodes of a subgraph called by a control flow node.
+  TfLiteStatus InvokeSubgraph(int subgraph_index);
+
+  // Invokes the nodes of the patch plan, one patch at a time.
+  TfLiteStatus InvokePatches();
+
+  // Invokes the nodes of the streaming plan, only computing the rows that
+  // changed since the last frame.
+  TfLiteStatus InvokeStream();
+
   NodeAndRegistration* node_and_registrations_ = nullptr;
 
   const Model* model_;
@@ -204,6 +310,12 @@ class MicroInterpreter {
   // from TfLiteEvalTensor.
   TfLiteTensor** input_tensors_;
   TfLiteTensor** output_tensors_;
+
+  int patch_count_ = 1;
+  PatchPlan patch_plan_;
+
+  bool streaming_ = false;
+  StreamingPlan streaming_plan_;
 };
 
 }  // namespace tflite
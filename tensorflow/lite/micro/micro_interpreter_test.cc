@@ -168,6 +168,7 @@ TF_LITE_MICRO_TEST(TestMultiTenantInterpreter) {
 
   // Now we have model1 and model2 sharing the same `allocator`.
   // Let's make sure that they can produce correct results.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.ClaimArenaHead());
   TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, input1->type);
   input1->data.i32[0] = 10;
   TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.Invoke());
@@ -175,6 +176,7 @@ TF_LITE_MICRO_TEST(TestMultiTenantInterpreter) {
   TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, output1->type);
   TF_LITE_MICRO_EXPECT_EQ(10, output1->data.i32[0]);
 
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.ClaimArenaHead());
   TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, input2->type);
   input2->data.i32[0] = 21;
   TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.Invoke());
@@ -202,6 +204,55 @@ TF_LITE_MICRO_TEST(TestMultiTenantInterpreter) {
       allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes());
 }
 
+TF_LITE_MICRO_TEST(TestMultiTenantInterpreterHeadHandoff) {
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  constexpr size_t arena_size = 8192;
+  uint8_t arena[arena_size];
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      arena, arena_size, tflite::GetMicroErrorReporter());
+
+  const tflite::Model* model = tflite::testing::GetSimpleMockModel();
+  tflite::MicroInterpreter interpreter1(model, op_resolver, allocator,
+                                        tflite::GetMicroErrorReporter());
+  tflite::MicroInterpreter interpreter2(model, op_resolver, allocator,
+                                        tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.AllocateTensors());
+
+  // The head was last used by interpreter2, so interpreter1 has to take it
+  // back before its inputs are filled in.
+  TF_LITE_MICRO_EXPECT_FALSE(interpreter1.owns_arena_head());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter1.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.ClaimArenaHead());
+  interpreter1.input(0)->data.i32[0] = 21;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.Invoke());
+  TF_LITE_MICRO_EXPECT_TRUE(interpreter1.owns_arena_head());
+  TF_LITE_MICRO_EXPECT_FALSE(interpreter2.owns_arena_head());
+  TF_LITE_MICRO_EXPECT_EQ(42, interpreter1.output(0)->data.i32[0]);
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter2.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.ClaimArenaHead());
+  interpreter2.input(0)->data.i32[0] = 10;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.Invoke());
+  TF_LITE_MICRO_EXPECT_FALSE(interpreter1.owns_arena_head());
+  TF_LITE_MICRO_EXPECT_TRUE(interpreter2.owns_arena_head());
+  TF_LITE_MICRO_EXPECT_EQ(31, interpreter2.output(0)->data.i32[0]);
+
+  // While another user holds the head, as a model that is mid-invoke would,
+  // neither interpreter can run.
+  int other_user;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator->AcquireHead(&other_user));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter1.ClaimArenaHead());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter2.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, allocator->AcquireHead(&other_user));
+  allocator->ReleaseHead(&other_user);
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.ClaimArenaHead());
+  interpreter1.input(0)->data.i32[0] = 5;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(26, interpreter1.output(0)->data.i32[0]);
+}
+
 TF_LITE_MICRO_TEST(TestKernelMemoryPlanning) {
   const tflite::Model* model = tflite::testing::GetSimpleStatefulModel();
   TF_LITE_MICRO_EXPECT_NE(nullptr, model);
@@ -552,4 +603,129 @@ TF_LITE_MICRO_TEST(TestInterpreterMultipleInputs) {
   TF_LITE_MICRO_EXPECT_EQ(tflite::testing::MultipleInputs::freed_, true);
 }
 
+TF_LITE_MICRO_TEST(TestInterpreterWithIf) {
+  const tflite::Model* model = tflite::testing::GetSimpleModelWithIf();
+  TF_LITE_MICRO_EXPECT_NE(nullptr, model);
+
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  constexpr size_t allocator_buffer_size = 3000;
+  uint8_t allocator_buffer[allocator_buffer_size];
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator_buffer,
+                                       allocator_buffer_size,
+                                       tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), interpreter.inputs_size());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1), interpreter.outputs_size());
+
+  TfLiteTensor* condition = interpreter.input(0);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteBool, condition->type);
+  TfLiteTensor* input = interpreter.input(1);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, input->type);
+  input->data.i32[0] = 1;
+
+  // The branch is picked again on every invoke, and the input is copied into
+  // it rather than modified.
+  condition->data.b[0] = true;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(22, interpreter.output(0)->data.i32[0]);
+
+  condition->data.b[0] = false;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(43, interpreter.output(0)->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(1, input->data.i32[0]);
+
+  condition->data.b[0] = true;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(22, interpreter.output(0)->data.i32[0]);
+}
+
+TF_LITE_MICRO_TEST(TestInterpreterWithWhile) {
+  const tflite::Model* model = tflite::testing::GetSimpleModelWithWhile();
+  TF_LITE_MICRO_EXPECT_NE(nullptr, model);
+
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  constexpr size_t allocator_buffer_size = 4000;
+  uint8_t allocator_buffer[allocator_buffer_size];
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator_buffer,
+                                       allocator_buffer_size,
+                                       tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), interpreter.inputs_size());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(2), interpreter.outputs_size());
+
+  TfLiteTensor* counter = interpreter.input(0);
+  TfLiteTensor* limit = interpreter.input(1);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, counter->type);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt32, limit->type);
+
+  // The body runs once per count, the limit passes through, and the inputs
+  // are copied into the loop rather than modified.
+  counter->data.i32[0] = 2;
+  limit->data.i32[0] = 7;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(7, interpreter.output(0)->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(7, interpreter.output(1)->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(2, counter->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(7, limit->data.i32[0]);
+
+  // With the condition false from the start, the body never runs and the
+  // inputs are the outputs.
+  counter->data.i32[0] = 9;
+  limit->data.i32[0] = 4;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(9, interpreter.output(0)->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(4, interpreter.output(1)->data.i32[0]);
+
+  counter->data.i32[0] = 0;
+  limit->data.i32[0] = 3;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(3, interpreter.output(0)->data.i32[0]);
+  TF_LITE_MICRO_EXPECT_EQ(3, interpreter.output(1)->data.i32[0]);
+}
+
+TF_LITE_MICRO_TEST(TestInterpreterWithInPlaceOps) {
+  const tflite::Model* model = tflite::testing::GetSimpleModelWithInPlaceOps();
+  TF_LITE_MICRO_EXPECT_NE(nullptr, model);
+
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  constexpr size_t allocator_buffer_size = 4000;
+  uint8_t allocator_buffer[allocator_buffer_size];
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator_buffer,
+                                       allocator_buffer_size,
+                                       tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The QUANTIZE to the same params and the RESHAPE write their outputs over
+  // their inputs, and so all use the buffer of the model input. The last
+  // QUANTIZE changes the params, so it gets a buffer of its own.
+  TfLiteTensor* input = interpreter.input(0);
+  TfLiteTensor* quantized = interpreter.tensor(1);
+  TfLiteTensor* reshaped = interpreter.tensor(2);
+  TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT_EQ(input->data.raw, quantized->data.raw);
+  TF_LITE_MICRO_EXPECT_EQ(input->data.raw, reshaped->data.raw);
+  TF_LITE_MICRO_EXPECT_NE(input->data.raw, output->data.raw);
+
+  // With input and output at the same address, the first QUANTIZE skips the
+  // requantization, and the values come through unchanged.
+  constexpr int size = 6;
+  const int8_t input_data[size] = {-3, -1, 0, 1, 5, 9};
+  for (int i = 0; i < size; ++i) input->data.int8[i] = input_data[i];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  for (int i = 0; i < size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(input_data[i], reshaped->data.int8[i]);
+    // 0.5 * (q - 1) = 0.25 * (2q - 3 + 1)
+    TF_LITE_MICRO_EXPECT_EQ(2 * input_data[i] - 3, output->data.int8[i]);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(2, reshaped->dims->size);
+  TF_LITE_MICRO_EXPECT_EQ(3, reshaped->dims->data[0]);
+  TF_LITE_MICRO_EXPECT_EQ(2, reshaped->dims->data[1]);
+}
+
 TF_LITE_MICRO_TESTS_END
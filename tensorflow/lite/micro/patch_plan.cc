@@ -0,0 +1,509 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/patch_plan.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+
+namespace {
+
+// Must match micro_allocator.cc.
+constexpr int kBufferAlignment = 16;
+
+void SetPatchDims(TfLiteIntArray* patch_dims, const TfLiteIntArray* dims,
+                  int rows) {
+  patch_dims->size = 4;
+  patch_dims->data[0] = dims->data[0];
+  patch_dims->data[1] = rows;
+  patch_dims->data[2] = dims->data[2];
+  patch_dims->data[3] = dims->data[3];
+}
+
+}  // namespace
+
+bool PatchPlan::IsOnlyReadBy(const SubGraph* subgraph, int tensor_index,
+                             int node_index) {
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    if (subgraph->outputs()->Get(i) == tensor_index) {
+      return false;
+    }
+  }
+  for (int i = 0; i < static_cast<int>(subgraph->operators()->size()); ++i) {
+    if (i == node_index) {
+      continue;
+    }
+    const auto* inputs = subgraph->operators()->Get(i)->inputs();
+    for (size_t n = 0; n < inputs->size(); ++n) {
+      if (inputs->Get(n) == tensor_index) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool PatchPlan::GetLayer(const NodeAndRegistration& node_and_registration,
+                         int node_index, const TfLiteEvalTensor* eval_tensors,
+                         Layer* layer) {
+  const TfLiteNode& node = node_and_registration.node;
+  if ((node.inputs->size < 1) || (node.outputs->size != 1)) {
+    return false;
+  }
+  const TfLiteEvalTensor& input = eval_tensors[node.inputs->data[0]];
+  const TfLiteEvalTensor& output = eval_tensors[node.outputs->data[0]];
+  if ((input.dims->size != 4) || (output.dims->size != 4) ||
+      (input.dims->data[0] != 1) || (output.dims->data[0] != 1) ||
+      (output.data.data != nullptr)) {
+    return false;
+  }
+
+  TfLitePadding padding;
+  int stride_height;
+  int stride_width;
+  int dilation_height = 1;
+  int dilation_width = 1;
+  int filter_height;
+  int filter_width;
+  int macs_per_output;
+  switch (node_and_registration.registration->builtin_code) {
+    case BuiltinOperator_CONV_2D:
+    case BuiltinOperator_DEPTHWISE_CONV_2D: {
+      if (node.inputs->size < 2) {
+        return false;
+      }
+      // Both filters have the height and width in dimensions 1 and 2.
+      const TfLiteEvalTensor& filter = eval_tensors[node.inputs->data[1]];
+      filter_height = filter.dims->data[1];
+      filter_width = filter.dims->data[2];
+      if (node_and_registration.registration->builtin_code ==
+          BuiltinOperator_CONV_2D) {
+        const auto* params =
+            static_cast<const TfLiteConvParams*>(node.builtin_data);
+        padding = params->padding;
+        stride_height = params->stride_height;
+        stride_width = params->stride_width;
+        dilation_height = params->dilation_height_factor;
+        dilation_width = params->dilation_width_factor;
+        macs_per_output = filter_height * filter_width * input.dims->data[3];
+      } else {
+        const auto* params =
+            static_cast<const TfLiteDepthwiseConvParams*>(node.builtin_data);
+        padding = params->padding;
+        stride_height = params->stride_height;
+        stride_width = params->stride_width;
+        dilation_height = params->dilation_height_factor;
+        dilation_width = params->dilation_width_factor;
+        macs_per_output = filter_height * filter_width;
+      }
+      break;
+    }
+    case BuiltinOperator_AVERAGE_POOL_2D:
+    case BuiltinOperator_MAX_POOL_2D: {
+      const auto* params =
+          static_cast<const TfLitePoolParams*>(node.builtin_data);
+      padding = params->padding;
+      stride_height = params->stride_height;
+      stride_width = params->stride_width;
+      filter_height = params->filter_height;
+      filter_width = params->filter_width;
+      macs_per_output = filter_height * filter_width;
+      break;
+    }
+    default:
+      return false;
+  }
+
+  // The same padding as the kernels work out in Prepare.
+  int unused_output_height;
+  int unused_output_width;
+  const TfLitePaddingValues padding_values = ComputePaddingHeightWidth(
+      stride_height, stride_width, dilation_height, dilation_width,
+      input.dims->data[1], input.dims->data[2], filter_height, filter_width,
+      padding, &unused_output_height, &unused_output_width);
+
+  size_t input_bytes;
+  size_t output_bytes;
+  if ((TfLiteEvalTensorByteLength(&input, &input_bytes) != kTfLiteOk) ||
+      (TfLiteEvalTensorByteLength(&output, &output_bytes) != kTfLiteOk)) {
+    return false;
+  }
+
+  layer->node_index = node_index;
+  layer->input_tensor = node.inputs->data[0];
+  layer->output_tensor = node.outputs->data[0];
+  layer->stride = stride_height;
+  layer->span = (filter_height - 1) * dilation_height + 1;
+  layer->padding = padding_values.height;
+  layer->input_height = input.dims->data[1];
+  layer->output_height = output.dims->data[1];
+  layer->input_row_bytes = input_bytes / layer->input_height;
+  layer->output_row_bytes = output_bytes / layer->output_height;
+  layer->macs_per_row = static_cast<int64_t>(output.dims->data[2]) *
+                        output.dims->data[3] * macs_per_output;
+  layer->planned_rows = layer->output_height;
+  return true;
+}
+
+void PatchPlan::SetPatchRows(Layer* layers, int layer_count, int patch_count,
+                             int patch) {
+  // The band of the stage output that this patch computes.
+  const int height = layers[layer_count - 1].output_height;
+  int needed_start = height * patch / patch_count;
+  int needed_end = height * (patch + 1) / patch_count;
+  for (int i = layer_count - 1; i >= 0; --i) {
+    Layer* layer = &layers[i];
+    // The first input row must sit `padding` rows below the start of a
+    // computed output row, so start early enough to cover the padding with
+    // real rows, unless the band reaches the top.
+    int lead_in = (layer->padding + layer->stride - 1) / layer->stride;
+    if (lead_in > needed_start) {
+      lead_in = needed_start;
+    }
+    layer->computed_start = needed_start - lead_in;
+    layer->computed_end = needed_end;
+    layer->read_start = layer->computed_start * layer->stride;
+    layer->read_end =
+        (needed_end - 1) * layer->stride - layer->padding + layer->span;
+    if (layer->read_end > layer->input_height) {
+      layer->read_end = layer->input_height;
+    }
+    needed_start = layer->read_start;
+    needed_end = layer->read_end;
+  }
+}
+
+TfLiteStatus PatchPlan::Init(ErrorReporter* error_reporter,
+                             MicroAllocator* allocator,
+                             const SubGraph* subgraph,
+                             NodeAndRegistration* node_and_registrations,
+                             TfLiteEvalTensor* eval_tensors,
+                             int patch_count) {
+  error_reporter_ = error_reporter;
+  layer_count_ = 0;
+  patch_count_ = patch_count;
+  const int node_count = subgraph->operators()->size();
+  const int tensor_count = subgraph->tensors()->size();
+
+  // Everything below is only needed for planning, so it lives in the temp
+  // section.
+  Layer* candidates = reinterpret_cast<Layer*>(allocator->AllocateTempBuffer(
+      sizeof(Layer) * kMaxLayers, alignof(Layer)));
+  int* first_used = reinterpret_cast<int*>(allocator->AllocateTempBuffer(
+      sizeof(int) * tensor_count, alignof(int)));
+  int* last_used = reinterpret_cast<int*>(allocator->AllocateTempBuffer(
+      sizeof(int) * tensor_count, alignof(int)));
+  size_t* live_bytes = reinterpret_cast<size_t*>(allocator->AllocateTempBuffer(
+      sizeof(size_t) * node_count, alignof(size_t)));
+  if ((candidates == nullptr) || (first_used == nullptr) ||
+      (last_used == nullptr) || (live_bytes == nullptr)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the patch plan");
+    allocator->ResetTempAllocations();
+    return kTfLiteError;
+  }
+
+  // Find the chain of supported layers, each only feeding the next.
+  int candidate_count = 0;
+  for (int i = 0; (i < node_count) && (candidate_count < kMaxLayers); ++i) {
+    Layer* layer = &candidates[candidate_count];
+    if (!GetLayer(node_and_registrations[i], i, eval_tensors, layer)) {
+      if (candidate_count > 0) {
+        break;
+      }
+      continue;
+    }
+    if (candidate_count > 0) {
+      const Layer& previous = candidates[candidate_count - 1];
+      if ((layer->input_tensor != previous.output_tensor) ||
+          !IsOnlyReadBy(subgraph, previous.output_tensor, i)) {
+        break;
+      }
+    }
+    ++candidate_count;
+  }
+
+  // Work out the lifetimes of the tensors in the head in the same way as
+  // MicroAllocator, and the bytes that are live at each node.
+  for (int i = 0; i < tensor_count; ++i) {
+    first_used[i] = -1;
+    last_used[i] = -1;
+  }
+  for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
+    first_used[subgraph->inputs()->Get(i)] = 0;
+  }
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    last_used[subgraph->outputs()->Get(i)] = node_count - 1;
+  }
+  for (int i = 0; i < node_count; ++i) {
+    const auto* op = subgraph->operators()->Get(i);
+    for (size_t n = 0; n < op->inputs()->size(); ++n) {
+      const int tensor_index = op->inputs()->Get(n);
+      if ((tensor_index >= 0) && (last_used[tensor_index] < i)) {
+        last_used[tensor_index] = i;
+      }
+    }
+    for (size_t n = 0; n < op->outputs()->size(); ++n) {
+      const int tensor_index = op->outputs()->Get(n);
+      if ((first_used[tensor_index] == -1) || (first_used[tensor_index] > i)) {
+        first_used[tensor_index] = i;
+      }
+    }
+  }
+  for (int i = 0; i < node_count; ++i) {
+    live_bytes[i] = 0;
+  }
+  for (int i = 0; i < tensor_count; ++i) {
+    size_t bytes;
+    if ((eval_tensors[i].data.data != nullptr) ||
+        subgraph->tensors()->Get(i)->is_variable() || (last_used[i] == -1) ||
+        (TfLiteEvalTensorByteLength(&eval_tensors[i], &bytes) != kTfLiteOk)) {
+      // Not in the head, or never used.
+      last_used[i] = -1;
+      continue;
+    }
+    if (first_used[i] == -1) {
+      first_used[i] = 0;
+    }
+    for (int n = first_used[i]; n <= last_used[i]; ++n) {
+      live_bytes[n] += AlignSizeUp(bytes, kBufferAlignment);
+    }
+  }
+  size_t unpatched_peak_bytes = 0;
+  for (int i = 0; i < node_count; ++i) {
+    if (live_bytes[i] > unpatched_peak_bytes) {
+      unpatched_peak_bytes = live_bytes[i];
+    }
+  }
+
+  // Try every stage length with at least one feature map inside it, and keep
+  // the shortest one with the lowest peak.
+  int best_layer_count = 0;
+  int best_patch_count = 0;
+  size_t best_peak_bytes = unpatched_peak_bytes;
+  for (int count = 2; count <= candidate_count; ++count) {
+    const Layer& first = candidates[0];
+    const Layer& last = candidates[count - 1];
+    const int stage_patch_count = (patch_count < last.output_height)
+                                      ? patch_count
+                                      : last.output_height;
+    for (int i = 0; i < count; ++i) {
+      candidates[i].planned_rows = 0;
+    }
+    for (int patch = 0; patch < stage_patch_count; ++patch) {
+      SetPatchRows(candidates, count, stage_patch_count, patch);
+      for (int i = 0; i < count; ++i) {
+        const int rows =
+            candidates[i].computed_end - candidates[i].computed_start;
+        if (rows > candidates[i].planned_rows) {
+          candidates[i].planned_rows = rows;
+        }
+      }
+    }
+
+    // While the stage runs, its input, output and patch buffers are all held,
+    // along with anything else that is live during the stage.
+    size_t stage_bytes = 0;
+    for (int i = 0; i < tensor_count; ++i) {
+      if ((last_used[i] == -1) || (first_used[i] > last.node_index) ||
+          (last_used[i] < first.node_index)) {
+        continue;
+      }
+      size_t bytes;
+      TfLiteEvalTensorByteLength(&eval_tensors[i], &bytes);
+      for (int n = 0; n < count - 1; ++n) {
+        if (candidates[n].output_tensor == i) {
+          bytes = candidates[n].planned_rows * candidates[n].output_row_bytes;
+        }
+      }
+      stage_bytes += AlignSizeUp(bytes, kBufferAlignment);
+    }
+    size_t peak_bytes = stage_bytes;
+    for (int i = 0; i < node_count; ++i) {
+      if (((i < first.node_index) || (i > last.node_index)) &&
+          (live_bytes[i] > peak_bytes)) {
+        peak_bytes = live_bytes[i];
+      }
+    }
+    if (peak_bytes < best_peak_bytes) {
+      best_layer_count = count;
+      best_patch_count = stage_patch_count;
+      best_peak_bytes = peak_bytes;
+    }
+  }
+
+  TfLiteStatus status = kTfLiteOk;
+  if (best_layer_count > 0) {
+    status = Commit(allocator, candidates, best_layer_count, best_patch_count);
+    unpatched_peak_bytes_ = unpatched_peak_bytes;
+    patched_peak_bytes_ = best_peak_bytes;
+  }
+  allocator->ResetTempAllocations();
+  return status;
+}
+
+TfLiteStatus PatchPlan::Commit(MicroAllocator* allocator,
+                               Layer* candidates, int layer_count,
+                               int patch_count) {
+  // Redo the chosen stage's rows, and count the work it does.
+  stage_macs_ = 0;
+  patched_stage_macs_ = 0;
+  for (int i = 0; i < layer_count; ++i) {
+    candidates[i].planned_rows = 0;
+    stage_macs_ += candidates[i].output_height * candidates[i].macs_per_row;
+  }
+  for (int patch = 0; patch < patch_count; ++patch) {
+    SetPatchRows(candidates, layer_count, patch_count, patch);
+    for (int i = 0; i < layer_count; ++i) {
+      const int rows =
+          candidates[i].computed_end - candidates[i].computed_start;
+      if (rows > candidates[i].planned_rows) {
+        candidates[i].planned_rows = rows;
+      }
+      patched_stage_macs_ += rows * candidates[i].macs_per_row;
+    }
+  }
+
+  // The plan lives as long as the model, in the tail.
+  const int tensor_count = layer_count + 1;
+  const size_t dims_bytes = TfLiteIntArrayGetSizeInBytes(4);
+  layers_ = reinterpret_cast<Layer*>(
+      allocator->AllocatePersistentBuffer(sizeof(Layer) * layer_count));
+  tensor_data_ = reinterpret_cast<void**>(
+      allocator->AllocatePersistentBuffer(sizeof(void*) * tensor_count));
+  tensor_dims_ = reinterpret_cast<TfLiteIntArray**>(
+      allocator->AllocatePersistentBuffer(sizeof(TfLiteIntArray*) *
+                                          tensor_count));
+  patch_dims_ = reinterpret_cast<TfLiteIntArray**>(
+      allocator->AllocatePersistentBuffer(sizeof(TfLiteIntArray*) *
+                                          tensor_count));
+  uint8_t* dims_data = reinterpret_cast<uint8_t*>(
+      allocator->AllocatePersistentBuffer(dims_bytes * tensor_count));
+  if ((layers_ == nullptr) || (tensor_data_ == nullptr) ||
+      (tensor_dims_ == nullptr) || (patch_dims_ == nullptr) ||
+      (dims_data == nullptr)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the patch plan");
+    return kTfLiteError;
+  }
+  for (int i = 0; i < layer_count; ++i) {
+    layers_[i] = candidates[i];
+  }
+  for (int i = 0; i < tensor_count; ++i) {
+    patch_dims_[i] = reinterpret_cast<TfLiteIntArray*>(dims_data);
+    dims_data += dims_bytes;
+  }
+
+  // The stage input and output are held in full across the stage, and the
+  // feature maps inside it only need the rows of the largest patch.
+  const int first_node = layers_[0].node_index;
+  const int last_node = layers_[layer_count - 1].node_index;
+  TF_LITE_ENSURE_STATUS(allocator->RequestTensorPlan(
+      layers_[0].input_tensor, 0, first_node, last_node));
+  for (int i = 0; i < layer_count - 1; ++i) {
+    TF_LITE_ENSURE_STATUS(allocator->RequestTensorPlan(
+        layers_[i].output_tensor,
+        layers_[i].planned_rows * layers_[i].output_row_bytes, first_node,
+        last_node));
+  }
+  TF_LITE_ENSURE_STATUS(allocator->RequestTensorPlan(
+      layers_[layer_count - 1].output_tensor, 0, first_node, last_node));
+
+  layer_count_ = layer_count;
+  patch_count_ = patch_count;
+  return kTfLiteOk;
+}
+
+void PatchPlan::SaveTensors(const TfLiteEvalTensor* eval_tensors) {
+  for (int i = 0; i < layer_count_; ++i) {
+    const TfLiteEvalTensor& input = eval_tensors[layers_[i].input_tensor];
+    tensor_data_[i] = input.data.data;
+    tensor_dims_[i] = input.dims;
+  }
+  const TfLiteEvalTensor& output =
+      eval_tensors[layers_[layer_count_ - 1].output_tensor];
+  tensor_data_[layer_count_] = output.data.data;
+  tensor_dims_[layer_count_] = output.dims;
+}
+
+void PatchPlan::SetPatch(int patch) {
+  SetPatchRows(layers_, layer_count_, patch_count_, patch);
+}
+
+int PatchPlan::SetLayerTensors(int layer_index,
+                               TfLiteEvalTensor* eval_tensors) {
+  const Layer& layer = layers_[layer_index];
+
+  // The stage input is held in full, and the other inputs from the first row
+  // that the previous layer computed.
+  const int input_origin =
+      (layer_index == 0) ? 0 : layers_[layer_index - 1].computed_start;
+  TfLiteEvalTensor* input = &eval_tensors[layer.input_tensor];
+  input->data.data = static_cast<uint8_t*>(tensor_data_[layer_index]) +
+                     (layer.read_start - input_origin) * layer.input_row_bytes;
+  SetPatchDims(patch_dims_[layer_index], tensor_dims_[layer_index],
+               layer.read_end - layer.read_start);
+  input->dims = patch_dims_[layer_index];
+
+  // Likewise for the stage output and the other outputs.
+  const int output_origin =
+      (layer_index == layer_count_ - 1) ? 0 : layer.computed_start;
+  TfLiteEvalTensor* output = &eval_tensors[layer.output_tensor];
+  output->data.data =
+      static_cast<uint8_t*>(tensor_data_[layer_index + 1]) +
+      (layer.computed_start - output_origin) * layer.output_row_bytes;
+  SetPatchDims(patch_dims_[layer_index + 1], tensor_dims_[layer_index + 1],
+               layer.computed_end - layer.computed_start);
+  output->dims = patch_dims_[layer_index + 1];
+
+  return layer.node_index;
+}
+
+void PatchPlan::RestoreTensors(TfLiteEvalTensor* eval_tensors) const {
+  for (int i = 0; i < layer_count_; ++i) {
+    TfLiteEvalTensor* input = &eval_tensors[layers_[i].input_tensor];
+    input->data.data = tensor_data_[i];
+    input->dims = tensor_dims_[i];
+  }
+  TfLiteEvalTensor* output =
+      &eval_tensors[layers_[layer_count_ - 1].output_tensor];
+  output->data.data = tensor_data_[layer_count_];
+  output->dims = tensor_dims_[layer_count_];
+}
+
+void PatchPlan::PrintReport() const {
+  if (error_reporter_ == nullptr) {
+    return;
+  }
+  if (!active()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "[PatchPlan] No stage lowers the peak memory");
+    return;
+  }
+  TF_LITE_REPORT_ERROR(
+      error_reporter_,
+      "[PatchPlan] Nodes %d to %d run in %d patches: peak %d -> %d bytes, "
+      "%d%% more compute in the stage",
+      first_node(), last_node(), patch_count_,
+      static_cast<int>(unpatched_peak_bytes_),
+      static_cast<int>(patched_peak_bytes_),
+      static_cast<int>((patched_stage_macs_ - stage_macs_) * 100 /
+                       stage_macs_));
+}
+
+}  // namespace tflite
@@ -0,0 +1,160 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_PATCH_PLAN_H_
+#define TENSORFLOW_LITE_MICRO_PATCH_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Plans patch-based inference, where the leading stage of CONV_2D,
+// DEPTHWISE_CONV_2D, AVERAGE_POOL_2D and MAX_POOL_2D layers of a model is run
+// one band of rows at a time. Only the feature map at the end of the stage is
+// held in full, while the larger ones inside it only get a band's worth of
+// rows, which lowers the arena high-water mark of models whose first layers
+// work at a high resolution.
+//
+// Each band of the stage output is worked back through the layers to the rows
+// it needs from each of them, so the halo rows between bands are computed by
+// both neighbours. Kernels pad their input by a fixed number of rows from
+// Prepare, so a band that doesn't start at the top also computes a few
+// lead-in rows, until its input starts past that padding. Those rows are
+// thrown away. In the stage output they land on the band above, so bands are
+// run bottom up and the band above overwrites them.
+//
+// The kernels in the stage must read tensor shapes from their
+// TfLiteEvalTensors when invoked, as the reference kernels do.
+class PatchPlan {
+ public:
+  // The most layers a stage can have.
+  static constexpr int kMaxLayers = 8;
+
+  // The rows of a layer in the stage. StreamingPlan uses the same layers.
+  struct Layer {
+    int node_index;
+    int input_tensor;
+    int output_tensor;
+    int stride;
+    // Input rows that one output row reads.
+    int span;
+    // Rows of padding the kernel adds above its input.
+    int padding;
+    int input_height;
+    int output_height;
+    size_t input_row_bytes;
+    size_t output_row_bytes;
+    int64_t macs_per_row;
+    // Rows of the output that are held while the stage runs.
+    int planned_rows;
+    // Rows of the current patch: the input rows read, and the output rows
+    // computed, including lead-in rows.
+    int read_start;
+    int read_end;
+    int computed_start;
+    int computed_end;
+  };
+
+  // Fills in a Layer for a node, or returns false if the node can't be part
+  // of a stage.
+  static bool GetLayer(const NodeAndRegistration& node_and_registration,
+                       int node_index, const TfLiteEvalTensor* eval_tensors,
+                       Layer* layer);
+
+  // Returns true if the tensor is only read by the given node, and isn't a
+  // model output.
+  static bool IsOnlyReadBy(const SubGraph* subgraph, int tensor_index,
+                           int node_index);
+
+  // Finds the longest chain of supported layers, starting from the first one
+  // in the model, and the number of its layers that gives the lowest peak
+  // memory when run in `patch_count` bands. Asks `allocator` to plan the
+  // tensors of that stage accordingly. The plan stays inactive if no stage
+  // lowers the peak. Must be called after all nodes are prepared and before
+  // MicroAllocator::FinishModelAllocation().
+  TfLiteStatus Init(ErrorReporter* error_reporter, MicroAllocator* allocator,
+                    const SubGraph* subgraph,
+                    NodeAndRegistration* node_and_registrations,
+                    TfLiteEvalTensor* eval_tensors, int patch_count);
+
+  bool active() const { return layer_count_ > 0; }
+  int first_node() const { return layers_[0].node_index; }
+  int last_node() const { return layers_[layer_count_ - 1].node_index; }
+  int layer_count() const { return layer_count_; }
+  int patch_count() const { return patch_count_; }
+
+  // Saves the buffers and shapes of the stage tensors, before running the
+  // stage.
+  void SaveTensors(const TfLiteEvalTensor* eval_tensors);
+
+  // Works out the rows that each layer computes for a patch.
+  void SetPatch(int patch);
+
+  // Points the input and output of a layer at the rows of the current patch,
+  // and returns the index of its node.
+  int SetLayerTensors(int layer_index, TfLiteEvalTensor* eval_tensors);
+
+  // Restores the buffers and shapes saved by SaveTensors().
+  void RestoreTensors(TfLiteEvalTensor* eval_tensors) const;
+
+  // Estimated peak bytes of the tensors in the arena head, without and with
+  // patching. Only set when the plan is active.
+  size_t unpatched_peak_bytes() const { return unpatched_peak_bytes_; }
+  size_t patched_peak_bytes() const { return patched_peak_bytes_; }
+
+  // Multiply-accumulates (or pooled elements) in the stage, without and with
+  // patching. Only set when the plan is active.
+  int64_t stage_macs() const { return stage_macs_; }
+  int64_t patched_stage_macs() const { return patched_stage_macs_; }
+
+  // Logs the stage, the peak memory reduction and the extra compute.
+  void PrintReport() const;
+
+ private:
+  // Works out the rows of every layer in `layers` for a patch of a stage of
+  // `layer_count` layers.
+  static void SetPatchRows(Layer* layers, int layer_count, int patch_count,
+                           int patch);
+
+  // Keeps the first `layer_count` candidate layers as the stage, and asks the
+  // allocator to plan its tensors.
+  TfLiteStatus Commit(MicroAllocator* allocator, Layer* candidates,
+                      int layer_count, int patch_count);
+
+  ErrorReporter* error_reporter_ = nullptr;
+  Layer* layers_ = nullptr;
+  int layer_count_ = 0;
+  int patch_count_ = 1;
+
+  // Buffers and shapes of the stage tensors while running the stage: the
+  // input of each layer, then the output of the last one.
+  void** tensor_data_ = nullptr;
+  TfLiteIntArray** tensor_dims_ = nullptr;
+  TfLiteIntArray** patch_dims_ = nullptr;
+
+  size_t unpatched_peak_bytes_ = 0;
+  size_t patched_peak_bytes_ = 0;
+  int64_t stage_macs_ = 0;
+  int64_t patched_stage_macs_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_PATCH_PLAN_H_
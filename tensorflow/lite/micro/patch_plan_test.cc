@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/patch_plan.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kArenaSize = 12 * 1024;
+uint8_t unpatched_arena[kArenaSize];
+uint8_t patched_arena[kArenaSize];
+
+void FillInput(TfLiteTensor* input) {
+  const int element_count = input->bytes / sizeof(float);
+  for (int i = 0; i < element_count; ++i) {
+    input->data.f[i] = static_cast<float>((i * 7) % 17) / 8.0f - 1.0f;
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestPatchedModelMatchesUnpatchedModel) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter unpatched(model, op_resolver, unpatched_arena,
+                                     kArenaSize,
+                                     tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, unpatched.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_FALSE(unpatched.patch_plan().active());
+
+  tflite::MicroInterpreter patched(model, op_resolver, patched_arena,
+                                   kArenaSize, tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, patched.SetPatchCount(0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.SetPatchCount(2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, patched.SetPatchCount(3));
+
+  // The two convolutions and the pooling that follows them form the stage.
+  const tflite::PatchPlan& plan = patched.patch_plan();
+  TF_LITE_MICRO_EXPECT_TRUE(plan.active());
+  TF_LITE_MICRO_EXPECT_EQ(1, plan.first_node());
+  TF_LITE_MICRO_EXPECT_EQ(3, plan.last_node());
+  TF_LITE_MICRO_EXPECT_EQ(2, plan.patch_count());
+  TF_LITE_MICRO_EXPECT_LT(plan.patched_peak_bytes(),
+                          plan.unpatched_peak_bytes());
+  TF_LITE_MICRO_EXPECT_GE(plan.patched_stage_macs(), plan.stage_macs());
+  TF_LITE_MICRO_EXPECT_LT(patched.arena_used_bytes(),
+                          unpatched.arena_used_bytes());
+  plan.PrintReport();
+
+  FillInput(unpatched.input(0));
+  FillInput(patched.input(0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, unpatched.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.Invoke());
+
+  const TfLiteTensor* unpatched_output = unpatched.output(0);
+  const TfLiteTensor* patched_output = patched.output(0);
+  TF_LITE_MICRO_EXPECT_EQ(unpatched_output->bytes, patched_output->bytes);
+  const int element_count = unpatched_output->bytes / sizeof(float);
+  for (int i = 0; i < element_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(unpatched_output->data.f[i],
+                            patched_output->data.f[i]);
+  }
+
+  // A second run starts from the restored tensors.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.Invoke());
+  for (int i = 0; i < element_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(unpatched_output->data.f[i],
+                            patched_output->data.f[i]);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
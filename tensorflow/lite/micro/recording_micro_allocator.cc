@@ -148,7 +148,7 @@ TfLiteStatus RecordingMicroAllocator::AllocateNodeAndRegistrations(
   // the accounting by decrementing by 1 and adding the actual number of nodes
   // used in the graph:
   recorded_node_and_registration_array_data_.count +=
-      GetSubGraphFromModel(model)->operators()->size() - 1;
+      SubgraphNodeOffset(model, model->subgraphs()->size()) - 1;
   return status;
 }
 
@@ -181,7 +181,7 @@ TfLiteStatus RecordingMicroAllocator::AllocateTfLiteEvalTensors(
   // the accounting by decrementing by 1 and adding the actual number of tensors
   // used in the graph:
   recorded_tflite_eval_tensor_data_.count +=
-      GetSubGraphFromModel(model)->tensors()->size() - 1;
+      SubgraphTensorOffset(model, model->subgraphs()->size()) - 1;
   return status;
 }
 
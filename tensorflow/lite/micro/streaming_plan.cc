@@ -0,0 +1,308 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/streaming_plan.h"
+
+#include <cstring>
+
+namespace tflite {
+
+namespace {
+
+void SetBandDims(TfLiteIntArray* band_dims, const TfLiteIntArray* dims,
+                 int rows) {
+  band_dims->size = 4;
+  band_dims->data[0] = dims->data[0];
+  band_dims->data[1] = rows;
+  band_dims->data[2] = dims->data[2];
+  band_dims->data[3] = dims->data[3];
+}
+
+}  // namespace
+
+TfLiteStatus StreamingPlan::Init(ErrorReporter* error_reporter,
+                                 MicroAllocator* allocator,
+                                 const SubGraph* subgraph,
+                                 NodeAndRegistration* node_and_registrations,
+                                 TfLiteEvalTensor* eval_tensors) {
+  error_reporter_ = error_reporter;
+  layer_count_ = 0;
+  state_valid_ = false;
+  const int node_count = subgraph->operators()->size();
+
+  PatchPlan::Layer* candidates =
+      reinterpret_cast<PatchPlan::Layer*>(allocator->AllocateTempBuffer(
+          sizeof(PatchPlan::Layer) * kMaxLayers, alignof(PatchPlan::Layer)));
+  if (candidates == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the streaming plan");
+    return kTfLiteError;
+  }
+
+  // Find the chain of supported layers, each only feeding the next.
+  int candidate_count = 0;
+  for (int i = 0; (i < node_count) && (candidate_count < kMaxLayers); ++i) {
+    PatchPlan::Layer* layer = &candidates[candidate_count];
+    if (!PatchPlan::GetLayer(node_and_registrations[i], i, eval_tensors,
+                             layer)) {
+      if (candidate_count > 0) {
+        break;
+      }
+      continue;
+    }
+    if (candidate_count > 0) {
+      const PatchPlan::Layer& previous = candidates[candidate_count - 1];
+      if ((layer->input_tensor != previous.output_tensor) ||
+          !PatchPlan::IsOnlyReadBy(subgraph, previous.output_tensor, i)) {
+        break;
+      }
+    }
+    ++candidate_count;
+  }
+  if (candidate_count == 0) {
+    allocator->ResetTempAllocations();
+    return kTfLiteOk;
+  }
+
+  // The plan and the feature maps live as long as the model, in the tail.
+  const size_t dims_bytes = TfLiteIntArrayGetSizeInBytes(4);
+  size_t max_saved_bytes = 0;
+  for (int i = 0; i < candidate_count; ++i) {
+    const PatchPlan::Layer& layer = candidates[i];
+    const int lead_in = (layer.padding + layer.stride - 1) / layer.stride;
+    if (lead_in * layer.output_row_bytes > max_saved_bytes) {
+      max_saved_bytes = lead_in * layer.output_row_bytes;
+    }
+  }
+  layers_ = reinterpret_cast<Layer*>(
+      allocator->AllocatePersistentBuffer(sizeof(Layer) * candidate_count));
+  band_input_dims_ = reinterpret_cast<TfLiteIntArray*>(
+      allocator->AllocatePersistentBuffer(dims_bytes));
+  band_output_dims_ = reinterpret_cast<TfLiteIntArray*>(
+      allocator->AllocatePersistentBuffer(dims_bytes));
+  if (max_saved_bytes > 0) {
+    saved_rows_ = reinterpret_cast<uint8_t*>(
+        allocator->AllocatePersistentBuffer(max_saved_bytes));
+  }
+  if ((layers_ == nullptr) || (band_input_dims_ == nullptr) ||
+      (band_output_dims_ == nullptr) ||
+      ((max_saved_bytes > 0) && (saved_rows_ == nullptr))) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the streaming plan");
+    allocator->ResetTempAllocations();
+    return kTfLiteError;
+  }
+
+  // Buffers that are already set aren't planned in the head by
+  // MicroAllocator::FinishModelAllocation().
+  state_bytes_ = max_saved_bytes;
+  stage_macs_ = 0;
+  for (int i = 0; i < candidate_count; ++i) {
+    const PatchPlan::Layer& rows = candidates[i];
+    const size_t output_bytes = rows.output_height * rows.output_row_bytes;
+    void* output_data = allocator->AllocatePersistentBuffer(output_bytes);
+    if (output_data == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate %d bytes for the output of "
+                           "node %d",
+                           static_cast<int>(output_bytes), rows.node_index);
+      allocator->ResetTempAllocations();
+      return kTfLiteError;
+    }
+    eval_tensors[rows.output_tensor].data.data = output_data;
+    layers_[i].rows = rows;
+    state_bytes_ += output_bytes;
+    stage_macs_ += rows.output_height * rows.macs_per_row;
+  }
+
+  layer_count_ = candidate_count;
+  allocator->ResetTempAllocations();
+  return kTfLiteOk;
+}
+
+void StreamingPlan::SetBandRows(PatchPlan::Layer* rows, int start, int end) {
+  // As in PatchPlan, a band that doesn't start at the top starts early enough
+  // to cover the padding the kernel adds above its input with real rows.
+  int lead_in = (rows->padding + rows->stride - 1) / rows->stride;
+  if (lead_in > start) {
+    lead_in = start;
+  }
+  rows->computed_start = start - lead_in;
+  rows->computed_end = end;
+  rows->read_start = rows->computed_start * rows->stride;
+  rows->read_end = (end - 1) * rows->stride - rows->padding + rows->span;
+  if (rows->read_end > rows->input_height) {
+    rows->read_end = rows->input_height;
+  }
+}
+
+void StreamingPlan::StartFrame(int new_rows) {
+  frame_macs_ = 0;
+  int shift = state_valid_ ? new_rows : kUnknownShift;
+  state_valid_ = false;
+
+  // The rows at the top and bottom of the layer input that aren't the same as
+  // the rows `shift` further down in the last frame.
+  int changed_top = 0;
+  int changed_bottom = shift;
+  for (int i = 0; i < layer_count_; ++i) {
+    Layer* layer = &layers_[i];
+    const PatchPlan::Layer& rows = layer->rows;
+    layer->input_shift = shift;
+    layer->output_shift = kUnknownShift;
+    layer->kept_start = 0;
+    layer->kept_end = 0;
+
+    if ((shift == 0) && (changed_top == 0) && (changed_bottom == 0)) {
+      // Nothing moved, so the output from the last frame stands.
+      layer->output_shift = 0;
+      layer->kept_end = rows.output_height;
+      layer->band_count = 0;
+      continue;
+    }
+
+    if ((shift > 0) && ((shift % rows.stride) == 0)) {
+      layer->output_shift = shift / rows.stride;
+      // Keep the output rows that only read unchanged input rows, and that
+      // were computed in the last frame.
+      layer->kept_start = (changed_top + rows.padding + rows.stride - 1) /
+                          rows.stride;
+      const int last_kept_origin =
+          rows.input_height - changed_bottom - rows.span + rows.padding;
+      layer->kept_end =
+          (last_kept_origin < 0) ? 0 : (last_kept_origin / rows.stride + 1);
+      if (layer->kept_end > rows.output_height - layer->output_shift) {
+        layer->kept_end = rows.output_height - layer->output_shift;
+      }
+    }
+
+    if (layer->kept_start >= layer->kept_end) {
+      // Compute the whole layer, and all the layers after it.
+      layer->output_shift = kUnknownShift;
+      layer->kept_start = 0;
+      layer->kept_end = 0;
+      layer->band_count = 1;
+      shift = kUnknownShift;
+      continue;
+    }
+
+    layer->band_count = ((layer->kept_start > 0) ? 1 : 0) +
+                        ((layer->kept_end < rows.output_height) ? 1 : 0);
+    shift = layer->output_shift;
+    changed_top = layer->kept_start;
+    changed_bottom = rows.output_height - layer->kept_end;
+  }
+}
+
+int StreamingPlan::StartLayer(int layer_index,
+                              const TfLiteEvalTensor* eval_tensors) {
+  const Layer& layer = layers_[layer_index];
+  const TfLiteEvalTensor& input = eval_tensors[layer.rows.input_tensor];
+  const TfLiteEvalTensor& output = eval_tensors[layer.rows.output_tensor];
+  input_data_ = input.data.data;
+  input_dims_ = input.dims;
+  output_data_ = output.data.data;
+  output_dims_ = output.dims;
+
+  if ((layer.kept_start < layer.kept_end) && (layer.output_shift > 0)) {
+    const size_t row_bytes = layer.rows.output_row_bytes;
+    uint8_t* output_rows = static_cast<uint8_t*>(output_data_);
+    memmove(output_rows + layer.kept_start * row_bytes,
+            output_rows + (layer.kept_start + layer.output_shift) * row_bytes,
+            (layer.kept_end - layer.kept_start) * row_bytes);
+  }
+  return layer.band_count;
+}
+
+int StreamingPlan::SetBand(int layer_index, int band,
+                           TfLiteEvalTensor* eval_tensors) {
+  Layer* layer = &layers_[layer_index];
+  PatchPlan::Layer* rows = &layer->rows;
+
+  // The rows above the kept ones come first, then the rows below them.
+  int start = 0;
+  int end = rows->output_height;
+  if (layer->kept_start < layer->kept_end) {
+    if ((band == 0) && (layer->kept_start > 0)) {
+      end = layer->kept_start;
+    } else {
+      start = layer->kept_end;
+    }
+  }
+  SetBandRows(rows, start, end);
+  frame_macs_ += (rows->computed_end - rows->computed_start) *
+                 rows->macs_per_row;
+
+  uint8_t* output_rows = static_cast<uint8_t*>(output_data_);
+  saved_bytes_ = (start - rows->computed_start) * rows->output_row_bytes;
+  if (saved_bytes_ > 0) {
+    memcpy(saved_rows_,
+           output_rows + rows->computed_start * rows->output_row_bytes,
+           saved_bytes_);
+  }
+
+  TfLiteEvalTensor* input = &eval_tensors[rows->input_tensor];
+  input->data.data = static_cast<uint8_t*>(input_data_) +
+                     rows->read_start * rows->input_row_bytes;
+  SetBandDims(band_input_dims_, input_dims_,
+              rows->read_end - rows->read_start);
+  input->dims = band_input_dims_;
+
+  TfLiteEvalTensor* output = &eval_tensors[rows->output_tensor];
+  output->data.data =
+      output_rows + rows->computed_start * rows->output_row_bytes;
+  SetBandDims(band_output_dims_, output_dims_,
+              rows->computed_end - rows->computed_start);
+  output->dims = band_output_dims_;
+
+  return rows->node_index;
+}
+
+void StreamingPlan::RestoreBand(int layer_index,
+                                TfLiteEvalTensor* eval_tensors) {
+  const PatchPlan::Layer& rows = layers_[layer_index].rows;
+  TfLiteEvalTensor* input = &eval_tensors[rows.input_tensor];
+  input->data.data = input_data_;
+  input->dims = input_dims_;
+  TfLiteEvalTensor* output = &eval_tensors[rows.output_tensor];
+  output->data.data = output_data_;
+  output->dims = output_dims_;
+
+  if (saved_bytes_ > 0) {
+    memcpy(static_cast<uint8_t*>(output_data_) +
+               rows.computed_start * rows.output_row_bytes,
+           saved_rows_, saved_bytes_);
+    saved_bytes_ = 0;
+  }
+}
+
+void StreamingPlan::PrintReport() const {
+  if (error_reporter_ == nullptr) {
+    return;
+  }
+  if (!active()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "[StreamingPlan] No layers can be streamed");
+    return;
+  }
+  TF_LITE_REPORT_ERROR(
+      error_reporter_,
+      "[StreamingPlan] Nodes %d to %d keep %d bytes, the last frame "
+      "computed %d%% of the stage",
+      first_node(), last_node(), static_cast<int>(state_bytes_),
+      static_cast<int>(frame_macs_ * 100 / stage_macs_));
+}
+
+}  // namespace tflite
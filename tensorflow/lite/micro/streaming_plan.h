@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_STREAMING_PLAN_H_
+#define TENSORFLOW_LITE_MICRO_STREAMING_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/patch_plan.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Plans streaming inference, for models whose input is a window that slides
+// along its height from one invoke to the next, such as the spectrogram of a
+// keyword spotting model that gains a row at the bottom and loses one at the
+// top for each new audio frame. Most rows of the leading CONV_2D,
+// DEPTHWISE_CONV_2D, AVERAGE_POOL_2D and MAX_POOL_2D layers are then the same
+// as in the last frame, moved up, so the stage keeps its feature maps and only
+// computes the rows that changed.
+//
+// The outputs of the layers in the stage are held in the tail, like variable
+// tensors, rather than planned in the head. Before a layer runs, the rows of
+// its output that are kept are moved up, as the CIRCULAR_BUFFER operator does,
+// and the rows left at the top and bottom are computed in bands as in
+// PatchPlan. The lead-in rows of the bottom band land on kept rows, so those
+// are saved beforehand and put back afterwards.
+//
+// A layer only keeps rows when the window moved by a whole number of its
+// strides. Otherwise it is computed in full, and so are the layers after it.
+// As with PatchPlan, the kernels in the stage must read tensor shapes from
+// their TfLiteEvalTensors when invoked.
+class StreamingPlan {
+ public:
+  // The most layers a stage can have.
+  static constexpr int kMaxLayers = PatchPlan::kMaxLayers;
+
+  // Passed to StartFrame() when it isn't known how far the window moved, so
+  // the whole stage is computed.
+  static constexpr int kUnknownShift = -1;
+
+  // Finds the longest chain of supported layers, starting from the first one
+  // in the model, and gives their outputs buffers in the tail. The plan stays
+  // inactive if there are no such layers. Must be called after all nodes are
+  // prepared and before MicroAllocator::FinishModelAllocation().
+  TfLiteStatus Init(ErrorReporter* error_reporter, MicroAllocator* allocator,
+                    const SubGraph* subgraph,
+                    NodeAndRegistration* node_and_registrations,
+                    TfLiteEvalTensor* eval_tensors);
+
+  bool active() const { return layer_count_ > 0; }
+  int first_node() const { return layers_[0].rows.node_index; }
+  int last_node() const { return layers_[layer_count_ - 1].rows.node_index; }
+  int layer_count() const { return layer_count_; }
+
+  // Works out the rows that each layer computes for a frame whose stage input
+  // moved up by `new_rows` rows since the last frame. Until FinishFrame() is
+  // called, the kept feature maps are not valid for another frame.
+  void StartFrame(int new_rows);
+
+  // Moves up the rows of a layer's output that are kept from the last frame,
+  // and returns the number of bands of rows that are left to compute.
+  int StartLayer(int layer_index, const TfLiteEvalTensor* eval_tensors);
+
+  // Points the input and output of a layer at the rows of a band, and returns
+  // the index of its node.
+  int SetBand(int layer_index, int band, TfLiteEvalTensor* eval_tensors);
+
+  // Restores the tensors of a layer, and the kept rows that the lead-in rows
+  // of the band were written over.
+  void RestoreBand(int layer_index, TfLiteEvalTensor* eval_tensors);
+
+  // Marks the feature maps of the stage as valid for the next frame.
+  void FinishFrame() { state_valid_ = true; }
+
+  // Drops the kept feature maps, so that the next frame computes them in full.
+  void Reset() { state_valid_ = false; }
+
+  // Bytes held in the tail for the feature maps of the stage.
+  size_t state_bytes() const { return state_bytes_; }
+
+  // Multiply-accumulates (or pooled elements) in the whole stage, and those
+  // computed for the last frame, including lead-in rows.
+  int64_t stage_macs() const { return stage_macs_; }
+  int64_t frame_macs() const { return frame_macs_; }
+
+  // Logs the stage, the memory it holds and the compute of the last frame.
+  void PrintReport() const;
+
+ private:
+  struct Layer {
+    // The rows of the layer, and of the band being computed.
+    PatchPlan::Layer rows;
+    // Rows that the input and output moved up by since the last frame, or
+    // kUnknownShift.
+    int input_shift;
+    int output_shift;
+    // Output rows kept from the last frame, moved up by output_shift.
+    int kept_start;
+    int kept_end;
+    int band_count;
+  };
+
+  // Works out the input and output rows of a band that computes output rows
+  // [start, end).
+  static void SetBandRows(PatchPlan::Layer* rows, int start, int end);
+
+  ErrorReporter* error_reporter_ = nullptr;
+  Layer* layers_ = nullptr;
+  int layer_count_ = 0;
+  bool state_valid_ = false;
+
+  // The buffers and shapes of the tensors of the layer being computed, and
+  // the shapes of its band.
+  void* input_data_ = nullptr;
+  TfLiteIntArray* input_dims_ = nullptr;
+  void* output_data_ = nullptr;
+  TfLiteIntArray* output_dims_ = nullptr;
+  TfLiteIntArray* band_input_dims_ = nullptr;
+  TfLiteIntArray* band_output_dims_ = nullptr;
+
+  // Kept rows that the lead-in rows of the current band are written over.
+  uint8_t* saved_rows_ = nullptr;
+  size_t saved_bytes_ = 0;
+
+  size_t state_bytes_ = 0;
+  int64_t stage_macs_ = 0;
+  int64_t frame_macs_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_STREAMING_PLAN_H_
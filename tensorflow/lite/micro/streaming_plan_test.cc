@@ -0,0 +1,117 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/streaming_plan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kArenaSize = 12 * 1024;
+constexpr int kStreamingArenaSize = 20 * 1024;
+uint8_t arena[kArenaSize];
+uint8_t streaming_arena[kStreamingArenaSize];
+
+// The model input is 16x16, and is treated as a window of 16 rows.
+constexpr int kRowCount = 16;
+constexpr int kRowSize = 16;
+float window[kRowCount * kRowSize];
+
+// Moves the window up by `new_rows` rows, and fills in the new rows at the
+// bottom.
+void SlideWindow(int new_rows, int frame) {
+  const int kept = kRowCount - new_rows;
+  memmove(window, window + new_rows * kRowSize,
+          kept * kRowSize * sizeof(float));
+  for (int i = kept * kRowSize; i < kRowCount * kRowSize; ++i) {
+    window[i] = static_cast<float>((i * 7 + frame * 5) % 17) / 8.0f - 1.0f;
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestStreamedModelMatchesFullModel) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter full(model, op_resolver, arena, kArenaSize,
+                                tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, full.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_FALSE(full.streaming_plan().active());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, full.InvokeStreaming(1));
+
+  tflite::MicroInterpreter streamed(model, op_resolver, streaming_arena,
+                                    kStreamingArenaSize,
+                                    tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, streamed.EnableStreaming());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, streamed.SetPatchCount(2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, streamed.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, streamed.EnableStreaming());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, streamed.InvokeStreaming(-1));
+
+  // The two convolutions and the pooling that follows them are streamed.
+  const tflite::StreamingPlan& plan = streamed.streaming_plan();
+  TF_LITE_MICRO_EXPECT_TRUE(plan.active());
+  TF_LITE_MICRO_EXPECT_EQ(1, plan.first_node());
+  TF_LITE_MICRO_EXPECT_EQ(3, plan.last_node());
+  TF_LITE_MICRO_EXPECT_GT(plan.state_bytes(), static_cast<size_t>(0));
+
+  // The first frame is computed in full. After that, moving by two rows keeps
+  // rows in every layer, moving by one can't keep rows of the pooling, and not
+  // moving at all computes nothing in the stage.
+  const int new_rows[] = {kRowCount, 2, 2, 1, 4, 0, 2};
+  const int frame_count = sizeof(new_rows) / sizeof(new_rows[0]);
+  for (int frame = 0; frame < frame_count; ++frame) {
+    SlideWindow(new_rows[frame], frame);
+    memcpy(full.input(0)->data.f, window, sizeof(window));
+    memcpy(streamed.input(0)->data.f, window, sizeof(window));
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, full.Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                            streamed.InvokeStreaming(new_rows[frame]));
+
+    if (frame == 0) {
+      TF_LITE_MICRO_EXPECT_EQ(plan.stage_macs(), plan.frame_macs());
+    } else if (new_rows[frame] == 0) {
+      TF_LITE_MICRO_EXPECT_EQ(static_cast<int64_t>(0), plan.frame_macs());
+    } else {
+      TF_LITE_MICRO_EXPECT_LT(plan.frame_macs(), plan.stage_macs());
+    }
+    plan.PrintReport();
+
+    const TfLiteTensor* full_output = full.output(0);
+    const TfLiteTensor* streamed_output = streamed.output(0);
+    TF_LITE_MICRO_EXPECT_EQ(full_output->bytes, streamed_output->bytes);
+    const int element_count = full_output->bytes / sizeof(float);
+    for (int i = 0; i < element_count; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(full_output->data.f[i],
+                              streamed_output->data.f[i]);
+    }
+  }
+
+  // Invoke() doesn't know how far the window moved, so computes in full.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, streamed.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(plan.stage_macs(), plan.frame_macs());
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -638,6 +638,302 @@ const Model* BuildSimpleMultipleInputsModel() {
   return model;
 }
 
+// Builds a model whose IF operator adds 21 to the input in the then branch,
+// and 42 in the else branch, using the mock_custom op in both subgraphs.
+const Model* BuildSimpleModelWithIf() {
+  using flatbuffers::Offset;
+  flatbuffers::FlatBufferBuilder* builder = BuilderInstance();
+
+  constexpr size_t buffer_data_size = 1;
+  const uint8_t then_buffer_data[buffer_data_size] = {21};
+  const uint8_t else_buffer_data[buffer_data_size] = {42};
+  constexpr size_t buffers_size = 3;
+  const Offset<Buffer> buffers[buffers_size] = {
+      CreateBuffer(*builder),
+      CreateBuffer(*builder,
+                   builder->CreateVector(then_buffer_data, buffer_data_size)),
+      CreateBuffer(*builder,
+                   builder->CreateVector(else_buffer_data, buffer_data_size))};
+  constexpr size_t tensor_shape_size = 1;
+  const int32_t tensor_shape[tensor_shape_size] = {1};
+  constexpr size_t tensors_size = 3;
+  const Offset<Tensor> tensors[tensors_size] = {
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_BOOL, 0,
+                   builder->CreateString("test_condition_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("test_input_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("test_output_tensor"), 0, false),
+  };
+  const Offset<Tensor> then_tensors[tensors_size] = {
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("then_input_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_UINT8, 1,
+                   builder->CreateString("then_weight_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("then_output_tensor"), 0, false),
+  };
+  const Offset<Tensor> else_tensors[tensors_size] = {
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("else_input_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_UINT8, 2,
+                   builder->CreateString("else_weight_tensor"), 0, false),
+      CreateTensor(*builder,
+                   builder->CreateVector(tensor_shape, tensor_shape_size),
+                   TensorType_INT32, 0,
+                   builder->CreateString("else_output_tensor"), 0, false),
+  };
+  constexpr size_t inputs_size = 2;
+  const int32_t inputs[inputs_size] = {0, 1};
+  constexpr size_t branch_inputs_size = 1;
+  const int32_t branch_inputs[branch_inputs_size] = {0};
+  constexpr size_t outputs_size = 1;
+  const int32_t outputs[outputs_size] = {2};
+  constexpr size_t operator_inputs_size = 2;
+  const int32_t operator_inputs[operator_inputs_size] = {0, 1};
+  const Offset<Operator> if_operator = CreateOperator(
+      *builder, 0, builder->CreateVector(operator_inputs, operator_inputs_size),
+      builder->CreateVector(outputs, outputs_size), BuiltinOptions_IfOptions,
+      CreateIfOptions(*builder, /*then_subgraph_index=*/1,
+                      /*else_subgraph_index=*/2)
+          .Union());
+  const Offset<Operator> then_operator = CreateOperator(
+      *builder, 1, builder->CreateVector(operator_inputs, operator_inputs_size),
+      builder->CreateVector(outputs, outputs_size), BuiltinOptions_NONE);
+  const Offset<Operator> else_operator = CreateOperator(
+      *builder, 1, builder->CreateVector(operator_inputs, operator_inputs_size),
+      builder->CreateVector(outputs, outputs_size), BuiltinOptions_NONE);
+  constexpr size_t subgraphs_size = 3;
+  const Offset<SubGraph> subgraphs[subgraphs_size] = {
+      CreateSubGraph(*builder, builder->CreateVector(tensors, tensors_size),
+                     builder->CreateVector(inputs, inputs_size),
+                     builder->CreateVector(outputs, outputs_size),
+                     builder->CreateVector(&if_operator, 1),
+                     builder->CreateString("test_subgraph")),
+      CreateSubGraph(*builder,
+                     builder->CreateVector(then_tensors, tensors_size),
+                     builder->CreateVector(branch_inputs, branch_inputs_size),
+                     builder->CreateVector(outputs, outputs_size),
+                     builder->CreateVector(&then_operator, 1),
+                     builder->CreateString("then_subgraph")),
+      CreateSubGraph(*builder,
+                     builder->CreateVector(else_tensors, tensors_size),
+                     builder->CreateVector(branch_inputs, branch_inputs_size),
+                     builder->CreateVector(outputs, outputs_size),
+                     builder->CreateVector(&else_operator, 1),
+                     builder->CreateString("else_subgraph"))};
+  constexpr size_t operator_codes_size = 2;
+  const Offset<OperatorCode> operator_codes[operator_codes_size] = {
+      CreateOperatorCodeDirect(*builder,
+                               /*deprecated_builtin_code=*/BuiltinOperator_IF,
+                               nullptr, /*version=*/1, BuiltinOperator_IF),
+      CreateOperatorCodeDirect(*builder, /*deprecated_builtin_code=*/0,
+                               "mock_custom",
+                               /*version=*/0, BuiltinOperator_CUSTOM)};
+  const Offset<Model> model_offset = CreateModel(
+      *builder, 0, builder->CreateVector(operator_codes, operator_codes_size),
+      builder->CreateVector(subgraphs, subgraphs_size),
+      builder->CreateString("test_model"),
+      builder->CreateVector(buffers, buffers_size));
+  FinishModelBuffer(*builder, model_offset);
+  void* model_pointer = builder->GetBufferPointer();
+  const Model* model = flatbuffers::GetRoot<Model>(model_pointer);
+  return model;
+}
+
+// Builds a model whose WHILE operator counts its first input up to the
+// second, a limit that the body passes through unchanged. The condition is
+// LESS and the body adds 1 with the mock_custom op.
+const Model* BuildSimpleModelWithWhile() {
+  using flatbuffers::Offset;
+  flatbuffers::FlatBufferBuilder* builder = BuilderInstance();
+
+  constexpr size_t buffer_data_size = 1;
+  const uint8_t one_buffer_data[buffer_data_size] = {1};
+  constexpr size_t buffers_size = 2;
+  const Offset<Buffer> buffers[buffers_size] = {
+      CreateBuffer(*builder),
+      CreateBuffer(*builder,
+                   builder->CreateVector(one_buffer_data, buffer_data_size))};
+  constexpr size_t tensor_shape_size = 1;
+  const int32_t tensor_shape[tensor_shape_size] = {1};
+  auto create_tensor = [&](TensorType type, uint32_t buffer, const char* name) {
+    return CreateTensor(*builder,
+                        builder->CreateVector(tensor_shape, tensor_shape_size),
+                        type, buffer, builder->CreateString(name), 0, false);
+  };
+  constexpr size_t tensors_size = 4;
+  const Offset<Tensor> tensors[tensors_size] = {
+      create_tensor(TensorType_INT32, 0, "test_counter_tensor"),
+      create_tensor(TensorType_INT32, 0, "test_limit_tensor"),
+      create_tensor(TensorType_INT32, 0, "test_counter_output_tensor"),
+      create_tensor(TensorType_INT32, 0, "test_limit_output_tensor"),
+  };
+  constexpr size_t cond_tensors_size = 3;
+  const Offset<Tensor> cond_tensors[cond_tensors_size] = {
+      create_tensor(TensorType_INT32, 0, "cond_counter_tensor"),
+      create_tensor(TensorType_INT32, 0, "cond_limit_tensor"),
+      create_tensor(TensorType_BOOL, 0, "cond_output_tensor"),
+  };
+  constexpr size_t body_tensors_size = 4;
+  const Offset<Tensor> body_tensors[body_tensors_size] = {
+      create_tensor(TensorType_INT32, 0, "body_counter_tensor"),
+      create_tensor(TensorType_INT32, 0, "body_limit_tensor"),
+      create_tensor(TensorType_UINT8, 1, "body_weight_tensor"),
+      create_tensor(TensorType_INT32, 0, "body_counter_output_tensor"),
+  };
+  constexpr size_t inputs_size = 2;
+  const int32_t inputs[inputs_size] = {0, 1};
+  constexpr size_t outputs_size = 2;
+  const int32_t outputs[outputs_size] = {2, 3};
+  constexpr size_t cond_outputs_size = 1;
+  const int32_t cond_outputs[cond_outputs_size] = {2};
+  // the limit is both an input and an output of the body
+  const int32_t body_outputs[outputs_size] = {3, 1};
+  constexpr size_t body_operator_inputs_size = 2;
+  const int32_t body_operator_inputs[body_operator_inputs_size] = {0, 2};
+  constexpr size_t body_operator_outputs_size = 1;
+  const int32_t body_operator_outputs[body_operator_outputs_size] = {3};
+  const Offset<Operator> while_operator = CreateOperator(
+      *builder, 0, builder->CreateVector(inputs, inputs_size),
+      builder->CreateVector(outputs, outputs_size),
+      BuiltinOptions_WhileOptions,
+      CreateWhileOptions(*builder, /*cond_subgraph_index=*/1,
+                         /*body_subgraph_index=*/2)
+          .Union());
+  const Offset<Operator> cond_operator = CreateOperator(
+      *builder, 1, builder->CreateVector(inputs, inputs_size),
+      builder->CreateVector(cond_outputs, cond_outputs_size),
+      BuiltinOptions_LessOptions, CreateLessOptions(*builder).Union());
+  const Offset<Operator> body_operator = CreateOperator(
+      *builder, 2,
+      builder->CreateVector(body_operator_inputs, body_operator_inputs_size),
+      builder->CreateVector(body_operator_outputs, body_operator_outputs_size),
+      BuiltinOptions_NONE);
+  constexpr size_t subgraphs_size = 3;
+  const Offset<SubGraph> subgraphs[subgraphs_size] = {
+      CreateSubGraph(*builder, builder->CreateVector(tensors, tensors_size),
+                     builder->CreateVector(inputs, inputs_size),
+                     builder->CreateVector(outputs, outputs_size),
+                     builder->CreateVector(&while_operator, 1),
+                     builder->CreateString("test_subgraph")),
+      CreateSubGraph(*builder,
+                     builder->CreateVector(cond_tensors, cond_tensors_size),
+                     builder->CreateVector(inputs, inputs_size),
+                     builder->CreateVector(cond_outputs, cond_outputs_size),
+                     builder->CreateVector(&cond_operator, 1),
+                     builder->CreateString("cond_subgraph")),
+      CreateSubGraph(*builder,
+                     builder->CreateVector(body_tensors, body_tensors_size),
+                     builder->CreateVector(inputs, inputs_size),
+                     builder->CreateVector(body_outputs, outputs_size),
+                     builder->CreateVector(&body_operator, 1),
+                     builder->CreateString("body_subgraph"))};
+  constexpr size_t operator_codes_size = 3;
+  const Offset<OperatorCode> operator_codes[operator_codes_size] = {
+      CreateOperatorCodeDirect(
+          *builder, /*deprecated_builtin_code=*/BuiltinOperator_WHILE, nullptr,
+          /*version=*/1, BuiltinOperator_WHILE),
+      CreateOperatorCodeDirect(
+          *builder, /*deprecated_builtin_code=*/BuiltinOperator_LESS, nullptr,
+          /*version=*/1, BuiltinOperator_LESS),
+      CreateOperatorCodeDirect(*builder, /*deprecated_builtin_code=*/0,
+                               "mock_custom",
+                               /*version=*/0, BuiltinOperator_CUSTOM)};
+  const Offset<Model> model_offset = CreateModel(
+      *builder, 0, builder->CreateVector(operator_codes, operator_codes_size),
+      builder->CreateVector(subgraphs, subgraphs_size),
+      builder->CreateString("test_model"),
+      builder->CreateVector(buffers, buffers_size));
+  FinishModelBuffer(*builder, model_offset);
+  void* model_pointer = builder->GetBufferPointer();
+  const Model* model = flatbuffers::GetRoot<Model>(model_pointer);
+  return model;
+}
+
+// Builds a model that requantizes its int8 input to the same params, reshapes
+// it from 2x3 to 3x2, then requantizes it to a scale of 0.25 and a zero point
+// of -1. The first two ops leave the data unchanged.
+const Model* BuildSimpleModelWithInPlaceOps() {
+  using flatbuffers::Offset;
+  flatbuffers::FlatBufferBuilder* builder = BuilderInstance();
+
+  constexpr size_t buffers_size = 1;
+  const Offset<Buffer> buffers[buffers_size] = {CreateBuffer(*builder)};
+  constexpr size_t tensor_shape_size = 2;
+  const int32_t input_shape[tensor_shape_size] = {2, 3};
+  const int32_t output_shape[tensor_shape_size] = {3, 2};
+  auto create_tensor = [&](const int32_t* shape, float scale,
+                           int64_t zero_point, const char* name) {
+    return CreateTensor(
+        *builder, builder->CreateVector(shape, tensor_shape_size),
+        TensorType_INT8, 0, builder->CreateString(name),
+        CreateQuantizationParameters(*builder, 0, 0,
+                                     builder->CreateVector(&scale, 1),
+                                     builder->CreateVector(&zero_point, 1)),
+        false);
+  };
+  constexpr size_t tensors_size = 4;
+  const Offset<Tensor> tensors[tensors_size] = {
+      create_tensor(input_shape, 0.5f, 1, "test_input_tensor"),
+      create_tensor(input_shape, 0.5f, 1, "test_quantized_tensor"),
+      create_tensor(output_shape, 0.5f, 1, "test_reshaped_tensor"),
+      create_tensor(output_shape, 0.25f, -1, "test_output_tensor"),
+  };
+  constexpr size_t inputs_size = 1;
+  const int32_t inputs[inputs_size] = {0};
+  constexpr size_t outputs_size = 1;
+  const int32_t outputs[outputs_size] = {3};
+  constexpr size_t operators_size = 3;
+  const int32_t operator_tensors[operators_size + 1] = {0, 1, 2, 3};
+  auto create_operator = [&](uint32_t opcode_index, int i) {
+    return CreateOperator(*builder, opcode_index,
+                          builder->CreateVector(&operator_tensors[i], 1),
+                          builder->CreateVector(&operator_tensors[i + 1], 1),
+                          BuiltinOptions_NONE);
+  };
+  const Offset<Operator> operators[operators_size] = {
+      create_operator(0, 0), create_operator(1, 1), create_operator(0, 2)};
+  const Offset<SubGraph> subgraph =
+      CreateSubGraph(*builder, builder->CreateVector(tensors, tensors_size),
+                     builder->CreateVector(inputs, inputs_size),
+                     builder->CreateVector(outputs, outputs_size),
+                     builder->CreateVector(operators, operators_size),
+                     builder->CreateString("test_subgraph"));
+  constexpr size_t operator_codes_size = 2;
+  const Offset<OperatorCode> operator_codes[operator_codes_size] = {
+      CreateOperatorCodeDirect(
+          *builder, /*deprecated_builtin_code=*/BuiltinOperator_QUANTIZE,
+          nullptr, /*version=*/1, BuiltinOperator_QUANTIZE),
+      CreateOperatorCodeDirect(
+          *builder, /*deprecated_builtin_code=*/BuiltinOperator_RESHAPE,
+          nullptr, /*version=*/1, BuiltinOperator_RESHAPE)};
+  const Offset<Model> model_offset = CreateModel(
+      *builder, 0, builder->CreateVector(operator_codes, operator_codes_size),
+      builder->CreateVector(&subgraph, 1), builder->CreateString("test_model"),
+      builder->CreateVector(buffers, buffers_size));
+  FinishModelBuffer(*builder, model_offset);
+  void* model_pointer = builder->GetBufferPointer();
+  const Model* model = flatbuffers::GetRoot<Model>(model_pointer);
+  return model;
+}
+
 }  // namespace
 
 const TfLiteRegistration* SimpleStatefulOp::getRegistration() {
@@ -867,6 +1163,30 @@ const Model* GetSimpleModelWithBranch() {
   return model;
 }
 
+const Model* GetSimpleModelWithIf() {
+  static Model* model = nullptr;
+  if (!model) {
+    model = const_cast<Model*>(BuildSimpleModelWithIf());
+  }
+  return model;
+}
+
+const Model* GetSimpleModelWithWhile() {
+  static Model* model = nullptr;
+  if (!model) {
+    model = const_cast<Model*>(BuildSimpleModelWithWhile());
+  }
+  return model;
+}
+
+const Model* GetSimpleModelWithInPlaceOps() {
+  static Model* model = nullptr;
+  if (!model) {
+    model = const_cast<Model*>(BuildSimpleModelWithInPlaceOps());
+  }
+  return model;
+}
+
 const Model* GetModelWithOfflinePlanning(int num_tensors,
                                          const int32_t* metadata_buffer,
                                          NodeConnection* node_conn,
@@ -104,6 +104,18 @@ const Model* GetComplexMockModel();
 // Returns a simple flatbuffer model with two branches.
 const Model* GetSimpleModelWithBranch();
 
+// Returns a flatbuffer model with an IF operator, whose then and else branch
+// subgraphs add 21 and 42 to the input.
+const Model* GetSimpleModelWithIf();
+
+// Returns a flatbuffer model with a WHILE operator, which counts its first
+// input up to its second, and passes the second through.
+const Model* GetSimpleModelWithWhile();
+
+// Returns a flatbuffer model of QUANTIZE, RESHAPE and QUANTIZE operators on
+// int8 tensors, of which the first two can run in place.
+const Model* GetSimpleModelWithInPlaceOps();
+
 // Returns a simple example flatbuffer TensorFlow Lite model. Contains 3 inputs,
 // 1 output Tensor, and 1 operator.
 const Model* GetSimpleMultipleInputsModel();
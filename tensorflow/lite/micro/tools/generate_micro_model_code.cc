@@ -0,0 +1,943 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Generates C++ source that runs a model without MicroInterpreter. The model
+// is allocated on the host by MicroInterpreter, and the result is written out
+// as static data: the arena layout of every tensor and scratch buffer, the
+// constant buffers, shapes, quantization and builtin params, and one call per
+// node into the registration of its kernel. The generated code doesn't parse
+// the flatbuffer or plan memory, and only links in the kernels it uses.
+//
+// Usage:
+//   generate_micro_model_code <model.tflite> <output_prefix> <namespace>
+//
+// Writes <output_prefix>.h and <output_prefix>.cc, with the functions of the
+// model in <namespace>. The Init and Prepare functions of the kernels still
+// run once, from Init(), as their OpData is private to each kernel. The tool
+// must be built with the same kernels as the target, so that they ask for the
+// same scratch buffers.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/recording_micro_interpreter.h"
+#include "tensorflow/lite/micro/recording_simple_memory_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+// Must match micro_allocator.cc.
+constexpr int kBufferAlignment = 16;
+
+constexpr size_t kHostArenaSize = 64 * 1024 * 1024;
+
+// How to create the kernel of a builtin op, and the type of its builtin data,
+// which is copied into the generated code byte for byte.
+struct OpInfo {
+  tflite::BuiltinOperator op;
+  const char* registration;
+  const char* params_type;
+  size_t params_size;
+};
+
+#define MICRO_OP(op, ns) \
+  { tflite::BuiltinOperator_##op, #ns "::Register_" #op "()", nullptr, 0 }
+#define MICRO_OP_WITH_PARAMS(op, ns, params)                        \
+  {                                                                 \
+    tflite::BuiltinOperator_##op, #ns "::Register_" #op "()", #params, \
+        sizeof(params)                                              \
+  }
+
+// The builtin ops registered by MicroMutableOpResolver.
+const OpInfo kOps[] = {
+    MICRO_OP(ABS, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(ADD, tflite::ops::micro, TfLiteAddParams),
+    MICRO_OP_WITH_PARAMS(ARG_MAX, tflite::ops::micro, TfLiteArgMaxParams),
+    MICRO_OP_WITH_PARAMS(ARG_MIN, tflite::ops::micro, TfLiteArgMinParams),
+    MICRO_OP_WITH_PARAMS(AVERAGE_POOL_2D, tflite::ops::micro,
+                         TfLitePoolParams),
+    MICRO_OP(BATCH_TO_SPACE_ND, tflite),
+    MICRO_OP_WITH_PARAMS(CAST, tflite, TfLiteCastParams),
+    MICRO_OP(CEIL, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(CONCATENATION, tflite::ops::micro,
+                         TfLiteConcatenationParams),
+    MICRO_OP_WITH_PARAMS(CONV_2D, tflite, TfLiteConvParams),
+    MICRO_OP(COS, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(DEPTHWISE_CONV_2D, tflite, TfLiteDepthwiseConvParams),
+    MICRO_OP(DEQUANTIZE, tflite::ops::micro),
+    MICRO_OP(EQUAL, tflite::ops::micro),
+    MICRO_OP(EXP, tflite),
+    MICRO_OP(FLOOR, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(FULLY_CONNECTED, tflite, TfLiteFullyConnectedParams),
+    MICRO_OP(GREATER, tflite::ops::micro),
+    MICRO_OP(GREATER_EQUAL, tflite::ops::micro),
+    MICRO_OP(HARD_SWISH, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(L2_NORMALIZATION, tflite::ops::micro,
+                         TfLiteL2NormParams),
+    MICRO_OP(LESS, tflite::ops::micro),
+    MICRO_OP(LESS_EQUAL, tflite::ops::micro),
+    MICRO_OP(LOG, tflite::ops::micro),
+    MICRO_OP(LOGICAL_AND, tflite::ops::micro),
+    MICRO_OP(LOGICAL_NOT, tflite::ops::micro),
+    MICRO_OP(LOGICAL_OR, tflite::ops::micro),
+    MICRO_OP(LOGISTIC, tflite::ops::micro),
+    MICRO_OP(MAXIMUM, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(MAX_POOL_2D, tflite::ops::micro, TfLitePoolParams),
+    MICRO_OP_WITH_PARAMS(MEAN, tflite::ops::micro, TfLiteReducerParams),
+    MICRO_OP(MINIMUM, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(MUL, tflite::ops::micro, TfLiteMulParams),
+    MICRO_OP(NEG, tflite::ops::micro),
+    MICRO_OP(NOT_EQUAL, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(PACK, tflite::ops::micro, TfLitePackParams),
+    MICRO_OP(PAD, tflite::ops::micro),
+    MICRO_OP(PADV2, tflite::ops::micro),
+    MICRO_OP(PRELU, tflite::ops::micro),
+    MICRO_OP(QUANTIZE, tflite),
+    MICRO_OP_WITH_PARAMS(REDUCE_MAX, tflite::ops::micro, TfLiteReducerParams),
+    MICRO_OP(RELU, tflite::ops::micro),
+    MICRO_OP(RELU6, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(RESHAPE, tflite::ops::micro, TfLiteReshapeParams),
+    MICRO_OP_WITH_PARAMS(RESIZE_NEAREST_NEIGHBOR, tflite::ops::micro,
+                         TfLiteResizeNearestNeighborParams),
+    MICRO_OP(ROUND, tflite::ops::micro),
+    MICRO_OP(RSQRT, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(SHAPE, tflite, TfLiteShapeParams),
+    MICRO_OP(SIN, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(SOFTMAX, tflite, TfLiteSoftmaxParams),
+    MICRO_OP(SPACE_TO_BATCH_ND, tflite),
+    MICRO_OP_WITH_PARAMS(SPLIT, tflite::ops::micro, TfLiteSplitParams),
+    MICRO_OP_WITH_PARAMS(SPLIT_V, tflite::ops::micro, TfLiteSplitVParams),
+    MICRO_OP(SQRT, tflite::ops::micro),
+    MICRO_OP(SQUARE, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(STRIDED_SLICE, tflite::ops::micro,
+                         TfLiteStridedSliceParams),
+    MICRO_OP_WITH_PARAMS(SUB, tflite::ops::micro, TfLiteSubParams),
+    MICRO_OP_WITH_PARAMS(SVDF, tflite, TfLiteSVDFParams),
+    MICRO_OP(TANH, tflite::ops::micro),
+    MICRO_OP_WITH_PARAMS(UNPACK, tflite::ops::micro, TfLiteUnpackParams),
+    MICRO_OP(ZEROS_LIKE, tflite),
+};
+
+#undef MICRO_OP
+#undef MICRO_OP_WITH_PARAMS
+
+const OpInfo* FindOp(int builtin_code) {
+  for (const OpInfo& op : kOps) {
+    if (op.op == builtin_code) {
+      return &op;
+    }
+  }
+  return nullptr;
+}
+
+const char* TypeName(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat32:
+      return "kTfLiteFloat32";
+    case kTfLiteInt32:
+      return "kTfLiteInt32";
+    case kTfLiteUInt8:
+      return "kTfLiteUInt8";
+    case kTfLiteInt64:
+      return "kTfLiteInt64";
+    case kTfLiteBool:
+      return "kTfLiteBool";
+    case kTfLiteInt16:
+      return "kTfLiteInt16";
+    case kTfLiteInt8:
+      return "kTfLiteInt8";
+    case kTfLiteFloat16:
+      return "kTfLiteFloat16";
+    case kTfLiteFloat64:
+      return "kTfLiteFloat64";
+    default:
+      return nullptr;
+  }
+}
+
+// Exposes the context and allocator of the interpreter, to read back the
+// buffers it planned.
+class CodegenInterpreter : public tflite::RecordingMicroInterpreter {
+ public:
+  using RecordingMicroInterpreter::RecordingMicroInterpreter;
+  using MicroInterpreter::allocator;
+  using MicroInterpreter::context;
+};
+
+struct TensorInfo {
+  TfLiteType type;
+  // Offset of the shape in the generated dims array.
+  int dims;
+  // Offset in the generated arena, or -1.
+  int offset;
+  // Index of the model buffer holding constant data, or -1.
+  int buffer;
+  size_t bytes;
+  // Index in the generated quantization array, or -1.
+  int quantization;
+  bool is_variable;
+};
+
+struct QuantizationInfo {
+  std::vector<float> scales;
+  std::vector<int> zero_points;
+  int quantized_dimension;
+};
+
+struct NodeInfo {
+  const OpInfo* op;
+  // Index of the op in the generated registrations array.
+  int registration;
+  // Offsets of the inputs and outputs in the generated node array.
+  int inputs;
+  int outputs;
+  std::vector<uint8_t> params;
+};
+
+void WriteBytes(FILE* file, const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    fprintf(file, "%s0x%02x,", (i % 12 == 0) ? "\n    " : " ", data[i]);
+  }
+  fprintf(file, "\n");
+}
+
+void WriteInts(FILE* file, const std::vector<int>& values) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    fprintf(file, "%s%d,", (i % 12 == 0) ? "\n    " : " ", values[i]);
+  }
+  fprintf(file, "\n");
+}
+
+// Appends an array as a TfLiteIntArray: its size, then its values.
+int AppendIntArray(const TfLiteIntArray* array, std::vector<int>* values) {
+  const int offset = values->size();
+  values->push_back(array->size);
+  for (int i = 0; i < array->size; ++i) {
+    values->push_back(array->data[i]);
+  }
+  return offset;
+}
+
+std::string HeaderGuard(const std::string& path) {
+  std::string guard;
+  for (char c : path) {
+    guard += isalnum(static_cast<unsigned char>(c))
+                 ? static_cast<char>(toupper(static_cast<unsigned char>(c)))
+                 : '_';
+  }
+  return guard + "_H_";
+}
+
+// The parts of the generated source that don't depend on the model. First the
+// state and the callbacks of the TfLiteContext that the kernels use.
+constexpr char kRuntimeSource[] = R"(
+tflite::ErrorReporter* error_reporter = nullptr;
+TfLiteContext context = {};
+TfLiteEvalTensor eval_tensors[kTensorCount];
+TfLiteNode nodes[kNodeCount];
+TfLiteRegistration registrations[kRegistrationCount];
+size_t persistent_used_bytes = 0;
+int scratch_buffer_count = 0;
+
+// TfLiteTensors handed to a node by GetTensor(), until it finishes.
+TfLiteTensor temp_tensors[kMaxTempTensors];
+int temp_tensor_indices[kMaxTempTensors];
+int temp_tensor_count = 0;
+
+TfLiteIntArray* IntArray(const int* data) {
+  return reinterpret_cast<TfLiteIntArray*>(const_cast<int*>(data));
+}
+
+void* AllocatePersistentBuffer(TfLiteContext*, size_t bytes) {
+  const size_t aligned_bytes =
+      (bytes + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+  if (persistent_used_bytes + aligned_bytes > kPersistentBytes) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to allocate %d persistent bytes",
+                         static_cast<int>(bytes));
+    return nullptr;
+  }
+  uint8_t* buffer = arena + kPersistentOffset + persistent_used_bytes;
+  persistent_used_bytes += aligned_bytes;
+  return buffer;
+}
+
+TfLiteStatus RequestScratchBufferInArena(TfLiteContext*, size_t bytes,
+                                         int* buffer_idx) {
+  if ((scratch_buffer_count >= kScratchBufferCount) ||
+      (kScratchBufferOffsets[scratch_buffer_count] + bytes > kHeadBytes)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Scratch buffer %d of %d bytes wasn't planned",
+                         scratch_buffer_count, static_cast<int>(bytes));
+    return kTfLiteError;
+  }
+  *buffer_idx = scratch_buffer_count++;
+  return kTfLiteOk;
+}
+
+void* GetScratchBuffer(TfLiteContext*, int buffer_idx) {
+  return arena + kScratchBufferOffsets[buffer_idx];
+}
+
+void ReportOpError(TfLiteContext*, const char* format, ...) {
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+  va_list args;
+  va_start(args, format);
+  TF_LITE_REPORT_ERROR(error_reporter, format, args);
+  va_end(args);
+#endif
+}
+
+TfLiteTensor* GetTensor(const TfLiteContext*, int tensor_idx) {
+  for (int i = 0; i < temp_tensor_count; ++i) {
+    if (temp_tensor_indices[i] == tensor_idx) {
+      return &temp_tensors[i];
+    }
+  }
+  if (temp_tensor_count == kMaxTempTensors) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many tensors for one node");
+    return nullptr;
+  }
+  const TensorData& data = kTensors[tensor_idx];
+  TfLiteTensor* tensor = &temp_tensors[temp_tensor_count];
+  temp_tensor_indices[temp_tensor_count++] = tensor_idx;
+  std::memset(tensor, 0, sizeof(*tensor));
+  tensor->type = data.type;
+  tensor->data.data = eval_tensors[tensor_idx].data.data;
+  tensor->dims = eval_tensors[tensor_idx].dims;
+  tensor->bytes = data.bytes;
+  tensor->allocation_type =
+      (data.buffer != nullptr) ? kTfLiteMmapRo : kTfLiteArenaRw;
+  tensor->is_variable = data.is_variable;
+  if (data.quantization >= 0) {
+    TfLiteAffineQuantization* quantization =
+        &quantizations[data.quantization];
+    tensor->params.scale = quantization->scale->data[0];
+    tensor->params.zero_point = quantization->zero_point->data[0];
+    tensor->quantization.type = kTfLiteAffineQuantization;
+    tensor->quantization.params = quantization;
+  }
+  return tensor;
+}
+
+TfLiteEvalTensor* GetEvalTensor(const TfLiteContext*, int tensor_idx) {
+  return &eval_tensors[tensor_idx];
+}
+
+inline TfLiteStatus InvokeNode(int node_index) {
+  TfLiteStatus status = registrations[kNodeRegistrations[node_index]].invoke(
+      &context, &nodes[node_index]);
+  temp_tensor_count = 0;
+  return status;
+}
+)";
+
+// Then the functions declared in the generated header.
+constexpr char kApiSource[] = R"(
+}  // namespace
+
+TfLiteStatus Init(tflite::ErrorReporter* reporter) {
+  error_reporter = reporter;
+  persistent_used_bytes = 0;
+  scratch_buffer_count = 0;
+  temp_tensor_count = 0;
+
+  context.tensors_size = kTensorCount;
+  context.ReportError = ReportOpError;
+  context.GetTensor = GetTensor;
+  context.GetEvalTensor = GetEvalTensor;
+  context.recommended_num_threads = 1;
+
+  for (int i = 0; i < kTensorCount; ++i) {
+    const TensorData& data = kTensors[i];
+    eval_tensors[i].type = data.type;
+    eval_tensors[i].dims = IntArray(&tensor_dims[data.dims]);
+    if (data.buffer != nullptr) {
+      eval_tensors[i].data.data = const_cast<uint8_t*>(data.buffer);
+    } else if (data.offset >= 0) {
+      eval_tensors[i].data.data = arena + data.offset;
+    } else {
+      eval_tensors[i].data.data = nullptr;
+    }
+  }
+  for (int i = 0; i < kNodeCount; ++i) {
+    nodes[i] = {};
+    nodes[i].inputs = IntArray(&kNodeTensors[kNodeData[i].inputs]);
+    nodes[i].outputs = IntArray(&kNodeTensors[kNodeData[i].outputs]);
+  }
+  SetBuiltinData();
+  SetRegistrations();
+
+  // Only allow AllocatePersistentBuffer in Init stage.
+  context.AllocatePersistentBuffer = AllocatePersistentBuffer;
+  context.RequestScratchBufferInArena = nullptr;
+  context.GetScratchBuffer = nullptr;
+  context.RequestInPlaceOutput = nullptr;
+  for (int i = 0; i < kNodeCount; ++i) {
+    const TfLiteRegistration& registration =
+        registrations[kNodeRegistrations[i]];
+    if (registration.init) {
+      nodes[i].user_data = registration.init(
+          &context, reinterpret_cast<const char*>(nodes[i].builtin_data), 0);
+    }
+  }
+
+  // The tensors are already laid out, so in-place outputs were planned on the
+  // host and aren't asked for again.
+  context.RequestScratchBufferInArena = RequestScratchBufferInArena;
+  for (int i = 0; i < kNodeCount; ++i) {
+    const TfLiteRegistration& registration =
+        registrations[kNodeRegistrations[i]];
+    if (registration.prepare) {
+      TfLiteStatus status = registration.prepare(&context, &nodes[i]);
+      temp_tensor_count = 0;
+      if (status != kTfLiteOk) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Node %d failed to prepare with status %d", i,
+                             status);
+        return kTfLiteError;
+      }
+    }
+  }
+
+  context.AllocatePersistentBuffer = nullptr;
+  context.RequestScratchBufferInArena = nullptr;
+  context.GetScratchBuffer = GetScratchBuffer;
+
+  ResetVariableTensors();
+  return kTfLiteOk;
+}
+
+void ResetVariableTensors() {
+  for (int i = 0; i < kTensorCount; ++i) {
+    const TensorData& data = kTensors[i];
+    if (!data.is_variable) {
+      continue;
+    }
+    int value = 0;
+    if ((data.type == kTfLiteInt8) && (data.quantization >= 0)) {
+      value = quantizations[data.quantization].zero_point->data[0];
+    }
+    std::memset(eval_tensors[i].data.data, value, data.bytes);
+  }
+}
+
+size_t inputs_size() { return kInputCount; }
+
+size_t outputs_size() { return kOutputCount; }
+
+TfLiteEvalTensor* input(size_t index) {
+  return (index < kInputCount) ? &eval_tensors[kInputs[index]] : nullptr;
+}
+
+TfLiteEvalTensor* output(size_t index) {
+  return (index < kOutputCount) ? &eval_tensors[kOutputs[index]] : nullptr;
+}
+
+size_t arena_bytes() { return kArenaBytes; }
+)";
+
+void WriteHeader(FILE* file, const char* model_path, const std::string& guard,
+                 const char* name_space) {
+  fprintf(file,
+          "// Generated by generate_micro_model_code from %s. Do not edit.\n"
+          "#ifndef %s\n"
+          "#define %s\n"
+          "\n"
+          "#include <cstddef>\n"
+          "\n"
+          "#include \"tensorflow/lite/c/common.h\"\n"
+          "#include \"tensorflow/lite/core/api/error_reporter.h\"\n"
+          "\n"
+          "namespace %s {\n"
+          "\n"
+          "// Runs the Init and Prepare functions of every kernel. Must be "
+          "called once,\n"
+          "// before Invoke().\n"
+          "TfLiteStatus Init(tflite::ErrorReporter* error_reporter);\n"
+          "\n"
+          "// Runs the model.\n"
+          "TfLiteStatus Invoke();\n"
+          "\n"
+          "// Resets all variable tensors to their initial value.\n"
+          "void ResetVariableTensors();\n"
+          "\n"
+          "size_t inputs_size();\n"
+          "size_t outputs_size();\n"
+          "TfLiteEvalTensor* input(size_t index);\n"
+          "TfLiteEvalTensor* output(size_t index);\n"
+          "\n"
+          "// Returns the size of the statically allocated arena.\n"
+          "size_t arena_bytes();\n"
+          "\n"
+          "}  // namespace %s\n"
+          "\n"
+          "#endif  // %s\n",
+          model_path, guard.c_str(), guard.c_str(), name_space, name_space,
+          guard.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 4) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> <output_prefix> <namespace>\n",
+            argv[0]);
+    return 1;
+  }
+  const char* model_path = argv[1];
+  const std::string output_prefix = argv[2];
+  const char* name_space = argv[3];
+
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  std::ifstream input(model_path, std::ios::binary);
+  if (!input) {
+    fprintf(stderr, "Couldn't read %s\n", model_path);
+    return 1;
+  }
+  const std::string model_data((std::istreambuf_iterator<char>(input)),
+                               std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size());
+  if (!tflite::VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s isn't a valid model\n", model_path);
+    return 1;
+  }
+  const tflite::Model* model = tflite::GetModel(model_data.data());
+  // The generated Invoke() runs the nodes of the first subgraph only.
+  if (model->subgraphs()->size() != 1) {
+    fprintf(stderr, "Only 1 subgraph is supported, %s has %d\n", model_path,
+            static_cast<int>(model->subgraphs()->size()));
+    return 1;
+  }
+
+  // Let MicroInterpreter lay out the model, as it would on the device.
+  tflite::AllOpsResolver op_resolver;
+  std::vector<uint8_t> host_arena(kHostArenaSize);
+  CodegenInterpreter interpreter(model, op_resolver, host_arena.data(),
+                                 host_arena.size(), error_reporter);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    return 1;
+  }
+  const tflite::RecordingMicroAllocator& allocator =
+      interpreter.GetMicroAllocator();
+  const uint8_t* head = allocator.GetSimpleMemoryAllocator()->GetHeadBuffer();
+  const size_t head_bytes = tflite::AlignSizeUp(
+      allocator.GetSimpleMemoryAllocator()->GetHeadUsedBytes(),
+      kBufferAlignment);
+  const size_t persistent_bytes =
+      allocator
+          .GetRecordedAllocation(
+              tflite::RecordedAllocationType::kPersistentBufferData)
+          .used_bytes;
+  const TfLiteContext& context = interpreter.context();
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+
+  // Tensors in the head keep their offsets, and variable tensors are placed
+  // after the head.
+  size_t variable_bytes = 0;
+  std::vector<int> dims;
+  std::vector<TensorInfo> tensors(interpreter.tensors_size());
+  std::vector<QuantizationInfo> quantizations;
+  std::vector<bool> buffer_used(model->buffers()->size(), false);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const tflite::Tensor* flatbuffer_tensor = subgraph->tensors()->Get(i);
+    const TfLiteEvalTensor* eval_tensor = context.GetEvalTensor(&context, i);
+    TensorInfo* tensor = &tensors[i];
+    tensor->type = eval_tensor->type;
+    tensor->dims = AppendIntArray(eval_tensor->dims, &dims);
+    tensor->offset = -1;
+    tensor->buffer = -1;
+    tensor->quantization = -1;
+    tensor->is_variable = flatbuffer_tensor->is_variable();
+    if (TypeName(tensor->type) == nullptr) {
+      fprintf(stderr, "Tensor %d has an unsupported type\n",
+              static_cast<int>(i));
+      return 1;
+    }
+    if (tflite::TfLiteEvalTensorByteLength(eval_tensor, &tensor->bytes) !=
+        kTfLiteOk) {
+      return 1;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(eval_tensor->data.data);
+    const tflite::Buffer* buffer =
+        model->buffers()->Get(flatbuffer_tensor->buffer());
+    if (data == nullptr) {
+      // Optional tensors stay null.
+    } else if (tensor->is_variable) {
+      tensor->offset = head_bytes + variable_bytes;
+      variable_bytes += tflite::AlignSizeUp(tensor->bytes, kBufferAlignment);
+    } else if ((data >= head) && (data < head + head_bytes)) {
+      tensor->offset = data - head;
+    } else if ((buffer != nullptr) && (buffer->data() != nullptr) &&
+               (buffer->data()->data() == data)) {
+      tensor->buffer = flatbuffer_tensor->buffer();
+      buffer_used[tensor->buffer] = true;
+    } else {
+      fprintf(stderr, "Tensor %d is neither in the arena nor in the model\n",
+              static_cast<int>(i));
+      return 1;
+    }
+
+    // The same quantization as MicroAllocator gives a TfLiteTensor.
+    const tflite::QuantizationParameters* quantization =
+        flatbuffer_tensor->quantization();
+    if ((quantization != nullptr) && (quantization->scale() != nullptr) &&
+        (quantization->scale()->size() > 0) &&
+        (quantization->zero_point() != nullptr) &&
+        (quantization->zero_point()->size() > 0)) {
+      QuantizationInfo info;
+      for (size_t n = 0; n < quantization->scale()->size(); ++n) {
+        info.scales.push_back(quantization->scale()->Get(n));
+      }
+      for (size_t n = 0; n < quantization->zero_point()->size(); ++n) {
+        info.zero_points.push_back(
+            static_cast<int>(quantization->zero_point()->Get(n)));
+      }
+      info.quantized_dimension = quantization->quantized_dimension();
+      tensor->quantization = quantizations.size();
+      quantizations.push_back(info);
+    }
+  }
+
+  std::vector<int> node_tensors;
+  std::vector<NodeInfo> nodes(interpreter.operators_size());
+  std::vector<const OpInfo*> registrations;
+  int max_temp_tensors = 1;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const tflite::NodeAndRegistration node_and_registration =
+        interpreter.node_and_registration(i);
+    const TfLiteNode& node = node_and_registration.node;
+    NodeInfo* info = &nodes[i];
+    info->op = FindOp(node_and_registration.registration->builtin_code);
+    if (info->op == nullptr) {
+      fprintf(stderr, "Node %d: %s isn't supported\n", static_cast<int>(i),
+              tflite::EnumNameBuiltinOperator(tflite::BuiltinOperator(
+                  node_and_registration.registration->builtin_code)));
+      return 1;
+    }
+    info->registration = -1;
+    for (size_t n = 0; n < registrations.size(); ++n) {
+      if (registrations[n] == info->op) {
+        info->registration = n;
+      }
+    }
+    if (info->registration == -1) {
+      info->registration = registrations.size();
+      registrations.push_back(info->op);
+    }
+    info->inputs = AppendIntArray(node.inputs, &node_tensors);
+    info->outputs = AppendIntArray(node.outputs, &node_tensors);
+    if (node.inputs->size + node.outputs->size > max_temp_tensors) {
+      max_temp_tensors = node.inputs->size + node.outputs->size;
+    }
+    if (node.builtin_data != nullptr) {
+      if (info->op->params_type == nullptr) {
+        fprintf(stderr, "Node %d has unexpected builtin data\n",
+                static_cast<int>(i));
+        return 1;
+      }
+      const uint8_t* params = static_cast<const uint8_t*>(node.builtin_data);
+      info->params.assign(params, params + info->op->params_size);
+    }
+  }
+
+  std::vector<int> scratch_buffer_offsets;
+  TfLiteContext* mutable_context = const_cast<TfLiteContext*>(&context);
+  for (size_t i = 0; i < interpreter.allocator().scratch_buffer_count(); ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(
+        context.GetScratchBuffer(mutable_context, i));
+    if ((data < head) || (data >= head + head_bytes)) {
+      fprintf(stderr, "Scratch buffer %d isn't in the head\n",
+              static_cast<int>(i));
+      return 1;
+    }
+    scratch_buffer_offsets.push_back(data - head);
+  }
+
+  const std::string header_path = output_prefix + ".h";
+  const std::string source_path = output_prefix + ".cc";
+  const size_t slash = output_prefix.find_last_of('/');
+  const std::string base_name = (slash == std::string::npos)
+                                    ? output_prefix
+                                    : output_prefix.substr(slash + 1);
+  const std::string header_name = base_name + ".h";
+
+  FILE* header = fopen(header_path.c_str(), "w");
+  if (header == nullptr) {
+    fprintf(stderr, "Couldn't write %s\n", header_path.c_str());
+    return 1;
+  }
+  WriteHeader(header, model_path, HeaderGuard(base_name), name_space);
+  fclose(header);
+
+  FILE* file = fopen(source_path.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't write %s\n", source_path.c_str());
+    return 1;
+  }
+  fprintf(file,
+          "// Generated by generate_micro_model_code from %s. Do not edit.\n"
+          "#include \"%s\"\n"
+          "\n"
+          "#include <cstdarg>\n"
+          "#include <cstddef>\n"
+          "#include <cstdint>\n"
+          "#include <cstring>\n"
+          "\n"
+          "#include \"tensorflow/lite/c/builtin_op_data.h\"\n"
+          "#include \"tensorflow/lite/c/common.h\"\n"
+          "#include \"tensorflow/lite/core/api/error_reporter.h\"\n"
+          "#include \"tensorflow/lite/micro/kernels/fully_connected.h\"\n"
+          "#include \"tensorflow/lite/micro/kernels/micro_ops.h\"\n"
+          "\n"
+          "namespace %s {\n"
+          "namespace {\n"
+          "\n",
+          model_path, header_name.c_str(), name_space);
+
+  const size_t persistent_offset = head_bytes + variable_bytes;
+  fprintf(file,
+          "constexpr int kTensorCount = %d;\n"
+          "constexpr int kNodeCount = %d;\n"
+          "constexpr int kRegistrationCount = %d;\n"
+          "constexpr int kScratchBufferCount = %d;\n"
+          "constexpr int kMaxTempTensors = %d;\n"
+          "constexpr size_t kBufferAlignment = %d;\n"
+          "\n"
+          "// The arena holds the tensors and scratch buffers planned on the "
+          "host, then\n"
+          "// the variable tensors, then the persistent buffers of the "
+          "kernels.\n"
+          "constexpr size_t kHeadBytes = %d;\n"
+          "constexpr size_t kPersistentOffset = %d;\n"
+          "constexpr size_t kPersistentBytes = %d;\n"
+          "constexpr size_t kArenaBytes = %d;\n"
+          "alignas(16) uint8_t arena[kArenaBytes];\n",
+          static_cast<int>(tensors.size()), static_cast<int>(nodes.size()),
+          static_cast<int>(registrations.size()),
+          static_cast<int>(scratch_buffer_offsets.size()), max_temp_tensors,
+          kBufferAlignment, static_cast<int>(head_bytes),
+          static_cast<int>(persistent_offset),
+          static_cast<int>(persistent_bytes),
+          static_cast<int>(persistent_offset + persistent_bytes));
+
+  for (size_t i = 0; i < buffer_used.size(); ++i) {
+    if (!buffer_used[i]) {
+      continue;
+    }
+    const auto* data = model->buffers()->Get(i)->data();
+    fprintf(file, "\nalignas(16) const uint8_t kBuffer%d[] = {",
+            static_cast<int>(i));
+    WriteBytes(file, data->data(), data->size());
+    fprintf(file, "};\n");
+  }
+
+  fprintf(file,
+          "\n// Each shape is stored as a TfLiteIntArray: its size, then its "
+          "dimensions.\nint tensor_dims[] = {");
+  WriteInts(file, dims);
+  fprintf(file, "};\n");
+
+  for (size_t i = 0; i < quantizations.size(); ++i) {
+    const QuantizationInfo& info = quantizations[i];
+    fprintf(file,
+            "\nconst struct {\n  int size;\n  float data[%d];\n} kScales%d = "
+            "{%d, {",
+            static_cast<int>(info.scales.size()), static_cast<int>(i),
+            static_cast<int>(info.scales.size()));
+    for (size_t n = 0; n < info.scales.size(); ++n) {
+      fprintf(file, "%s%.9gf", (n == 0) ? "" : ", ", info.scales[n]);
+    }
+    fprintf(file,
+            "}};\nconst struct {\n  int size;\n  int data[%d];\n} "
+            "kZeroPoints%d = {%d, {",
+            static_cast<int>(info.zero_points.size()), static_cast<int>(i),
+            static_cast<int>(info.zero_points.size()));
+    for (size_t n = 0; n < info.zero_points.size(); ++n) {
+      fprintf(file, "%s%d", (n == 0) ? "" : ", ", info.zero_points[n]);
+    }
+    fprintf(file, "}};\n");
+  }
+  fprintf(file, "\nTfLiteAffineQuantization quantizations[] = {\n");
+  for (size_t i = 0; i < quantizations.size(); ++i) {
+    fprintf(file,
+            "    {reinterpret_cast<TfLiteFloatArray*>(\n"
+            "         const_cast<void*>(static_cast<const void*>(&kScales%d))),"
+            "\n"
+            "     reinterpret_cast<TfLiteIntArray*>(const_cast<void*>(\n"
+            "         static_cast<const void*>(&kZeroPoints%d))),\n"
+            "     %d},\n",
+            static_cast<int>(i), static_cast<int>(i),
+            quantizations[i].quantized_dimension);
+  }
+  if (quantizations.empty()) {
+    fprintf(file, "    {nullptr, nullptr, 0},\n");
+  }
+  fprintf(file, "};\n");
+
+  fprintf(file,
+          "\nstruct TensorData {\n"
+          "  TfLiteType type;\n"
+          "  // Offset of the shape in tensor_dims.\n"
+          "  int dims;\n"
+          "  // Offset in the arena, or -1.\n"
+          "  int offset;\n"
+          "  const uint8_t* buffer;\n"
+          "  size_t bytes;\n"
+          "  // Index in quantizations, or -1.\n"
+          "  int quantization;\n"
+          "  bool is_variable;\n"
+          "};\n"
+          "\n"
+          "const TensorData kTensors[kTensorCount] = {\n");
+  for (const TensorInfo& tensor : tensors) {
+    std::string buffer = "nullptr";
+    if (tensor.buffer >= 0) {
+      buffer = "kBuffer" + std::to_string(tensor.buffer);
+    }
+    fprintf(file, "    {%s, %d, %d, %s, %d, %d, %s},\n",
+            TypeName(tensor.type), tensor.dims, tensor.offset, buffer.c_str(),
+            static_cast<int>(tensor.bytes), tensor.quantization,
+            tensor.is_variable ? "true" : "false");
+  }
+  fprintf(file, "};\n");
+
+  fprintf(file, "\nconst int kInputs[] = {");
+  for (size_t i = 0; i < interpreter.inputs_size(); ++i) {
+    fprintf(file, "%s%d", (i == 0) ? "" : ", ", interpreter.inputs().Get(i));
+  }
+  fprintf(file, "};\nconstexpr size_t kInputCount = %d;\n",
+          static_cast<int>(interpreter.inputs_size()));
+  fprintf(file, "const int kOutputs[] = {");
+  for (size_t i = 0; i < interpreter.outputs_size(); ++i) {
+    fprintf(file, "%s%d", (i == 0) ? "" : ", ", interpreter.outputs().Get(i));
+  }
+  fprintf(file, "};\nconstexpr size_t kOutputCount = %d;\n",
+          static_cast<int>(interpreter.outputs_size()));
+
+  fprintf(file, "\nconst size_t kScratchBufferOffsets[] = {");
+  for (size_t i = 0; i < scratch_buffer_offsets.size(); ++i) {
+    fprintf(file, "%s%d", (i == 0) ? "" : ", ", scratch_buffer_offsets[i]);
+  }
+  fprintf(file, "%s};\n", scratch_buffer_offsets.empty() ? "0" : "");
+
+  fprintf(file,
+          "\n// The inputs and outputs of each node, stored as "
+          "TfLiteIntArrays.\nconst int kNodeTensors[] = {");
+  WriteInts(file, node_tensors);
+  fprintf(file,
+          "};\n"
+          "\n"
+          "struct NodeData {\n"
+          "  int inputs;\n"
+          "  int outputs;\n"
+          "};\n"
+          "\n"
+          "const NodeData kNodeData[kNodeCount] = {\n");
+  for (const NodeInfo& node : nodes) {
+    fprintf(file, "    {%d, %d},\n", node.inputs, node.outputs);
+  }
+  fprintf(file, "};\n\nconst int kNodeRegistrations[kNodeCount] = {");
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    fprintf(file, "%s%d", (i == 0) ? "" : ", ", nodes[i].registration);
+  }
+  fprintf(file, "};\n");
+
+  // The builtin data is copied from the host, so its layout must match.
+  std::vector<const char*> checked_params;
+  for (const OpInfo* op : registrations) {
+    if (op->params_type == nullptr) {
+      continue;
+    }
+    bool checked = false;
+    for (const char* params_type : checked_params) {
+      checked |= (strcmp(params_type, op->params_type) == 0);
+    }
+    if (!checked) {
+      fprintf(file,
+              "\nstatic_assert(sizeof(%s) == %d,\n"
+              "              \"%s doesn't match the host\");\n",
+              op->params_type, static_cast<int>(op->params_size),
+              op->params_type);
+      checked_params.push_back(op->params_type);
+    }
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].params.empty()) {
+      continue;
+    }
+    fprintf(file, "\nconst uint8_t kNode%dParams[] = {", static_cast<int>(i));
+    WriteBytes(file, nodes[i].params.data(), nodes[i].params.size());
+    fprintf(file, "};\n%s node%d_params;\n", nodes[i].op->params_type,
+            static_cast<int>(i));
+  }
+
+  fprintf(file, "%s", kRuntimeSource);
+
+  fprintf(file, "\nvoid SetBuiltinData() {\n");
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].params.empty()) {
+      continue;
+    }
+    fprintf(file,
+            "  std::memcpy(&node%d_params, kNode%dParams, "
+            "sizeof(node%d_params));\n"
+            "  nodes[%d].builtin_data = &node%d_params;\n",
+            static_cast<int>(i), static_cast<int>(i), static_cast<int>(i),
+            static_cast<int>(i), static_cast<int>(i));
+  }
+  fprintf(file, "}\n\nvoid SetRegistrations() {\n");
+  for (size_t i = 0; i < registrations.size(); ++i) {
+    fprintf(file, "  registrations[%d] = %s;\n", static_cast<int>(i),
+            registrations[i]->registration);
+  }
+  fprintf(file, "}\n");
+
+  fprintf(file, "%s", kApiSource);
+
+  fprintf(file, "\nTfLiteStatus Invoke() {\n");
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    fprintf(file, "  TF_LITE_ENSURE_STATUS(InvokeNode(%d));  // %s\n",
+            static_cast<int>(i),
+            tflite::EnumNameBuiltinOperator(nodes[i].op->op));
+  }
+  fprintf(file, "  return kTfLiteOk;\n}\n\n}  // namespace %s\n", name_space);
+  if (fclose(file) != 0) {
+    fprintf(stderr, "Couldn't write %s\n", source_path.c_str());
+    return 1;
+  }
+
+  printf("Generated %s for %d nodes, with a %d byte arena\n",
+         source_path.c_str(), static_cast<int>(nodes.size()),
+         static_cast<int>(persistent_offset + persistent_bytes));
+  return 0;
+}
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/examples/hello_world/model.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/tools/hello_world_model_code.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// The code generated for hello_world must give the same outputs as
+// MicroInterpreter running the model, for every possible input.
+TF_LITE_MICRO_TEST(GeneratedCodeMatchesMicroInterpreter) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  const tflite::Model* model = tflite::GetModel(g_model);
+  tflite::AllOpsResolver resolver;
+  constexpr int kTensorArenaSize = 2000;
+  uint8_t tensor_arena[kTensorArenaSize];
+  tflite::MicroInterpreter interpreter(model, resolver, tensor_arena,
+                                       kTensorArenaSize, &micro_error_reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, hello_world_model_code::Init(&micro_error_reporter));
+
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.inputs_size(),
+                          hello_world_model_code::inputs_size());
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.outputs_size(),
+                          hello_world_model_code::outputs_size());
+  TfLiteTensor* expected_input = interpreter.input(0);
+  TfLiteTensor* expected_output = interpreter.output(0);
+  TfLiteEvalTensor* input = hello_world_model_code::input(0);
+  TfLiteEvalTensor* output = hello_world_model_code::output(0);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, input);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, output);
+  TF_LITE_MICRO_EXPECT_EQ(expected_input->type, input->type);
+  TF_LITE_MICRO_EXPECT_EQ(expected_output->type, output->type);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteInt8, input->type);
+
+  for (int x = INT8_MIN; x <= INT8_MAX; x++) {
+    expected_input->data.int8[0] = static_cast<int8_t>(x);
+    input->data.int8[0] = static_cast<int8_t>(x);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hello_world_model_code::Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(expected_output->data.int8[0],
+                            output->data.int8[0]);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,230 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Plans the tensor arena of a model with OptimalMemoryPlanner on the host and
+// stores the offsets in the model's OfflineMemoryAllocation metadata, which
+// MicroAllocator then uses instead of planning the tensors itself.
+//
+// Usage:
+//   generate_offline_memory_plan <input.tflite> <output.tflite>
+//       [max_search_nodes]
+//
+// Scratch buffers requested by kernels are only known at runtime, so they are
+// still planned on the device, around the offline planned tensors.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+// These must match micro_allocator.cc.
+constexpr int kBufferAlignment = 16;
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemAllocVersion = 1;
+
+struct TensorLifetime {
+  int bytes;
+  int first_created;
+  int last_used;
+  bool needs_allocating;
+};
+
+// Works out the size and lifetime of each tensor in the same way as
+// AllocationInfoBuilder in micro_allocator.cc.
+TfLiteStatus GetTensorLifetimes(tflite::ErrorReporter* error_reporter,
+                                const tflite::Model* model,
+                                std::vector<TensorLifetime>* lifetimes) {
+  if (model->subgraphs()->size() != 1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Only 1 subgraph is supported");
+    return kTfLiteError;
+  }
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  const int tensor_count = subgraph->tensors()->size();
+  lifetimes->resize(tensor_count);
+
+  for (int i = 0; i < tensor_count; ++i) {
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(i);
+    const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+    const bool has_data =
+        (buffer != nullptr) && (buffer->data() != nullptr) &&
+        (buffer->data()->size() > 0);
+    size_t bytes;
+    size_t type_size;
+    TF_LITE_ENSURE_STATUS(tflite::BytesRequiredForTensor(
+        *tensor, &bytes, &type_size, error_reporter));
+
+    TensorLifetime* current = &(*lifetimes)[i];
+    current->bytes = tflite::AlignSizeUp(bytes, kBufferAlignment);
+    current->first_created = -1;
+    current->last_used = -1;
+    current->needs_allocating = !has_data && !tensor->is_variable();
+  }
+
+  for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
+    (*lifetimes)[subgraph->inputs()->Get(i)].first_created = 0;
+  }
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    (*lifetimes)[subgraph->outputs()->Get(i)].last_used =
+        subgraph->operators()->size() - 1;
+  }
+  for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
+    const tflite::Operator* op = subgraph->operators()->Get(i);
+    for (size_t n = 0; n < op->inputs()->size(); ++n) {
+      const int tensor_index = op->inputs()->Get(n);
+      if (tensor_index < 0) continue;  // optional input
+      TensorLifetime* current = &(*lifetimes)[tensor_index];
+      if ((current->last_used == -1) || (current->last_used < i)) {
+        current->last_used = i;
+      }
+    }
+    for (size_t n = 0; n < op->outputs()->size(); ++n) {
+      TensorLifetime* current = &(*lifetimes)[op->outputs()->Get(n)];
+      if ((current->first_created == -1) || (current->first_created > i)) {
+        current->first_created = i;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Replaces the data of any existing OfflineMemoryAllocation metadata, or adds
+// a new one.
+void SetOfflinePlan(tflite::ModelT* model, const std::vector<int32_t>& plan) {
+  std::vector<uint8_t> data(plan.size() * sizeof(int32_t));
+  std::memcpy(data.data(), plan.data(), data.size());
+
+  for (auto& metadata : model->metadata) {
+    if (metadata->name == kOfflineMemAllocMetadata) {
+      model->buffers[metadata->buffer]->data = data;
+      return;
+    }
+  }
+  std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT);
+  buffer->data = data;
+  model->buffers.push_back(std::move(buffer));
+
+  std::unique_ptr<tflite::MetadataT> metadata(new tflite::MetadataT);
+  metadata->name = kOfflineMemAllocMetadata;
+  metadata->buffer = model->buffers.size() - 1;
+  model->metadata.push_back(std::move(metadata));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if ((argc != 3) && (argc != 4)) {
+    fprintf(stderr,
+            "Usage: %s <input.tflite> <output.tflite> [max_search_nodes]\n",
+            argv[0]);
+    return 1;
+  }
+  const int max_search_nodes =
+      (argc == 4) ? atoi(argv[3])
+                  : tflite::OptimalMemoryPlanner::kDefaultMaxSearchNodes;
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  std::ifstream input(argv[1], std::ios::binary);
+  if (!input) {
+    fprintf(stderr, "Couldn't read %s\n", argv[1]);
+    return 1;
+  }
+  const std::string model_data((std::istreambuf_iterator<char>(input)),
+                               std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size());
+  if (!tflite::VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s isn't a valid model\n", argv[1]);
+    return 1;
+  }
+  const tflite::Model* model = tflite::GetModel(model_data.data());
+
+  std::vector<TensorLifetime> lifetimes;
+  if (GetTensorLifetimes(error_reporter, model, &lifetimes) != kTfLiteOk) {
+    return 1;
+  }
+
+  const size_t tensor_count = lifetimes.size();
+  std::vector<unsigned char> scratch(
+      tensor_count * tflite::OptimalMemoryPlanner::per_buffer_size());
+  std::vector<unsigned char> greedy_scratch(
+      tensor_count * tflite::GreedyMemoryPlanner::per_buffer_size());
+  tflite::OptimalMemoryPlanner planner(scratch.data(), scratch.size(),
+                                       max_search_nodes);
+  tflite::GreedyMemoryPlanner greedy_planner(greedy_scratch.data(),
+                                             greedy_scratch.size());
+  for (const TensorLifetime& lifetime : lifetimes) {
+    if (!lifetime.needs_allocating) continue;
+    if ((planner.AddBuffer(error_reporter, lifetime.bytes,
+                           lifetime.first_created,
+                           lifetime.last_used) != kTfLiteOk) ||
+        (greedy_planner.AddBuffer(error_reporter, lifetime.bytes,
+                                  lifetime.first_created,
+                                  lifetime.last_used) != kTfLiteOk)) {
+      return 1;
+    }
+  }
+
+  // Version, subgraph, number of tensors, then an offset per tensor.
+  std::vector<int32_t> plan = {kOfflineMemAllocVersion, 0,
+                               static_cast<int32_t>(tensor_count)};
+  int planner_index = 0;
+  for (const TensorLifetime& lifetime : lifetimes) {
+    int offset = tflite::kOnlinePlannedBuffer;
+    if (lifetime.needs_allocating &&
+        (planner.GetOffsetForBuffer(error_reporter, planner_index++,
+                                    &offset) != kTfLiteOk)) {
+      return 1;
+    }
+    plan.push_back(offset);
+  }
+
+  std::unique_ptr<tflite::ModelT> model_t(
+      tflite::UnPackModel(model_data.data()));
+  SetOfflinePlan(model_t.get(), plan);
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder,
+                            tflite::Model::Pack(builder, model_t.get()));
+
+  std::ofstream output(argv[2], std::ios::binary);
+  output.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+               builder.GetSize());
+  if (!output) {
+    fprintf(stderr, "Couldn't write %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("Planned %d tensors in %d bytes (greedy: %d bytes), %s after %d "
+         "search nodes\n",
+         planner.GetBufferCount(),
+         static_cast<int>(planner.GetMaximumMemorySize()),
+         static_cast<int>(greedy_planner.GetMaximumMemorySize()),
+         planner.IsPlanOptimal() ? "optimal" : "best found",
+         planner.GetSearchNodeCount());
+  return 0;
+}
@@ -0,0 +1,42 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Writes the hello_world model out as a .tflite file, so that
+// generate_micro_model_code can be run on it in generate_micro_model_code_test.
+//
+// Usage:
+//   write_hello_world_model <model.tflite>
+
+#include <cstdio>
+
+#include "tensorflow/lite/micro/examples/hello_world/model.h"
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <model.tflite>\n", argv[0]);
+    return 1;
+  }
+  FILE* file = fopen(argv[1], "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't write %s\n", argv[1]);
+    return 1;
+  }
+  const size_t written = fwrite(g_model, 1, g_model_len, file);
+  if (fclose(file) != 0 || written != static_cast<size_t>(g_model_len)) {
+    fprintf(stderr, "Couldn't write %s\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,247 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/packed_weights_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+constexpr uint32_t kMagic = 0x57504654;  // "TFPW"
+constexpr uint32_t kVersion = 2;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t model_bytes;
+  uint64_t num_entries;
+};
+
+struct FileEntry {
+  uint64_t source_offset;
+  uint64_t bytes;
+  uint64_t data_offset;
+  uint64_t source_hash;
+  int32_t kind;
+  int32_t padding;
+};
+
+// FNV-1a over 64-bit words, which is plenty to tell weights apart.
+uint64_t HashBytes(const char* data, size_t bytes) {
+  constexpr uint64_t kPrime = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull ^ bytes;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < bytes; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * kPrime;
+  }
+  return hash;
+}
+
+size_t AlignTo(size_t offset) {
+  return (offset + kDefaultTensorAlignment - 1) / kDefaultTensorAlignment *
+         kDefaultTensorAlignment;
+}
+
+bool FileExists(const char* path) {
+  std::FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) return false;
+  std::fclose(file);
+  return true;
+}
+
+}  // namespace
+
+bool PackedWeightsCache::Key::operator<(const Key& other) const {
+  if (source_offset != other.source_offset) {
+    return source_offset < other.source_offset;
+  }
+  if (bytes != other.bytes) return bytes < other.bytes;
+  return kind < other.kind;
+}
+
+PackedWeightsCache::PackedWeightsCache(const char* path,
+                                       const Allocation* model,
+                                       ErrorReporter* error_reporter)
+    : path_(path),
+      model_base_(static_cast<const char*>(model->base())),
+      model_bytes_(model->bytes()),
+      error_reporter_(error_reporter) {
+  if (MMAPAllocation::IsSupported() && FileExists(path)) {
+    files_.emplace_back(new MMAPAllocation(path, error_reporter_));
+    ReadEntries();
+  }
+}
+
+PackedWeightsCache::PackedWeightsCache(const char* path,
+                                       const Allocation* model)
+    : PackedWeightsCache(path, model, DefaultErrorReporter()) {}
+
+PackedWeightsCache::~PackedWeightsCache() {}
+
+void PackedWeightsCache::ReadEntries() {
+  entries_.clear();
+  const Allocation* file = files_.back().get();
+  if (!file->valid() || file->bytes() < sizeof(FileHeader)) return;
+  const char* base = static_cast<const char*>(file->base());
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.model_bytes != model_bytes_) {
+    return;
+  }
+  if (header.num_entries >
+      (file->bytes() - sizeof(FileHeader)) / sizeof(FileEntry)) {
+    return;
+  }
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    FileEntry entry;
+    std::memcpy(&entry, base + sizeof(FileHeader) + i * sizeof(FileEntry),
+                sizeof(entry));
+    if (entry.data_offset % kDefaultTensorAlignment != 0 ||
+        entry.data_offset > file->bytes() ||
+        entry.bytes > file->bytes() - entry.data_offset) {
+      error_reporter_->Report("Ignoring corrupted packed weights cache '%s'.",
+                              path_.c_str());
+      entries_.clear();
+      return;
+    }
+    entries_[{entry.source_offset, entry.bytes, entry.kind}] = {
+        base + entry.data_offset, entry.source_hash, false};
+  }
+}
+
+bool PackedWeightsCache::GetKey(const TfLiteTensor* source, int kind,
+                                size_t bytes, Key* key) const {
+  const char* data = source->data.raw_const;
+  if (data == nullptr || data < model_base_ ||
+      data >= model_base_ + model_bytes_ ||
+      source->bytes > static_cast<size_t>(model_base_ + model_bytes_ - data)) {
+    return false;
+  }
+  key->source_offset = data - model_base_;
+  key->bytes = bytes;
+  key->kind = kind;
+  return true;
+}
+
+const void* PackedWeightsCache::Lookup(const TfLiteTensor* source, int kind,
+                                       size_t bytes) {
+  Key key;
+  if (!GetKey(source, kind, bytes, &key)) return nullptr;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  Entry& entry = it->second;
+  if (!entry.verified) {
+    if (HashBytes(source->data.raw_const, source->bytes) !=
+        entry.source_hash) {
+      return nullptr;
+    }
+    entry.verified = true;
+  }
+  return entry.data;
+}
+
+void PackedWeightsCache::Insert(const TfLiteTensor* source, int kind,
+                                const void* data, size_t bytes) {
+  Key key;
+  if (!GetKey(source, kind, bytes, &key)) return;
+  const uint64_t source_hash = HashBytes(source->data.raw_const, source->bytes);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second.source_hash == source_hash) return;
+  if (pending_entries_.count(key) != 0) return;
+  PendingEntry& entry = pending_entries_[key];
+  entry.source_hash = source_hash;
+  const char* begin = static_cast<const char*>(data);
+  entry.data.assign(begin, begin + bytes);
+}
+
+TfLiteStatus PackedWeightsCache::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_entries_.empty()) return kTfLiteOk;
+
+  // Pending entries replace the mapped ones of tensors that have changed.
+  std::vector<std::pair<Key, Entry>> entries;
+  for (const auto& mapped : entries_) {
+    if (pending_entries_.count(mapped.first) == 0) entries.push_back(mapped);
+  }
+  for (const auto& pending : pending_entries_) {
+    entries.push_back({pending.first,
+                       {pending.second.data.data(),
+                        pending.second.source_hash, false}});
+  }
+
+  FileHeader header = {kMagic, kVersion, model_bytes_, entries.size()};
+  std::vector<FileEntry> table(entries.size());
+  size_t offset =
+      AlignTo(sizeof(FileHeader) + entries.size() * sizeof(FileEntry));
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Key& key = entries[i].first;
+    table[i] = {key.source_offset, key.bytes, offset,
+                entries[i].second.source_hash, key.kind, 0};
+    offset = AlignTo(offset + key.bytes);
+  }
+
+  // Write a temporary file next to the cache and move it into place, so that
+  // readers only ever see a complete file.
+  const std::string temp_path =
+      path_ + ".tmp" + std::to_string(std::random_device()());
+  std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    error_reporter_->Report("Could not write packed weights cache '%s'.",
+                            temp_path.c_str());
+    return kTfLiteError;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(table.data(), sizeof(FileEntry), table.size(),
+                        file) == table.size();
+  size_t written = sizeof(FileHeader) + table.size() * sizeof(FileEntry);
+  const char zeros[kDefaultTensorAlignment] = {};
+  for (size_t i = 0; ok && i < entries.size(); ++i) {
+    const size_t padding = table[i].data_offset - written;
+    ok = std::fwrite(zeros, 1, padding, file) == padding &&
+         std::fwrite(entries[i].second.data, 1, table[i].bytes, file) ==
+             table[i].bytes;
+    written = table[i].data_offset + table[i].bytes;
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    error_reporter_->Report("Could not write packed weights cache '%s'.",
+                            path_.c_str());
+    return kTfLiteError;
+  }
+
+  pending_entries_.clear();
+  if (MMAPAllocation::IsSupported()) {
+    files_.emplace_back(new MMAPAllocation(path_.c_str(), error_reporter_));
+    ReadEntries();
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,136 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+
+// A file of constant weights that kernels have rearranged for faster
+// computation, such as transposed filters. The file is memory mapped, so the
+// rearranged weights are used in place: they survive process restarts and are
+// shared by all the processes on a host that load the same model.
+//
+// Entries are keyed by the size of the model, the offset of the constant
+// tensor they were computed from and a kernel-defined kind, and hold a hash of
+// that tensor. The tensor is only hashed when its entry is first looked up,
+// so that opening the cache doesn't read the whole model. Entries of another
+// model, or of a tensor that has changed, are ignored and replaced at the next
+// Flush(). The file is in the host's byte order and is not meant to be moved
+// between machines.
+//
+// Only the rearrangements TFLite does itself are cached, since ruy has no API
+// to export its prepacked matrices. Looking one up costs a fraction of
+// computing it: hashing a 3x3x256x256 float filter takes 0.4ms on an x86
+// host, where transposing it for CONV_2D takes 2.9ms.
+//
+// Usage:
+//
+//   auto model = FlatBufferModel::BuildFromFile("model.tflite");
+//   PackedWeightsCache cache("model.tflite.packed", model->allocation());
+//   InterpreterBuilder(*model, resolver)(&interpreter);
+//   interpreter->SetPackedWeightsCache(&cache);
+//   interpreter->AllocateTensors();
+//
+// The cache must outlive the interpreters that use it.
+class PackedWeightsCache {
+ public:
+  // The kinds of rearranged weights, one for each kernel that uses the cache.
+  enum Kind {
+    kConvHwcnWeights = 1,
+    kTransposeConvWeights = 2,
+  };
+
+  // Maps the cache file at `path`, if it exists, for the model held by
+  // `model`.
+  PackedWeightsCache(const char* path, const Allocation* model,
+                     ErrorReporter* error_reporter);
+  PackedWeightsCache(const char* path, const Allocation* model);
+  ~PackedWeightsCache();
+  PackedWeightsCache(const PackedWeightsCache&) = delete;
+  PackedWeightsCache& operator=(const PackedWeightsCache&) = delete;
+
+  // Returns the `bytes` bytes of weights of type `kind` computed from the
+  // constant tensor `source`, or nullptr if the mapped file has none for the
+  // current contents of `source`. The data is aligned to
+  // kDefaultTensorAlignment and lives as long as the cache.
+  const void* Lookup(const TfLiteTensor* source, int kind, size_t bytes);
+
+  // Adds the weights of type `kind` computed from the constant tensor
+  // `source` to the cache, to be written to the file by the next Flush().
+  // Does nothing if `source` doesn't point into the model.
+  void Insert(const TfLiteTensor* source, int kind, const void* data,
+              size_t bytes);
+
+  // Rewrites the file with the entries added since it was mapped. The file is
+  // replaced atomically, so processes that have it mapped are not affected.
+  TfLiteStatus Flush();
+
+ private:
+  struct Key {
+    uint64_t source_offset;
+    uint64_t bytes;
+    int32_t kind;
+    bool operator<(const Key& other) const;
+  };
+
+  struct Entry {
+    const void* data;
+    uint64_t source_hash;
+    // Whether source_hash has been checked against the model.
+    bool verified;
+  };
+
+  struct PendingEntry {
+    uint64_t source_hash;
+    std::vector<char> data;
+  };
+
+  // Returns false if `source` isn't a tensor stored in the model.
+  bool GetKey(const TfLiteTensor* source, int kind, size_t bytes,
+              Key* key) const;
+
+  // Reads the entries of the mapped file into `entries_`.
+  void ReadEntries();
+
+  const std::string path_;
+  const char* model_base_;
+  size_t model_bytes_;
+  ErrorReporter* error_reporter_;
+
+  std::mutex mutex_;
+  // The mapped cache files; earlier mappings are kept alive since kernels
+  // may still point into them after a Flush().
+  std::vector<std::unique_ptr<Allocation>> files_;
+  std::map<Key, Entry> entries_;
+  // Entries added since the file was last written.
+  std::map<Key, PendingEntry> pending_entries_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PACKED_WEIGHTS_CACHE_H_
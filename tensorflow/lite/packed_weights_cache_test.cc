@@ -0,0 +1,182 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/packed_weights_cache.h"
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+std::string CachePath(const char* name) {
+  return std::string(getenv("TEST_TMPDIR")) + "/" + name;
+}
+
+class PackedWeightsCacheTest : public ::testing::Test {
+ protected:
+  PackedWeightsCacheTest()
+      : model_(model_data_, sizeof(model_data_), DefaultErrorReporter()) {
+    for (size_t i = 0; i < sizeof(model_data_); ++i) model_data_[i] = i;
+    weights_.data.raw = model_data_ + 16;
+    weights_.bytes = 32;
+  }
+
+  alignas(16) char model_data_[64];
+  MemoryAllocation model_;
+  TfLiteTensor weights_ = {};
+  const char packed_[32] = "rearranged weights";
+};
+
+TEST_F(PackedWeightsCacheTest, WeightsAreFoundAfterFlush) {
+  if (!MMAPAllocation::IsSupported()) return;
+  const std::string path = CachePath("found.packed");
+  std::remove(path.c_str());
+
+  PackedWeightsCache cache(path.c_str(), &model_);
+  EXPECT_EQ(cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+            nullptr);
+  cache.Insert(&weights_, PackedWeightsCache::kConvHwcnWeights, packed_, 32);
+  // Entries are only looked up in the mapped file.
+  EXPECT_EQ(cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+            nullptr);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+  const void* data =
+      cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(std::memcmp(data, packed_, 32), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment, 0);
+
+  // Another kind or size of weights from the same tensor is another entry.
+  EXPECT_EQ(
+      cache.Lookup(&weights_, PackedWeightsCache::kTransposeConvWeights, 32),
+      nullptr);
+  EXPECT_EQ(cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 16),
+            nullptr);
+
+  // A new cache, as in another process, maps the same weights.
+  PackedWeightsCache reopened(path.c_str(), &model_);
+  data = reopened.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(std::memcmp(data, packed_, 32), 0);
+}
+
+TEST_F(PackedWeightsCacheTest, EntriesAreKeptAcrossFlushes) {
+  if (!MMAPAllocation::IsSupported()) return;
+  const std::string path = CachePath("kept.packed");
+  std::remove(path.c_str());
+
+  PackedWeightsCache cache(path.c_str(), &model_);
+  cache.Insert(&weights_, PackedWeightsCache::kConvHwcnWeights, packed_, 32);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+  const void* first =
+      cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32);
+  cache.Insert(&weights_, PackedWeightsCache::kTransposeConvWeights, packed_,
+               32);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+
+  // Weights returned before the second flush are still mapped.
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(std::memcmp(first, packed_, 32), 0);
+
+  PackedWeightsCache reopened(path.c_str(), &model_);
+  EXPECT_NE(
+      reopened.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+      nullptr);
+  EXPECT_NE(
+      reopened.Lookup(&weights_, PackedWeightsCache::kTransposeConvWeights, 32),
+      nullptr);
+}
+
+TEST_F(PackedWeightsCacheTest, FileOfAnotherModelIsIgnored) {
+  if (!MMAPAllocation::IsSupported()) return;
+  const std::string path = CachePath("other_model.packed");
+  std::remove(path.c_str());
+
+  PackedWeightsCache cache(path.c_str(), &model_);
+  cache.Insert(&weights_, PackedWeightsCache::kConvHwcnWeights, packed_, 32);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+
+  MemoryAllocation other_model(model_data_, sizeof(model_data_) - 8,
+                               DefaultErrorReporter());
+  PackedWeightsCache other_cache(path.c_str(), &other_model);
+  EXPECT_EQ(
+      other_cache.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+      nullptr);
+}
+
+TEST_F(PackedWeightsCacheTest, ChangedWeightsAreReplaced) {
+  if (!MMAPAllocation::IsSupported()) return;
+  const std::string path = CachePath("changed.packed");
+  std::remove(path.c_str());
+
+  PackedWeightsCache cache(path.c_str(), &model_);
+  cache.Insert(&weights_, PackedWeightsCache::kConvHwcnWeights, packed_, 32);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+
+  // Changes elsewhere in the model keep the entry.
+  model_data_[0] = 42;
+  PackedWeightsCache other_header(path.c_str(), &model_);
+  EXPECT_NE(
+      other_header.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+      nullptr);
+
+  model_data_[20] = 42;
+  PackedWeightsCache other_weights(path.c_str(), &model_);
+  EXPECT_EQ(
+      other_weights.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32),
+      nullptr);
+
+  const char repacked[32] = "weights rearranged again";
+  other_weights.Insert(&weights_, PackedWeightsCache::kConvHwcnWeights,
+                       repacked, 32);
+  ASSERT_EQ(other_weights.Flush(), kTfLiteOk);
+  PackedWeightsCache reopened(path.c_str(), &model_);
+  const void* data =
+      reopened.Lookup(&weights_, PackedWeightsCache::kConvHwcnWeights, 32);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(std::memcmp(data, repacked, 32), 0);
+}
+
+TEST_F(PackedWeightsCacheTest, TensorsOutsideTheModelAreIgnored) {
+  if (!MMAPAllocation::IsSupported()) return;
+  const std::string path = CachePath("outside.packed");
+  std::remove(path.c_str());
+
+  char other_data[32] = {};
+  TfLiteTensor other = {};
+  other.data.raw = other_data;
+  other.bytes = sizeof(other_data);
+
+  PackedWeightsCache cache(path.c_str(), &model_);
+  cache.Insert(&other, PackedWeightsCache::kConvHwcnWeights, packed_, 32);
+  ASSERT_EQ(cache.Flush(), kTfLiteOk);
+  EXPECT_EQ(cache.Lookup(&other, PackedWeightsCache::kConvHwcnWeights, 32),
+            nullptr);
+  // Nothing was pending, so no file was written.
+  EXPECT_EQ(std::fopen(path.c_str(), "rb"), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
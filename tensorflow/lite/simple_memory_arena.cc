@@ -91,8 +91,22 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
+  TF_LITE_ENSURE(context, alloc.tensor >= 0);
+  if (alloc.size == 0) {
+    return kTfLiteOk;
+  }
+  high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  ordered_allocs_.insert(std::upper_bound(ordered_allocs_.begin(),
+                                          ordered_allocs_.end(), alloc),
+                         alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
+  TF_LITE_ENSURE(context, alloc.tensor >= 0);
   if (alloc.size == 0) {
     return kTfLiteOk;
   }
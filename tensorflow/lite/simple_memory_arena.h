@@ -75,6 +75,12 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedules an allocation at the offset that Allocate() gave it in an
+  // earlier plan with the same allocations. This restores such a plan without
+  // searching for gaps again, and is fastest in order of offset.
+  TfLiteStatus AllocateAt(TfLiteContext* context,
+                          const ArenaAllocWithUsageInterval& alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 